@@ -7,8 +7,11 @@
 QT       += core gui
 QT       += xml
 QT       += printsupport
+QT       += network
 
 CONFIG   += qwt
+# constexpr std::array coefficient tables (sorpprops/propcoefficients.h)
+CONFIG   += c++14
 win32:CONFIG += console
 
 # Uncomment if you want to set this in here, otherwise set an environment variable
@@ -147,7 +150,20 @@ SOURCES += main.cpp \
     selectparadialog.cpp \
     resultdisplaydialog.cpp \
     resultdialog.cpp \
+    optimizer.cpp \
+    optimizedialog.cpp \
+    uncertainty.cpp \
+    uncertaintydialog.cpp \
+    annualsimulation.cpp \
+    annualdialog.cpp \
+    doedesign.cpp \
+    doedialog.cpp \
+    surrogate.cpp \
+    surrogatedialog.cpp \
+    multistart.cpp \
     plotproperty.cpp \
+    plotbackground.cpp \
+    lodcurve.cpp \
     node.cpp \
     myview.cpp \
     myscene.cpp \
@@ -199,7 +215,13 @@ SOURCES += main.cpp \
     curvesettingdialog.cpp \
     editpropertycurvedialog.cpp \
     ifixdialog.cpp \
-    sorputils.cpp
+    sorputils.cpp \
+    solverpool.cpp \
+    solvercache.cpp \
+    solvercase.cpp \
+    solverserver.cpp \
+    propbench.cpp \
+    correlationbench.cpp
 
 HEADERS  += \
     unitconvert.h \
@@ -212,7 +234,20 @@ HEADERS  += \
     selectparadialog.h \
     resultdisplaydialog.h \
     resultdialog.h \
+    optimizer.h \
+    optimizedialog.h \
+    uncertainty.h \
+    uncertaintydialog.h \
+    annualsimulation.h \
+    annualdialog.h \
+    doedesign.h \
+    doedialog.h \
+    surrogate.h \
+    surrogatedialog.h \
+    multistart.h \
     plotproperty.h \
+    plotbackground.h \
+    lodcurve.h \
     node.h \
     myview.h \
     myscene.h \
@@ -266,6 +301,12 @@ HEADERS  += \
     curvesettingdialog.h \
     ifixdialog.h \
     sorputils.h \
+    solverpool.h \
+    solvercache.h \
+    solvercase.h \
+    solverserver.h \
+    propbench.h \
+    correlationbench.h \
     version.h
 
 FORMS    += \
@@ -276,6 +317,11 @@ FORMS    += \
     selectparadialog.ui \
     resultdisplaydialog.ui \
     resultdialog.ui \
+    optimizedialog.ui \
+    uncertaintydialog.ui \
+    annualdialog.ui \
+    doedialog.ui \
+    surrogatedialog.ui \
     mainwindow.ui \
     linkdialog.ui \
     globaldialog.ui \
@@ -313,6 +359,9 @@ FORMS    += \
     curvesettingdialog.ui \
     ifixdialog.ui
 
+# the property correlations (also built alone as libsorpprops, see sorpprops/sorpprops.pro)
+include(sorpprops/sorpprops.pri)
+
 RESOURCES += \
     functionIcons.qrc \
     examples.qrc
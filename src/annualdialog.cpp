@@ -0,0 +1,299 @@
+/*! \file annualdialog.cpp
+    \brief Dialog to simulate the current case over the hours of a weather file
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QApplication>
+#include <QComboBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QTableWidget>
+
+#include "annualdialog.h"
+#include "ui_annualdialog.h"
+#include "mainwindow.h"
+#include "calculate.h"
+#include "optimizer.h"
+#include "resultdialog.h"
+#include "unit.h"
+
+extern globalparameter globalpara;
+extern unit *dummy;
+
+namespace {
+
+enum InputColumns { UseColumn, NameColumn, ValueColumn, ColumnColumn, InputUnitColumn };
+enum OutputColumns { OutputUseColumn, OutputNameColumn, CaseColumn, TotalColumn, MeanColumn, OutputUnitColumn };
+
+QTableWidgetItem *fixedItem(const QString &text)
+{
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+
+QTableWidgetItem *useItem(bool checked)
+{
+    QTableWidgetItem *item = new QTableWidgetItem;
+    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+    item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    return item;
+}
+
+/// results that are rates, whose sum over the hours is an energy
+bool isRate(const sensitivityReport::item &item)
+{
+    return item.quantity == sensitivityReport::HeatTransfer || item.quantity == sensitivityReport::Capacity;
+}
+
+}
+
+annualDialog::annualDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::annualDialog),
+    ready(false),
+    running(false),
+    stopRequested(false)
+{
+    ui->setupUi(this);
+    setWindowTitle("Annual Simulation");
+    setWindowModality(Qt::ApplicationModal);
+
+    calculate mycal(dummy);
+    if(mycal.buildInputs(globalpara,baseInputs))
+    {
+        baseInputs.sensitivity = true;
+        if(globalpara.lastSolution.isValid())
+            baseInputs.warmStart = globalpara.lastSolution;
+        calOutputs result;
+        QString error;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        bool solved = designOptimizer::solveCase(baseInputs,result,&error);
+        QApplication::restoreOverrideCursor();
+        if(!solved)
+            log("The case as it is can't be solved ("+error+"), the hours need a converged case to start from.");
+        else if(!result.sensitivity.isValid())
+            log("No fixed inputs and results of the case: "+result.sensitivity.message);
+        else
+        {
+            baseReport = result.sensitivity;
+            baseInputs.warmStart = result.state;
+            ready = true;
+            log("Choose a weather file, the inputs its columns set (in the units of the case) and the results to keep.");
+        }
+    }
+    setupTables();
+    ui->runButton->setEnabled(ready);
+}
+
+annualDialog::~annualDialog()
+{
+    delete ui;
+}
+
+void annualDialog::setupTables()
+{
+    QStringList headers;
+    headers<<"Use"<<"Input"<<"Value"<<"Weather Column"<<"Unit";
+    QTableWidget *table = ui->inputTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(baseReport.inputs.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    for(int i = 0; i < baseReport.inputs.count(); i++)
+    {
+        const sensitivityReport::item &item = baseReport.inputs.at(i);
+        double value = resultDialog::inputToCase(item,designOptimizer::inputValue(baseInputs,item));
+        table->setItem(i,UseColumn,useItem(false));
+        table->setItem(i,NameColumn,fixedItem(resultDialog::sensitivityName(item)));
+        table->setItem(i,ValueColumn,fixedItem(QString::number(value)));
+        table->setCellWidget(i,ColumnColumn,new QComboBox);
+        table->setItem(i,InputUnitColumn,fixedItem(resultDialog::sensitivityUnit(item)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    headers.clear();
+    headers<<"Use"<<"Result"<<"Value"<<"Annual Total"<<"Mean"<<"Unit";
+    table = ui->outputTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(baseReport.outputs.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    for(int o = 0; o < baseReport.outputs.count(); o++)
+    {
+        const sensitivityReport::item &item = baseReport.outputs.at(o);
+        bool system = item.quantity == sensitivityReport::COP || item.quantity == sensitivityReport::Capacity;
+        table->setItem(o,OutputUseColumn,useItem(system));
+        table->setItem(o,OutputNameColumn,fixedItem(resultDialog::sensitivityName(item)));
+        table->setItem(o,CaseColumn,fixedItem(QString::number(resultDialog::resultToCase(item,baseReport.results.at(o)))));
+        table->setItem(o,TotalColumn,fixedItem(""));
+        table->setItem(o,MeanColumn,fixedItem(""));
+        table->setItem(o,OutputUnitColumn,fixedItem(resultDialog::sensitivityUnit(item)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+}
+
+void annualDialog::loadColumns(const QString &fileName)
+{
+    QString error;
+    QStringList names;
+    if(!annualSimulation::readColumns(fileName,names,&error))
+    {
+        globalpara.reportError(error,this);
+        return;
+    }
+    columns = names;
+    ui->weatherEdit->setText(fileName);
+    if(ui->resultEdit->text().isEmpty())
+    {
+        QFileInfo info(fileName);
+        ui->resultEdit->setText(info.absoluteDir().absoluteFilePath(info.completeBaseName()+"_hourly.csv"));
+    }
+    QTableWidget *table = ui->inputTable;
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        QComboBox *column = qobject_cast<QComboBox*>(table->cellWidget(i,ColumnColumn));
+        column->clear();
+        column->addItems(columns);
+    }
+    log(QFileInfo(fileName).fileName()+": "+QString::number(columns.count())+" columns.");
+}
+
+void annualDialog::on_weatherButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,"Weather File",ui->weatherEdit->text(),
+                                                    "CSV files (*.csv *.epw *.txt);;All files (*)");
+    if(!fileName.isEmpty())
+        loadColumns(fileName);
+}
+
+void annualDialog::on_resultButton_clicked()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,"Hourly Results",ui->resultEdit->text(),"CSV files (*.csv)");
+    if(!fileName.isEmpty())
+        ui->resultEdit->setText(fileName);
+}
+
+void annualDialog::on_runButton_clicked()
+{
+    if(columns.isEmpty())
+    {
+        globalpara.reportError("Please choose a weather file.",this);
+        return;
+    }
+    if(ui->resultEdit->text().isEmpty())
+    {
+        globalpara.reportError("Please choose a file for the hourly results.",this);
+        return;
+    }
+    simulation = annualSimulation();
+    simulation.setInputs(baseInputs);
+    simulation.setWeatherFile(ui->weatherEdit->text());
+    simulation.setResultFile(ui->resultEdit->text());
+
+    QTableWidget *table = ui->inputTable;
+    int mapped = 0;
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        if(table->item(i,UseColumn)->checkState() != Qt::Checked)
+            continue;
+        weatherMapping mapping;
+        mapping.item = baseReport.inputs.at(i);
+        mapping.column = qobject_cast<QComboBox*>(table->cellWidget(i,ColumnColumn))->currentIndex();
+        // the file is in the units of the case
+        mapping.offset = resultDialog::inputToEngine(mapping.item,0);
+        mapping.scale = resultDialog::inputToEngine(mapping.item,1)-mapping.offset;
+        simulation.addMapping(mapping);
+        mapped++;
+    }
+    if(mapped == 0)
+    {
+        globalpara.reportError("Please check at least one input set from the weather file.",this);
+        return;
+    }
+
+    QVector<int> kept;
+    table = ui->outputTable;
+    for(int o = 0; o < table->rowCount(); o++)
+    {
+        table->item(o,TotalColumn)->setText("");
+        table->item(o,MeanColumn)->setText("");
+        if(table->item(o,OutputUseColumn)->checkState() != Qt::Checked)
+            continue;
+        annualOutput output;
+        output.item = baseReport.outputs.at(o);
+        output.name = resultDialog::sensitivityName(output.item)+" ["+resultDialog::sensitivityUnit(output.item)+"]";
+        output.offset = resultDialog::resultToCase(output.item,0);
+        output.scale = resultDialog::resultToCase(output.item,1)-output.offset;
+        simulation.addOutput(output);
+        kept<<o;
+    }
+    if(kept.isEmpty())
+    {
+        globalpara.reportError("Please check at least one result to keep.",this);
+        return;
+    }
+
+    running = true;
+    stopRequested = false;
+    ui->runButton->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+    ui->stopButton->setEnabled(true);
+    ui->progressBar->setValue(0);
+    log("Simulating the hours of "+QFileInfo(ui->weatherEdit->text()).fileName()+"...");
+
+    bool done = simulation.run([&](int hoursDone, int hours)
+    {
+        ui->progressBar->setMaximum(hours);
+        ui->progressBar->setValue(hoursDone);
+        QApplication::processEvents();
+        return !stopRequested;
+    });
+
+    running = false;
+    ui->runButton->setEnabled(true);
+    ui->closeButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
+    log(simulation.message());
+    if(!done)
+        return;
+    for(int i = 0; i < kept.count(); i++)
+    {
+        const sensitivityReport::item &item = baseReport.outputs.at(kept.at(i));
+        if(isRate(item))
+            table->item(kept.at(i),TotalColumn)->setText(QString::number(simulation.total(i))+" "
+                                                         +resultDialog::sensitivityUnit(item)+"*h");
+        table->item(kept.at(i),MeanColumn)->setText(QString::number(simulation.mean(i)));
+    }
+}
+
+void annualDialog::on_stopButton_clicked()
+{
+    stopRequested = true;
+}
+
+void annualDialog::on_closeButton_clicked()
+{
+    reject();
+}
+
+void annualDialog::log(const QString &line)
+{
+    ui->logText->appendPlainText(line);
+}
+
+void annualDialog::reject()
+{
+    // closing while the hours are solved only stops the simulation
+    if(running)
+    {
+        stopRequested = true;
+        return;
+    }
+    QDialog::reject();
+}
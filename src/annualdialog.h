@@ -0,0 +1,64 @@
+/*! \file annualdialog.h
+    \brief Dialog to simulate the current case over the hours of a weather file
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef ANNUALDIALOG_H
+#define ANNUALDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+
+#include "dataComm.h"
+#include "annualsimulation.h"
+
+namespace Ui {
+class annualDialog;
+}
+
+/// Dialog for a quasi-steady annual simulation of the current case (see annualSimulation)
+/// - solves the case once with sensitivities to list its fixed inputs and its results
+/// - columns of a CSV weather or load file, in the unit system of the case, are mapped onto fixed inputs
+/// - the hourly results go to a CSV file, the annual totals and means are shown
+/// - called by mainwindow.cpp
+class annualDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit annualDialog(QWidget *parent = 0);
+    ~annualDialog();
+
+public slots:
+    void reject();
+
+private slots:
+    void on_weatherButton_clicked();
+
+    void on_resultButton_clicked();
+
+    void on_runButton_clicked();
+
+    void on_stopButton_clicked();
+
+    void on_closeButton_clicked();
+
+private:
+    Ui::annualDialog *ui;
+
+    void setupTables();
+    void loadColumns(const QString &fileName);
+    void log(const QString &line);
+
+    calInputs baseInputs;
+    sensitivityReport baseReport;
+    annualSimulation simulation;
+    QStringList columns;
+    bool ready;
+    bool running;
+    bool stopRequested;
+};
+
+#endif // ANNUALDIALOG_H
@@ -0,0 +1,333 @@
+/*! \file annualsimulation.cpp
+    \brief Quasi-steady simulation of a case over the hours of a weather file
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QFile>
+#include <QObject>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "annualsimulation.h"
+#include "optimizer.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+#include "uncertainty.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+/// time limit for one hour solved by the worker pool [ms]
+const int hourTimeout = 60000;
+
+QStringList splitRow(const QString &line)
+{
+    QStringList fields = line.split(',');
+    for(int i = 0; i < fields.count(); i++)
+    {
+        QString field = fields.at(i).trimmed();
+        if(field.length() >= 2 && field.startsWith('"') && field.endsWith('"'))
+            field = field.mid(1, field.length()-2);
+        fields[i] = field;
+    }
+    return fields;
+}
+
+/// a row of values rather than a header: most of its fields are numbers
+bool isDataRow(const QStringList &fields)
+{
+    int numbers = 0;
+    for(int i = 0; i < fields.count(); i++)
+    {
+        bool ok = false;
+        fields.at(i).toDouble(&ok);
+        if(ok)
+            numbers++;
+    }
+    return numbers > 0 && 2*numbers >= fields.count();
+}
+
+bool converged(solverPool::Status status, const calOutputs &result)
+{
+    return status == solverPool::Finished && !result.stopped && result.IER >= 1 && result.IER <= 3;
+}
+
+}
+
+annualSimulation::annualSimulation() :
+    nHours(0),
+    failed(0)
+{
+}
+
+bool annualSimulation::readColumns(const QString &fileName, QStringList &columns, QString *error)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        *error = "Can't open "+fileName+".";
+        return false;
+    }
+    QTextStream stream(&file);
+    QStringList header;
+    while(!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        if(line.trimmed().isEmpty())
+            continue;
+        QStringList fields = splitRow(line);
+        if(!isDataRow(fields))
+        {
+            header = fields;
+            continue;
+        }
+        columns.clear();
+        for(int i = 0; i < fields.count(); i++)
+            columns<<(header.count() == fields.count() && !header.at(i).isEmpty()
+                      ? header.at(i) : "Column "+QString::number(i+1));
+        return true;
+    }
+    *error = fileName+" has no rows of numbers.";
+    return false;
+}
+
+void annualSimulation::setInputs(const calInputs &inputs)
+{
+    base = inputs;
+    base.sensitivity = false;
+}
+
+void annualSimulation::setWeatherFile(const QString &fileName)
+{
+    weatherFile = fileName;
+}
+
+void annualSimulation::addMapping(const weatherMapping &mapping)
+{
+    mappings<<mapping;
+}
+
+void annualSimulation::addOutput(const annualOutput &output)
+{
+    results<<output;
+}
+
+void annualSimulation::setResultFile(const QString &fileName)
+{
+    resultFile = fileName;
+}
+
+QString annualSimulation::message() const
+{
+    return endMessage;
+}
+
+int annualSimulation::hours() const
+{
+    return nHours;
+}
+
+int annualSimulation::failures() const
+{
+    return failed;
+}
+
+double annualSimulation::total(int i) const
+{
+    return sums.at(i);
+}
+
+double annualSimulation::mean(int i) const
+{
+    return nHours > failed ? sums.at(i)/(nHours-failed) : 0;
+}
+
+bool annualSimulation::readWeather(QVector<double> &values, QString *error) const
+{
+    QFile file(weatherFile);
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        *error = "Can't open "+weatherFile+".";
+        return false;
+    }
+    QTextStream stream(&file);
+    bool data = false;
+    int row = 0;
+    while(!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        row++;
+        if(line.trimmed().isEmpty())
+            continue;
+        QStringList fields = splitRow(line);
+        if(!data && !isDataRow(fields))
+            continue;// header
+        data = true;
+        for(int m = 0; m < mappings.count(); m++)
+        {
+            bool ok = false;
+            int column = mappings.at(m).column;
+            double value = column < fields.count() ? fields.at(column).toDouble(&ok) : 0;
+            if(!ok)
+            {
+                *error = "Row "+QString::number(row)+" of "+weatherFile+" has no number in column "
+                        +QString::number(column+1)+".";
+                return false;
+            }
+            values<<value*mappings.at(m).scale+mappings.at(m).offset;
+        }
+    }
+    if(values.isEmpty())
+    {
+        *error = weatherFile+" has no rows of numbers.";
+        return false;
+    }
+    return true;
+}
+
+void annualSimulation::storeHour(QString &line, int hour, bool converged, const calOutputs &result)
+{
+    line = QString::number(hour+1);
+    if(!converged)
+        failed++;
+    for(int o = 0; o < results.count(); o++)
+    {
+        line.append(',');
+        if(!converged)
+            continue;
+        const annualOutput &output = results.at(o);
+        double value = uncertaintyAnalysis::outputValue(result, output.item)*output.scale+output.offset;
+        sums[o] += value;
+        line.append(QString::number(value, 'g', 8));
+    }
+    line.append('\n');
+}
+
+bool annualSimulation::run(const progressHandler &progress)
+{
+    nHours = 0;
+    failed = 0;
+    sums = QVector<double>(results.count(), 0);
+    endMessage.clear();
+    if(mappings.isEmpty())
+    {
+        endMessage = "No columns of the weather file are used.";
+        return false;
+    }
+
+    QVector<double> weather;
+    if(!readWeather(weather, &endMessage))
+        return false;
+    int hours = weather.count()/mappings.count();
+
+    // consecutive chunks of hours, one per worker
+    int chunks = qBound(1, solverPool::shared()->workerCount(), hours);
+    int chunkHours = (hours+chunks-1)/chunks;
+    chunks = (hours+chunkHours-1)/chunkHours;
+    QObject owner;
+    QVector<QTemporaryFile*> parts;
+    for(int k = 0; k < chunks; k++)
+    {
+        QTemporaryFile *part = new QTemporaryFile(&owner);
+        if(!part->open())
+        {
+            endMessage = "Can't create a temporary file for the results.";
+            return false;
+        }
+        parts<<part;
+    }
+    // the latest converged hour of each chunk starts the next one
+    QVector<solverState> latest(chunks, base.warmStart);
+
+    QVector<calInputs> jobs;
+    QVector<int> jobHours;
+    QVector<QString> lines;
+    for(int i = 0; i < chunkHours; i++)
+    {
+        // hour i of every chunk, each from the state of the hour before it, which is stored
+        // by now: the pool hands runs to whichever worker is free, so the next hour of a
+        // chunk is only queued in the next round
+        jobs.clear();
+        jobHours.clear();
+        for(int k = 0; k < chunks; k++)
+        {
+            int hour = k*chunkHours+i;
+            if(hour >= hours)
+                continue;
+            jobs.resize(jobs.count()+1);
+            calInputs &job = jobs.last();
+            job = base;
+            job.warmStart = latest.at(k);
+            for(int m = 0; m < mappings.count(); m++)
+                designOptimizer::setInputValue(job, mappings.at(m).item, weather.at(hour*mappings.count()+m));
+            jobHours<<hour;
+        }
+
+        lines = QVector<QString>(jobs.count());
+        auto store = [&](int job, bool ok, const calOutputs &result)
+        {
+            int hour = jobHours.at(job), k = hour/chunkHours;
+            storeHour(lines[job], hour, ok, result);
+            if(ok)
+                latest[k] = result.state;
+        };
+        bool started = solverPool::shared()->solve(jobs, hourTimeout,
+            [&](int job, solverPool::Status status, const calOutputs &result)
+        {
+            store(job, converged(status, result), result);
+        });
+        if(!started)
+        {
+            // no worker processes, solve in this process
+            for(int j = 0; j < jobs.count(); j++)
+            {
+                absdCal(0,0,jobs.at(j),false);
+                store(j, converged(solverPool::Finished, outputs), outputs);
+            }
+        }
+
+        for(int j = 0; j < jobs.count(); j++)
+        {
+            QTemporaryFile *part = parts.at(jobHours.at(j)/chunkHours);
+            part->write(lines.at(j).toUtf8());
+        }
+        nHours += jobs.count();
+
+        if(progress && !progress(nHours, hours))
+        {
+            endMessage = "Stopped after "+QString::number(nHours)+" of "+QString::number(hours)+" hours.";
+            return false;
+        }
+    }
+
+    QSaveFile file(resultFile);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Text))
+    {
+        endMessage = "Can't write "+resultFile+".";
+        return false;
+    }
+    QString header = "Hour";
+    for(int o = 0; o < results.count(); o++)
+        header.append(","+results.at(o).name);
+    file.write((header+"\n").toUtf8());
+    for(int k = 0; k < chunks; k++)
+    {
+        QTemporaryFile *part = parts.at(k);
+        part->seek(0);
+        while(!part->atEnd())
+            file.write(part->read(1 << 20));
+    }
+    if(!file.commit())
+    {
+        endMessage = "Can't write "+resultFile+".";
+        return false;
+    }
+    endMessage = QString::number(hours)+" hours solved";
+    if(failed > 0)
+        endMessage.append(", "+QString::number(failed)+" of them didn't converge and are left out of the totals");
+    endMessage.append(". The hourly results are in "+resultFile+".");
+    return true;
+}
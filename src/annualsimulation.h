@@ -0,0 +1,108 @@
+/*! \file annualsimulation.h
+    \brief Quasi-steady simulation of a case over the hours of a weather file
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef ANNUALSIMULATION_H
+#define ANNUALSIMULATION_H
+
+#include <functional>
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "dataComm.h"
+
+/// A column of the weather file that sets a fixed input of the case each hour:
+/// input = value * scale + offset (engine units)
+struct weatherMapping
+{
+    int column = 0;
+    sensitivityReport::item item;
+    double scale = 1;
+    double offset = 0;
+};
+
+/// A result written for each hour and summed over the year: value * scale + offset
+struct annualOutput
+{
+    sensitivityReport::item item;
+    QString name;
+    double scale = 1;
+    double offset = 0;
+};
+
+/*!
+Solves a case once for every hour of a weather (or load) file, as a series of
+steady states: the columns of the file set fixed inputs of the case (e.g. the
+temperature and humidity of the outdoor air entering a conditioner_* or
+regenerator_* component), the rest of the case stays as it is.
+
+The file is comma separated text with one row per hour; leading rows that are
+mostly not numbers are taken as headers (as in TMY3 and EPW files), the last of
+them naming the columns.
+
+The hours are split into as many consecutive chunks as there are solver
+workers (solverPool), which solve their chunks side by side, one hour of every
+chunk per round: the pool hands runs to whichever worker is free, so the next
+hour of a chunk is only queued once the hour before it is done. Each hour starts
+from the solver state of the latest hour of its chunk that converged, normally
+the hour before; the first hour of a chunk starts from the case. Without
+workers, the rounds are solved in this process. Only one hour per chunk is in
+memory at a time: the results of each chunk go to a temporary file as they come
+in, and the files are joined in hour order into the result file at the end, so
+a failure doesn't leave a partial result file.
+
+The total of each result over the converged hours (value times one hour) and
+its mean are kept, in the units of annualOutput. Used by annualDialog.
+*/
+class annualSimulation
+{
+public:
+    /// Called after each round of hours; return false to stop the simulation.
+    typedef std::function<bool(int hoursDone, int hours)> progressHandler;
+
+    annualSimulation();
+
+    /// Names of the columns of a weather file (or "Column n" where the file has none).
+    /// \return false, and why in error, if the file can't be read or has no numeric rows
+    static bool readColumns(const QString &fileName, QStringList &columns, QString *error);
+
+    /// The case, with the warm start of its solution.
+    void setInputs(const calInputs &base);
+    void setWeatherFile(const QString &fileName);
+    void addMapping(const weatherMapping &mapping);
+    void addOutput(const annualOutput &output);
+    void setResultFile(const QString &fileName);
+
+    /// \return false if the simulation couldn't start or the result file couldn't be written
+    bool run(const progressHandler &progress);
+
+    /// Why the simulation ended.
+    QString message() const;
+    int hours() const;
+    int failures() const;
+    /// Sum of output i over the converged hours, times one hour.
+    double total(int i) const;
+    double mean(int i) const;
+
+private:
+    bool readWeather(QVector<double> &values, QString *error) const;
+    /// the line of the result file of an hour, and its results added to the totals
+    void storeHour(QString &line, int hour, bool converged, const calOutputs &result);
+
+    calInputs base;
+    QString weatherFile;
+    QString resultFile;
+    QVector<weatherMapping> mappings;
+    QVector<annualOutput> results;
+
+    int nHours;
+    int failed;
+    QVector<double> sums;
+    QString endMessage;
+};
+
+#endif // ANNUALSIMULATION_H
@@ -13,6 +13,7 @@
     \copyright 2017-2018, Nicholas Fette
 */
 
+#include <QApplication>
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
@@ -24,6 +25,7 @@
 #include "dataComm.h"
 #include "sorpsimEngine.h"
 #include "calcdetaildialog.h"
+#include "multistart.h"
 
 extern int spnumber;
 extern int globalcount;
@@ -39,14 +41,13 @@ calculate::calculate(unit * dummy) :
 
 }
 
-void calculate::calc(globalparameter globalpara, QString fileName)
+bool calculate::buildInputs(globalparameter globalpara, calInputs &myInputs)
 {
     bool error = false;
 
     globalparameter *theGlobal = &globalpara;
     globalpara.checkMinMax(theGlobal);
 
-    calInputs myInputs;
     myInputs.title = globalpara.title;
     myInputs.tmax = convert(globalpara.tmax,temperature[globalpara.unitindex_temperature],temperature[3]);
     myInputs.tmin = convert(globalpara.tmin,temperature[globalpara.unitindex_temperature],temperature[3]);
@@ -56,6 +57,11 @@ void calculate::calc(globalparameter globalpara, QString fileName)
     myInputs.msglvl = globalpara.msglvl;
     myInputs.ftol = globalpara.ftol;
     myInputs.xtol = globalpara.xtol;
+    myInputs.fastProperties = globalpara.fastProperties;
+    myInputs.if97Water = globalpara.if97Water;
+    myInputs.sensitivity = globalpara.sensitivity;
+    myInputs.solverMethod = globalpara.solverMethod;
+    myInputs.autoScaling = globalpara.autoScaling;
     myInputs.nunits = globalcount;
     myInputs.nsp = spnumber;
 
@@ -104,7 +110,7 @@ void calculate::calc(globalparameter globalpara, QString fileName)
                 if(myHead->sensor==NULL)
                 {
                     QMessageBox::warning(theMainwindow, "Warning", "Please reset temperature sensor of the thermostatic valve.");
-                    return;
+                    return false;
                 }
                 myInputs.devl[count] = myHead->devl;
             }
@@ -181,7 +187,13 @@ void calculate::calc(globalparameter globalpara, QString fileName)
         }
     }
 
-    if(!error)
+    return !error;
+}
+
+void calculate::calc(globalparameter globalpara, QString fileName)
+{
+    calInputs myInputs;
+    if(buildInputs(globalpara,myInputs))
     {
         outputs.ivart.clear();
         outputs.ivarf.clear();
@@ -189,12 +201,37 @@ void calculate::calc(globalparameter globalpara, QString fileName)
         outputs.ivarp.clear();
         outputs.ivarw.clear();
 
+        if(globalpara.warmStart)
+            myInputs.warmStart = globalpara.lastSolution;
         absdCal(0,0,myInputs,false);
 
+        // a run that gave up gets several other starts at once
+        QString recovery;
+        if(globalpara.multiStart && !outputs.stopped && outputs.IER >= 4 && outputs.IER <= 7)
+        {
+            int failedIER = outputs.IER;
+            multiStart starts;
+            starts.setInputs(myInputs);
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            if(starts.run())
+                outputs = starts.result();
+            QApplication::restoreOverrideCursor();
+            recovery = "The run didn't converge (IER = "+QString::number(failedIER)+"). "+starts.message()+"\n";
+        }
+
         QMessageBox calcMsg(theMainwindow);
         QString title = "Warning",msg = "not defined";
 
         QString nvneq = /*"";//*/ "There are "+QString::number(outputs.noEqn)+" equations and "+QString::number(outputs.noVar)+" variables.\n";
+        nvneq.append(recovery);
+        if(outputs.fromCache)
+            nvneq.append("Results of an identical earlier run were reused.\n");
+        else if(outputs.warmStarted)
+            nvneq.append("Started from an earlier converged solution.\n");
+        if(outputs.sensitivity.isValid())
+            nvneq.append("Sensitivities to "+QString::number(outputs.sensitivity.inputs.count())+" inputs are in the results.\n");
+        else if(!outputs.sensitivity.message.isEmpty())
+            nvneq.append(outputs.sensitivity.message+"\n");
 
         bool converged = false;
         if(!outputs.stopped)
@@ -222,7 +259,7 @@ void calculate::calc(globalparameter globalpara, QString fileName)
                 msg = nvneq+"Iteration couldn't reduce the residuals in last 20 steps,calculation terminated.\nHint:the case could be over-defined with too many equations,\nor it needs a better guess value set.";
                 break;
             case 6:
-                msg = nvneq+"Unsuccessful due to following possible reasons:\n* tolerance is too stringent\n* slow convergence due to Jacobian singular\n or badly scaled variables";
+                msg = nvneq+"Unsuccessful due to following possible reasons:\n* tolerance is too stringent\n* slow convergence due to Jacobian singular\n or badly scaled variables\nHint:try automatic scaling (in the \"Run\" Dialog)";
                 break;
             case 7:
                 msg = nvneq+"Couldn't progress as step bound is too small\nrelative to the size of the iterates.";
@@ -281,6 +318,10 @@ void calculate::calc(globalparameter globalpara, QString fileName)
 
 bool calculate::updateSystem()
 {
+    if(outputs.state.isValid())
+        globalpara.lastSolution = outputs.state;
+    globalpara.lastSensitivity = outputs.sensitivity;
+
     // sp para
     unit * iterator;
     Node* node;
@@ -26,7 +26,7 @@
 
 /*!
 Class to control simulation procedure
-- collects the case configuration and parameter values from current system data structure and insert into [inputs]
+- collects the case configuration and parameter values from current system data structure and insert into [inputs] (buildInputs(), also used by the optimizer)
 - initiate the simulation engine [sorpsimengine.cpp] and pass the inputs to the engine
 - once simulation engine finished, determine the status of the simulation by reading the massage [outputs.msgs]
 - if calculation is not terminated unexpectly (e.g. due to NaN), extract results from [outputs] and insert them into the case data structure
@@ -38,6 +38,9 @@ public:
     calculate(unit * dummy);
 
     void calc(globalparameter globalpara, QString fileName);
+    /// Collects the engine inputs (engine units) of the case on the scene.
+    /// \return false, after warning the user, if the case can't be calculated
+    bool buildInputs(globalparameter globalpara, calInputs &myInputs);
     // TODO: is called internally only, maybe make private
     bool updateSystem();
 
@@ -0,0 +1,515 @@
+/*! \file correlationbench.cpp
+    \brief Microbenchmark of the property routines of every fluid family
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <math.h>
+
+#include "correlationbench.h"
+#include "sorpsimEngine.h"
+#include "sorputils.h"
+#include "version.h"
+#include "sorpprops/propsurrogates.h"
+
+using namespace sorpsim4l;
+
+extern calOutputs outputs;
+extern bool printOut;
+extern bool fastProperties;
+extern bool if97Water;
+
+namespace {
+
+/// one input of a routine, swept from min to max; where the case has a setup,
+/// the swept quantity, which the setup turns into the input of the routine
+struct sweep
+{
+    const char *name;// 0 for routines of one input
+    const char *unit;
+    double min, max;
+    bool logarithmic;
+};
+
+typedef void (*setupFunction)(common &cmn, double &a, double &b);
+typedef double (*runFunction)(common &cmn, int substance, double a, double b);
+
+struct benchCase
+{
+    const char *routine;
+    const char *fluid;
+    const char *computes;
+    int substance;// kk of eqb(), the refrigerant number for the refrigerant routines
+    sweep in[2];
+    setupFunction setup;// may be 0
+    runFunction run;
+};
+
+/// eqb() as the components call it; t and c are inputs or results depending on klv and kent
+double callEqb(common &cmn, int kk, int klv, int kent, double p, double &c, double &t)
+{
+    double h = 0;
+    eqb(cmn, p, c, t, h, klv, kent, kk);
+    return h;
+}
+
+/// T and h of a solution or liquid from p and x
+double liquidTH(common &cmn, int kk, double p, double x)
+{
+    double t = 0;
+    double h = callEqb(cmn, kk, 1, 1, p, x, t);
+    return h + t;
+}
+
+/// h of a vapor from p and t (t not used where the vapor is saturated)
+double vaporH(common &cmn, int kk, double p, double t)
+{
+    double c = 0;
+    return callEqb(cmn, kk, 2, 1, p, c, t);
+}
+
+// the refrigerant sweeps: a in 0..1 from 1 psia to 0.95 pc on a log scale, b a superheat
+
+double refrigerantPressure(common &cmn, double a)
+{
+    return exp(a * log(0.95 * cmn.pc));
+}
+
+void saturatedSetup(common &cmn, double &a, double &)
+{
+    a = refrigerantPressure(cmn, a);
+}
+
+void saturatedTemperatureSetup(common &cmn, double &a, double &)
+{
+    int flag = 0;
+    a = tsat(cmn, refrigerantPressure(cmn, a), flag);
+}
+
+void superheatedSetup(common &cmn, double &a, double &b)
+{
+    int flag = 0;
+    a = refrigerantPressure(cmn, a);
+    b += tsat(cmn, a, flag);
+}
+
+/// the NH3/water vapor in equilibrium with the solution of concentration b
+void ammoniaVaporSetup(common &cmn, double &a, double &b)
+{
+    double t = 0;
+    tfpx2(cmn, t, a, b);
+    b = t;
+}
+
+const benchCase solutionCases[] = {
+    {"eqb1", "LiBr-H2O", "T, h of the solution from p, x", 1,
+     {{"p", "psia", 0.1, 14.7, true}, {"x", "%", 40, 70, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb2", "H2O-NH3", "T, h of the solution from p, x", 2,
+     {{"p", "psia", 2.9, 1595, true}, {"x", "%", 5, 95, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb2", "H2O-NH3", "y, h of the vapor from p, T (boiling T of x = 5..95 %)", 2,
+     {{"p", "psia", 2.9, 1595, true}, {"x", "%", 5, 95, false}}, ammoniaVaporSetup,
+     [](common &cmn, int kk, double p, double t) { return vaporH(cmn, kk, p, t); }},
+    {"eqb3", "H2O", "T, h of saturated liquid from p", 3,
+     {{"p", "psia", 0.1, 3000, true}, {0, 0, 0, 0, false}}, 0,
+     [](common &cmn, int kk, double p, double) { return liquidTH(cmn, kk, p, 0); }},
+    {"eqb3", "H2O", "T, h of saturated vapor from p", 3,
+     {{"p", "psia", 0.1, 3000, true}, {0, 0, 0, 0, false}}, 0,
+     [](common &cmn, int kk, double p, double) { return vaporH(cmn, kk, p, 0); }},
+    {"eqb4", "LiBr-H2O-NH3", "T, h of the solution from p, x", 4,
+     {{"p", "psia", 10, 300, true}, {"x", "%", 10, 50, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb5", "LiBr/ZnBr2-CH3OH", "T, h of the solution from p, x", 5,
+     {{"p", "psia", 0.5, 30, true}, {"x", "%", 50, 75, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb6", "CH3OH", "T, h of saturated liquid from p", 6,
+     {{"p", "psia", 0.5, 100, true}, {0, 0, 0, 0, false}}, 0,
+     [](common &cmn, int kk, double p, double) { return liquidTH(cmn, kk, p, 0); }},
+    {"eqb6", "CH3OH", "T, h of saturated vapor from p", 6,
+     {{"p", "psia", 0.5, 100, true}, {0, 0, 0, 0, false}}, 0,
+     [](common &cmn, int kk, double p, double) { return vaporH(cmn, kk, p, 0); }},
+    {"eqb7", "LiNO3/KNO3/NaNO3-H2O", "T, h of the solution from p, x", 7,
+     {{"p", "psia", 0.5, 50, true}, {"x", "%", 80, 95, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb8", "NaOH-H2O", "T, h of the solution from p, x", 8,
+     {{"p", "psia", 0.1, 14.7, true}, {"x", "%", 20, 60, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb9", "LiCl-H2O", "T, h of the solution from p, x", 9,
+     {{"p", "psia", 0.1, 14.7, true}, {"x", "%", 10, 40, false}}, 0,
+     [](common &cmn, int kk, double p, double x) { return liquidTH(cmn, kk, p, x); }},
+    {"eqb10", "Moist Air", "dew point from p, x (weight % water)", 10,
+     {{"p", "psia", 10, 20, false}, {"x", "%", 0.1, 5, false}}, 0,
+     [](common &cmn, int kk, double p, double x) {
+         double t = 0;
+         callEqb(cmn, kk, 2, 0, p, x, t);
+         return t; }},
+    {"eqb10", "Moist Air", "h from T, x at 14.7 psia", 10,
+     {{"t", "F", 32, 200, false}, {"x", "%", 0.1, 5, false}}, 0,
+     [](common &cmn, int kk, double t, double x) { return callEqb(cmn, kk, 2, 1, 14.7, x, t); }},
+    {"hftx10", "Moist Air", "h from T, humidity ratio at 14.7 psia", 10,
+     {{"t", "F", 32, 200, false}, {"w", "lb/lb", 0.001, 0.05, false}}, 0,
+     [](common &cmn, int, double t, double w) {
+         double h = 0;
+         hftx10(cmn, h, t, w, 14.7);
+         return h; }},
+    {"eqb11", "Flue Gas", "h from T, x (weight % air)", 11,
+     {{"t", "F", 200, 2000, false}, {"x", "%", 95, 99.9, false}}, 0,
+     [](common &cmn, int kk, double t, double x) { return callEqb(cmn, kk, 2, 1, 14.7, x, t); }},
+    {"eqb13", "Silica Gel-H2O", "T, h from p, x (lb water/lb gel)", 13,
+     {{"p", "psia", 0.05, 1, true}, {"x", "lb/lb", 0.05, 0.35, false}}, 0,
+     [](common &cmn, int, double p, double x) {
+         double t = 0, h = 0;
+         eqb13(cmn, p, x, t, h, 1, 1);
+         return h + t; }},
+    {"eqb14", "[C2mim][OAc]", "h of the solution from T, x", 14,
+     {{"t", "F", 60, 250, false}, {"x", "%", 50, 90, false}}, 0,
+     [](common &cmn, int kk, double t, double x) { return callEqb(cmn, kk, 1, 1, 1.0, x, t); }},
+    {"tfp3", "H2O", "saturation temperature from p", 3,
+     {{"p", "psia", 2.5491e-6, 3200, true}, {0, 0, 0, 0, false}}, 0,
+     [](common &cmn, int, double p, double) {
+         double t = 0;
+         tfp3(cmn, t, p);
+         return t; }},
+    {"xftp2", "H2O-NH3", "x of the solution from T, p (boiling T of x = 5..95 %)", 2,
+     {{"p", "psia", 2.9, 1595, true}, {"x", "%", 5, 95, false}}, ammoniaVaporSetup,
+     [](common &cmn, int, double p, double t) {
+         double x = 0;
+         xftp2(cmn, x, t, p);
+         return x; }}
+};
+
+const benchCase refrigerantCases[] = {
+    {"eqb12", 0, "T, h of saturated liquid from p", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {0, 0, 0, 0, false}}, saturatedSetup,
+     [](common &cmn, int, double p, double) {
+         double t = 0, h = 0;
+         eqb12(cmn, p, 0, t, h, 1, 1);
+         return h + t; }},
+    {"eqb12", 0, "h of superheated vapor from p, T (0..150 F superheat)", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {"superheat", "F", 0, 150, false}}, superheatedSetup,
+     [](common &cmn, int, double p, double t) {
+         // eqb12 takes the vapor temperature in place of the concentration
+         double tsatr = 0, h = 0;
+         eqb12(cmn, p, t, tsatr, h, 2, 1);
+         return h; }},
+    {"tsat", 0, "saturation temperature from p", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {0, 0, 0, 0, false}}, saturatedSetup,
+     [](common &cmn, int, double p, double) {
+         int flag = 0;
+         return tsat(cmn, p, flag); }},
+    {"satprp", 0, "saturation properties from T", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {0, 0, 0, 0, false}}, saturatedTemperatureSetup,
+     [](common &cmn, int, double t, double) {
+         double psat, vf, vg, hf, hfg, hg, sf, sg;
+         int flag = 0;
+         satprp(cmn, t, psat, vf, vg, hf, hfg, hg, sf, sg, flag);
+         return hg; }},
+    {"vapor", 0, "v, h, s of superheated vapor from p, T (0..150 F superheat)", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {"superheat", "F", 0, 150, false}}, superheatedSetup,
+     [](common &cmn, int, double p, double t) {
+         double v, h, s;
+         int error = 0;
+         vapor(cmn, t, p, v, h, s, error);
+         return h; }},
+    {"spvol", 0, "specific volume of superheated vapor from p, T (0..150 F superheat)", 0,
+     {{"p", "fraction of ln(0.95 pc/psia)", 0, 1, false}, {"superheat", "F", 0, 150, false}}, superheatedSetup,
+     [](common &cmn, int, double p, double t) { return spvol(cmn, t, p); }}
+};
+
+/// the refrigerants of globalparameter::fluidInventory
+const struct { const char *name; int nr; } refrigerants[] = {
+    {"R12", 12}, {"R22", 22}, {"R32", 32}, {"R134a", 134}, {"R152a", 152}, {"R290", 290}, {"R410A", 411}
+};
+
+/// the refrigerant numbers of eqb(); 13 is silica gel here, which eqb() does not reach
+bool isRefrigerant(int kk)
+{
+    return kk > 11 && kk != 13 && kk != 14;
+}
+
+/// the inputs of all points of a case
+struct benchPoints
+{
+    QVector<double> a, b;
+};
+
+double sweepValue(const sweep &s, int i, int n)
+{
+    // exactly the ends, exp(log()) could round past them
+    if(i == 0)
+        return s.min;
+    if(i == n - 1)
+        return s.max;
+    double f = double(i) / (n - 1);
+    if(s.logarithmic)
+        return exp(log(s.min) + f * (log(s.max) - log(s.min)));
+    return s.min + f * (s.max - s.min);
+}
+
+benchPoints makePoints(common &cmn, const benchCase &c, int n)
+{
+    benchPoints points;
+    int nb = c.in[1].name ? n : 1;
+    // the first input changes fastest, so that no routine gets the inputs of its previous call
+    for(int j = 0; j < nb; j++)
+        for(int i = 0; i < n; i++)
+        {
+            double a = sweepValue(c.in[0], i, n);
+            double b = c.in[1].name ? sweepValue(c.in[1], j, n) : 0.0;
+            if(c.setup)
+                c.setup(cmn, a, b);
+            points.a << a;
+            points.b << b;
+        }
+    return points;
+}
+
+/// one call of the routine; false if the engine stopped or gave NaN
+bool runPoint(common &cmn, const benchCase &c, double a, double b, double &sum)
+{
+    try
+    {
+        double r = c.run(cmn, c.substance, a, b);
+        sum += r;
+        bool failed = outputs.stopped || r != r;
+        outputs.stopped = false;
+        return !failed;
+    }
+    catch(const fem::stop_info &)
+    {
+        outputs.stopped = false;
+        return false;
+    }
+}
+
+struct solveField
+{
+    const char *name;
+    solveCount solveCounts::*count;
+};
+
+const solveField solveFields[] = {
+    {"tfp3", &solveCounts::tfp3},
+    {"xftp2", &solveCounts::xftp2},
+    {"tsat", &solveCounts::tsat},
+    {"spvol", &solveCounts::spvol}
+};
+
+long long totalIterations(const solveCounts &counts)
+{
+    long long total = 0;
+    for(const solveField &f : solveFields)
+        total += (counts.*f.count).iterations;
+    return total;
+}
+
+/// the swept range, and with a setup the range of the values the routine was given
+QJsonObject inputRange(const sweep &s, const QVector<double> &values, bool setup)
+{
+    QJsonObject input;
+    input["name"] = s.name;
+    input["unit"] = s.unit;
+    input["min"] = s.min;
+    input["max"] = s.max;
+    if(setup)
+    {
+        double lo = values.first(), hi = values.first();
+        for(double v : values)
+        {
+            lo = qMin(lo, v);
+            hi = qMax(hi, v);
+        }
+        input["passedMin"] = lo;
+        input["passedMax"] = hi;
+    }
+    return input;
+}
+
+/// sweeps the case once counting the iterations, then times it
+QJsonObject benchOne(common &cmn, const benchCase &c, const char *fluid, int n, int repeats)
+{
+    if(isRefrigerant(c.substance))
+        tables(cmn, c.substance);
+    benchPoints points = makePoints(cmn, c, n);
+    int count = points.a.count();
+    double sum = 0;
+
+    // the counting pass, point by point for the worst point
+    solveCounts counts, before;
+    int failures = 0, worst = -1;
+    long long worstIterations = -1;
+    solveCounts worstCounts;
+    solveCounting = &counts;
+    for(int i = 0; i < count; i++)
+    {
+        before = counts;
+        if(!runPoint(cmn, c, points.a.at(i), points.b.at(i), sum))
+            failures++;
+        long long iterations = totalIterations(counts) - totalIterations(before);
+        if(iterations > worstIterations)
+        {
+            worstIterations = iterations;
+            worst = i;
+            for(const solveField &f : solveFields)
+            {
+                solveCount &w = worstCounts.*f.count;
+                w = solveCount();
+                w.calls = (counts.*f.count).calls - (before.*f.count).calls;
+                w.iterations = (counts.*f.count).iterations - (before.*f.count).iterations;
+            }
+        }
+    }
+    solveCounting = 0;
+
+    // the timed passes
+    qint64 best = -1;
+    for(int r = 0; r < repeats; r++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for(int i = 0; i < count; i++)
+            runPoint(cmn, c, points.a.at(i), points.b.at(i), sum);
+        qint64 elapsed = timer.nsecsElapsed();
+        if(best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    QJsonObject result;
+    result["routine"] = c.routine;
+    result["fluid"] = fluid;
+    result["computes"] = c.computes;
+    if(isRefrigerant(c.substance))
+        result["refrigerant"] = c.substance;
+    QJsonArray inputs;
+    inputs << inputRange(c.in[0], points.a, c.setup != 0);
+    if(c.in[1].name)
+        inputs << inputRange(c.in[1], points.b, c.setup != 0);
+    result["inputs"] = inputs;
+    result["points"] = count;
+    result["failures"] = failures;
+    result["nsPerCall"] = double(best) / count;
+
+    QJsonObject solves;
+    for(const solveField &f : solveFields)
+    {
+        const solveCount &s = counts.*f.count;
+        if(s.calls == 0)
+            continue;
+        QJsonObject solve;
+        solve["callsPerPoint"] = double(s.calls) / count;
+        solve["meanIterations"] = double(s.iterations) / s.calls;
+        solve["maxIterations"] = s.maxIterations;
+        solve["worstInputs"] = QJsonArray() << s.worstInputs[0] << s.worstInputs[1];
+        solves[f.name] = solve;
+    }
+    result["solves"] = solves;
+
+    if(worst >= 0 && worstIterations > 0)
+    {
+        QJsonObject path;
+        QJsonArray at;
+        at << points.a.at(worst);
+        if(c.in[1].name)
+            at << points.b.at(worst);
+        path["inputs"] = at;
+        path["iterations"] = worstIterations;
+        for(const solveField &f : solveFields)
+        {
+            const solveCount &w = worstCounts.*f.count;
+            if(w.calls > 0)
+                path[f.name] = QJsonArray() << w.calls << w.iterations;
+        }
+        result["worstPoint"] = path;
+    }
+    // keeps the calls from being optimized away
+    result["checksum"] = sum;
+    return result;
+}
+
+}
+
+int correlationBench::benchMain(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    QTextStream err(stderr);
+    QString fileName;
+    bool fast = false, if97 = false;
+    QList<int> numbers;
+    for(int i = 2; i < args.count(); i++)
+    {
+        if(args.at(i) == "--json" && i + 1 < args.count())
+            fileName = args.at(++i);
+        else if(args.at(i) == "--fast-properties")
+            fast = true;
+        else if(args.at(i) == "--if97")
+            if97 = true;
+        else
+            numbers << args.at(i).toInt();
+    }
+    int points = numbers.count() > 0 ? numbers.at(0) : 64;
+    int repeats = numbers.count() > 1 ? numbers.at(1) : 3;
+    if(points < 2 || repeats < 1)
+    {
+        err << "usage: " << args.first() << " --bench-correlations [points] [repeats]"
+            << " [--json file] [--fast-properties] [--if97]" << Qt::endl;
+        return 1;
+    }
+
+    int engineArgc = 0;
+    char const* engineArgv[1];
+    common cmn(engineArgc, engineArgv);
+    printOut = false;
+    if97Water = if97;
+    fastProperties = fast && sorpprops::propSurrogates::shared().prepare(
+                Sorputils::sorpTempDir().absoluteFilePath("propertyTables.dat").toLocal8Bit().constData());
+
+    QJsonArray results;
+    for(const benchCase &c : solutionCases)
+    {
+        err << c.routine << " " << c.fluid << ": " << c.computes << Qt::endl;
+        results << benchOne(cmn, c, c.fluid, points, repeats);
+    }
+    for(const auto &r : refrigerants)
+        for(benchCase c : refrigerantCases)
+        {
+            c.substance = r.nr;
+            err << c.routine << " " << r.name << ": " << c.computes << Qt::endl;
+            results << benchOne(cmn, c, r.name, points, repeats);
+        }
+
+    QJsonObject report;
+    report["version"] = SORP_VERSION;
+    report["pointsPerInput"] = points;
+    report["repeats"] = repeats;
+    report["fastProperties"] = fastProperties;
+    report["if97Water"] = if97Water;
+    report["routines"] = results;
+    fastProperties = false;
+    if97Water = false;
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if(fileName.isEmpty())
+    {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+    {
+        err << "cannot write " << fileName << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+/*! \file correlationbench.h
+    \brief Microbenchmark of the property routines of every fluid family
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef CORRELATIONBENCH_H
+#define CORRELATIONBENCH_H
+
+/*!
+Times the engine's property routines one call at a time, as the solver calls
+them, for every substance of globalparameter::fluidInventory: the equilibrium
+routines eqb1 to eqb14 (through eqb() where the engine goes through it, eqb12
+and eqb13 directly as the engine calls them), the refrigerant routines tsat,
+satprp, vapor and spvol, moist air (hftx10, eqb10) and the inner solves tfp3
+and xftp2 on their own.
+
+Started with
+"--bench-correlations [points] [repeats] [--json file] [--fast-properties] [--if97]".
+Each routine is swept over a grid of points x points (points for one input)
+spanning its valid range; the options select the case options of the same
+names (calInputs::fastProperties, calInputs::if97Water).
+
+For each routine the JSON report (written to the file, or to stdout) has
+- the time per call [ns], best of the repeats
+- the swept inputs with their ranges (where a setup turns the swept value
+  into the input of the routine, also the range of the values passed), and
+  the number of points that failed (engine stopped or NaN)
+- for each inner solve it reaches (tfp3, xftp2, tsat, spvol, see solveCounts):
+  calls, mean and maximum iterations and the inputs of the slowest call
+- the worst point: the inputs with the most inner iterations over all solves,
+  and how they split between the solves
+
+so that the expensive families and iteration paths can be compared between
+versions.
+*/
+class correlationBench
+{
+public:
+    static int benchMain(int argc, char *argv[]);
+};
+
+#endif // CORRELATIONBENCH_H
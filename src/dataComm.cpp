@@ -18,6 +18,7 @@
 #include <QSet>
 #include <QVector>
 #include <QStringList>
+#include <QCryptographicHash>
 
 #include "dataComm.h"
 #include "unit.h"
@@ -443,6 +444,16 @@ void globalparameter::resetGlobalPara()
     copT = 0;
     capacityT = 0;
 
+    warmStart = true;
+    lastSolution = solverState();
+    fastProperties = false;
+    if97Water = false;
+    sensitivity = false;
+    multiStart = true;
+    solverMethod = calInputs::Hybrid;
+    autoScaling = false;
+    lastSensitivity = sensitivityReport();
+
     fluids.clear();
     tGroup.clear();
     fGroup.clear();
@@ -460,3 +471,397 @@ bool globalparameter::compResSelected()
 {
     return (resUA|resEFF|resNTU|resCAT|resLMTD|resHT);
 }
+
+namespace {
+
+template <typename T, int N>
+void writeArray(QDataStream &out, const T (&a)[N])
+{
+    for(int i = 0; i < N; i++)
+        out << a[i];
+}
+
+template <typename T, int N, int M>
+void writeArray(QDataStream &out, const T (&a)[N][M])
+{
+    for(int i = 0; i < N; i++)
+        for(int j = 0; j < M; j++)
+            out << a[i][j];
+}
+
+template <typename T, int N>
+void readArray(QDataStream &in, T (&a)[N])
+{
+    for(int i = 0; i < N; i++)
+        in >> a[i];
+}
+
+template <typename T, int N, int M>
+void readArray(QDataStream &in, T (&a)[N][M])
+{
+    for(int i = 0; i < N; i++)
+        for(int j = 0; j < M; j++)
+            in >> a[i][j];
+}
+
+}
+
+QDataStream &operator<<(QDataStream &out, const calInputs &in)
+{
+    out << in.title << in.tmax << in.tmin << in.fmax << in.pmax
+        << qint32(in.nsp) << qint32(in.nunits) << qint32(in.maxfev) << qint32(in.msglvl)
+        << in.ftol << in.xtol;
+
+    writeArray(out, in.idunit);
+    writeArray(out, in.iht);
+    writeArray(out, in.ht);
+    writeArray(out, in.ipinch);
+    writeArray(out, in.devl);
+    writeArray(out, in.devg);
+    writeArray(out, in.icop);
+    writeArray(out, in.isp);
+    writeArray(out, in.wetness);
+    writeArray(out, in.ntum);
+    writeArray(out, in.ntuw);
+    writeArray(out, in.ntua);
+    writeArray(out, in.nIter);
+    writeArray(out, in.le);
+    writeArray(out, in.height);
+
+    writeArray(out, in.ksub);
+    writeArray(out, in.itfix);
+    writeArray(out, in.t);
+    writeArray(out, in.iffix);
+    writeArray(out, in.f);
+    writeArray(out, in.icfix);
+    writeArray(out, in.c);
+    writeArray(out, in.ipfix);
+    writeArray(out, in.p);
+    writeArray(out, in.iwfix);
+    writeArray(out, in.w);
+
+    out << qint32(in.solverMethod) << in.autoScaling << in.warmStart << in.fastProperties << in.if97Water << in.sensitivity;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, calInputs &out)
+{
+    qint32 nsp, nunits, maxfev, msglvl;
+    in >> out.title >> out.tmax >> out.tmin >> out.fmax >> out.pmax
+       >> nsp >> nunits >> maxfev >> msglvl
+       >> out.ftol >> out.xtol;
+    out.nsp = nsp;
+    out.nunits = nunits;
+    out.maxfev = maxfev;
+    out.msglvl = msglvl;
+
+    readArray(in, out.idunit);
+    readArray(in, out.iht);
+    readArray(in, out.ht);
+    readArray(in, out.ipinch);
+    readArray(in, out.devl);
+    readArray(in, out.devg);
+    readArray(in, out.icop);
+    readArray(in, out.isp);
+    readArray(in, out.wetness);
+    readArray(in, out.ntum);
+    readArray(in, out.ntuw);
+    readArray(in, out.ntua);
+    readArray(in, out.nIter);
+    readArray(in, out.le);
+    readArray(in, out.height);
+
+    readArray(in, out.ksub);
+    readArray(in, out.itfix);
+    readArray(in, out.t);
+    readArray(in, out.iffix);
+    readArray(in, out.f);
+    readArray(in, out.icfix);
+    readArray(in, out.c);
+    readArray(in, out.ipfix);
+    readArray(in, out.p);
+    readArray(in, out.iwfix);
+    readArray(in, out.w);
+
+    qint32 solverMethod;
+    in >> solverMethod >> out.autoScaling >> out.warmStart >> out.fastProperties >> out.if97Water >> out.sensitivity;
+    out.solverMethod = solverMethod;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const calOutputs &in)
+{
+    out << qint32(in.noVar) << qint32(in.noVarT) << qint32(in.noVarC) << qint32(in.noVarF)
+        << qint32(in.noVarP) << qint32(in.noVarW) << qint32(in.noEqn) << qint32(in.noEqnLin)
+        << qint32(in.noEqnNln) << qint32(in.noIter) << qint32(in.IER) << in.stopped
+        << qint32(in.currentSp) << in.myMsg << in.cop << in.capacity;
+
+    writeArray(out, in.eqn_var);
+    writeArray(out, in.eqn_res);
+    writeArray(out, in.eqn_name);
+    writeArray(out, in.eqn_uid);
+    out << qint32(in.eqn_nukt) << qint32(in.eqn_nconc) << qint32(in.eqn_nflow)
+        << qint32(in.eqn_npress) << qint32(in.eqn_nw);
+    out << in.ivart << in.ivarf << in.ivarc << in.ivarp << in.ivarw;
+
+    writeArray(out, in.t);
+    writeArray(out, in.h);
+    writeArray(out, in.f);
+    writeArray(out, in.c);
+    writeArray(out, in.p);
+    writeArray(out, in.w);
+
+    writeArray(out, in.uType);
+    writeArray(out, in.ua);
+    writeArray(out, in.ntu);
+    writeArray(out, in.eff);
+    writeArray(out, in.cat);
+    writeArray(out, in.lmtd);
+    writeArray(out, in.heat);
+    writeArray(out, in.devg);
+    writeArray(out, in.devl);
+    writeArray(out, in.ipinch);
+    writeArray(out, in.mrate);
+    writeArray(out, in.humeff);
+    writeArray(out, in.enthalpyeff);
+    writeArray(out, in.distributionW);
+    writeArray(out, in.distributionT);
+    writeArray(out, in.distributionH);
+
+    out << in.equations << in.singularIndex << in.ptxPoints;
+    out << in.state << in.warmStarted << in.fromCache << in.sensitivity;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, calOutputs &out)
+{
+    qint32 noVar, noVarT, noVarC, noVarF, noVarP, noVarW, noEqn, noEqnLin, noEqnNln,
+            noIter, IER, currentSp;
+    in >> noVar >> noVarT >> noVarC >> noVarF >> noVarP >> noVarW >> noEqn >> noEqnLin
+       >> noEqnNln >> noIter >> IER >> out.stopped
+       >> currentSp >> out.myMsg >> out.cop >> out.capacity;
+    out.noVar = noVar;
+    out.noVarT = noVarT;
+    out.noVarC = noVarC;
+    out.noVarF = noVarF;
+    out.noVarP = noVarP;
+    out.noVarW = noVarW;
+    out.noEqn = noEqn;
+    out.noEqnLin = noEqnLin;
+    out.noEqnNln = noEqnNln;
+    out.noIter = noIter;
+    out.IER = IER;
+    out.currentSp = currentSp;
+
+    readArray(in, out.eqn_var);
+    readArray(in, out.eqn_res);
+    readArray(in, out.eqn_name);
+    readArray(in, out.eqn_uid);
+    qint32 nukt, nconc, nflow, npress, nw;
+    in >> nukt >> nconc >> nflow >> npress >> nw;
+    out.eqn_nukt = nukt;
+    out.eqn_nconc = nconc;
+    out.eqn_nflow = nflow;
+    out.eqn_npress = npress;
+    out.eqn_nw = nw;
+    in >> out.ivart >> out.ivarf >> out.ivarc >> out.ivarp >> out.ivarw;
+
+    readArray(in, out.t);
+    readArray(in, out.h);
+    readArray(in, out.f);
+    readArray(in, out.c);
+    readArray(in, out.p);
+    readArray(in, out.w);
+
+    readArray(in, out.uType);
+    readArray(in, out.ua);
+    readArray(in, out.ntu);
+    readArray(in, out.eff);
+    readArray(in, out.cat);
+    readArray(in, out.lmtd);
+    readArray(in, out.heat);
+    readArray(in, out.devg);
+    readArray(in, out.devl);
+    readArray(in, out.ipinch);
+    readArray(in, out.mrate);
+    readArray(in, out.humeff);
+    readArray(in, out.enthalpyeff);
+    readArray(in, out.distributionW);
+    readArray(in, out.distributionT);
+    readArray(in, out.distributionH);
+
+    in >> out.equations >> out.singularIndex >> out.ptxPoints;
+    in >> out.state >> out.warmStarted >> out.fromCache >> out.sensitivity;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const solverState &in)
+{
+    out << in.structureHash << in.x << in.ivt << in.ivc << in.ivf << in.ivp << in.ivw
+        << in.q << in.r << in.tmin << in.txn << in.fmax << in.pmax;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, solverState &out)
+{
+    in >> out.structureHash >> out.x >> out.ivt >> out.ivc >> out.ivf >> out.ivp >> out.ivw
+       >> out.q >> out.r >> out.tmin >> out.txn >> out.fmax >> out.pmax;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const sensitivityReport::item &in)
+{
+    return out << in.quantity << in.index << in.iht;
+}
+
+QDataStream &operator>>(QDataStream &in, sensitivityReport::item &out)
+{
+    return in >> out.quantity >> out.index >> out.iht;
+}
+
+QDataStream &operator<<(QDataStream &out, const sensitivityReport &in)
+{
+    return out << in.inputs << in.outputs << in.values << in.results << in.message;
+}
+
+QDataStream &operator>>(QDataStream &in, sensitivityReport &out)
+{
+    return in >> out.inputs >> out.outputs >> out.values >> out.results >> out.message;
+}
+
+namespace {
+
+QString joinNumbers(const QVector<double> &values)
+{
+    QStringList list;
+    foreach(double value, values)
+        list.append(QString::number(value, 'g', 17));
+    return list.join(" ");
+}
+
+QString joinNumbers(const QVector<int> &values)
+{
+    QStringList list;
+    foreach(int value, values)
+        list.append(QString::number(value));
+    return list.join(" ");
+}
+
+QVector<double> splitDoubles(const QDomElement &element, bool &ok)
+{
+    QVector<double> values;
+    foreach(QString item, element.text().split(" ", Qt::SkipEmptyParts))
+    {
+        bool isNumber;
+        values.append(item.toDouble(&isNumber));
+        ok = ok && isNumber;
+    }
+    return values;
+}
+
+QVector<int> splitInts(const QDomElement &element, bool &ok)
+{
+    QVector<int> values;
+    foreach(QString item, element.text().split(" ", Qt::SkipEmptyParts))
+    {
+        bool isNumber;
+        values.append(item.toInt(&isNumber));
+        ok = ok && isNumber;
+    }
+    return values;
+}
+
+}
+
+QDomElement solverStateToXml(QDomDocument &doc, const solverState &state)
+{
+    QDomElement element = doc.createElement("SolverState");
+    element.setAttribute("hash", state.structureHash);
+    element.setAttribute("n", QString::number(state.n()));
+    element.setAttribute("tmin", QString::number(state.tmin, 'g', 17));
+    element.setAttribute("txn", QString::number(state.txn, 'g', 17));
+    element.setAttribute("fmax", QString::number(state.fmax, 'g', 17));
+    element.setAttribute("pmax", QString::number(state.pmax, 'g', 17));
+
+    QStringList names = QStringList()<<"x"<<"q"<<"r";
+    QList<const QVector<double> *> reals = QList<const QVector<double> *>()<<&state.x<<&state.q<<&state.r;
+    for(int i = 0; i < names.count(); i++)
+    {
+        QDomElement child = doc.createElement(names.at(i));
+        child.appendChild(doc.createTextNode(joinNumbers(*reals.at(i))));
+        element.appendChild(child);
+    }
+    names = QStringList()<<"ivt"<<"ivc"<<"ivf"<<"ivp"<<"ivw";
+    QList<const QVector<int> *> indexes = QList<const QVector<int> *>()
+            <<&state.ivt<<&state.ivc<<&state.ivf<<&state.ivp<<&state.ivw;
+    for(int i = 0; i < names.count(); i++)
+    {
+        QDomElement child = doc.createElement(names.at(i));
+        child.appendChild(doc.createTextNode(joinNumbers(*indexes.at(i))));
+        element.appendChild(child);
+    }
+    return element;
+}
+
+solverState solverStateFromXml(const QDomElement &element)
+{
+    solverState state;
+    if(element.isNull())
+        return state;
+
+    bool ok = true;
+    state.structureHash = element.attribute("hash");
+    state.tmin = element.attribute("tmin").toDouble();
+    state.txn = element.attribute("txn").toDouble();
+    state.fmax = element.attribute("fmax").toDouble();
+    state.pmax = element.attribute("pmax").toDouble();
+    state.x = splitDoubles(element.firstChildElement("x"), ok);
+    state.q = splitDoubles(element.firstChildElement("q"), ok);
+    state.r = splitDoubles(element.firstChildElement("r"), ok);
+    state.ivt = splitInts(element.firstChildElement("ivt"), ok);
+    state.ivc = splitInts(element.firstChildElement("ivc"), ok);
+    state.ivf = splitInts(element.firstChildElement("ivf"), ok);
+    state.ivp = splitInts(element.firstChildElement("ivp"), ok);
+    state.ivw = splitInts(element.firstChildElement("ivw"), ok);
+
+    int n = element.attribute("n").toInt();
+    if(!ok || n != state.n() || state.ivt.count() != n || state.ivc.count() != n
+            || state.ivf.count() != n || state.ivp.count() != n || state.ivw.count() != n)
+        return solverState();
+    return state;
+}
+
+QString solverStructureHash(const calInputs &in)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << qint32(in.nsp) << qint32(in.nunits);
+    for(int i = 1; i <= in.nunits && i < 50; i++)
+    {
+        stream << qint32(in.idunit[i]) << qint32(in.iht[i]) << qint32(in.ipinch[i])
+               << qint32(in.icop[i]) << qint32(in.nIter[i]);
+        for(int j = 0; j < 7; j++)
+            stream << qint32(in.isp[i][j]);
+    }
+    for(int i = 1; i <= in.nsp && i < 150; i++)
+        stream << qint32(in.ksub[i]) << qint32(in.itfix[i]) << qint32(in.icfix[i])
+               << qint32(in.iffix[i]) << qint32(in.ipfix[i]) << qint32(in.iwfix[i]);
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+}
+
+QString solverInputHash(const calInputs &in)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << solverStructureHash(in)
+           << in.tmax << in.tmin << in.fmax << in.pmax
+           << qint32(in.maxfev) << qint32(in.msglvl) << in.ftol << in.xtol
+           << in.fastProperties << in.if97Water << in.sensitivity << qint32(in.solverMethod) << in.autoScaling;
+    for(int i = 1; i <= in.nunits && i < 50; i++)
+        stream << in.ht[i] << in.devl[i] << in.devg[i] << in.wetness[i] << in.ntum[i]
+               << in.ntuw[i] << in.ntua[i] << in.le[i] << in.height[i];
+    for(int i = 1; i <= in.nsp && i < 150; i++)
+        stream << in.t[i] << in.f[i] << in.c[i] << in.p[i] << in.w[i];
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+}
@@ -42,9 +42,76 @@ Developed by Zhiyao Yang and Dr. Ming Qu for ORNL.
 #include "node.h"
 #include <QMessageBox>
 #include <QMultiMap>
+#include <QDataStream>
+#include <QDomDocument>
+#include <QDomElement>
 
 /// \{
 
+/*!
+Converged state of the nonlinear solver (hybrd1/hybrdm in the engine).
+
+Enough to restart the solver where it stopped: the scaled variables x, which
+state point each variable belongs to, and the QR factors of the last Jacobian
+(Broyden updated). A state is only valid for the flowsheet it was computed
+for, which is checked with structureHash (see solverStructureHash()).
+- filled in calOutputs::state after a converged run
+- given back to the engine in calInputs::warmStart
+- saved with the case as the "SolverState" element
+*/
+struct solverState
+{
+    QString structureHash;
+    /// scaled variables, x(1..n)
+    QVector<double> x;
+    /// state point of each variable by type, 0 if the variable is of another type (as ivt..ivw in the engine)
+    QVector<int> ivt, ivc, ivf, ivp, ivw;
+    /// orthogonal factor, column major n*n
+    QVector<double> q;
+    /// upper triangular factor packed by rows, n*(n+1)/2
+    QVector<double> r;
+    /// normalization used for x
+    double tmin = 0, txn = 0, fmax = 0, pmax = 0;
+
+    int n() const { return x.count(); }
+    bool isValid() const { return !x.isEmpty() && !structureHash.isEmpty(); }
+};
+
+/*!
+First order sensitivities of the results of a converged run to its fixed inputs.
+
+Computed by the engine at the solution with the implicit function theorem: one
+Jacobian, then one linear solve per input (see sensitivity() in
+sorpsimEngine.cpp). Values are in the British units of the engine.
+- requested with calInputs::sensitivity, returned in calOutputs::sensitivity
+- shown in the "Sensitivity" tab of resultDialog
+*/
+struct sensitivityReport
+{
+    enum Quantity { Temperature, Enthalpy, MassFlow, Concentration, Pressure, VaporFraction,
+                    HeatSpec, HeatTransfer, UAValue, COP, Capacity };
+    struct item
+    {
+        qint32 quantity = 0;
+        /// state point or component, 0 for the system
+        qint32 index = 0;
+        /// HeatSpec: what the specification of the component is (iht)
+        qint32 iht = 0;
+    };
+    QVector<item> inputs;
+    QVector<item> outputs;
+    /// d outputs[o] / d inputs[i] at [i * outputs.count() + o]
+    QVector<double> values;
+    /// outputs[o] at the solution, not rounded as the results in calOutputs
+    QVector<double> results;
+    /// why there are no values, if there aren't
+    QString message;
+
+    bool isValid() const { return !inputs.isEmpty() && values.count() == inputs.count() * outputs.count()
+                                  && results.count() == outputs.count(); }
+    double value(int output, int input) const { return values.at(input * outputs.count() + output); }
+};
+
 struct calInputs
 {
 //    global para
@@ -91,7 +158,24 @@ struct calInputs
     int iwfix[150];
     float w[150];
 
-
+//    solver
+    /// how the engine solves the residuals (see solverMethod)
+    enum SolverMethod {
+        Hybrid,     ///< Powell's hybrid method, hybrd1()
+        Homotopy,   ///< homotopy continuation from the start, for poor guesses (see homotopy())
+        BoundedTrustRegion  ///< trust region within the physical bounds of the variables (see boundedTrustRegion())
+    };
+    int solverMethod = Hybrid;
+    /// Hybrid solves in variables and residuals scaled by the norms of the Jacobian
+    /// instead of tmax, tmin, fmax and pmax (see scaledHybrid())
+    bool autoScaling = false;
+    solverState warmStart;
+    /// evaluate the iterative property inversions from spline tables (see propSurrogates)
+    bool fastProperties = false;
+    /// water properties from IAPWS-IF97 instead of Saul/Wagner (see sorpprops/if97.h)
+    bool if97Water = false;
+    /// compute calOutputs::sensitivity after convergence
+    bool sensitivity = false;
 };
 
 struct calOutputs
@@ -171,8 +255,48 @@ struct calOutputs
 
     QList<int> ptxPoints;
 
+//    solver
+    solverState state;
+    bool warmStarted = false;
+    /// taken from the solverCache instead of being solved
+    bool fromCache = false;
+    sensitivityReport sensitivity;
 };
 
+/// \name Binary serialization of the engine interface
+///
+/// Used to ship a run to a solver worker process and its results back
+/// (see solverPool). Both ends are the same executable, so the layout
+/// only has to agree with itself; bump solverPool::protocolVersion if it changes.
+/// \{
+QDataStream &operator<<(QDataStream &out, const calInputs &in);
+QDataStream &operator>>(QDataStream &in, calInputs &out);
+QDataStream &operator<<(QDataStream &out, const calOutputs &in);
+QDataStream &operator>>(QDataStream &in, calOutputs &out);
+QDataStream &operator<<(QDataStream &out, const solverState &in);
+QDataStream &operator>>(QDataStream &in, solverState &out);
+QDataStream &operator<<(QDataStream &out, const sensitivityReport &in);
+QDataStream &operator>>(QDataStream &in, sensitivityReport &out);
+/// \}
+
+/// \name Case file storage of the solver state
+/// \{
+QDomElement solverStateToXml(QDomDocument &doc, const solverState &state);
+/// \return an invalid state if the element is missing or malformed
+solverState solverStateFromXml(const QDomElement &element);
+/// \}
+
+/// Hash of everything in the inputs that decides the equations and the
+/// variables of the engine (components, connections, fluids, fix flags), but
+/// not the values, so that a solverState can be reused after value changes.
+QString solverStructureHash(const calInputs &in);
+
+/// Hash of everything in the inputs that decides the solution: the structure,
+/// the values (including the guess values), the solver settings, the
+/// property models and the sensitivity option. Only the title and the warm start are left out, so runs with
+/// the same hash converge to the same solution (see solverCache).
+QString solverInputHash(const calInputs &in);
+
 struct globalparameter
 {
     QString title;
@@ -188,6 +312,23 @@ struct globalparameter
     double ftol;
     double xtol;
     bool updateGuessValues;
+    /// start the next run from lastSolution if it fits the case
+    bool warmStart;
+    solverState lastSolution;
+    /// calInputs::fastProperties of the runs
+    bool fastProperties;
+    /// calInputs::if97Water of the runs
+    bool if97Water;
+    /// calInputs::sensitivity of the runs
+    bool sensitivity;
+    /// solve a run that didn't converge again from several starts (see multiStart)
+    bool multiStart;
+    /// calInputs::solverMethod of the runs
+    int solverMethod;
+    /// calInputs::autoScaling of the runs
+    bool autoScaling;
+    /// of the last run, see calculate::updateSystem()
+    sensitivityReport lastSensitivity;
 
     float cop;
     float capacity;
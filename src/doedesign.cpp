@@ -0,0 +1,189 @@
+/*! \file doedesign.cpp
+    \brief Designs of experiments for parametric tables
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <random>
+
+#include "doedesign.h"
+
+namespace {
+
+/// degree s, coefficients a and initial direction numbers m of Sobol dimensions 2..10
+struct sobolPolynomial
+{
+    int s;
+    unsigned a;
+    unsigned m[5];
+};
+
+const sobolPolynomial joeKuo[doeDesign::maxSobolDimensions-1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}}
+};
+
+const int sobolBits = 32;
+
+/// direction numbers v[1..32] of a dimension (0 based), scaled by 2^32
+QVector<quint32> directions(int dimension)
+{
+    QVector<quint32> v(sobolBits+1, 0);
+    if(dimension == 0)
+    {
+        for(int k = 1; k <= sobolBits; k++)
+            v[k] = quint32(1) << (sobolBits-k);
+        return v;
+    }
+    const sobolPolynomial &p = joeKuo[dimension-1];
+    for(int k = 1; k <= p.s; k++)
+        v[k] = p.m[k-1] << (sobolBits-k);
+    for(int k = p.s+1; k <= sobolBits; k++)
+    {
+        v[k] = v[k-p.s] ^ (v[k-p.s] >> p.s);
+        for(int i = 1; i < p.s; i++)
+            if((p.a >> (p.s-1-i)) & 1)
+                v[k] ^= v[k-i];
+    }
+    return v;
+}
+
+double squaredDistance(const QVector<double> &a, const QVector<double> &b)
+{
+    double sum = 0;
+    for(int i = 0; i < a.count() && i < b.count(); i++)
+        sum += (a.at(i)-b.at(i))*(a.at(i)-b.at(i));
+    return sum;
+}
+
+}
+
+QVector<QVector<double> > doeDesign::fullFactorial(const QVector<int> &levels)
+{
+    QVector<QVector<double> > points;
+    int count = 1;
+    for(int i = 0; i < levels.count(); i++)
+    {
+        if(levels.at(i) < 1)
+            return points;
+        count *= levels.at(i);
+    }
+    points.reserve(count);
+    QVector<int> index(levels.count(), 0);
+    for(int n = 0; n < count; n++)
+    {
+        QVector<double> point(levels.count());
+        for(int i = 0; i < levels.count(); i++)
+            point[i] = levels.at(i) > 1 ? double(index.at(i))/(levels.at(i)-1) : 0.5;
+        points << point;
+        // odometer, the last input fastest
+        for(int i = levels.count()-1; i >= 0; i--)
+        {
+            if(++index[i] < levels.at(i))
+                break;
+            index[i] = 0;
+        }
+    }
+    return points;
+}
+
+QVector<QVector<double> > doeDesign::latinHypercube(int points, int dimensions, quint32 seed)
+{
+    std::mt19937 random(seed);
+    QVector<QVector<double> > result(points, QVector<double>(dimensions));
+    QVector<int> strata(points);
+    for(int d = 0; d < dimensions; d++)
+    {
+        for(int n = 0; n < points; n++)
+            strata[n] = n;
+        for(int n = points-1; n > 0; n--)
+            qSwap(strata[n], strata[int(random() % quint32(n+1))]);
+        for(int n = 0; n < points; n++)
+            result[n][d] = (strata.at(n) + (random() + 0.5)/4294967296.0)/points;
+    }
+    return result;
+}
+
+QVector<QVector<double> > doeDesign::sobol(int points, int dimensions)
+{
+    QVector<QVector<double> > result;
+    if(dimensions > maxSobolDimensions || points < 1)
+        return result;
+    QVector<QVector<quint32> > v;
+    for(int d = 0; d < dimensions; d++)
+        v << directions(d);
+
+    // Gray code order: each point differs from the last in one direction number
+    result.reserve(points);
+    QVector<quint32> x(dimensions, 0);
+    for(int n = 0; n < points; n++)
+    {
+        if(n > 0)
+        {
+            int c = 1;
+            for(quint32 value = quint32(n-1); value & 1; value >>= 1)
+                c++;
+            for(int d = 0; d < dimensions; d++)
+                x[d] ^= v.at(d).at(c);
+        }
+        QVector<double> point(dimensions);
+        for(int d = 0; d < dimensions; d++)
+            point[d] = x.at(d)/4294967296.0;
+        result << point;
+    }
+    return result;
+}
+
+designSeeds::designSeeds(int size) :
+    capacity(qMax(size, 1))
+{
+}
+
+void designSeeds::add(const QVector<double> &point, const solverState &state)
+{
+    if(!state.isValid())
+        return;
+    if(points.count() < capacity)
+    {
+        points << point;
+        states << state;
+        return;
+    }
+    int replaced = nearestIndex(point);
+    points[replaced] = point;
+    states[replaced] = state;
+}
+
+solverState designSeeds::nearest(const QVector<double> &point) const
+{
+    int index = nearestIndex(point);
+    return index < 0 ? solverState() : states.at(index);
+}
+
+int designSeeds::count() const
+{
+    return points.count();
+}
+
+int designSeeds::nearestIndex(const QVector<double> &point) const
+{
+    int best = -1;
+    double bestDistance = 0;
+    for(int i = 0; i < points.count(); i++)
+    {
+        double distance = squaredDistance(point, points.at(i));
+        if(best < 0 || distance < bestDistance)
+        {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,73 @@
+/*! \file doedesign.h
+    \brief Designs of experiments for parametric tables
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef DOEDESIGN_H
+#define DOEDESIGN_H
+
+#include <QVector>
+
+#include "dataComm.h"
+
+/*!
+Points of a design of experiments in the unit cube [0,1]^d, one QVector of d
+coordinates per point; doeDialog scales them to the ranges of the inputs of a
+parametric table.
+
+- full factorial: every combination of the levels of each input, the last
+  input changing fastest (so neighbouring runs are neighbours in input space)
+- Latin hypercube: each input has one point in each of n equal strata, at a
+  random position within it, with the strata paired at random between inputs;
+  the same seed gives the same design
+- Sobol: the Sobol low discrepancy sequence, direction numbers of Joe and Kuo
+  (new-joe-kuo-6.21201) for up to maxSobolDimensions inputs; any prefix of the
+  sequence covers the cube evenly, and more points refine a design without
+  moving the points it has
+*/
+class doeDesign
+{
+public:
+    enum Method { FullFactorial, LatinHypercube, Sobol };
+
+    static const int maxSobolDimensions = 10;
+
+    /// \param levels number of levels of each input, an input with one level is at 0.5
+    static QVector<QVector<double> > fullFactorial(const QVector<int> &levels);
+    static QVector<QVector<double> > latinHypercube(int points, int dimensions, quint32 seed);
+    /// \return no points for more than maxSobolDimensions dimensions
+    static QVector<QVector<double> > sobol(int points, int dimensions);
+};
+
+/*!
+Solver states of the converged runs of a sweep, to start each run from the
+converged run nearest to it in input space instead of from the guess values.
+
+The points are the table inputs of the runs scaled to [0,1] by the range of
+each input over the table, the distance is Euclidean. A solver state holds
+the factors of the Jacobian, so only a bounded number of states is kept: once
+full, a new state takes the place of the kept state nearest to it, which keeps
+the kept states spread over the input space.
+
+Used by tableDialog::calcTableParallel() as the warm start of the solverPool.
+*/
+class designSeeds
+{
+public:
+    explicit designSeeds(int capacity = 256);
+
+    void add(const QVector<double> &point, const solverState &state);
+    /// \return an invalid state if no run converged yet
+    solverState nearest(const QVector<double> &point) const;
+    int count() const;
+
+private:
+    int nearestIndex(const QVector<double> &point) const;
+
+    int capacity;
+    QVector<QVector<double> > points;
+    QVector<solverState> states;
+};
+
+#endif // DOEDESIGN_H
@@ -0,0 +1,174 @@
+/*! \file doedialog.cpp
+    \brief Dialog to fill a parametric table with a design of experiments
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QHeaderView>
+#include <QTableWidget>
+
+#include "doedialog.h"
+#include "ui_doedialog.h"
+#include "doedesign.h"
+#include "mainwindow.h"
+
+extern globalparameter globalpara;
+
+namespace {
+
+enum Columns { NameColumn, LowerColumn, UpperColumn, LevelsColumn };
+
+}
+
+doeDialog::doeDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::doeDialog)
+{
+    ui->setupUi(this);
+    setWindowTitle("Design Runs");
+    setWindowModality(Qt::WindowModal);
+
+    ui->inputTable->setColumnCount(4);
+    ui->inputTable->setHorizontalHeaderLabels(QStringList()<<"Input"<<"Lower"<<"Upper"<<"Levels");
+    ui->inputTable->horizontalHeader()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+    ui->inputTable->verticalHeader()->hide();
+    on_methodBox_currentIndexChanged(ui->methodBox->currentIndex());
+}
+
+doeDialog::~doeDialog()
+{
+    delete ui;
+}
+
+void doeDialog::setInputs(const QStringList &names, const QVector<double> &lower, const QVector<double> &upper)
+{
+    ui->inputTable->blockSignals(true);
+    ui->inputTable->setRowCount(names.count());
+    for(int i = 0; i < names.count(); i++)
+    {
+        QTableWidgetItem *name = new QTableWidgetItem(names.at(i));
+        name->setFlags(name->flags() & ~Qt::ItemIsEditable);
+        ui->inputTable->setItem(i, NameColumn, name);
+        ui->inputTable->setItem(i, LowerColumn, new QTableWidgetItem(QString::number(lower.value(i))));
+        ui->inputTable->setItem(i, UpperColumn, new QTableWidgetItem(QString::number(upper.value(i))));
+        ui->inputTable->setItem(i, LevelsColumn, new QTableWidgetItem(QString::number(3)));
+    }
+    ui->inputTable->blockSignals(false);
+    showRunCount();
+}
+
+QVector<QVector<double> > doeDialog::designValues() const
+{
+    return design;
+}
+
+qint64 doeDialog::runCount() const
+{
+    if(ui->methodBox->currentIndex() != doeDesign::FullFactorial)
+        return ui->pointsBox->value();
+    qint64 count = 1;
+    for(int i = 0; i < ui->inputTable->rowCount(); i++)
+    {
+        QTableWidgetItem *levels = ui->inputTable->item(i, LevelsColumn);
+        count *= qMax(levels == NULL ? 1 : levels->text().toInt(), 0);
+        if(count > maxRuns)
+            return maxRuns+1;
+    }
+    return count;
+}
+
+void doeDialog::showRunCount()
+{
+    qint64 count = runCount();
+    ui->runsLabel->setText(count > maxRuns ? QString("more than %1 runs").arg(maxRuns)
+                                           : QString("%1 runs").arg(count));
+}
+
+void doeDialog::on_methodBox_currentIndexChanged(int index)
+{
+    ui->inputTable->setColumnHidden(LevelsColumn, index != doeDesign::FullFactorial);
+    ui->pointsBox->setEnabled(index != doeDesign::FullFactorial);
+    ui->seedBox->setEnabled(index == doeDesign::LatinHypercube);
+    showRunCount();
+}
+
+void doeDialog::on_pointsBox_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    showRunCount();
+}
+
+void doeDialog::on_inputTable_itemChanged(QTableWidgetItem *item)
+{
+    if(item->column() == LevelsColumn)
+        showRunCount();
+}
+
+void doeDialog::on_okButton_clicked()
+{
+    int inputs = ui->inputTable->rowCount();
+    QVector<double> lower(inputs), upper(inputs);
+    QVector<int> levels(inputs);
+    for(int i = 0; i < inputs; i++)
+    {
+        bool lowerOk, upperOk, levelsOk;
+        lower[i] = ui->inputTable->item(i, LowerColumn)->text().toDouble(&lowerOk);
+        upper[i] = ui->inputTable->item(i, UpperColumn)->text().toDouble(&upperOk);
+        levels[i] = ui->inputTable->item(i, LevelsColumn)->text().toInt(&levelsOk);
+        if(!lowerOk || !upperOk)
+        {
+            globalpara.reportError("Please enter a valid range for "
+                                   +ui->inputTable->item(i, NameColumn)->text()+".",this);
+            return;
+        }
+        if(ui->methodBox->currentIndex() == doeDesign::FullFactorial && (!levelsOk || levels[i] < 1))
+        {
+            globalpara.reportError("Please enter at least one level for "
+                                   +ui->inputTable->item(i, NameColumn)->text()+".",this);
+            return;
+        }
+    }
+    if(runCount() > maxRuns)
+    {
+        globalpara.reportError(QString("The design has more than %1 runs, please use fewer levels.")
+                               .arg(maxRuns),this);
+        return;
+    }
+
+    QVector<QVector<double> > points;
+    switch(ui->methodBox->currentIndex())
+    {
+    case doeDesign::FullFactorial:
+        points = doeDesign::fullFactorial(levels);
+        break;
+    case doeDesign::LatinHypercube:
+        points = doeDesign::latinHypercube(ui->pointsBox->value(), inputs, quint32(ui->seedBox->value()));
+        break;
+    case doeDesign::Sobol:
+        if(inputs > doeDesign::maxSobolDimensions)
+        {
+            globalpara.reportError(QString("The Sobol sequence is available for up to %1 inputs, "
+                                           "please use a Latin hypercube instead.")
+                                   .arg(doeDesign::maxSobolDimensions),this);
+            return;
+        }
+        points = doeDesign::sobol(ui->pointsBox->value(), inputs);
+        break;
+    }
+
+    design.clear();
+    design.reserve(points.count());
+    for(int n = 0; n < points.count(); n++)
+    {
+        QVector<double> values(inputs);
+        for(int i = 0; i < inputs; i++)
+            values[i] = lower.at(i)+points.at(n).at(i)*(upper.at(i)-lower.at(i));
+        design<<values;
+    }
+    accept();
+}
+
+void doeDialog::on_cancelButton_clicked()
+{
+    reject();
+}
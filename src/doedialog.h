@@ -0,0 +1,61 @@
+/*! \file doedialog.h
+    \brief Dialog to fill a parametric table with a design of experiments
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef DOEDIALOG_H
+#define DOEDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+
+class QTableWidgetItem;
+
+namespace Ui {
+class doeDialog;
+}
+
+/// Dialog to generate the runs of a parametric table from a design of experiments (see doeDesign)
+/// - the range of each input of the table, and the levels of a full factorial design, are
+///   entered in the units of the table
+/// - the new input values replace the runs of the table in tableDialog
+/// - called by tabledialog.cpp
+class doeDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit doeDialog(QWidget *parent = 0);
+    ~doeDialog();
+
+    /// \param lower, upper default range of each input
+    void setInputs(const QStringList &names, const QVector<double> &lower, const QVector<double> &upper);
+    /// values of the inputs of each run, valid once the dialog is accepted
+    QVector<QVector<double> > designValues() const;
+
+    /// largest design accepted, in runs
+    static const int maxRuns = 100000;
+
+private slots:
+    void on_methodBox_currentIndexChanged(int index);
+
+    void on_pointsBox_valueChanged(int value);
+
+    void on_inputTable_itemChanged(QTableWidgetItem *item);
+
+    void on_okButton_clicked();
+
+    void on_cancelButton_clicked();
+
+private:
+    Ui::doeDialog *ui;
+
+    qint64 runCount() const;
+    void showRunCount();
+
+    QVector<QVector<double> > design;
+};
+
+#endif // DOEDIALOG_H
@@ -488,12 +488,10 @@ void editPropertyCurveDialog::drawPlot()
         {
             addvalue addsp = overlay_plot->addvaluelist.at(i);
             double tsol = convert(addsp.add_temperature,temperature[tInd],temperature[1]),
-                    csol=addsp.add_concentration,tref,Tref,y,pt;
+                    csol=addsp.add_concentration,y;
             if (addsp.add_concentration!=0)
             {
-                tref=(tsol-(124.937-7.71649*csol+0.152286*pow(csol,2)-0.00079509*pow(csol,3)))/(-2.00755+0.16976*csol-0.003133362*pow(csol,2)+0.0000197668*pow(csol,3));
-                Tref=tref+273.15;
-                y=pow(10,(7.05-1596.49/Tref-104095.5/pow(Tref,2)));
+                y=plotBackground::solutionPressure(csol,tsol);
                 points<< QPointF( -1/(tsol+273.15),y );
 
 
@@ -509,8 +507,7 @@ void editPropertyCurveDialog::drawPlot()
             else
             {
 
-                pt = 1 - (tsol + 273.15) / 647.35;
-                y= 227.98*100*exp((-7.855823 * pt + 1.83991 * pow(pt, 1.5) - 11.7811 * pow(pt,3) + 22.6705 * pow(pt, 3.5) - 15.9393 * pow(pt, 4) + 1.77516 * pow(pt ,7.5)) / (1 - pt));
+                y=plotBackground::waterPressure(tsol);
                 points<< QPointF( -1/(tsol+273.15),y );
 
                 marker=new QwtPlotMarker;
@@ -23,6 +23,7 @@
 #include "globaldialog.h"
 #include "ui_globaldialog.h"
 #include "mainwindow.h"
+#include "solvercache.h"
 
 extern globalparameter globalpara;
 extern MainWindow*theMainwindow;
@@ -36,6 +37,18 @@ GlobalDialog::GlobalDialog(QWidget *parent) :
     ui->maxiteration->setText(QString::number(globalpara.maxfev));
     ui->convtolerancef->setText(QString::number(globalpara.ftol));
     ui->convtolerancev->setText(QString::number(globalpara.xtol));
+    ui->solverBox->setCurrentIndex(globalpara.solverMethod);
+    ui->autoScalingBox->setChecked(globalpara.autoScaling);
+    ui->autoScalingBox->setEnabled(globalpara.solverMethod == calInputs::Hybrid);
+    ui->warmStartBox->setChecked(globalpara.warmStart);
+    ui->warmStartBox->setEnabled(globalpara.lastSolution.isValid());
+    ui->fastPropertiesBox->setChecked(globalpara.fastProperties);
+    ui->if97Box->setChecked(globalpara.if97Water);
+    ui->sensitivityBox->setChecked(globalpara.sensitivity);
+    ui->multiStartBox->setChecked(globalpara.multiStart);
+    ui->cacheBox->setChecked(solverCache::shared()->isEnabled());
+    ui->diskCacheBox->setChecked(solverCache::shared()->hasDiskStore());
+    ui->diskCacheBox->setEnabled(ui->cacheBox->isChecked());
 
     setWindowTitle("Set Calculation Control");
     setWindowFlags(Qt::Dialog);
@@ -61,6 +74,15 @@ void GlobalDialog::on_buttonBox_accepted()
    globalpara.msglvl = globalpara.maxfev;
    globalpara.ftol = ui->convtolerancef->text().toDouble();
    globalpara.xtol = ui->convtolerancev->text().toDouble();
+   globalpara.solverMethod = ui->solverBox->currentIndex();
+   globalpara.autoScaling = ui->autoScalingBox->isEnabled() && ui->autoScalingBox->isChecked();
+   globalpara.warmStart = ui->warmStartBox->isChecked();
+   globalpara.fastProperties = ui->fastPropertiesBox->isChecked();
+   globalpara.if97Water = ui->if97Box->isChecked();
+   globalpara.sensitivity = ui->sensitivityBox->isChecked();
+   globalpara.multiStart = ui->multiStartBox->isChecked();
+   solverCache::shared()->setEnabled(ui->cacheBox->isChecked());
+   solverCache::shared()->setDiskStore(ui->diskCacheBox->isChecked());
    accept();
 }
 
@@ -69,6 +91,17 @@ void GlobalDialog::on_buttonBox_rejected()
     reject();
 }
 
+void GlobalDialog::on_cacheBox_toggled(bool checked)
+{
+    ui->diskCacheBox->setEnabled(checked);
+}
+
+void GlobalDialog::on_solverBox_currentIndexChanged(int index)
+{
+    // only the Hybrid method scales automatically
+    ui->autoScalingBox->setEnabled(index == calInputs::Hybrid);
+}
+
 bool GlobalDialog::event(QEvent *e)
 {
     if(e->type()==QEvent::ActivationChange)
@@ -42,6 +42,10 @@ private slots:
 
     void on_buttonBox_rejected();
 
+    void on_cacheBox_toggled(bool checked);
+
+    void on_solverBox_currentIndexChanged(int index);
+
 
 private:
     Ui::GlobalDialog *ui;
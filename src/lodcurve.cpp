@@ -0,0 +1,182 @@
+/*! \file lodcurve.cpp
+    \brief Plot curve that draws dense data at the level of detail of the screen
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QPainter>
+#include <QPolygonF>
+
+#include <qwt_painter.h>
+#include <qwt_scale_map.h>
+#include <qwt_symbol.h>
+
+#include "lodcurve.h"
+
+namespace {
+
+/// curves with fewer samples are always drawn as they are
+const int minimumSamples = 1024;
+/// the pyramid stops at this many buckets
+const int minimumBuckets = 64;
+
+/// lowest and highest point of each group of four points, in index order
+QVector<QPointF> reduce(const QVector<QPointF> &points)
+{
+    QVector<QPointF> result;
+    result.reserve((points.count()+3)/4*2);
+    for(int i = 0; i < points.count(); i += 4)
+    {
+        int end = qMin(i+4, points.count());
+        int lo = i, hi = i;
+        for(int j = i+1; j < end; j++)
+        {
+            if(points.at(j).y() < points.at(lo).y())
+                lo = j;
+            if(points.at(j).y() > points.at(hi).y())
+                hi = j;
+        }
+        result << points.at(qMin(lo,hi)) << points.at(qMax(lo,hi));
+    }
+    return result;
+}
+
+}
+
+lodCurve::lodCurve(const QString &title) :
+    QwtPlotCurve(title),
+    levelsData(0),
+    levelsSize(0),
+    order(0)
+{
+    setPaintAttribute(QwtPlotCurve::FilterPoints, true);
+}
+
+void lodCurve::drawCurve(QPainter *painter, int style, const QwtScaleMap &xMap,
+                         const QwtScaleMap &yMap, const QRectF &canvasRect,
+                         int from, int to) const
+{
+    if(levelsData != data() || levelsSize != dataSize())
+        buildLevels();
+    if(style != QwtPlotCurve::Lines || levels.isEmpty() || brush().style() != Qt::NoBrush)
+    {
+        QwtPlotCurve::drawCurve(painter, style, xMap, yMap, canvasRect, from, to);
+        return;
+    }
+
+    visibleRange(xMap, from, to);
+    double pixels = qMax(xMap.pDist(), 1.0);
+    int visible = to - from + 1;
+    if(visible <= 2*pixels)
+    {
+        QwtPlotCurve::drawCurve(painter, style, xMap, yMap, canvasRect, from, to);
+        return;
+    }
+
+    // the first level with buckets of at least visible/pixels samples
+    int level = 0;
+    while(level < levels.count()-1 && (4 << level) * pixels < visible)
+        level++;
+    int bucket = 4 << level;
+    const QVector<QPointF> &points = levels.at(level);
+    int first = 2*(from/bucket), last = qMin(2*(to/bucket)+1, points.count()-1);
+
+    QPolygonF polyline(last-first+1);
+    QPointF *mapped = polyline.data();
+    for(int i = first; i <= last; i++)
+        mapped[i-first] = QPointF(xMap.transform(points.at(i).x()), yMap.transform(points.at(i).y()));
+    QwtPainter::drawPolyline(painter, polyline);
+}
+
+void lodCurve::drawSymbols(QPainter *painter, const QwtSymbol &symbol,
+                           const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRectF &canvasRect, int from, int to) const
+{
+    if(levelsData != data() || levelsSize != dataSize())
+        buildLevels();
+    if(order != 0)
+        visibleRange(xMap, from, to);
+
+    // symbols closer than their own width only smear the line
+    double spacing = qMax(symbol.size().width(), 1);
+    if((to - from + 1) * spacing > qMax(xMap.pDist(), 1.0))
+        return;
+    QwtPlotCurve::drawSymbols(painter, symbol, xMap, yMap, canvasRect, from, to);
+}
+
+int lodCurve::ordering() const
+{
+    int n = int(dataSize());
+    if(n < 2)
+        return 0;
+    bool increasing = true, decreasing = true;
+    double previous = sample(0).x();
+    for(int i = 1; i < n && (increasing || decreasing); i++)
+    {
+        double x = sample(i).x();
+        if(x < previous)
+            increasing = false;
+        if(x > previous)
+            decreasing = false;
+        previous = x;
+    }
+    if(increasing)
+        return 1;
+    if(decreasing)
+        return -1;
+    return 0;
+}
+
+void lodCurve::buildLevels() const
+{
+    levelsData = data();
+    levelsSize = dataSize();
+    levels.clear();
+    order = ordering();
+    if(order == 0 || levelsSize < size_t(minimumSamples))
+        return;
+
+    QVector<QPointF> samples;
+    samples.reserve(int(levelsSize));
+    for(int i = 0; i < int(levelsSize); i++)
+        samples << sample(i);
+    levels << reduce(samples);
+    while(levels.last().count() > 2*minimumBuckets)
+        levels << reduce(levels.last());
+}
+
+void lodCurve::visibleRange(const QwtScaleMap &xMap, int &from, int &to) const
+{
+    if(order == 0)
+        return;
+    // x*order increases with the index, so the visible samples are found by bisection
+    double lo = order*qMin(xMap.s1(), xMap.s2()), hi = order*qMax(xMap.s1(), xMap.s2());
+    if(order < 0)
+        qSwap(lo, hi);
+
+    int a = from, b = to + 1;
+    while(a < b)
+    {
+        int m = (a + b)/2;
+        if(order*sample(m).x() < lo)
+            a = m + 1;
+        else
+            b = m;
+    }
+    int first = qMax(a - 1, from);
+
+    a = first, b = to + 1;
+    while(a < b)
+    {
+        int m = (a + b)/2;
+        if(order*sample(m).x() <= hi)
+            a = m + 1;
+        else
+            b = m;
+    }
+    int last = qMin(a, to);
+
+    // keep the line to the neighbours outside the view
+    from = first;
+    to = qMax(last, first);
+}
@@ -0,0 +1,59 @@
+/*! \file lodcurve.h
+    \brief Plot curve that draws dense data at the level of detail of the screen
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef LODCURVE_H
+#define LODCURVE_H
+
+#include <QPointF>
+#include <QVector>
+#include <qwt_plot_curve.h>
+
+/*!
+A QwtPlotCurve that keeps panning and zooming smooth for curves with many
+samples (large parametric sweeps, property chart lines).
+
+- Lines: if the samples are ordered in x and more than two of them fall on
+  one pixel column, the curve is drawn from a min/max decimation of the
+  visible samples: for each bucket of samples its lowest and highest point,
+  with buckets about a pixel wide at the current zoom. The decimation is
+  precomputed once as a pyramid of bucket sizes 4, 8, 16, ..., so a redraw
+  only picks the level for the zoom and maps about two points per pixel,
+  whatever the size of the curve.
+- Symbols are only drawn when the visible samples are at least a symbol
+  width apart on average.
+
+Everything else (other curve styles, samples not ordered in x) is drawn by
+QwtPlotCurve. The level is chosen again at each replot, so zooming with the
+plot's zoomer or panner picks up the new scale by itself.
+*/
+class lodCurve : public QwtPlotCurve
+{
+public:
+    explicit lodCurve(const QString &title = QString());
+
+protected:
+    virtual void drawCurve(QPainter *painter, int style, const QwtScaleMap &xMap,
+                           const QwtScaleMap &yMap, const QRectF &canvasRect,
+                           int from, int to) const;
+    virtual void drawSymbols(QPainter *painter, const QwtSymbol &symbol,
+                             const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                             const QRectF &canvasRect, int from, int to) const;
+
+private:
+    /// \return 1 if x increases with the index, -1 if it decreases, 0 if neither
+    int ordering() const;
+    void buildLevels() const;
+    /// first and last sample inside the x range of xMap, plus one on each side
+    void visibleRange(const QwtScaleMap &xMap, int &from, int &to) const;
+
+    mutable const void *levelsData;
+    mutable size_t levelsSize;
+    mutable int order;
+    /// levels[k]: two points per bucket of 2^(k+2) samples, lowest and highest in index order
+    mutable QVector<QVector<QPointF> > levels;
+};
+
+#endif // LODCURVE_H
@@ -14,9 +14,14 @@
 
 */
 
+#include "correlationbench.h"
 #include "mainwindow.h"
+#include "propbench.h"
 #include "sorputils.h"
+#include "solverpool.h"
+#include "solverserver.h"
 #include <QApplication>
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDomImplementation>
 #include <QFile>
@@ -25,8 +30,24 @@
 /// start a new mainwindow and leave all interactions to the mainwindow
 /// - once the mainwindow is closed, the application is closed as well
 /// - first subroutine to run at SorpSim's launch
+/// - with "--solver-worker", runs headless as a solver process for solverPool instead
+/// - with "--solver-server", serves a case to local clients instead (see solverServer)
+/// - with "--bench-properties", times the property routines instead (see propBench)
+/// - with "--bench-correlations", times the routines of every fluid family (see correlationBench)
 int main(int argc, char *argv[])
 {
+    if(argc > 1 && QString(argv[1]) == "--solver-worker")
+    {
+        QCoreApplication worker(argc, argv);
+        return solverPool::workerMain();
+    }
+    if(argc > 1 && QString(argv[1]) == "--solver-server")
+        return solverServer::serverMain(argc, argv);
+    if(argc > 1 && QString(argv[1]) == "--bench-properties")
+        return propBench::benchMain(argc, argv);
+    if(argc > 1 && QString(argv[1]) == "--bench-correlations")
+        return correlationBench::benchMain(argc, argv);
+
     QApplication a(argc, argv);
     QDomImplementation::setInvalidDataPolicy(QDomImplementation::ReturnNullNode);
 
@@ -84,6 +84,9 @@
 #include "syssettingdialog.h"
 #include "dataComm.h"
 #include "resultdialog.h"
+#include "optimizedialog.h"
+#include "uncertaintydialog.h"
+#include "annualdialog.h"
 #include "startdialog.h"
 #include "texteditdialog.h"
 #include "vicheckdialog.h"
@@ -841,6 +844,12 @@ void MainWindow::newCase()
                 globalData.setAttribute("maxfev",QString::number(globalpara.maxfev));
                 globalData.setAttribute("ftol",QString::number(globalpara.ftol));
                 globalData.setAttribute("xtol",QString::number(globalpara.xtol));
+                globalData.setAttribute("fastProperties",globalpara.fastProperties?"1":"0");
+                globalData.setAttribute("if97Water",globalpara.if97Water?"1":"0");
+                globalData.setAttribute("sensitivity",globalpara.sensitivity?"1":"0");
+                globalData.setAttribute("multiStart",globalpara.multiStart?"1":"0");
+                globalData.setAttribute("solverMethod",QString::number(globalpara.solverMethod));
+                globalData.setAttribute("autoScaling",globalpara.autoScaling?"1":"0");
                 caseData.appendChild(globalData);
                 file.resize(0);
                 doc.save(stream,4);
@@ -946,10 +955,18 @@ bool MainWindow::loadCase(QString name)
         globalpara.ftol = globalData.attribute("ftol").toFloat();
         globalpara.xtol = globalData.attribute("xtol").toFloat();
         globalpara.maxfev = globalData.attribute("maxfev").toInt();
+        globalpara.fastProperties = globalData.attribute("fastProperties") == "1";
+        globalpara.if97Water = globalData.attribute("if97Water") == "1";
+        globalpara.sensitivity = globalData.attribute("sensitivity") == "1";
+        globalpara.multiStart = globalData.attribute("multiStart","1") == "1";
+        globalpara.solverMethod = qBound(int(calInputs::Hybrid), globalData.attribute("solverMethod").toInt(), int(calInputs::BoundedTrustRegion));
+        globalpara.autoScaling = globalData.attribute("autoScaling","0") == "1"
+                && globalpara.solverMethod == calInputs::Hybrid;
         globalpara.cop = globalData.attribute("COP").toFloat();
         globalpara.capacity = convert(globalData.attribute("capacity").toFloat(),heat_trans_rate[7],heat_trans_rate[globalpara.unitindex_heat_trans_rate]);
 
         globalpara.msglvl = globalpara.maxfev;
+        globalpara.lastSolution = solverStateFromXml(caseData.elementsByTagName("SolverState").at(0).toElement());
 
         copX = globalData.attribute("COPX").toInt();
         copY = globalData.attribute("COPY").toInt();
@@ -3006,6 +3023,12 @@ void MainWindow::saveFile(QString fileName, bool overwrite)
         globalData.setAttribute("maxfev",QString::number(globalpara.maxfev));
         globalData.setAttribute("ftol",QString::number(globalpara.ftol));
         globalData.setAttribute("xtol",QString::number(globalpara.xtol));
+        globalData.setAttribute("fastProperties",globalpara.fastProperties?"1":"0");
+        globalData.setAttribute("if97Water",globalpara.if97Water?"1":"0");
+        globalData.setAttribute("sensitivity",globalpara.sensitivity?"1":"0");
+        globalData.setAttribute("multiStart",globalpara.multiStart?"1":"0");
+        globalData.setAttribute("solverMethod",QString::number(globalpara.solverMethod));
+        globalData.setAttribute("autoScaling",globalpara.autoScaling?"1":"0");
         globalData.setAttribute("COP",QString::number(globalpara.cop));
         globalData.setAttribute("capacity",QString::number(convert(globalpara.capacity,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[7])));
 
@@ -3202,6 +3225,11 @@ void MainWindow::saveFile(QString fileName, bool overwrite)
                 caseData.appendChild(unitData);
             }
         }
+
+        // converged solver state, so that the next run can start from it
+        caseData.removeChild(caseData.elementsByTagName("SolverState").at(0));
+        if(globalpara.lastSolution.isValid())
+            caseData.appendChild(solverStateToXml(doc,globalpara.lastSolution));
     }
        //end of CaseData
     file.resize(0);
@@ -4263,3 +4291,39 @@ void MainWindow::on_actionGuess_Value_triggered()
     guessDialog gDialog(false,this);
     gDialog.exec();
 }
+
+void MainWindow::on_actionOptimize_Design_triggered()
+{
+    scene->resetPointedComp();
+    globalpara.resetIfixes('t');
+    globalpara.resetIfixes('f');
+    globalpara.resetIfixes('c');
+    globalpara.resetIfixes('p');
+    globalpara.resetIfixes('w');
+    optimizeDialog oDialog(this);
+    oDialog.exec();
+}
+
+void MainWindow::on_actionUncertainty_Analysis_triggered()
+{
+    scene->resetPointedComp();
+    globalpara.resetIfixes('t');
+    globalpara.resetIfixes('f');
+    globalpara.resetIfixes('c');
+    globalpara.resetIfixes('p');
+    globalpara.resetIfixes('w');
+    uncertaintyDialog uDialog(this);
+    uDialog.exec();
+}
+
+void MainWindow::on_actionAnnual_Simulation_triggered()
+{
+    scene->resetPointedComp();
+    globalpara.resetIfixes('t');
+    globalpara.resetIfixes('f');
+    globalpara.resetIfixes('c');
+    globalpara.resetIfixes('p');
+    globalpara.resetIfixes('w');
+    annualDialog aDialog(this);
+    aDialog.exec();
+}
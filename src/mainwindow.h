@@ -230,6 +230,12 @@ private slots:
 
     void on_actionGuess_Value_triggered();
 
+    void on_actionOptimize_Design_triggered();
+
+    void on_actionUncertainty_Analysis_triggered();
+
+    void on_actionAnnual_Simulation_triggered();
+
 private:
     Ui::MainWindow *ui;
 
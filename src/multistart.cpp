@@ -0,0 +1,254 @@
+/*! \file multistart.cpp
+    \brief Parallel multi-start recovery of a case that didn't converge
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <random>
+
+#include <QtGlobal>
+
+#include "multistart.h"
+#include "solvercache.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+bool converged(const calOutputs &result)
+{
+    return !result.stopped && result.IER >= 1 && result.IER <= 3;
+}
+
+/// uniform on (-1,1) from 32 random bits, the same on every platform
+double symmetric(std::mt19937 &random)
+{
+    return 2*(random()+0.5)/4294967296.0-1;
+}
+
+/// The state of the warm start without its Jacobian factors, so hybrd1 starts with a new one.
+solverState withoutJacobian(const solverState &state)
+{
+    solverState fresh = state;
+    fresh.q.clear();
+    fresh.r.clear();
+    return fresh;
+}
+
+/// Moves the guess values and the solver state at random by up to the fraction of their size;
+/// temperatures by the fraction of the normalization range.
+void perturb(calInputs &in, double fraction, quint32 seed)
+{
+    std::mt19937 random(seed);
+    double range = qMax(double(in.tmax-in.tmin), 1.);
+    for(int i = 1; i <= in.nsp; i++)
+    {
+        if(in.itfix[i] > 0)
+            in.t[i] += fraction*range*symmetric(random);
+        if(in.iffix[i] > 0)
+            in.f[i] *= 1+fraction*symmetric(random);
+        if(in.icfix[i] > 0)
+            in.c[i] = qBound(0., in.c[i]*(1+fraction*symmetric(random)), 100.);
+        if(in.ipfix[i] > 0)
+            in.p[i] *= 1+fraction*symmetric(random);
+        if(in.iwfix[i] > 0)
+            in.w[i] = qBound(0., in.w[i]*(1+fraction*symmetric(random)), 1.);
+    }
+    solverState &state = in.warmStart;
+    for(int i = 0; i < state.n(); i++)
+    {
+        if(i < state.ivt.count() && state.ivt.at(i) != 0)
+            state.x[i] += fraction*symmetric(random);
+        else
+            state.x[i] *= 1+fraction*symmetric(random);
+    }
+}
+
+}
+
+multiStart::multiStart() :
+    found(new calOutputs),
+    winner(-1)
+{
+}
+
+multiStart::~multiStart()
+{
+}
+
+void multiStart::setInputs(const calInputs &failed)
+{
+    base = failed;
+}
+
+const calOutputs &multiStart::result() const
+{
+    return *found;
+}
+
+QString multiStart::strategy() const
+{
+    return winner >= 0 ? starts.at(winner).name : QString();
+}
+
+QString multiStart::message() const
+{
+    return endMessage;
+}
+
+void multiStart::addStart(const QString &name, const calInputs &in, bool needsRefining)
+{
+    start s;
+    s.name = name;
+    s.needsRefining = needsRefining;
+    starts<<s;
+    startInputs<<in;
+}
+
+void multiStart::setupStarts()
+{
+    starts.clear();
+    startInputs.clear();
+    // the runs that failed started from this state (see absdCal())
+    solverState state = base.warmStart.isValid() ? base.warmStart : solverCache::shared()->nearest(base);
+    calInputs in;
+
+    in = base;
+    in.warmStart = withoutJacobian(state);
+    in.maxfev = 4*base.maxfev;
+    in.msglvl = 4*base.msglvl;
+    addStart("a fresh Jacobian and four times the iteration limit", in, false);
+
+    in = base;
+    in.warmStart = state;
+    in.tmax = base.tmin+0.5*(base.tmax-base.tmin);
+    in.fmax = 0.5*base.fmax;
+    in.pmax = 0.5*base.pmax;
+    addStart("the normalization of the variables halved", in, true);
+
+    in.tmax = base.tmin+2*(base.tmax-base.tmin);
+    in.fmax = 2*base.fmax;
+    in.pmax = 2*base.pmax;
+    addStart("the normalization of the variables doubled", in, true);
+
+    if(!base.autoScaling)
+    {
+        in = base;
+        in.warmStart = state;
+        in.solverMethod = calInputs::Hybrid;
+        in.autoScaling = true;
+        addStart("automatic scaling of the variables and residuals", in, false);
+    }
+
+    const int percents[] = {5, 15, 30};
+    for(int k = 0; k < 3; k++)
+    {
+        in = base;
+        in.warmStart = withoutJacobian(state);
+        perturb(in, percents[k]/100., quint32(k+1));
+        addStart("guess values perturbed by up to "+QString::number(percents[k])+" %", in, false);
+    }
+
+    // unknown temperatures in the middle of the range, unknown flows at the mean of the known ones
+    in = base;
+    in.warmStart = withoutJacobian(state);
+    double flows = 0;
+    int nFlows = 0;
+    for(int i = 1; i <= base.nsp; i++)
+        if(base.iffix[i] == 0 && base.f[i] > 0)
+        {
+            flows += base.f[i];
+            nFlows++;
+        }
+    for(int i = 1; i <= base.nsp; i++)
+    {
+        if(base.itfix[i] > 0)
+            in.t[i] = 0.5*(base.tmin+base.tmax);
+        if(base.iffix[i] > 0 && nFlows > 0)
+            in.f[i] = flows/nFlows;
+    }
+    addStart("heuristic guess values", in, false);
+
+    if(base.solverMethod != calInputs::Homotopy)
+    {
+        in = base;
+        in.warmStart = withoutJacobian(state);
+        in.solverMethod = calInputs::Homotopy;
+        addStart("homotopy continuation", in, false);
+    }
+
+    if(base.solverMethod != calInputs::BoundedTrustRegion)
+    {
+        in = base;
+        in.warmStart = withoutJacobian(state);
+        in.solverMethod = calInputs::BoundedTrustRegion;
+        addStart("the bounded trust region", in, false);
+    }
+
+    in = base;
+    in.warmStart = withoutJacobian(state);
+    in.ftol = 100*base.ftol;
+    in.xtol = 100*base.xtol;
+    addStart("tolerances a hundred times looser", in, true);
+}
+
+bool multiStart::run()
+{
+    winner = -1;
+    endMessage.clear();
+    setupStarts();
+    // the engine outputs of the failed run are given back as they were
+    QScopedPointer<calOutputs> kept(new calOutputs(outputs));
+
+    solverPool *pool = solverPool::shared();
+    bool started = pool->solve(startInputs, startTimeout,
+        [&](int index, solverPool::Status status, const calOutputs &result)
+    {
+        if(winner >= 0 || status != solverPool::Finished || !converged(result))
+            return;
+        winner = index;
+        *found = result;
+        // the other starts are of no use anymore
+        pool->abort();
+    });
+    if(!started)
+    {
+        // no worker processes, one start after the other in this process
+        for(int s = 0; s < startInputs.count() && winner < 0; s++)
+        {
+            absdCal(0,0,startInputs.at(s),false);
+            if(converged(outputs))
+            {
+                winner = s;
+                *found = outputs;
+            }
+        }
+    }
+
+    if(winner < 0)
+        endMessage = "None of "+QString::number(starts.count())+" other starts converged either.";
+    else
+    {
+        endMessage = "Converged from a new start with "+starts.at(winner).name+".";
+        if(starts.at(winner).needsRefining)
+            refine();
+        else
+            solverCache::shared()->store(base, *found);
+    }
+    outputs = *kept;
+    return winner >= 0;
+}
+
+void multiStart::refine()
+{
+    QScopedPointer<calInputs> in(new calInputs(base));
+    in->warmStart = found->state;
+    absdCal(0,0,*in,false);
+    if(converged(outputs))
+        *found = outputs;
+    else
+        endMessage.append(" Solving it again with the settings of the case didn't converge,"
+                          " the results are those of the start.");
+}
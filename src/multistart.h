@@ -0,0 +1,90 @@
+/*! \file multistart.h
+    \brief Parallel multi-start recovery of a case that didn't converge
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef MULTISTART_H
+#define MULTISTART_H
+
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "dataComm.h"
+
+/*!
+Solves a case again, from several starting points and solver settings at
+once, after hybrd1 gave up on it (IER 4 to 7): the starts are solved side by
+side by the solver workers (solverPool), the first one that converges is taken
+and the workers still solving the others are killed (solverPool::abort()).
+
+The starts, in order of preference (the workers take them in this order):
+- a fresh finite-difference Jacobian and four times the iteration limit
+- the normalization of temperatures, flows and pressures halved, and doubled,
+  which changes the scaling of the variables and of the residuals
+- hybrd1 with automatic scaling by the Jacobian (calInputs::autoScaling),
+  unless the case uses it already
+- the guess values (and the solver state of the warm start) perturbed at
+  random by up to 5 %, 15 % and 30 %
+- heuristic guess values: unknown temperatures in the middle of the
+  normalization range, unknown flows at the mean of the fixed flows
+- homotopy continuation (calInputs::Homotopy) and the bounded trust region
+  (calInputs::BoundedTrustRegion), unless the case uses them already
+- tolerances a hundred times looser
+
+A start that changes the normalization or the tolerances converges to a
+solution of slightly different accuracy; it is solved once more with the
+settings of the case, starting from that solution. The random perturbations
+use a fixed seed, so the same case gives the same starts.
+
+Without workers the starts are solved one after the other in this process,
+until one converges. The engine outputs (the global calOutputs) are left as
+they were; the converged run is in result(). Used by calculate::calc().
+*/
+class multiStart
+{
+public:
+    multiStart();
+    ~multiStart();
+
+    /// The inputs of the run that didn't converge.
+    void setInputs(const calInputs &failed);
+
+    /// \return true if one of the starts converged
+    bool run();
+
+    /// Outputs of the converged start.
+    const calOutputs &result() const;
+    /// Which start converged, e.g. "guess values perturbed by up to 15 %".
+    QString strategy() const;
+    /// How the starts went, for the message of the run.
+    QString message() const;
+
+    /// time limit for each start solved by the worker pool [ms]
+    static const int startTimeout = 120000;
+
+private:
+    struct start
+    {
+        QString name;
+        /// the tolerances or the normalization differ from the case
+        bool needsRefining;
+    };
+
+    void addStart(const QString &name, const calInputs &in, bool needsRefining);
+    void setupStarts();
+    /// solves the case with its own settings from the state of the converged start
+    void refine();
+
+    calInputs base;
+    QVector<start> starts;
+    QVector<calInputs> startInputs;
+    /// calOutputs is too large for the stack
+    QScopedPointer<calOutputs> found;
+    int winner;
+    QString endMessage;
+};
+
+#endif // MULTISTART_H
@@ -32,6 +32,9 @@ extern globalparameter globalpara;
 extern myScene * theScene;
 extern MainWindow* theMainwindow;
 
+/// points of a curve drawn from the surrogate of a table
+static const int surrogatePlotPoints = 41;
+
 //mode = 0:new paraPlot; mode = 1:from table; mode = 2:re-select plot
 newParaPlotDialog::newParaPlotDialog(int theMode, QString tableName, QString plotName, QWidget *parent):
 QDialog(parent),
@@ -73,6 +76,8 @@ void newParaPlotDialog::on_okButton_clicked()
 {
     if(ui->xList->selectedItems().count()==0 || ui->yList->selectedItems().count()==0)
         globalpara.reportError("Please select variables for both axises.",this);
+    else if(ui->surrogateCB->isChecked() && !surrogateSelectionValid())
+        return;
     else
     {
         if(mode<2)
@@ -171,6 +176,13 @@ bool newParaPlotDialog::setupXml()
         return false;
     }
 
+    // curves from the surrogate of the table take the place of its runs
+    QStringList xValues;
+    QVector<QStringList> yValueRows;
+    int outside = 0;
+    if(ui->surrogateCB->isChecked() && surface.isValid())
+        outside = surrogateCurve(inputIndex, outputIndexes, outputCount, xValues, yValueRows);
+
     // TODO: the only usage of setupXml(), newPropPlotDialog::on_okButton_clicked(), already closed the window.
     // So get rid of this code?
     // Also, if this is meant to lock the XML, that's a bad implementation of a mutex.
@@ -252,8 +264,10 @@ bool newParaPlotDialog::setupXml()
         newPlot.setAttribute("tableName",ui->tableCB->currentText());
     else if(mode>0)
         newPlot.setAttribute("tableName",tName);
-    int nRuns = currentTable.attribute("runs").toInt();
+    int nRuns = xValues.isEmpty() ? currentTable.attribute("runs").toInt() : xValues.count();
     newPlot.setAttribute("runs",QString::number(nRuns));
+    if(!xValues.isEmpty())
+        newPlot.setAttribute("surrogate","1");
 
     //plotName: tableName, # of runs, axisNames, # of outputs, scaleInfo
     newPlot.setAttribute("xAxisName",ui->xList->currentItem()->text());
@@ -272,33 +286,41 @@ bool newParaPlotDialog::setupXml()
     for(int i = 0; i < nRuns;i++)
     {
         //prepare values for input/outputs
-        QDomElement currentTableRun = tableRuns.at(i).toElement();
-        int nTableInputs = currentTableRun.elementsByTagName("Input").count();
         QString xValue;
-        if(inputIndex<=nTableInputs-1)
+        QStringList yValues;
+        if(!xValues.isEmpty())
         {
-            QDomElement tableInput = currentTableRun.elementsByTagName("Input").at(inputIndex).toElement();
-            xValue = tableInput.elementsByTagName("value").at(0).toElement().text();
+            xValue = xValues.at(i);
+            yValues = yValueRows.at(i);
         }
         else
         {
-            QDomElement tableInput =
-                    currentTableRun.elementsByTagName("Output").at(inputIndex-nTableInputs).toElement();
-            xValue= tableInput.elementsByTagName("value").at(0).toElement().text();
-        }
-        QStringList yValues;
-        for(int p = 0; p < outputCount;p++)
-        {
-            if(outputIndexes[p]<=nTableInputs-1)
+            QDomElement currentTableRun = tableRuns.at(i).toElement();
+            int nTableInputs = currentTableRun.elementsByTagName("Input").count();
+            if(inputIndex<=nTableInputs-1)
             {
-                QDomElement tableInput = currentTableRun.elementsByTagName("Input").at(outputIndexes[p]).toElement();
-                yValues.append(tableInput.elementsByTagName("value").at(0).toElement().text());
+                QDomElement tableInput = currentTableRun.elementsByTagName("Input").at(inputIndex).toElement();
+                xValue = tableInput.elementsByTagName("value").at(0).toElement().text();
             }
             else
             {
-                QDomElement tableOutput =
-                        currentTableRun.elementsByTagName("Output").at(outputIndexes[p]-nTableInputs).toElement();
-                yValues.append(tableOutput.elementsByTagName("value").at(0).toElement().text());
+                QDomElement tableInput =
+                        currentTableRun.elementsByTagName("Output").at(inputIndex-nTableInputs).toElement();
+                xValue= tableInput.elementsByTagName("value").at(0).toElement().text();
+            }
+            for(int p = 0; p < outputCount;p++)
+            {
+                if(outputIndexes[p]<=nTableInputs-1)
+                {
+                    QDomElement tableInput = currentTableRun.elementsByTagName("Input").at(outputIndexes[p]).toElement();
+                    yValues.append(tableInput.elementsByTagName("value").at(0).toElement().text());
+                }
+                else
+                {
+                    QDomElement tableOutput =
+                            currentTableRun.elementsByTagName("Output").at(outputIndexes[p]-nTableInputs).toElement();
+                    yValues.append(tableOutput.elementsByTagName("value").at(0).toElement().text());
+                }
             }
         }
         //prepare values for input/outputs
@@ -332,9 +354,75 @@ bool newParaPlotDialog::setupXml()
     doc.save(stream,4);
     file.close();
     delete[] outputIndexes;
+    if(outside > 0)
+    {
+        QMessageBox infoBox(this);
+        infoBox.setWindowTitle("Parametric Plot");
+        infoBox.setText(QString::number(outside)+" points of the curves are outside the range of the runs the "
+                        "surrogate was fitted to, they are extrapolated.");
+        infoBox.exec();
+    }
     return true;
 }
 
+/// The x variable is an input of the table, and the y variables are outputs that its surrogate fits.
+bool newParaPlotDialog::surrogateSelectionValid()
+{
+    int nInputs = surface.inputEntries().count();
+    int inputIndex = -1;
+    for(int i = 0; i < ui->xList->count(); i++)
+        if(ui->xList->item(i)->isSelected())
+            inputIndex = i;
+    if(inputIndex < 0 || inputIndex >= nInputs)
+    {
+        globalpara.reportError("Curves from the surrogate need an input of the table on the x axis.",this);
+        return false;
+    }
+    if(!(surface.upper(inputIndex) > surface.lower(inputIndex)))
+    {
+        globalpara.reportError(ui->xList->item(inputIndex)->text()
+                               +" is the same in every run the surrogate was fitted to.",this);
+        return false;
+    }
+    for(int i = 0; i < ui->yList->count(); i++)
+        if(ui->yList->item(i)->isSelected()
+                && (i < nInputs || !surface.outputEntries().contains(tableOutputEntries.value(i-nInputs))))
+        {
+            globalpara.reportError("The surrogate of the table has no surface for "+ui->yList->item(i)->text()+".",this);
+            return false;
+        }
+    return true;
+}
+
+/// The selected outputs over the range of the x input from the surrogate of the table,
+/// the other inputs at their mean over the runs.
+/// \return the number of points outside the range of the runs the surrogate was fitted to
+int newParaPlotDialog::surrogateCurve(int inputIndex, const int *outputIndexes, int outputCount,
+                                      QStringList &xValues, QVector<QStringList> &yValues)
+{
+    int nInputs = surface.inputEntries().count();
+    QVector<double> x = inputMeans;
+    double lower = surface.lower(inputIndex), upper = surface.upper(inputIndex);
+    int outside = 0;
+    for(int i = 0; i < surrogatePlotPoints; i++)
+    {
+        x[inputIndex] = lower+(upper-lower)*i/(surrogatePlotPoints-1);
+        bool inRange = true;
+        QVector<double> y = surface.predict(x,&inRange);
+        if(!inRange)
+            outside++;
+        xValues<<QString::number(x.at(inputIndex));
+        QStringList row;
+        for(int p = 0; p < outputCount; p++)
+        {
+            int o = surface.outputEntries().indexOf(tableOutputEntries.at(outputIndexes[p]-nInputs));
+            row<<QString::number(y.at(o));
+        }
+        yValues<<row;
+    }
+    return outside;
+}
+
 bool newParaPlotDialog::plotNameUsed(QString name)
 {
     if(name.isEmpty())
@@ -550,6 +638,19 @@ bool newParaPlotDialog::readTheFile(QString tableName)
         }
 
     }
+
+    // a surrogate fitted to the current inputs of the table can draw its curves
+    tableOutputEntries = outputs.text().split(";");
+    surface = responseSurface::fromXml(currentTable.firstChildElement("surrogate"));
+    if(surface.isValid() && surface.inputEntries() != inputs.text().split(";"))
+        surface = responseSurface();
+    inputMeans = QVector<double>(inputD.count(), 0);
+    for(int i = 0; i < rownum; i++)
+        for(int j = 0; j < inputD.count(); j++)
+            inputMeans[j] += tablevalue[i][j]/rownum;
+    ui->surrogateCB->setEnabled(surface.isValid());
+    if(!surface.isValid())
+        ui->surrogateCB->setChecked(false);
     // TODO: member tablevalue is never referenced after being set in this function. What is intent of the array?
     // TODO: dynamically allocated arrays are created with new, stored in tablevalue, but never delete[]'d!
     return true;
@@ -20,12 +20,15 @@
 #include <QtXml/QDomDocument>
 #include <QtXml/QDomElement>
 
+#include "surrogate.h"
+
 namespace Ui {
 class newParaPlotDialog;
 }
 
 /// Dialog to define the x and y axis variables for a new parametric plot
 /// - can be called directly from mainwindow or from tabledialog (different in mode, which determines the source table)
+/// - if the table has a surrogate, the curves can be drawn from it instead of the runs
 class newParaPlotDialog : public QDialog
 {
     Q_OBJECT
@@ -56,9 +59,15 @@ private:
     QString plotName;
     bool plotNameUsed(QString name);
     bool setupXml();
+    bool surrogateSelectionValid();
+    int surrogateCurve(int inputIndex, const int *outputIndexes, int outputCount,
+                       QStringList &xValues, QVector<QStringList> &yValues);
 
     QString tName,pName;
     int mode;
+    responseSurface surface;
+    QStringList tableOutputEntries;
+    QVector<double> inputMeans;
 };
 
 #endif // NEWPARAPLOTDIALOG_H
@@ -0,0 +1,401 @@
+/*! \file optimizedialog.cpp
+    \brief Dialog to optimize the fixed inputs of the current case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QApplication>
+#include <QComboBox>
+#include <QHeaderView>
+#include <QTableWidget>
+#include <QtNumeric>
+
+#include "optimizedialog.h"
+#include "ui_optimizedialog.h"
+#include "mainwindow.h"
+#include "calculate.h"
+#include "resultdialog.h"
+#include "unit.h"
+
+extern globalparameter globalpara;
+extern calOutputs outputs;
+extern unit *dummy;
+extern int globalcount;
+extern MainWindow *theMainwindow;
+
+namespace {
+
+enum Columns { UseColumn, NameColumn, StartColumn, TypeColumn, BoundColumn, OptimumColumn, UnitColumn };
+// the variable table has the lower bound in TypeColumn and the upper bound in BoundColumn
+
+/// the results of a report summed over terms, NaN if one is missing
+double sumResults(const sensitivityReport &report, const QVector<sensitivityReport::item> &terms)
+{
+    double sum = 0;
+    for(int t = 0; t < terms.count(); t++)
+    {
+        int row = -1;
+        for(int o = 0; o < report.outputs.count() && row < 0; o++)
+            if(report.outputs.at(o).quantity == terms.at(t).quantity && report.outputs.at(o).index == terms.at(t).index)
+                row = o;
+        if(row < 0)
+            return qQNaN();
+        sum += report.results.at(row);
+    }
+    return sum;
+}
+
+bool containsItem(const QVector<sensitivityReport::item> &list, const sensitivityReport::item &item)
+{
+    for(int i = 0; i < list.count(); i++)
+        if(list.at(i).quantity == item.quantity && list.at(i).index == item.index)
+            return true;
+    return false;
+}
+
+QTableWidgetItem *fixedItem(const QString &text)
+{
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+
+QTableWidgetItem *useItem()
+{
+    QTableWidgetItem *item = new QTableWidgetItem;
+    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+    item->setCheckState(Qt::Unchecked);
+    return item;
+}
+
+bool readNumber(QTableWidget *table, int row, int column, double &value)
+{
+    bool ok = false;
+    if(table->item(row,column) != NULL)
+        value = table->item(row,column)->text().toDouble(&ok);
+    if(!ok)
+        globalpara.reportError("Please enter a number for \""+table->item(row,NameColumn)->text()
+                               +"\" ("+table->horizontalHeaderItem(column)->text()+").");
+    return ok;
+}
+
+}
+
+optimizeDialog::optimizeDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::optimizeDialog),
+    ready(false),
+    running(false),
+    stopRequested(false)
+{
+    ui->setupUi(this);
+    setWindowTitle("Optimize Design");
+    setWindowModality(Qt::ApplicationModal);
+
+    calculate mycal(dummy);
+    if(mycal.buildInputs(globalpara,baseInputs))
+    {
+        baseInputs.sensitivity = true;
+        if(globalpara.lastSolution.isValid())
+            baseInputs.warmStart = globalpara.lastSolution;
+        calOutputs result;
+        QString error;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        bool solved = designOptimizer::solveCase(baseInputs,result,&error);
+        QApplication::restoreOverrideCursor();
+        if(!solved)
+            log("The case as it is can't be solved ("+error+"), the optimization needs a converged start.");
+        else if(!result.sensitivity.isValid())
+            log("No sensitivities of the case: "+result.sensitivity.message);
+        else
+        {
+            baseReport = result.sensitivity;
+            baseInputs.warmStart = result.state;
+            ready = true;
+            log("Check the decision variables and constraints to use, and set their bounds.");
+        }
+    }
+    setupTables();
+    ui->optimizeButton->setEnabled(ready);
+}
+
+optimizeDialog::~optimizeDialog()
+{
+    delete ui;
+}
+
+void optimizeDialog::setupTables()
+{
+    QStringList headers;
+    headers<<"Use"<<"Variable"<<"Start"<<"Lower"<<"Upper"<<"Optimum"<<"Unit";
+    QTableWidget *table = ui->variableTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(baseReport.inputs.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    for(int i = 0; i < baseReport.inputs.count(); i++)
+    {
+        const sensitivityReport::item &item = baseReport.inputs.at(i);
+        double value = resultDialog::inputToCase(item,designOptimizer::inputValue(baseInputs,item));
+        double lower, upper;
+        if(item.quantity == sensitivityReport::Temperature)
+        {
+            lower = value - qMax(0.2*qAbs(value),5.0);
+            upper = value + qMax(0.2*qAbs(value),5.0);
+        }
+        else if(item.quantity == sensitivityReport::Concentration)
+        {
+            lower = qMax(value-5,0.0);
+            upper = qMin(value+5,100.0);
+        }
+        else if(value != 0)
+        {
+            lower = qMin(0.5*value,1.5*value);
+            upper = qMax(0.5*value,1.5*value);
+        }
+        else
+        {
+            lower = 0;
+            upper = 1;
+        }
+        table->setItem(i,UseColumn,useItem());
+        table->setItem(i,NameColumn,fixedItem(resultDialog::sensitivityName(item)));
+        table->setItem(i,StartColumn,fixedItem(QString::number(value)));
+        table->setItem(i,TypeColumn,new QTableWidgetItem(QString::number(lower)));
+        table->setItem(i,BoundColumn,new QTableWidgetItem(QString::number(upper)));
+        table->setItem(i,OptimumColumn,fixedItem(""));
+        table->setItem(i,UnitColumn,fixedItem(resultDialog::sensitivityUnit(item)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    // every result can be a constraint, and the total UA for a UA budget
+    QVector<sensitivityReport::item> uaTerms;
+    for(int o = 0; o < baseReport.outputs.count(); o++)
+        if(baseReport.outputs.at(o).quantity == sensitivityReport::UAValue)
+            uaTerms<<baseReport.outputs.at(o);
+    headers.clear();
+    headers<<"Use"<<"Result"<<"Start"<<"Type"<<"Bound"<<"Optimum"<<"Unit";
+    table = ui->constraintTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(baseReport.outputs.count()+(uaTerms.isEmpty() ? 0 : 1));
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    for(int row = 0; row < table->rowCount(); row++)
+    {
+        QVector<sensitivityReport::item> terms;
+        QString name;
+        if(row < baseReport.outputs.count())
+        {
+            terms<<baseReport.outputs.at(row);
+            name = resultDialog::sensitivityName(terms.first());
+        }
+        else
+        {
+            terms = uaTerms;
+            name = "Total UA";
+        }
+        double value = resultDialog::resultToCase(terms.first(),sumResults(baseReport,terms));
+        QComboBox *type = new QComboBox;
+        type->addItem("<=");
+        type->addItem(">=");
+        table->setItem(row,UseColumn,useItem());
+        table->setItem(row,NameColumn,fixedItem(name));
+        table->setItem(row,StartColumn,fixedItem(QString::number(value)));
+        table->setCellWidget(row,TypeColumn,type);
+        table->setItem(row,BoundColumn,new QTableWidgetItem(QString::number(value)));
+        table->setItem(row,OptimumColumn,fixedItem(""));
+        table->setItem(row,UnitColumn,fixedItem(resultDialog::sensitivityUnit(terms.first())));
+        constraintTerms<<terms;
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    int objective = 0;
+    for(int o = 0; o < baseReport.outputs.count(); o++)
+    {
+        ui->objectiveBox->addItem(resultDialog::sensitivityName(baseReport.outputs.at(o)));
+        if(baseReport.outputs.at(o).quantity == sensitivityReport::COP)
+            objective = o;
+    }
+    ui->objectiveBox->setCurrentIndex(objective);
+}
+
+void optimizeDialog::on_optimizeButton_clicked()
+{
+    optimizer = designOptimizer();
+    optimizer.setInputs(baseInputs);
+    chosen.clear();
+
+    QTableWidget *table = ui->variableTable;
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        if(table->item(i,UseColumn)->checkState() != Qt::Checked)
+            continue;
+        optimizerVariable variable;
+        variable.item = baseReport.inputs.at(i);
+        double lower, upper;
+        if(!readNumber(table,i,TypeColumn,lower) || !readNumber(table,i,BoundColumn,upper))
+            return;
+        if(!(upper > lower))
+        {
+            globalpara.reportError("The lower bound of \""+table->item(i,NameColumn)->text()
+                                   +"\" should be below its upper bound.",this);
+            return;
+        }
+        variable.lower = resultDialog::inputToEngine(variable.item,lower);
+        variable.upper = resultDialog::inputToEngine(variable.item,upper);
+        optimizer.addVariable(variable);
+        chosen<<variable.item;
+    }
+    if(chosen.isEmpty())
+    {
+        globalpara.reportError("Please check at least one decision variable.",this);
+        return;
+    }
+
+    table = ui->constraintTable;
+    for(int row = 0; row < table->rowCount(); row++)
+    {
+        if(table->item(row,UseColumn)->checkState() != Qt::Checked)
+            continue;
+        optimizerConstraint constraint;
+        constraint.terms = constraintTerms.at(row);
+        double bound;
+        if(!readNumber(table,row,BoundColumn,bound))
+            return;
+        constraint.bound = resultDialog::resultToEngine(constraint.terms.first(),bound);
+        constraint.atMost = qobject_cast<QComboBox*>(table->cellWidget(row,TypeColumn))->currentIndex() == 0;
+        optimizer.addConstraint(constraint);
+    }
+
+    sensitivityReport::item objective = baseReport.outputs.at(ui->objectiveBox->currentIndex());
+    optimizer.setObjective(objective,ui->senseBox->currentIndex() == 0);
+    optimizer.setMaxSolves(ui->solvesBox->value());
+
+    running = true;
+    stopRequested = false;
+    ui->optimizeButton->setEnabled(false);
+    ui->applyButton->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+    ui->stopButton->setEnabled(true);
+    ui->logText->clear();
+    log("Optimizing "+ui->objectiveBox->currentText()+" over "+QString::number(chosen.count())+" variable(s)...");
+
+    QString objectiveUnit = resultDialog::sensitivityUnit(objective);
+    bool done = optimizer.run([&](const optimizerPoint &point)
+    {
+        QString line = "solve "+QString::number(point.solves)+": best "+ui->objectiveBox->currentText()+" = "
+                +QString::number(resultDialog::resultToCase(objective,point.objective))+" "+objectiveUnit;
+        if(point.violation > 0)
+            line.append(", constraints violated by "+QString::number(100*point.violation,'g',3)+"%");
+        log(line);
+        QApplication::processEvents();
+        return !stopRequested;
+    });
+
+    running = false;
+    ui->optimizeButton->setEnabled(true);
+    ui->closeButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
+    log(optimizer.message());
+    if(done)
+    {
+        if(!optimizer.feasible())
+            log("No point met all the constraints, the one closest to meeting them is shown.");
+        showOptimum();
+        ui->applyButton->setEnabled(true);
+    }
+}
+
+void optimizeDialog::on_stopButton_clicked()
+{
+    stopRequested = true;
+}
+
+void optimizeDialog::on_applyButton_clicked()
+{
+    const calInputs &best = optimizer.bestInputs();
+    for(int i = 0; i < chosen.count(); i++)
+    {
+        const sensitivityReport::item &item = chosen.at(i);
+        double value = resultDialog::inputToCase(item,designOptimizer::inputValue(best,item));
+        unit *iterator = dummy;
+        if(item.quantity == sensitivityReport::HeatSpec)
+        {
+            for(int j = 0; j < item.index && iterator->next != NULL; j++)
+                iterator = iterator->next;
+            iterator->ht = value;
+            continue;
+        }
+        for(int j = 0; j < globalcount; j++)
+        {
+            iterator = iterator->next;
+            for(int k = 0; k < iterator->usp; k++)
+            {
+                Node *node = iterator->myNodes[k];
+                if(node->ndum != item.index)
+                    continue;
+                if(item.quantity == sensitivityReport::Temperature)
+                    node->t = value;
+                else if(item.quantity == sensitivityReport::MassFlow)
+                    node->f = value;
+                else if(item.quantity == sensitivityReport::Concentration)
+                    node->c = value;
+                else if(item.quantity == sensitivityReport::Pressure)
+                    node->p = value;
+            }
+        }
+    }
+
+    outputs = optimizer.bestOutputs();
+    calculate mycal(dummy);
+    mycal.updateSystem();
+    theMainwindow->resultShow();
+    log("The optimum was written into the case.");
+    ui->applyButton->setEnabled(false);
+}
+
+void optimizeDialog::on_closeButton_clicked()
+{
+    reject();
+}
+
+void optimizeDialog::showOptimum()
+{
+    const calInputs &best = optimizer.bestInputs();
+    QTableWidget *table = ui->variableTable;
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        const sensitivityReport::item &item = baseReport.inputs.at(i);
+        QString text;
+        if(containsItem(chosen,item))
+            text = QString::number(resultDialog::inputToCase(item,designOptimizer::inputValue(best,item)));
+        table->item(i,OptimumColumn)->setText(text);
+    }
+
+    const sensitivityReport &report = optimizer.bestOutputs().sensitivity;
+    table = ui->constraintTable;
+    for(int row = 0; row < table->rowCount(); row++)
+    {
+        double value = sumResults(report,constraintTerms.at(row));
+        table->item(row,OptimumColumn)->setText(qIsNaN(value) ? QString()
+                : QString::number(resultDialog::resultToCase(constraintTerms.at(row).first(),value)));
+    }
+}
+
+void optimizeDialog::log(const QString &line)
+{
+    ui->logText->appendPlainText(line);
+}
+
+void optimizeDialog::reject()
+{
+    // closing while the optimizer runs only stops it
+    if(running)
+    {
+        stopRequested = true;
+        return;
+    }
+    QDialog::reject();
+}
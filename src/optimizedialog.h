@@ -0,0 +1,65 @@
+/*! \file optimizedialog.h
+    \brief Dialog to optimize the fixed inputs of the current case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef OPTIMIZEDIALOG_H
+#define OPTIMIZEDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "dataComm.h"
+#include "optimizer.h"
+
+namespace Ui {
+class optimizeDialog;
+}
+
+/// Dialog to optimize the current case (see designOptimizer)
+/// - solves the case once with sensitivities to list its fixed inputs as candidate
+///   decision variables and its results as objective and constraints
+/// - bounds and constraints are entered in the unit system of the case
+/// - the optimum can be written back into the case, with its results
+/// - called by mainwindow.cpp
+class optimizeDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit optimizeDialog(QWidget *parent = 0);
+    ~optimizeDialog();
+
+public slots:
+    void reject();
+
+private slots:
+    void on_optimizeButton_clicked();
+
+    void on_stopButton_clicked();
+
+    void on_applyButton_clicked();
+
+    void on_closeButton_clicked();
+
+private:
+    Ui::optimizeDialog *ui;
+
+    void setupTables();
+    void showOptimum();
+    void log(const QString &line);
+
+    calInputs baseInputs;
+    sensitivityReport baseReport;
+    designOptimizer optimizer;
+    /// the decision variables of the last optimization
+    QVector<sensitivityReport::item> chosen;
+    /// results summed by each row of the constraint table
+    QVector<QVector<sensitivityReport::item> > constraintTerms;
+    bool ready;
+    bool running;
+    bool stopRequested;
+};
+
+#endif // OPTIMIZEDIALOG_H
@@ -0,0 +1,546 @@
+/*! \file optimizer.cpp
+    \brief Gradient based optimization of the fixed inputs of a case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QDebug>
+
+#include <math.h>
+
+#include "optimizer.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+/// pairs of steps and gradient changes kept by L-BFGS
+const int memorySize = 5;
+/// sufficient decrease of the Armijo condition
+const double armijo = 1.e-4;
+const int maxBacktracks = 10;
+/// longest first step of an inner loop, scaled variables
+const double firstStep = 0.2;
+/// the inner loop ends when the projected gradient or the step is below these
+const double gradientTolerance = 1.e-5;
+const double stepTolerance = 1.e-6;
+/// largest relative violation that counts as feasible
+const double feasibilityTolerance = 1.e-4;
+/// relative change of the multipliers at a Lagrange point
+const double multiplierTolerance = 1.e-3;
+const int maxOuter = 15;
+/// time limit of a solve by the workers [ms]
+const int solveTimeout = 120000;
+
+double dot(const QVector<double> &a, const QVector<double> &b)
+{
+    double sum = 0;
+    for(int i = 0; i < a.count(); i++)
+        sum += a.at(i)*b.at(i);
+    return sum;
+}
+
+/// gradient with the components that push against an active bound left out
+QVector<double> projectedGradient(const QVector<double> &u, const QVector<double> &g)
+{
+    QVector<double> result = g;
+    for(int i = 0; i < u.count(); i++)
+        if((u.at(i) <= 0 && g.at(i) > 0) || (u.at(i) >= 1 && g.at(i) < 0))
+            result[i] = 0;
+    return result;
+}
+
+double maxNorm(const QVector<double> &v)
+{
+    double norm = 0;
+    for(int i = 0; i < v.count(); i++)
+        norm = qMax(norm, qAbs(v.at(i)));
+    return norm;
+}
+
+int findItem(const QVector<sensitivityReport::item> &list, const sensitivityReport::item &item)
+{
+    for(int i = 0; i < list.count(); i++)
+        if(list.at(i).quantity == item.quantity && list.at(i).index == item.index)
+            return i;
+    return -1;
+}
+
+}
+
+designOptimizer::designOptimizer() :
+    maximize(true),
+    maxSolves(200),
+    solves(0),
+    objectiveScale(1),
+    penalty(10),
+    haveBest(false)
+{
+}
+
+void designOptimizer::setInputs(const calInputs &inputs)
+{
+    base = inputs;
+    base.sensitivity = true;
+}
+
+void designOptimizer::addVariable(const optimizerVariable &variable)
+{
+    variables.append(variable);
+}
+
+void designOptimizer::addConstraint(const optimizerConstraint &constraint)
+{
+    constraints.append(constraint);
+}
+
+void designOptimizer::setObjective(const sensitivityReport::item &item, bool maximizeIt)
+{
+    objective = item;
+    maximize = maximizeIt;
+}
+
+void designOptimizer::setMaxSolves(int count)
+{
+    maxSolves = qMax(count, 1);
+}
+
+QString designOptimizer::message() const
+{
+    return endMessage;
+}
+
+bool designOptimizer::feasible() const
+{
+    return haveBest && bestPoint.violation <= feasibilityTolerance;
+}
+
+const optimizerPoint &designOptimizer::best() const
+{
+    return bestPoint;
+}
+
+const calInputs &designOptimizer::bestInputs() const
+{
+    return bestIn;
+}
+
+const calOutputs &designOptimizer::bestOutputs() const
+{
+    return bestOut;
+}
+
+double designOptimizer::inputValue(const calInputs &in, const sensitivityReport::item &item)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::Temperature: return in.t[item.index];
+    case sensitivityReport::MassFlow: return in.f[item.index];
+    case sensitivityReport::Concentration: return in.c[item.index];
+    case sensitivityReport::Pressure: return in.p[item.index];
+    case sensitivityReport::HeatSpec: return in.ht[item.index];
+    default: return 0;
+    }
+}
+
+void designOptimizer::setInputValue(calInputs &in, const sensitivityReport::item &item, double value)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::Temperature: in.t[item.index] = value; break;
+    case sensitivityReport::MassFlow: in.f[item.index] = value; break;
+    case sensitivityReport::Concentration: in.c[item.index] = value; break;
+    case sensitivityReport::Pressure: in.p[item.index] = value; break;
+    case sensitivityReport::HeatSpec: in.ht[item.index] = value; break;
+    default: break;
+    }
+}
+
+bool designOptimizer::run(const progressHandler &progress)
+{
+    solves = 0;
+    haveBest = false;
+    bestPoint = optimizerPoint();
+    endMessage.clear();
+    lastState = base.warmStart;
+    objectiveScale = 1;
+    constraintScales = QVector<double>(constraints.count(), 1);
+    multipliers = QVector<double>(constraints.count(), 0);
+    penalty = 10;
+
+    if(variables.isEmpty())
+    {
+        endMessage = "No decision variables.";
+        return false;
+    }
+    QVector<double> u(variables.count());
+    for(int i = 0; i < variables.count(); i++)
+    {
+        const optimizerVariable &variable = variables.at(i);
+        if(!(variable.upper > variable.lower))
+        {
+            endMessage = "The upper bound of a decision variable is not above its lower bound.";
+            return false;
+        }
+        double value = inputValue(base, variable.item);
+        u[i] = qBound(0.0, (value-variable.lower)/(variable.upper-variable.lower), 1.0);
+    }
+
+    sample point;
+    QString error;
+    if(!evaluate(u, point, &error))
+    {
+        endMessage = "The case at the start: "+error;
+        return false;
+    }
+    objectiveScale = qMax(qAbs(point.objective), 1.e-12);
+    for(int j = 0; j < constraints.count(); j++)
+        constraintScales[j] = qMax(qMax(qAbs(constraints.at(j).bound), qAbs(point.sums.at(j))), 1.e-12);
+    accept(point);
+    if(progress && !progress(bestPoint))
+    {
+        endMessage = "Stopped.";
+        return true;
+    }
+
+    bool stopped = false;
+    double lastViolation = violation(point);
+    for(int outer = 0; outer < maxOuter; outer++)
+    {
+        bool converged = innerLoop(point, progress, stopped);
+        if(stopped)
+            break;
+
+        if(solves >= maxSolves)
+            break;
+        if(constraints.isEmpty())
+        {
+            if(converged)
+            {
+                endMessage = "Converged: no better point within the bounds.";
+                return true;
+            }
+            continue;
+        }
+
+        // a Lagrange point when feasible and the multipliers stay where they are
+        double v = violation(point);
+        double change = 0, largest = 0;
+        for(int j = 0; j < constraints.count(); j++)
+        {
+            double updated = qMax(0.0, multipliers.at(j) + penalty*constraintValue(point, j));
+            change = qMax(change, qAbs(updated - multipliers.at(j)));
+            largest = qMax(largest, updated);
+            multipliers[j] = updated;
+        }
+        if(converged && v <= feasibilityTolerance && change <= multiplierTolerance*(1+largest))
+        {
+            endMessage = "Converged: no better point within the bounds and constraints.";
+            return true;
+        }
+        if(v > 0.25*lastViolation)
+            penalty *= 10;
+        lastViolation = v;
+    }
+
+    if(stopped)
+        endMessage = "Stopped.";
+    else if(solves >= maxSolves)
+        endMessage = "The limit of "+QString::number(maxSolves)+" solves was reached.";
+    else
+        endMessage = "No convergence within "+QString::number(maxOuter)+" updates of the multipliers.";
+    return true;
+}
+
+bool designOptimizer::innerLoop(sample &point, const progressHandler &progress, bool &stopped)
+{
+    int n = variables.count();
+    QVector<QVector<double> > steps, changes;
+    QVector<double> gradient = lagrangianGradient(point);
+    double value = lagrangian(point);
+    QString error;
+
+    while(solves < maxSolves)
+    {
+        QVector<double> pg = projectedGradient(point.u, gradient);
+        if(maxNorm(pg) < gradientTolerance)
+            return true;
+
+        // L-BFGS two loop recursion on the free variables
+        QVector<double> d = pg;
+        QVector<double> alpha(steps.count());
+        for(int k = steps.count()-1; k >= 0; k--)
+        {
+            alpha[k] = dot(steps.at(k), d)/dot(steps.at(k), changes.at(k));
+            for(int i = 0; i < n; i++)
+                d[i] -= alpha.at(k)*changes.at(k).at(i);
+        }
+        if(!steps.isEmpty())
+        {
+            double gamma = dot(steps.last(), changes.last())/dot(changes.last(), changes.last());
+            for(int i = 0; i < n; i++)
+                d[i] *= gamma;
+        }
+        for(int k = 0; k < steps.count(); k++)
+        {
+            double beta = dot(changes.at(k), d)/dot(steps.at(k), changes.at(k));
+            for(int i = 0; i < n; i++)
+                d[i] += (alpha.at(k)-beta)*steps.at(k).at(i);
+        }
+        for(int i = 0; i < n; i++)
+        {
+            d[i] = -d.at(i);
+            if(pg.at(i) == 0)
+                d[i] = 0;
+        }
+        if(dot(d, pg) >= 0)
+        {
+            // not a descent direction: back to steepest descent
+            for(int i = 0; i < n; i++)
+                d[i] = -pg.at(i);
+            steps.clear();
+            changes.clear();
+        }
+        double t = 1;
+        if(steps.isEmpty())
+            t = qMin(1.0, firstStep/maxNorm(d));
+
+        // projected backtracking, shortened by quadratic interpolation
+        sample trial;
+        bool found = false;
+        QVector<double> u(n);
+        for(int backtrack = 0; backtrack <= maxBacktracks && solves < maxSolves; backtrack++)
+        {
+            QVector<double> s(n);
+            for(int i = 0; i < n; i++)
+            {
+                u[i] = qBound(0.0, point.u.at(i) + t*d.at(i), 1.0);
+                s[i] = u.at(i) - point.u.at(i);
+            }
+            if(maxNorm(s) < stepTolerance)
+                return true;
+            if(!evaluate(u, trial, &error))
+            {
+                qDebug()<<"optimizer: step rejected,"<<error;
+                t *= 0.5;
+                continue;
+            }
+            double slope = dot(gradient, s);
+            double rise = lagrangian(trial) - value;
+            if(rise <= armijo*slope)
+            {
+                found = true;
+                break;
+            }
+            // minimum of the parabola through value, slope and rise, within [0.1t, 0.5t]
+            double curvature = rise - slope;
+            t *= curvature > 0 ? qBound(0.1, -slope/(2*curvature), 0.5) : 0.5;
+        }
+        if(!found)
+            return solves < maxSolves;// no step along d decreases the lagrangian: as good as it gets
+
+        QVector<double> newGradient = lagrangianGradient(trial);
+        QVector<double> s(n), y(n);
+        for(int i = 0; i < n; i++)
+        {
+            s[i] = trial.u.at(i) - point.u.at(i);
+            y[i] = newGradient.at(i) - gradient.at(i);
+        }
+        if(dot(s, y) > 1.e-12*dot(y, y))
+        {
+            steps.append(s);
+            changes.append(y);
+            if(steps.count() > memorySize)
+            {
+                steps.removeFirst();
+                changes.removeFirst();
+            }
+        }
+        point = trial;
+        gradient = newGradient;
+        value = lagrangian(point);
+        accept(point);
+        if(progress && !progress(bestPoint))
+        {
+            stopped = true;
+            return false;
+        }
+    }
+    return false;
+}
+
+bool designOptimizer::evaluate(const QVector<double> &u, sample &point, QString *error)
+{
+    calInputs in = base;
+    for(int i = 0; i < variables.count(); i++)
+    {
+        const optimizerVariable &variable = variables.at(i);
+        setInputValue(in, variable.item, variable.lower + u.at(i)*(variable.upper-variable.lower));
+    }
+    in.warmStart = lastState;
+
+    calOutputs result;
+    solves++;
+    if(!solveCase(in, result, error))
+        return false;
+    const sensitivityReport &report = result.sensitivity;
+    if(!report.isValid())
+    {
+        *error = "no sensitivities: "+report.message;
+        return false;
+    }
+
+    int n = variables.count();
+    QVector<int> columns(n);
+    for(int i = 0; i < n; i++)
+    {
+        columns[i] = findItem(report.inputs, variables.at(i).item);
+        if(columns.at(i) < 0)
+        {
+            *error = "a decision variable is not a fixed input of the case";
+            return false;
+        }
+    }
+
+    // value and gradient in scaled variables of a sum of results
+    auto combine = [&](const QVector<sensitivityReport::item> &terms, double &value, QVector<double> &gradient)
+    {
+        value = 0;
+        gradient = QVector<double>(n, 0);
+        for(int t = 0; t < terms.count(); t++)
+        {
+            int row = findItem(report.outputs, terms.at(t));
+            if(row < 0)
+                return false;
+            value += report.results.at(row);
+            for(int i = 0; i < n; i++)
+                gradient[i] += report.value(row, columns.at(i))
+                        *(variables.at(i).upper-variables.at(i).lower);
+        }
+        return true;
+    };
+
+    if(!combine(QVector<sensitivityReport::item>() << objective, point.objective, point.objectiveGradient))
+    {
+        *error = "the objective is not a result of the case";
+        return false;
+    }
+    point.sums.resize(constraints.count());
+    point.sumGradients.resize(constraints.count());
+    for(int j = 0; j < constraints.count(); j++)
+    {
+        if(!combine(constraints.at(j).terms, point.sums[j], point.sumGradients[j]))
+        {
+            *error = "a constraint is not on results of the case";
+            return false;
+        }
+    }
+
+    point.u = u;
+    point.inputs = in;
+    point.outputs = result;
+    lastState = result.state;
+    return true;
+}
+
+bool designOptimizer::solveCase(const calInputs &in, calOutputs &result, QString *error)
+{
+    solverPool::Status status = solverPool::Finished;
+    bool started = solverPool::shared()->solve(QVector<calInputs>() << in, solveTimeout,
+        [&](int, solverPool::Status runStatus, const calOutputs &runResult)
+    {
+        status = runStatus;
+        result = runResult;
+    });
+    if(!started)
+    {
+        // no worker processes, solve in this process
+        absdCal(0,0,in,false);
+        result = outputs;
+    }
+
+    if(status == solverPool::Crashed)
+        *error = "the solver crashed";
+    else if(status == solverPool::TimedOut)
+        *error = "time limit exceeded";
+    else if(status == solverPool::Cancelled)
+        *error = "not calculated";
+    else if(result.stopped)
+        *error = "calculation stopped: "+result.myMsg;
+    else if(result.IER < 1 || result.IER > 3)
+        *error = "failed to converge (ier = "+QString::number(result.IER)+")";
+    else
+        return true;
+    return false;
+}
+
+double designOptimizer::constraintValue(const sample &point, int j) const
+{
+    const optimizerConstraint &constraint = constraints.at(j);
+    double direction = constraint.atMost ? 1 : -1;
+    return direction*(point.sums.at(j) - constraint.bound)/constraintScales.at(j);
+}
+
+double designOptimizer::lagrangian(const sample &point) const
+{
+    double value = (maximize ? -1 : 1)*point.objective/objectiveScale;
+    for(int j = 0; j < constraints.count(); j++)
+    {
+        double shifted = qMax(0.0, multipliers.at(j) + penalty*constraintValue(point, j));
+        value += (shifted*shifted - multipliers.at(j)*multipliers.at(j))/(2*penalty);
+    }
+    return value;
+}
+
+QVector<double> designOptimizer::lagrangianGradient(const sample &point) const
+{
+    QVector<double> gradient = point.objectiveGradient;
+    for(int i = 0; i < gradient.count(); i++)
+        gradient[i] *= (maximize ? -1 : 1)/objectiveScale;
+    for(int j = 0; j < constraints.count(); j++)
+    {
+        double shifted = qMax(0.0, multipliers.at(j) + penalty*constraintValue(point, j));
+        double direction = constraints.at(j).atMost ? 1 : -1;
+        for(int i = 0; i < gradient.count(); i++)
+            gradient[i] += shifted*direction*point.sumGradients.at(j).at(i)/constraintScales.at(j);
+    }
+    return gradient;
+}
+
+double designOptimizer::violation(const sample &point) const
+{
+    double largest = 0;
+    for(int j = 0; j < constraints.count(); j++)
+        largest = qMax(largest, constraintValue(point, j));
+    return largest;
+}
+
+void designOptimizer::accept(const sample &point)
+{
+    double v = violation(point);
+    double f = point.objective;
+    bool better = !haveBest;
+    if(haveBest)
+    {
+        bool feasibleNow = v <= feasibilityTolerance;
+        bool feasibleBefore = bestPoint.violation <= feasibilityTolerance;
+        if(feasibleNow && feasibleBefore)
+            better = maximize ? f > bestPoint.objective : f < bestPoint.objective;
+        else
+            better = feasibleNow || (!feasibleBefore && v < bestPoint.violation);
+    }
+    if(better)
+    {
+        haveBest = true;
+        bestPoint.values.resize(variables.count());
+        for(int i = 0; i < variables.count(); i++)
+            bestPoint.values[i] = inputValue(point.inputs, variables.at(i).item);
+        bestPoint.objective = f;
+        bestPoint.violation = v;
+        bestIn = point.inputs;
+        bestOut = point.outputs;
+    }
+    bestPoint.solves = solves;
+}
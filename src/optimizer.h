@@ -0,0 +1,153 @@
+/*! \file optimizer.h
+    \brief Gradient based optimization of the fixed inputs of a case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <functional>
+
+#include <QString>
+#include <QVector>
+
+#include "dataComm.h"
+
+/// A decision variable: a fixed input of the case, kept between two bounds (engine units)
+struct optimizerVariable
+{
+    sensitivityReport::item item;
+    double lower = 0;
+    double upper = 0;
+};
+
+/// A constraint on a result, or on the sum of a few results (e.g. the total UA):
+/// sum <= bound if atMost, sum >= bound otherwise (engine units)
+struct optimizerConstraint
+{
+    QVector<sensitivityReport::item> terms;
+    bool atMost = true;
+    double bound = 0;
+};
+
+/// One point the optimizer accepted
+struct optimizerPoint
+{
+    /// values of the variables, engine units
+    QVector<double> values;
+    double objective = 0;
+    /// largest violation of the constraints, relative to their bounds
+    double violation = 0;
+    /// solves of the engine so far
+    int solves = 0;
+};
+
+/*!
+Maximizes or minimizes one result of a case (COP, capacity, or any result of
+the sensitivity report) over some of its fixed inputs (ht/UA/NTU... of the
+components, fixed values of the state points), within bounds on the inputs
+and inequality constraints on the results.
+
+Every evaluation is one solve of the engine with calInputs::sensitivity, which
+gives the results and their derivatives to all fixed inputs from the Jacobian
+at the solution (see sensitivityReport), so a gradient costs one solve instead
+of one per variable. Each solve is warm-started from the solver state of the
+last converged one, and sent to the solver workers (solverPool) if there are
+any, so a crash in the engine doesn't take the program down.
+
+The method is an augmented Lagrangian for the constraints around a projected
+L-BFGS for the bounds, with the variables scaled to [0,1] between their bounds
+and the objective and constraints to their size at the start:
+- inner loop: L-BFGS direction on the variables that are not held at a bound,
+  projected back into the bounds and shortened until the Armijo condition
+  holds; a failed solve counts as a step that is too long
+- outer loop: multiplier update, the penalty grows tenfold whenever the
+  violation didn't fall to a quarter
+
+The best point so far is kept: the best feasible one, or the least infeasible
+one while none is feasible. Used by optimizeDialog.
+*/
+class designOptimizer
+{
+public:
+    /// Called after each accepted point; return false to stop the optimization.
+    typedef std::function<bool(const optimizerPoint &point)> progressHandler;
+
+    designOptimizer();
+
+    /// The case at the start (variables at their values in it, clamped to the bounds).
+    void setInputs(const calInputs &base);
+    void addVariable(const optimizerVariable &variable);
+    void addConstraint(const optimizerConstraint &constraint);
+    void setObjective(const sensitivityReport::item &item, bool maximize);
+    /// Upper limit of engine solves (default 200).
+    void setMaxSolves(int solves);
+
+    /// \return false if the optimization couldn't start, or no point was solved
+    bool run(const progressHandler &progress);
+
+    /// Why the optimization ended.
+    QString message() const;
+    bool feasible() const;
+    const optimizerPoint &best() const;
+    /// Inputs and results of best() (with its sensitivities).
+    const calInputs &bestInputs() const;
+    const calOutputs &bestOutputs() const;
+
+    /// \name The value of a fixed input in calInputs
+    /// \{
+    static double inputValue(const calInputs &in, const sensitivityReport::item &item);
+    static void setInputValue(calInputs &in, const sensitivityReport::item &item, double value);
+    /// \}
+
+    /// Solves a case with the solver workers, or in this process if there are none.
+    /// \return the case converged, otherwise why not in error
+    static bool solveCase(const calInputs &in, calOutputs &result, QString *error);
+
+private:
+    /// a solved point: objective and constraint sums, with their gradients in scaled variables
+    struct sample
+    {
+        QVector<double> u;
+        double objective = 0;
+        QVector<double> objectiveGradient;
+        QVector<double> sums;
+        QVector<QVector<double> > sumGradients;
+        calInputs inputs;
+        calOutputs outputs;
+    };
+
+    bool evaluate(const QVector<double> &u, sample &point, QString *error);
+    /// scaled constraint j, <= 0 when satisfied
+    double constraintValue(const sample &point, int j) const;
+    double lagrangian(const sample &point) const;
+    QVector<double> lagrangianGradient(const sample &point) const;
+    double violation(const sample &point) const;
+    void accept(const sample &point);
+    /// \return the inner loop converged: no better point for the current multipliers
+    bool innerLoop(sample &point, const progressHandler &progress, bool &stopped);
+
+    calInputs base;
+    QVector<optimizerVariable> variables;
+    QVector<optimizerConstraint> constraints;
+    sensitivityReport::item objective;
+    bool maximize;
+    int maxSolves;
+    int solves;
+
+    double objectiveScale;
+    QVector<double> constraintScales;
+    QVector<double> multipliers;
+    double penalty;
+    /// warm start of the next solve
+    solverState lastState;
+
+    bool haveBest;
+    optimizerPoint bestPoint;
+    calInputs bestIn;
+    calOutputs bestOut;
+    QString endMessage;
+};
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,304 @@
+/*! \file plotbackground.cpp
+    \brief Background lines of the property charts, generated once and cached
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <math.h>
+
+#include "plotbackground.h"
+#include "sorputils.h"
+#include "unitconvert.h"
+#include "sorpprops/propkernels.h"
+
+namespace {
+
+const quint32 diskMagic = 0x53504247;
+const QDataStream::Version streamVersion = QDataStream::Qt_5_6;
+
+/// psia to kPa, as the engine converts
+const double psiaToKpa = 6.895;
+
+/// lowest solution temperature [C] of each line of the Duhring chart from 65%
+/// on, where it meets the crystallization line
+double duhringStart(int c)
+{
+    switch(c)
+    {
+    case 65: return 50;
+    case 66: return 63;
+    case 67: return 77;
+    case 68: return 88;
+    case 69: return 95;
+    case 70: return 103;
+    default: return 0;
+    }
+}
+
+/// crystallization line of the Duhring chart, solution and water temperature [C]
+const double crystallization[13][2] = {
+    {50, 0}, {55, 4.4}, {60, 7.8}, {65, 11.6}, {70, 15}, {75, 18.2}, {80, 21.7},
+    {85, 24.8}, {90, 27.8}, {95, 30.6}, {100, 32.8}, {105, 35}, {110, 37}
+};
+
+double toF(double t)
+{
+    return convert(t, temperature[1], temperature[3]);
+}
+
+void addPoint(backgroundCurve &curve, double x, double y)
+{
+    if(!qIsNaN(x) && !qIsNaN(y))
+        curve.samples << QPointF(x, y);
+}
+
+}
+
+backgroundCurve::backgroundCurve() :
+    width(1),
+    visible(true)
+{
+}
+
+backgroundLevel::backgroundLevel() :
+    value(0)
+{
+}
+
+bool chartBackground::isEmpty() const
+{
+    return curves.isEmpty() && levels.isEmpty();
+}
+
+QDataStream &operator<<(QDataStream &out, const backgroundCurve &curve)
+{
+    return out << curve.title << curve.samples << qint32(curve.width) << curve.visible;
+}
+
+QDataStream &operator>>(QDataStream &in, backgroundCurve &curve)
+{
+    qint32 width = 1;
+    in >> curve.title >> curve.samples >> width >> curve.visible;
+    curve.width = width;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const backgroundLevel &level)
+{
+    return out << level.value << level.label;
+}
+
+QDataStream &operator>>(QDataStream &in, backgroundLevel &level)
+{
+    return in >> level.value >> level.label;
+}
+
+chartBackground plotBackground::chart(const QString &fluid, const QString &subType, const QString &unitSystem)
+{
+    QString name = key(fluid, subType, unitSystem);
+    QHash<QString,chartBackground> &charts = memory();
+    QHash<QString,chartBackground>::const_iterator found = charts.constFind(name);
+    if(found != charts.constEnd())
+        return found.value();
+
+    chartBackground result;
+    if(!readDisk(name, result))
+    {
+        result = generate(fluid, subType, unitSystem);
+        if(!result.isEmpty())
+            writeDisk(name, result);
+    }
+    charts.insert(name, result);
+    return result;
+}
+
+double plotBackground::waterPressure(double t)
+{
+    return sorpprops::waterSatPressure(t * 1.8 + 32.0) * psiaToKpa;
+}
+
+double plotBackground::waterTemperature(double p)
+{
+    return (sorpprops::waterSatTemperature(p / psiaToKpa) - 32.0) / 1.8;
+}
+
+double plotBackground::duhringTemperature(double c, double t)
+{
+    return (t - sorpprops::librDuhringOffset(c)) / sorpprops::librDuhringSlope(c);
+}
+
+double plotBackground::solutionPressure(double c, double t)
+{
+    return waterPressure(duhringTemperature(c, t));
+}
+
+QHash<QString,chartBackground> &plotBackground::memory()
+{
+    static QHash<QString,chartBackground> charts;
+    return charts;
+}
+
+QDir plotBackground::diskDir()
+{
+    QDir dir = Sorputils::sorpTempDir();
+    dir.mkpath("plotBackgrounds");
+    dir.cd("plotBackgrounds");
+    return dir;
+}
+
+QString plotBackground::key(const QString &fluid, const QString &subType, const QString &unitSystem)
+{
+    return fluid + "_" + subType + "_" + unitSystem;
+}
+
+bool plotBackground::readDisk(const QString &key, chartBackground &result)
+{
+    QFile file(diskDir().absoluteFilePath(key+".dat"));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(streamVersion);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+    if(magic != diskMagic || version != backgroundVersion)
+        return false;
+    stream >> result.curves >> result.levels;
+    return stream.status() == QDataStream::Ok && !result.isEmpty();
+}
+
+void plotBackground::writeDisk(const QString &key, const chartBackground &result)
+{
+    QSaveFile file(diskDir().absoluteFilePath(key+".dat"));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug()<<"plot background: can't write"<<file.fileName();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(streamVersion);
+    stream << diskMagic << backgroundVersion << result.curves << result.levels;
+    if(!file.commit())
+        qDebug()<<"plot background: can't write"<<file.fileName();
+}
+
+chartBackground plotBackground::generate(const QString &fluid, const QString &subType, const QString &unitSystem)
+{
+    if(fluid != "LiBr" || (unitSystem != "SI" && unitSystem != "IP"))
+        return chartBackground();
+    bool ip = unitSystem == "IP";
+    if(subType == "Duhring")
+        return duhring(ip);
+    if(subType == "Clapeyron")
+        return clapeyron(ip);
+    return chartBackground();
+}
+
+chartBackground plotBackground::duhring(bool ip)
+{
+    chartBackground chart;
+    // the lines are straight, so their ends are all there is to compute
+    double tEnd = ip ? 270 : 260;
+
+    backgroundCurve water;
+    water.title = "Pure Water";
+    water.width = 2;
+    if(ip)
+    {
+        addPoint(water, toF(0), toF(0));
+        addPoint(water, toF(tEnd), toF(tEnd));
+    }
+    else
+    {
+        addPoint(water, 0, 0);
+        addPoint(water, tEnd, tEnd);
+    }
+    chart.curves << water;
+
+    for(int c = 45; c <= 70; c++)
+    {
+        backgroundCurve line;
+        line.title = "baseConcentration_"+QString::number(c);
+        line.visible = c % 5 == 0;
+        double ends[2] = {duhringStart(c), tEnd};
+        for(int i = 0; i < 2; i++)
+        {
+            double tref = duhringTemperature(c, ends[i]);
+            if(ip)
+                addPoint(line, toF(ends[i]), toF(tref));
+            else
+                addPoint(line, ends[i], tref);
+        }
+        chart.curves << line;
+    }
+
+    backgroundCurve crystal;
+    crystal.title = "Crystallization Line";
+    crystal.width = 2;
+    for(int i = 0; i < 13; i++)
+    {
+        if(ip)
+            addPoint(crystal, toF(crystallization[i][0]), toF(crystallization[i][1]));
+        else
+            addPoint(crystal, crystallization[i][0], crystallization[i][1]);
+    }
+    chart.curves << crystal;
+
+    const int pressuresSI[7] = {1,5,10,50,100,200,1000};
+    const int pressuresIP[7] = {5,10,50,100,500,1000,7500};
+    QString unit = ip ? "mm Hg" : "kPa";
+    for(int i = 0; i < 7; i++)
+    {
+        backgroundLevel level;
+        if(ip)
+            level.value = toF(waterTemperature(convert(double(pressuresIP[i]), pressure[6], pressure[2])));
+        else
+            level.value = waterTemperature(pressuresSI[i]);
+        level.label = QString::number(ip ? pressuresIP[i] : pressuresSI[i])+unit;
+        if(i == 0)
+            level.label.prepend("Pressure=");
+        if(!qIsNaN(level.value))
+            chart.levels << level;
+    }
+    return chart;
+}
+
+chartBackground plotBackground::clapeyron(bool ip)
+{
+    chartBackground chart;
+    // x is -1/T [1/K or 1/R], y the vapor pressure [kPa or mmHg]
+    for(int c = 45; c <= 70; c += 5)
+    {
+        backgroundCurve line;
+        line.title = "baseConcentration_"+QString::number(c);
+        for(int t = 1; t <= 200; t++)
+        {
+            double p = solutionPressure(c, t);
+            if(ip)
+                addPoint(line, -1/convert(double(t), temperature[1], temperature[2]),
+                         convert(p, pressure[2], pressure[6]));
+            else
+                addPoint(line, -1/(t+273.15), p);
+        }
+        chart.curves << line;
+    }
+
+    backgroundCurve water;
+    water.title = "Pure Water";
+    water.width = 2;
+    for(int t = 0; t < 200; t++)
+    {
+        double p = waterPressure(t);
+        if(ip)
+            addPoint(water, -1/convert(double(t), temperature[1], temperature[2]),
+                     convert(p, pressure[2], pressure[6]));
+        else
+            addPoint(water, -1/(t+273.15), p);
+    }
+    chart.curves << water;
+    return chart;
+}
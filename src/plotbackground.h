@@ -0,0 +1,101 @@
+/*! \file plotbackground.h
+    \brief Background lines of the property charts, generated once and cached
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PLOTBACKGROUND_H
+#define PLOTBACKGROUND_H
+
+#include <QDataStream>
+#include <QDir>
+#include <QHash>
+#include <QList>
+#include <QPolygonF>
+#include <QString>
+
+/// One background line of a property chart, in the units of the chart's axes
+struct backgroundCurve
+{
+    QString title;
+    QPolygonF samples;
+    int width;
+    bool visible;
+
+    backgroundCurve();
+};
+
+/// A horizontal reference line of a property chart (the pressures of the Duhring chart)
+struct backgroundLevel
+{
+    double value;
+    QString label;
+
+    backgroundLevel();
+};
+
+/// The lines drawn behind the state points of one property chart
+struct chartBackground
+{
+    QList<backgroundCurve> curves;
+    QList<backgroundLevel> levels;
+
+    bool isEmpty() const;
+};
+
+QDataStream &operator<<(QDataStream &out, const backgroundCurve &curve);
+QDataStream &operator>>(QDataStream &in, backgroundCurve &curve);
+QDataStream &operator<<(QDataStream &out, const backgroundLevel &level);
+QDataStream &operator>>(QDataStream &in, backgroundLevel &level);
+
+/*!
+Generates the background lines of the property charts of Plot, once per
+(fluid, chart type, unit system).
+
+The lines come from the engine's correlations (sorpprops/propkernels.h), so the
+state points of a calculation sit on the lines of their concentration:
+- Duhring chart: solution temperature against the saturation temperature of
+  water at the same pressure, a straight line for each concentration
+  (45% to 70%), the pure water line, the crystallization line and the
+  saturation temperatures of a few pressures
+- Clapeyron chart: vapor pressure against -1/T for 45% to 70% and pure water
+
+A chart is kept in memory for the rest of the process, and as a file in the
+"plotBackgrounds" folder of the temp directory, so that later runs of the
+program read it instead of generating it. Files of another backgroundVersion
+are generated again and overwritten.
+
+The saturation temperature for a pressure is found by regula falsi on the
+water vapor pressure (sorpprops::waterSatTemperature()), not by stepping
+through the temperatures.
+*/
+class plotBackground
+{
+public:
+    /// Bump when the generated lines change, so the files on disk are made again.
+    static const qint32 backgroundVersion = 1;
+
+    /// \return the background of the chart, empty for a chart that doesn't exist
+    static chartBackground chart(const QString &fluid, const QString &subType, const QString &unitSystem);
+
+    /// \name LiBr/water and water in SI units (C, kPa, concentration in %)
+    /// \{
+    static double waterPressure(double t);
+    static double waterTemperature(double p);
+    /// temperature of water with the vapor pressure of the solution at t and c
+    static double duhringTemperature(double c, double t);
+    static double solutionPressure(double c, double t);
+    /// \}
+
+private:
+    static QHash<QString,chartBackground> &memory();
+    static QDir diskDir();
+    static QString key(const QString &fluid, const QString &subType, const QString &unitSystem);
+    static bool readDisk(const QString &key, chartBackground &result);
+    static void writeDisk(const QString &key, const chartBackground &result);
+    static chartBackground generate(const QString &fluid, const QString &subType, const QString &unitSystem);
+    static chartBackground duhring(bool ip);
+    static chartBackground clapeyron(bool ip);
+};
+
+#endif // PLOTBACKGROUND_H
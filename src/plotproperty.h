@@ -19,9 +19,11 @@
 
 #include <cmath>
 #include <unitconvert.h>
+#include "plotbackground.h"
 #include <QApplication>
 #include <QList>
 #include <QMultiMap>
+#include <QVector>
 #include <QtGui>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
@@ -37,6 +39,15 @@
 #include <qwt_plot_zoomer.h>
 #include <qwt_text.h>
 
+/// Columns of a parametric plot, one value per run of the table
+/// - the curves point into the columns (QwtCPointerData), so they must not change while the plot exists
+struct plotSeries
+{
+    QVector<double> x;
+    /// one column per curve
+    QList<QVector<double> > y;
+};
+
 /// Used to represent a state point for drawing an overlay curve
 struct addvalue
 {
@@ -66,7 +77,7 @@ public:
         if ( !points.isEmpty() )
         {
             QString info;/*℃*/
-            info.asprintf( "T_sol=%g C, T_ref=%g C, P=%g kPa",pos.x(),pos.y(),pow(10,(7.05-1596.49/(pos.y()+273.15)-104095.5/pow((pos.y()+273.15),2))));
+            info = QString::asprintf("T_sol=%g C, T_ref=%g C, P=%g kPa",pos.x(),pos.y(),plotBackground::waterPressure(pos.y()));
             text.setText( info );
         }
         return text;
@@ -91,7 +102,7 @@ public:
         if ( !points.isEmpty() )
         {
             QString info;/*℉*/
-            info.asprintf( "T_sol=%g F, T_ref=%g F, P=%g mm Hg",pos.x(),pos.y(),convert(pow(10,(7.05-1596.49/(convert(pos.y(),temperature[3],temperature[1])+273.15)-104095.5/pow((convert(pos.y(),temperature[3],temperature[1])+273.15),2))),pressure[2],pressure[6]));
+            info = QString::asprintf("T_sol=%g F, T_ref=%g F, P=%g mm Hg",pos.x(),pos.y(),convert(plotBackground::waterPressure(convert(pos.y(),temperature[3],temperature[1])),pressure[2],pressure[6]));
             text.setText( info );
         }
         return text;
@@ -122,8 +133,8 @@ public:
 /// Major class for plotting in SorpSim
 /// - two reload constructor subroutines to initiate a parametric/property plot
 /// - calculates status parameters of LiBr according to known variables for plotting
-/// - the property plot background lines are plotted using Tsol and Tref calculated over a range of temperature each given fixed concentration
-/// - the parameric plot points are passed to the class using QMultiMap, a data structure similar to dictionary with keys vs. values
+/// - the property plot background lines come from plotBackground, generated once per chart type and cached
+/// - the parameric plot points are passed to the class as columns (plotSeries) that the curves draw without a copy
 /// - called by plotsdialog.cpp
 ///
 /// \todo pass in parent for constructors?
@@ -131,7 +142,7 @@ class Plot : public QwtPlot
 {
 public:
     Plot(QString fluid, QString subType, QString unitSystem);
-    Plot(QMultiMap<double,double> data, QStringList xValues, int curveCount, int*axis_info, QStringList axis_name);
+    Plot(const plotSeries &data, int*axis_info, QStringList axis_name);
     ~Plot();
     double cal_rt_p(double pres);
     double cal_rt_c(double c, double t);
@@ -144,6 +155,8 @@ public:
     int axis_typeinfo[2];
     QwtPlotGrid *grid;
     bool isParametric;
+    /// data of a parametric plot, kept for its curves
+    plotSeries series;
 
     void setupNewPropertyCurve(QString title, bool isDuhring);
     void getCurveByTitle(const QString &title, QwtPlotCurve *&result, int &i);
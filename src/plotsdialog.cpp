@@ -17,6 +17,7 @@
 #include <QDomImplementation>
 #include <QLabel>
 #include <QLayout>
+#include <QVBoxLayout>
 #include <QMessageBox>
 #include <QMenu>
 #include <QPainter>
@@ -56,6 +57,13 @@ extern myScene * theScene;
 extern MainWindow * theMainwindow;
 extern globalparameter globalpara;
 
+namespace {
+
+/// number of plots kept built; the least recently shown one beyond this is released
+const int builtPlotLimit = 8;
+
+}
+
 class Zoomer: public QwtPlotZoomer
 {
 public:
@@ -77,7 +85,8 @@ public:
 
 plotsDialog::plotsDialog(QString startPlot, bool fromTable, QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::plotsDialog)
+    ui(new Ui::plotsDialog),
+    showCount(0)
 {
     ui->setupUi(this);
 
@@ -164,8 +173,8 @@ void plotsDialog::refreshThePlot()
 
 void plotsDialog::setupPlots(bool init)
 {
-    if(!init)
-        disconnect(tabs,SIGNAL(currentChanged(int)),this,SLOT(resetZoomer(int)));
+    // no tab is built while they are added, only the one shown at the end
+    disconnect(tabs,SIGNAL(currentChanged(int)),this,SLOT(resetZoomer(int)));
     if(!loadXml(init))
     {
         globalpara.reportError("Fail to load xml file for plots!",this);
@@ -173,9 +182,6 @@ void plotsDialog::setupPlots(bool init)
     }
     showInfo();
 
-    if(!init)
-        connect(tabs,SIGNAL(currentChanged(int)),SLOT(resetZoomer(int)));
-
     int newCurrentIndex = 0;
     if(tabs->count()>0)
         newCurrentIndex = tabs->count()-1;
@@ -190,6 +196,9 @@ void plotsDialog::setupPlots(bool init)
     }
 
     tabs->setCurrentIndex(newCurrentIndex);
+    connect(tabs,SIGNAL(currentChanged(int)),SLOT(resetZoomer(int)));
+    if(tabs->count()>0)
+        resetZoomer(newCurrentIndex);
 
     refreshThePlot();
 }
@@ -201,7 +210,7 @@ bool plotsDialog::loadXml(bool init)
     qDebug() << "Note: QDomImplementation::invalidDataPolicy() is " << policy;
 #endif
 
-    tabs->clear();
+    clearPages();
     QString plotTempXML = Sorputils::sorpTempDir().absoluteFilePath("plotTemp.xml");
     QFile file(plotTempXML);
 
@@ -218,8 +227,7 @@ bool plotsDialog::loadXml(bool init)
     }
 
     QDomDocument doc;
-    QDomElement plotData, currentPlot;
-    Plot*newPlot;
+    QDomElement plotData;
 
     if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
     {
@@ -239,242 +247,315 @@ bool plotsDialog::loadXml(bool init)
         return false;
     }
 
+    // Only the title of each <plot> is read here, the Plot is built by plotAt()
+    // when its tab is shown.
+    plotDoc = doc;
     plotData = doc.elementsByTagName("plotData").at(0).toElement();
     int plotCount = plotData.childNodes().count();
-    // Read each <plot>
     for(int i = 0; i < plotCount;i++)
     {
-        // FIXED: update to read valid new form of xml for <plotData>
-        currentPlot = plotData.childNodes().at(i).toElement();
-        QString plotTitle = currentPlot.attribute("title");
-        qDebug() << "Loading from XML plot with title \"" << plotTitle << "\".";
-        if(currentPlot.attribute("plotType")=="parametric")
+        plotPage page;
+        page.element = plotData.childNodes().at(i).toElement();
+        page.title = page.element.attribute("title");
+        page.page = new QWidget;
+        QVBoxLayout *layout = new QVBoxLayout(page.page);
+        layout->setContentsMargins(0,0,0,0);
+        page.plot = NULL;
+        page.shownAt = 0;
+        pages<<page;
+        tabs->insertTab(-1,page.page,page.title);
+    }
+    file.close();
+    return true;
+}
+
+Plot *plotsDialog::buildPlot(const QDomElement &currentPlot)
+{
+    Plot*newPlot;
+    QString plotTitle = currentPlot.attribute("title");
+    qDebug() << "Loading from XML plot with title \"" << plotTitle << "\".";
+    if(currentPlot.attribute("plotType")=="parametric")
+    {
+        QDomElement currentRun,runOutput;
+        int axis_info[8];
+        QStringList axis_name, info;
+        plotSeries series;
+        axis_name.append(currentPlot.attribute("xAxisName"));
+        axis_name= axis_name + currentPlot.attribute("yAxisName").split(",");
+        info = currentPlot.attribute("scaleInfo").split(",");
+        for(int j = 0; j < 8; j++)
+            axis_info[j] = info.at(j).toInt();
+        QDomNodeList runs = currentPlot.elementsByTagName("Run");
+        int nRuns = runs.count(), nOutputs = currentPlot.attribute("outputs").toInt();
+        // one column for the input and one for each output, in the order of the runs
+        series.x.reserve(nRuns);
+        for(int p = 0; p < nOutputs; p++)
+        {
+            series.y.append(QVector<double>());
+            series.y[p].reserve(nRuns);
+        }
+        for(int j = 0; j < nRuns; j++)
         {
-            QDomElement currentRun,runInput,runOutput;
-            double currentInput;
-            int axis_info[8];
-            QStringList currentOutput, xValues, axis_name, info;
-            QMultiMap<double,double> allData;
-            axis_name.append(currentPlot.attribute("xAxisName"));
-            axis_name= axis_name + currentPlot.attribute("yAxisName").split(",");
-            info = currentPlot.attribute("scaleInfo").split(",");
-            for(int j = 0; j < 8; j++)
-                axis_info[j] = info.at(j).toInt();
-            int nRuns = currentPlot.elementsByTagName("Run").count(), nOutputs = currentPlot.attribute("outputs").toInt();
-            for(int j = 0; j < nRuns; j++)
+            currentRun = runs.at(j).toElement();
+            series.x.append(currentRun.firstChildElement("Input").firstChildElement("value").text().toDouble());
+            runOutput = currentRun.firstChildElement("Output");
+            for(int p = 0; p < nOutputs; p++)
             {
-                currentOutput.clear();
-                currentRun = currentPlot.elementsByTagName("Run").at(j).toElement();
-                runInput = currentRun.elementsByTagName("Input").at(0).toElement();
-                currentInput = runInput.elementsByTagName("value").at(0).toElement().text().toDouble();
-                xValues.append(QString::number(currentInput));
-                for(int p = 0; p < nOutputs; p++)
-                {
-                    runOutput = currentRun.elementsByTagName("Output").at(p).toElement();
-                    currentOutput.append(runOutput.elementsByTagName("value").at(0).toElement().text());
-                    allData.insert(currentInput,currentOutput.at(p).toDouble());
-                }
+                series.y[p].append(runOutput.firstChildElement("value").text().toDouble());
+                runOutput = runOutput.nextSiblingElement("Output");
             }
-            newPlot = new Plot(allData,xValues,nOutputs,axis_info,axis_name);
         }
-        else if(currentPlot.attribute("plotType")=="property")
+        newPlot = new Plot(series,axis_info,axis_name);
+    }
+    else if(currentPlot.attribute("plotType")=="property")
+    {
+        QString fluid = currentPlot.attribute("fluid"),
+                subType = currentPlot.attribute("subType"),
+                unit = currentPlot.attribute("unitSystem");
+
+        newPlot = new Plot(fluid,subType,unit);
+        QDomElement currentCurve, currentPoint;
+
+        newPlot->curvePoints.clear();
+        // Now looking for nodes matching <curve type="custom">, descendant of <plot>
+        // Read each <curve>
+        QDomElement curveList = currentPlot.elementsByTagName("curveList").at(0).toElement();
+        QDomNodeList curveNodes = curveList.elementsByTagName("curve");
+        for(int i = 0; i < curveNodes.length(); i++)
         {
-            QString fluid = currentPlot.attribute("fluid"),
-                    subType = currentPlot.attribute("subType"),
-                    unit = currentPlot.attribute("unitSystem");
-
-            newPlot = new Plot(fluid,subType,unit);
-            QDomElement currentCurve, currentPoint;
-
-            newPlot->curvePoints.clear();
-            // Now looking for nodes matching <curve type="custom">, descendant of <plot>
-            // Read each <curve>
-            QDomElement curveList = currentPlot.elementsByTagName("curveList").at(0).toElement();
-            QDomNodeList curveNodes = curveList.elementsByTagName("curve");
-            for(int i = 0; i < curveNodes.length(); i++)
+            QDomElement node = curveNodes.at(i).toElement();
+            // Check for type attribute (apparently generated by overlaysetting::updateXml())
+            if(node.attribute("type")=="custom")
             {
-                QDomElement node = curveNodes.at(i).toElement();
-                // Check for type attribute (apparently generated by overlaysetting::updateXml())
-                if(node.attribute("type")=="custom")
+                addvalue value;
+                newPlot->addvaluelist.clear();
+                currentCurve = node.toElement();
+                QString title = currentCurve.attribute("title");
+                for(int j = 0; j < currentCurve.childNodes().count();j++)
                 {
-                    addvalue value;
-                    newPlot->addvaluelist.clear();
-                    currentCurve = node.toElement();
-                    QString title = currentCurve.attribute("title");
-                    for(int j = 0; j < currentCurve.childNodes().count();j++)
+                    currentPoint = currentCurve.childNodes().at(j).toElement();
+                    if(currentPoint.attribute("order")==QString::number(j))
                     {
-                        currentPoint = currentCurve.childNodes().at(j).toElement();
-                        if(currentPoint.attribute("order")==QString::number(j))
-                        {
-                            value.index = currentPoint.attribute("index").toInt();
-                            value.add_temperature = currentPoint.attribute("t").toDouble();
-                            value.add_pressure = currentPoint.attribute("p").toDouble();
-                            value.add_concentration = currentPoint.attribute("c").toDouble();
-                            value.add_enthalpy = currentPoint.attribute("h").toDouble();
+                        value.index = currentPoint.attribute("index").toInt();
+                        value.add_temperature = currentPoint.attribute("t").toDouble();
+                        value.add_pressure = currentPoint.attribute("p").toDouble();
+                        value.add_concentration = currentPoint.attribute("c").toDouble();
+                        value.add_enthalpy = currentPoint.attribute("h").toDouble();
 //                                    qDebug()<<"adding a new point"<<currentPoint.attribute("index")<<"t"<<currentPoint.attribute("t")<<"p"<<currentPoint.attribute("p")<<"c"<<currentPoint.attribute("c");
-                            newPlot->addvaluelist<<value;
-                        }
+                        newPlot->addvaluelist<<value;
                     }
-
-                    if(subType == "Duhring")
-                        newPlot->setupNewPropertyCurve(title,true);
-                    else if(subType == "Clapeyron")
-                        newPlot->setupNewPropertyCurve(title,false);
                 }
+
+                if(subType == "Duhring")
+                    newPlot->setupNewPropertyCurve(title,true);
+                else if(subType == "Clapeyron")
+                    newPlot->setupNewPropertyCurve(title,false);
             }
         }
-        else
-        {
-            qDebug() << "Unkown plotType \"" << currentPlot.attribute("plotType") << "\".";
-        }
-        newPlot->setTitle(plotTitle);
+    }
+    else
+    {
+        qDebug() << "Unkown plotType \"" << currentPlot.attribute("plotType") << "\".";
+        return NULL;
+    }
+    newPlot->setTitle(plotTitle);
 
-        //load the plot settings
-        QDomElement general, legend, grid, curveList;
+    //load the plot settings
+    QDomElement general, legend, grid, curveList;
 
-        //general
-        if(currentPlot.elementsByTagName("general").count()>0)
-        {
-            general = currentPlot.elementsByTagName("general").at(0).toElement();
-            QString bgColor, lMargin, rMargin, tMargin, bMargin, plotTitle, xTitle, yTitle;
-            bgColor = general.attribute("bgColor");
-            newPlot->setCanvasBackground(QColor(bgColor));
-            lMargin = general.attribute("lMargin");
-            rMargin = general.attribute("rMargin");
-            tMargin = general.attribute("tMargin");
-            bMargin = general.attribute("bMargin");
-            newPlot->setContentsMargins(lMargin.toInt(),tMargin.toInt(),rMargin.toInt(),bMargin.toInt());
-            plotTitle = general.attribute("plotTitle");
-            newPlot->setTitle(plotTitle);
-            xTitle = general.attribute("xTitle");
-            yTitle = general.attribute("yTitle");
-            newPlot->setAxisTitle(QwtPlot::xBottom,xTitle);
-            newPlot->setAxisTitle(QwtPlot::yLeft,yTitle);
-        }
+    //general
+    if(currentPlot.elementsByTagName("general").count()>0)
+    {
+        general = currentPlot.elementsByTagName("general").at(0).toElement();
+        QString bgColor, lMargin, rMargin, tMargin, bMargin, plotTitle, xTitle, yTitle;
+        bgColor = general.attribute("bgColor");
+        newPlot->setCanvasBackground(QColor(bgColor));
+        lMargin = general.attribute("lMargin");
+        rMargin = general.attribute("rMargin");
+        tMargin = general.attribute("tMargin");
+        bMargin = general.attribute("bMargin");
+        newPlot->setContentsMargins(lMargin.toInt(),tMargin.toInt(),rMargin.toInt(),bMargin.toInt());
+        plotTitle = general.attribute("plotTitle");
+        newPlot->setTitle(plotTitle);
+        xTitle = general.attribute("xTitle");
+        yTitle = general.attribute("yTitle");
+        newPlot->setAxisTitle(QwtPlot::xBottom,xTitle);
+        newPlot->setAxisTitle(QwtPlot::yLeft,yTitle);
+    }
 
-        // <legend>
-        // Attributes: plotLegend=on|off,
-        //             extInt=ext|int,
-        //             extPos=0|1|2|3, (see QwtPlot::LegendPosition)
-        //             nCol=integer,
-        //             legendSize=integer
-        if(currentPlot.elementsByTagName("legend").count()>0)
+    // <legend>
+    // Attributes: plotLegend=on|off,
+    //             extInt=ext|int,
+    //             extPos=0|1|2|3, (see QwtPlot::LegendPosition)
+    //             nCol=integer,
+    //             legendSize=integer
+    if(currentPlot.elementsByTagName("legend").count()>0)
+    {
+        legend = currentPlot.elementsByTagName("legend").at(0).toElement();
+        QString plotLegend, extInt, extPos, nCol, legendSize;
+        plotLegend = legend.attribute("plotLegend");
+        if(plotLegend == "on")
         {
-            legend = currentPlot.elementsByTagName("legend").at(0).toElement();
-            QString plotLegend, extInt, extPos, nCol, legendSize;
-            plotLegend = legend.attribute("plotLegend");
-            if(plotLegend == "on")
+            QwtLegend* externalLegend=NULL;
+            LegendItem* internalLegend = new LegendItem();
+            newPlot->externalLegend = externalLegend;
+            newPlot->internalLegend = internalLegend;
+            internalLegend->attach(newPlot);
+            internalLegend->setBorderRadius( 4 );
+            internalLegend->setMargin( 0 );
+            internalLegend->setSpacing( 4 );
+            internalLegend->setItemMargin( 2 );
+            internalLegend->setMaxColumns(4);
+            internalLegend->setAlignmentInCanvas(Qt::AlignBottom|Qt::AlignRight);
+            extInt = legend.attribute("extInt");
+            if(extInt == "ext")
             {
-                QwtLegend* externalLegend=NULL;
-                LegendItem* internalLegend = new LegendItem();
-                newPlot->externalLegend = externalLegend;
-                newPlot->internalLegend = internalLegend;
-                internalLegend->attach(newPlot);
-                internalLegend->setBorderRadius( 4 );
-                internalLegend->setMargin( 0 );
-                internalLegend->setSpacing( 4 );
-                internalLegend->setItemMargin( 2 );
-                internalLegend->setMaxColumns(4);
-                internalLegend->setAlignmentInCanvas(Qt::AlignBottom|Qt::AlignRight);
-                extInt = legend.attribute("extInt");
-                if(extInt == "ext")
-                {
-                    internalLegend->setVisible(false);
-                    externalLegend = new QwtLegend();
-                    extPos = legend.attribute("extPos");//0=L, 1=R, 2=B, 3=T
-                    newPlot->insertLegend(externalLegend,QwtPlot::LegendPosition(extPos.toInt()));
-                }
-                else if(extInt == "int")
-                {
-                    internalLegend->setVisible(true);
-                    nCol = legend.attribute("nCol");
-                    legendSize = legend.attribute("legendSize");
-
-                    // other setting
-                    newPlot->internalLegend->setMaxColumns(nCol.toInt());
-                    QFont font = newPlot->internalLegend->font();
-                    font.setPointSize( legendSize.toInt());
-                    newPlot->internalLegend->setFont( font );
-                }
+                internalLegend->setVisible(false);
+                externalLegend = new QwtLegend();
+                extPos = legend.attribute("extPos");//0=L, 1=R, 2=B, 3=T
+                newPlot->insertLegend(externalLegend,QwtPlot::LegendPosition(extPos.toInt()));
+            }
+            else if(extInt == "int")
+            {
+                internalLegend->setVisible(true);
+                nCol = legend.attribute("nCol");
+                legendSize = legend.attribute("legendSize");
+
+                // other setting
+                newPlot->internalLegend->setMaxColumns(nCol.toInt());
+                QFont font = newPlot->internalLegend->font();
+                font.setPointSize( legendSize.toInt());
+                newPlot->internalLegend->setFont( font );
             }
         }
+    }
 
-        //grid
-        if(currentPlot.elementsByTagName("grid").count()>0)
+    //grid
+    if(currentPlot.elementsByTagName("grid").count()>0)
+    {
+        grid = currentPlot.elementsByTagName("grid").at(0).toElement();
+        QString xMaj, yMaj, xMin, yMin, majColor, minColor, majSize, minSize, majStyle, minStyle;
+        xMaj = grid.attribute("xMaj");
+        yMaj = grid.attribute("yMaj");
+        xMin = grid.attribute("xMin");
+        yMin = grid.attribute("yMin");
+        majColor = grid.attribute("majColor");
+        minColor = grid.attribute("minColor");
+        majSize = grid.attribute("majSize");
+        minSize = grid.attribute("minSize");
+        majStyle = grid.attribute("majStyle");
+        minStyle = grid.attribute("minStyle");
+        newPlot->grid->enableX(xMaj=="on");
+        newPlot->grid->enableY(yMaj == "on");
+        newPlot->grid->enableXMin(xMin=="on");
+        newPlot->grid->enableYMin(yMin=="on");
+        if(newPlot->grid->xEnabled()||newPlot->grid->yEnabled())
+            newPlot->grid->setMajorPen(QColor(majColor),majSize.toInt(),Qt::PenStyle(majStyle.toInt()));
+        if(newPlot->grid->xMinEnabled()||newPlot->grid->yMinEnabled())
+            newPlot->grid->setMinorPen(QColor(minColor),minSize.toInt(),Qt::PenStyle(minStyle.toInt()));
+    }
+
+    //curve
+    // Fixed: rework to read new XML structure for this
+    // See savePlotSettings().
+    if(currentPlot.elementsByTagName("curveList").count()>0)
+    {
+        curveList = currentPlot.elementsByTagName("curveList").at(0).toElement();
+        QMap<QString, QDomElement> curveListMap;
+        QDomNodeList  curveListNodes = curveList.childNodes();
+        for (int j = 0; j < curveListNodes.count(); j++)
         {
-            grid = currentPlot.elementsByTagName("grid").at(0).toElement();
-            QString xMaj, yMaj, xMin, yMin, majColor, minColor, majSize, minSize, majStyle, minStyle;
-            xMaj = grid.attribute("xMaj");
-            yMaj = grid.attribute("yMaj");
-            xMin = grid.attribute("xMin");
-            yMin = grid.attribute("yMin");
-            majColor = grid.attribute("majColor");
-            minColor = grid.attribute("minColor");
-            majSize = grid.attribute("majSize");
-            minSize = grid.attribute("minSize");
-            majStyle = grid.attribute("majStyle");
-            minStyle = grid.attribute("minStyle");
-            newPlot->grid->enableX(xMaj=="on");
-            newPlot->grid->enableY(yMaj == "on");
-            newPlot->grid->enableXMin(xMin=="on");
-            newPlot->grid->enableYMin(yMin=="on");
-            if(newPlot->grid->xEnabled()||newPlot->grid->yEnabled())
-                newPlot->grid->setMajorPen(QColor(majColor),majSize.toInt(),Qt::PenStyle(majStyle.toInt()));
-            if(newPlot->grid->xMinEnabled()||newPlot->grid->yMinEnabled())
-                newPlot->grid->setMinorPen(QColor(minColor),minSize.toInt(),Qt::PenStyle(minStyle.toInt()));
+            QDomElement el = curveListNodes.at(j).toElement();
+            QString curveTitle = el.attribute("title");
+            curveListMap[curveTitle] = el;
         }
+        qDebug() << "Curve titles available in XML:" << curveListMap.keys();
 
-        //curve
-        // Fixed: rework to read new XML structure for this
-        // See savePlotSettings().
-        if(currentPlot.elementsByTagName("curveList").count()>0)
+        if(curveList.childNodes().count()==newPlot->curvelist.count())
         {
-            curveList = currentPlot.elementsByTagName("curveList").at(0).toElement();
-            QMap<QString, QDomElement> curveListMap;
-            QDomNodeList  curveListNodes = curveList.childNodes();
-            for (int j = 0; j < curveListNodes.count(); j++)
+            QDomElement currentCurve;
+            QwtPlotCurve *thisCurve;
+            QString curveTitle, lineColor, lineSize, lineType, isVisible;
+            for(int i = 0; i < newPlot->curvelist.count();i++)
             {
-                QDomElement el = curveListNodes.at(j).toElement();
-                QString curveTitle = el.attribute("title");
-                curveListMap[curveTitle] = el;
-            }
-            qDebug() << "Curve titles available in XML:" << curveListMap.keys();
-
-            if(curveList.childNodes().count()==newPlot->curvelist.count())
-            {
-                QDomElement currentCurve;
-                QwtPlotCurve *thisCurve;
-                QString curveTitle, lineColor, lineSize, lineType, isVisible;
-                for(int i = 0; i < newPlot->curvelist.count();i++)
+                curveTitle = newPlot->curvelist.at(i)->title().text();
+                if (!curveListMap.contains(curveTitle))
                 {
-                    curveTitle = newPlot->curvelist.at(i)->title().text();
-                    if (!curveListMap.contains(curveTitle))
-                    {
-                        qDebug() << "Curve not found in XML with title \"" << curveTitle << "\".";
-                        continue;
-                    }
-                    qDebug() << "Loading attributes from XML for curve \"" << curveTitle << "\".";
-                    currentCurve = curveListMap.value(curveTitle);
-                    thisCurve = newPlot->curvelist[i];
-                    lineColor = currentCurve.attribute("lineColor");
-                    lineSize = currentCurve.attribute("lineSize");
-                    lineType = currentCurve.attribute("lineType");
-                    isVisible = currentCurve.attribute("isVisible");
-                    thisCurve->setPen(QColor(lineColor),lineSize.toInt(),Qt::PenStyle(lineType.toInt()));
-                    thisCurve->setVisible("true" == isVisible);
+                    qDebug() << "Curve not found in XML with title \"" << curveTitle << "\".";
+                    continue;
                 }
+                qDebug() << "Loading attributes from XML for curve \"" << curveTitle << "\".";
+                currentCurve = curveListMap.value(curveTitle);
+                thisCurve = newPlot->curvelist[i];
+                lineColor = currentCurve.attribute("lineColor");
+                lineSize = currentCurve.attribute("lineSize");
+                lineType = currentCurve.attribute("lineType");
+                isVisible = currentCurve.attribute("isVisible");
+                thisCurve->setPen(QColor(lineColor),lineSize.toInt(),Qt::PenStyle(lineType.toInt()));
+                thisCurve->setVisible("true" == isVisible);
             }
         }
-        tabs->insertTab(-1,newPlot,currentPlot.attribute("title"));
+    }
+    return newPlot;
+}
+
+Plot *plotsDialog::plotAt(int index)
+{
+    if(index < 0 || index >= pages.count())
+        return NULL;
+    if(pages.at(index).plot == NULL)
+    {
+        Plot *newPlot = buildPlot(pages.at(index).element);
+        if(newPlot == NULL)
+            return NULL;
+        pages[index].plot = newPlot;
+        pages.at(index).page->layout()->addWidget(newPlot);
         newPlot->replot();
     }
-    file.close();
-    return true;
+    pages[index].shownAt = ++showCount;
+    releasePlots();
+    return pages.at(index).plot;
+}
+
+void plotsDialog::releasePlots()
+{
+    int built = 0;
+    for(int i = 0; i < pages.count(); i++)
+        if(pages.at(i).plot != NULL)
+            built++;
+    if(built <= builtPlotLimit)
+        return;
+
+    // keep the changes made to the plots, they are read again when rebuilt
+    savePlotSettings();
+    for(; built > builtPlotLimit; built--)
+    {
+        int oldest = -1;
+        for(int i = 0; i < pages.count(); i++)
+        {
+            if(pages.at(i).plot != NULL && i != tabs->currentIndex()
+                    && (oldest < 0 || pages.at(i).shownAt < pages.at(oldest).shownAt))
+                oldest = i;
+        }
+        if(oldest < 0)
+            return;
+        qDebug() << "Releasing plot" << pages.at(oldest).title;
+        delete pages.at(oldest).plot;
+        pages[oldest].plot = NULL;
+    }
+}
+
+void plotsDialog::clearPages()
+{
+    tabs->clear();
+    for(int i = 0; i < pages.count(); i++)
+        delete pages.at(i).page;
+    pages.clear();
 }
 
 void plotsDialog::moved(const QPoint &pos)
 {
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
     QString info;
     info.asprintf( "X=%g, Y=%g",currentPlot->invTransform(QwtPlot::xBottom,pos.x()),currentPlot->invTransform(QwtPlot::yLeft,pos.y()));
     showInfo( info );
@@ -488,7 +569,7 @@ void plotsDialog::selected(const QPolygon &)
 // \todo this still needs work!
 void plotsDialog::overlay()
 {
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
     overlaysetting * dialog= new overlaysetting(currentPlot,this);
     connect(dialog, SIGNAL(finished(int)), this, SLOT(onOverlayFinished(int)));
     connect(theMainwindow, SIGNAL(cancel_mouse_select_operation()), dialog, SLOT(on_pushButton_clicked()));
@@ -500,7 +581,7 @@ void plotsDialog::overlay()
 
 void plotsDialog::edit()
 {
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
     curvesetting * dialog = new curvesetting(&currentPlot->curvelist,currentPlot,this);
     dialog->setModal(true);
     if (dialog->exec()== QDialog::Accepted)
@@ -515,7 +596,7 @@ void plotsDialog::print()
 {
     QPrinter printer( QPrinter::HighResolution );
 
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
     QString docName = currentPlot->title().text();
     if ( !docName.isEmpty() )
     {
@@ -545,7 +626,7 @@ void plotsDialog::print()
 
 void plotsDialog::exportDocument()
 {
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
     QwtPlotRenderer renderer;
     renderer.exportTo( currentPlot, currentPlot->title().text()/*+".jpg"*/ );
 }
@@ -581,7 +662,7 @@ void plotsDialog::deleteCurrentPlot()
     askBox.exec();
     if(askBox.buttonRole(askBox.clickedButton())==QMessageBox::YesRole)
     {
-        Plot* plotToDelete = dynamic_cast<Plot*>(tabs->currentWidget());
+        Plot* plotToDelete = plotAt(tabs->currentIndex());
         //QString plotTitle = tabs->tabText(tabs->currentIndex());
         QString plotTitle = plotToDelete->title().text();
 
@@ -618,7 +699,12 @@ void plotsDialog::deleteCurrentPlot()
 
         if(tabs->count()>1)
         {
-            tabs->removeTab(tabs->currentIndex());
+            int index = tabs->currentIndex();
+            QWidget *page = pages.at(index).page;
+            // the tab shown next is built while the tab is removed
+            pages.removeAt(index);
+            tabs->removeTab(index);
+            page->deleteLater();
         }
         else if(tabs->count()==1)
         {
@@ -629,7 +715,9 @@ void plotsDialog::deleteCurrentPlot()
 
 void plotsDialog::resetZoomer(int i)
 {
-    Plot* currentPlot = dynamic_cast<Plot*>(tabs->currentWidget());
+    Plot* currentPlot = plotAt(tabs->currentIndex());
+    if(currentPlot == NULL)
+        return;
 
     d_zoomer[0] = new Zoomer( QwtPlot::xBottom, QwtPlot::yLeft,
         currentPlot->canvas() );
@@ -952,9 +1040,12 @@ void plotsDialog::savePlotSettings()
         plotsByTitle.insert(plot.attribute("title"), plot);
     }
 
-    for(int i = 0; i < tabs->count();i++)
+    for(int i = 0; i < pages.count();i++)
     {
-        Plot* set_plot = dynamic_cast<Plot*>(tabs->widget(i));
+        // plots not built since the last save are unchanged in the file
+        Plot* set_plot = pages.at(i).plot;
+        if(set_plot == NULL)
+            continue;
         // The plot's own title is preferable to the tab text.
         QString tabTitle = tabs->tabText(i);
         QString plotTitle = set_plot->title().text();
@@ -1141,6 +1232,11 @@ void plotsDialog::savePlotSettings()
     file.resize(0);
     doc.save(stream,4);
     file.close();
+
+    // plots built again read their settings from the document just saved
+    plotDoc = doc;
+    for(int i = 0; i < pages.count(); i++)
+        pages[i].element = plotsByTitle.value(pages.at(i).title);
 }
 
 void plotsDialog::on_editButton_clicked()
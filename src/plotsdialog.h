@@ -18,6 +18,9 @@
 #define PLOTSDIALOG_H
 
 #include <QDialog>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QList>
 #include "plotproperty.h"
 #include <QTabWidget>
 #include <QStatusBar>
@@ -37,6 +40,8 @@ class plotsDialog;
 /// Dialog to display and edit all available plots (parametric and property) in the current case
 /// - create a copy of the case XML file and operates on the plot part of the copy
 /// - upon close, the plot part in the copy XML file with all the changes are merged into the original case file and overwrite the previous ones
+/// - the Plot of a tab is built from its <plot> element when the tab is first shown; only the
+///   most recently shown plots are kept, the others are saved to the copy and released
 /// - called by myScene.cpp, mainwindow.cpp
 class plotsDialog : public QDialog
 {
@@ -108,7 +113,25 @@ private:
     bool isFromTable;
     QMenu* contextMenu;
 
+    /// A tab and the <plot> it shows; plot is NULL until the tab is shown
+    struct plotPage
+    {
+        QString title;
+        QDomElement element;
+        QWidget *page;
+        Plot *plot;
+        int shownAt;
+    };
+    /// plotTemp.xml as last read or written here, holding the elements of pages
+    QDomDocument plotDoc;
+    QList<plotPage> pages;
+    int showCount;
+
     void savePlotSettings();
+    Plot *plotAt(int index);
+    Plot *buildPlot(const QDomElement &currentPlot);
+    void releasePlots();
+    void clearPages();
 };
 
 #endif // PLOTSDIALOG_H
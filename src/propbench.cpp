@@ -0,0 +1,204 @@
+/*! \file propbench.cpp
+    \brief Microbenchmark of the batch property evaluation
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <math.h>
+
+#include "propbench.h"
+#include "sorpsimEngine.h"
+#include "sorpprops/propbatch.h"
+#include "sorpprops/propkernels.h"
+
+using namespace sorpsim4l;
+
+namespace {
+
+/// inputs of all properties, spread over the valid ranges
+struct benchPoints
+{
+    int n;
+    QVector<double> t;// 60..250 F
+    QVector<double> p;// 0.1..14 psia
+    QVector<double> xLibr;// 45..65 %
+    QVector<double> xLicl;// 10..40 %
+    QVector<double> xNh3;// 5..90 %
+    QVector<double> tNh3;// boiling temperatures of p and xNh3
+    QVector<double> w;// 0.001..0.05 lb/lb
+};
+
+typedef void (*engineLoop)(common &cmn, const benchPoints &in, double *out);
+typedef void (*batchCall)(const benchPoints &in, double *out);
+
+struct benchCase
+{
+    const char *name;
+    engineLoop engine;
+    batchCall batch;
+};
+
+benchPoints makePoints(int n)
+{
+    benchPoints in;
+    in.n = n;
+    for(int i = 0; i < n; i++)
+    {
+        // different strides so the inputs of a point are not correlated
+        double s1 = double(i) / n, s2 = double((i*7) % n) / n, s3 = double((i*13) % n) / n;
+        in.t << 60 + 190 * s1;
+        in.p << 0.1 + 13.9 * s3;
+        in.xLibr << 45 + 20 * s2;
+        in.xLicl << 10 + 30 * s2;
+        in.xNh3 << 5 + 85 * s2;
+        in.w << 0.001 + 0.049 * s3;
+    }
+    in.tNh3.resize(n);
+    sorpprops::ammonia::temperature(n, in.p.constData(), in.xNh3.constData(), in.tNh3.data());
+    return in;
+}
+
+const benchCase cases[] = {
+    {"water saturation pressure (pft3)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) pft3(cmn, out[i], in.t[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::water::satPressure(in.n, in.t.constData(), out); }},
+    {"water saturation temperature (tfp3)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) tfp3(cmn, out[i], in.p[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::water::satTemperature(in.n, in.p.constData(), out); }},
+    {"LiBr temperature (tfpx1)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) tfpx1(cmn, out[i], in.p[i], in.xLibr[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::libr::temperature(in.n, in.p.constData(), in.xLibr.constData(), out); }},
+    {"LiBr pressure (pftx1)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) pftx1(cmn, out[i], in.t[i], in.xLibr[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::libr::pressure(in.n, in.t.constData(), in.xLibr.constData(), out); }},
+    {"LiBr humidity (wftx1)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) wftx1(cmn, out[i], in.t[i], in.xLibr[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::libr::humidity(in.n, in.t.constData(), in.xLibr.constData(), out); }},
+    {"LiBr enthalpy (hftx1)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) hftx1(cmn, out[i], in.t[i], in.xLibr[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::libr::enthalpy(in.n, in.t.constData(), in.xLibr.constData(), out); }},
+    {"LiCl temperature (tfpx9)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) tfpx9(cmn, out[i], in.p[i], in.xLicl[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::licl::temperature(in.n, in.p.constData(), in.xLicl.constData(), out); }},
+    {"LiCl humidity (wftx9)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) wftx9(cmn, out[i], in.t[i], in.xLicl[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::licl::humidity(in.n, in.t.constData(), in.xLicl.constData(), out); }},
+    {"LiCl heat capacity (cpftx9)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) cpftx9(cmn, out[i], in.t[i], in.xLicl[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::licl::heatCapacity(in.n, in.t.constData(), in.xLicl.constData(), out); }},
+    {"LiCl enthalpy (hftx9)",
+     [](common &, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) hftx9(out[i], in.t[i], in.xLicl[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::licl::enthalpy(in.n, in.t.constData(), in.xLicl.constData(), out); }},
+    {"NH3 temperature (tfpx2)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) tfpx2(cmn, out[i], in.p[i], in.xNh3[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::ammonia::temperature(in.n, in.p.constData(), in.xNh3.constData(), out); }},
+    {"NH3 concentration (xftp2)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) xftp2(cmn, out[i], in.tNh3[i], in.p[i]); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::ammonia::concentration(in.n, in.tNh3.constData(), in.p.constData(), out); }},
+    {"air enthalpy (hftx10)",
+     [](common &cmn, const benchPoints &in, double *out) {
+         for(int i = 0; i < in.n; i++) hftx10(cmn, out[i], in.t[i], in.w[i], 14.7); },
+     [](const benchPoints &in, double *out) {
+         sorpprops::air::enthalpy(in.n, in.t.constData(), in.w.constData(), out); }}
+};
+
+/// \return points per second of the fastest of the repeats
+template <typename Run>
+double pointsPerSecond(int points, int repeats, Run run)
+{
+    qint64 best = -1;
+    for(int r = 0; r < repeats; r++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        run();
+        qint64 elapsed = timer.nsecsElapsed();
+        if(best < 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best > 0 ? points * 1.e9 / best : 0;
+}
+
+}
+
+int propBench::benchMain(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments();
+    int points = args.count() > 2 ? args.at(2).toInt() : 100000;
+    int repeats = args.count() > 3 ? args.at(3).toInt() : 5;
+    if(points < 1 || repeats < 1)
+    {
+        QTextStream(stderr) << "usage: " << args.first()
+                            << " --bench-properties [points] [repeats]" << Qt::endl;
+        return 1;
+    }
+
+    int engineArgc = 0;
+    char const* engineArgv[1];
+    common cmn(engineArgc, engineArgv);
+    benchPoints in = makePoints(points);
+    QVector<double> reference(points), result(points);
+
+    out << points << " points, best of " << repeats << " runs, AVX2 "
+        << (sorpprops::simdAvailable() ? "available" : "not available") << Qt::endl;
+    out << QString("%1 %2 %3 %4 %5").arg("property", -38).arg("engine/s", 12)
+           .arg("batch/s", 12).arg("AVX2/s", 12).arg("max rel. diff", 14) << Qt::endl;
+    for(unsigned c = 0; c < sizeof(cases)/sizeof(cases[0]); c++)
+    {
+        const benchCase &bench = cases[c];
+        double engine = pointsPerSecond(points, repeats, [&]() {
+            bench.engine(cmn, in, reference.data()); });
+        sorpprops::setSimdEnabled(false);
+        double scalar = pointsPerSecond(points, repeats, [&]() {
+            bench.batch(in, result.data()); });
+        double simd = 0;
+        if(sorpprops::simdAvailable())
+        {
+            sorpprops::setSimdEnabled(true);
+            simd = pointsPerSecond(points, repeats, [&]() {
+                bench.batch(in, result.data()); });
+        }
+
+        double difference = 0;
+        for(int i = 0; i < points; i++)
+            difference = qMax(difference, fabs(result.at(i) - reference.at(i))
+                              / qMax(1.e-12, fabs(reference.at(i))));
+        out << QString("%1 %2 %3 %4 %5").arg(bench.name, -38)
+               .arg(engine, 12, 'g', 4).arg(scalar, 12, 'g', 4)
+               .arg(simd, 12, 'g', 4).arg(difference, 14, 'g', 3) << Qt::endl;
+    }
+    sorpprops::setSimdEnabled(true);
+    return 0;
+}
@@ -0,0 +1,25 @@
+/*! \file propbench.h
+    \brief Microbenchmark of the batch property evaluation
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPBENCH_H
+#define PROPBENCH_H
+
+/*!
+Compares the throughput of the property routines of the engine (one point per
+call through sorpsim4l::common) with the batch functions of sorpprops, with and
+without AVX2.
+
+Started with "--bench-properties [points] [repeats]"; prints a table of points
+per second for each property to stdout. The points are spread over the valid
+range of each correlation, the same points are used for all three paths.
+*/
+class propBench
+{
+public:
+    static int benchMain(int argc, char *argv[]);
+};
+
+#endif // PROPBENCH_H
@@ -42,6 +42,171 @@ extern unit * dummy;
 extern QRect mainwindowSize;
 extern MainWindow*theMainwindow;
 
+namespace {
+
+QString csvField(QString text)
+{
+    text.replace('\n',' ');
+    if(text.contains(',') || text.contains('"'))
+        text = "\""+text.replace("\"","\"\"")+"\"";
+    return text;
+}
+
+/// temperature difference scale of calculate::buildInputs() for iht 4/5
+double heatSpecScale()
+{
+    if(globalpara.unitindex_temperature == 3)
+        return 1;
+    if(globalpara.unitindex_temperature == 1)
+        return 1.8;
+    return 10;
+}
+
+}
+
+double resultDialog::displayScale(int quantity, int iht, QString &unitName)
+{
+    // temperatures are differences here, without the offsets of the scales
+    double temperatureScale = convert(1.0,temperature[3],temperature[globalpara.unitindex_temperature])
+            - convert(0.0,temperature[3],temperature[globalpara.unitindex_temperature]);
+    unitName = "-";
+    switch(quantity)
+    {
+    case sensitivityReport::Temperature:
+        unitName = globalpara.unitname_temperature;
+        return temperatureScale;
+    case sensitivityReport::Enthalpy:
+        unitName = globalpara.unitname_enthalpy;
+        return convert(1.0,enthalpy[2],enthalpy[globalpara.unitindex_enthalpy]);
+    case sensitivityReport::MassFlow:
+        unitName = globalpara.unitname_massflow;
+        return convert(1.0,mass_flow_rate[1],mass_flow_rate[globalpara.unitindex_massflow]);
+    case sensitivityReport::Concentration:
+        unitName = "%";
+        return 1;
+    case sensitivityReport::Pressure:
+        unitName = globalpara.unitname_pressure;
+        return convert(1.0,pressure[8],pressure[globalpara.unitindex_pressure]);
+    case sensitivityReport::HeatSpec:
+        if(iht == 0)
+            return displayScale(sensitivityReport::HeatTransfer,0,unitName);
+        if(iht == 1)
+            return displayScale(sensitivityReport::UAValue,0,unitName);
+        if(iht == 4 || iht == 5)
+            return displayScale(sensitivityReport::Temperature,0,unitName);
+        return 1;
+    case sensitivityReport::HeatTransfer:
+    case sensitivityReport::Capacity:
+        unitName = globalpara.unitname_heatquantity;
+        return convert(1.0,heat_trans_rate[7],heat_trans_rate[globalpara.unitindex_heat_trans_rate]);
+    case sensitivityReport::UAValue:
+        unitName = globalpara.unitname_UAvalue;
+        return convert(1.0,UA[1],UA[globalpara.unitindex_UA]);
+    default:
+        return 1;
+    }
+}
+
+QString resultDialog::sensitivityName(const sensitivityReport::item &item)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::COP:
+        return "System COP";
+    case sensitivityReport::Capacity:
+        return "System Capacity";
+    case sensitivityReport::HeatSpec:
+    case sensitivityReport::HeatTransfer:
+    case sensitivityReport::UAValue:
+        break;
+    default:
+    {
+        const char *names = "THFCPW";
+        return "sp#"+QString::number(item.index)+" "+QLatin1Char(names[item.quantity]);
+    }
+    }
+
+    unit *iterator = dummy;
+    for(int i = 0; i < item.index && iterator->next != NULL; i++)
+        iterator = iterator->next;
+    QString name = iterator->unitName+"#"+QString::number(item.index)+" ";
+    if(item.quantity == sensitivityReport::HeatTransfer)
+        return name+"HT";
+    if(item.quantity == sensitivityReport::UAValue)
+        return name+"UA";
+    const char *specs[6] = {"HT","UA","NTU","EFF","CAT","LMTD"};
+    return name+specs[qBound(0,int(item.iht),5)];
+}
+
+QString resultDialog::sensitivityUnit(const sensitivityReport::item &item)
+{
+    QString name;
+    displayScale(item.quantity,item.iht,name);
+    return name;
+}
+
+double resultDialog::inputToCase(const sensitivityReport::item &item, double value)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::Temperature:
+        return convert(value,temperature[3],temperature[globalpara.unitindex_temperature]);
+    case sensitivityReport::MassFlow:
+        return convert(value,mass_flow_rate[1],mass_flow_rate[globalpara.unitindex_massflow]);
+    case sensitivityReport::Pressure:
+        return convert(value,pressure[8],pressure[globalpara.unitindex_pressure]);
+    case sensitivityReport::HeatSpec:
+        if(item.iht == 0)
+            return convert(value,heat_trans_rate[7],heat_trans_rate[globalpara.unitindex_heat_trans_rate]);
+        if(item.iht == 1)
+            return convert(value,UA[1],UA[globalpara.unitindex_UA]);
+        if(item.iht == 4 || item.iht == 5)
+            return value/heatSpecScale();
+        return value;
+    default:
+        return value;
+    }
+}
+
+double resultDialog::inputToEngine(const sensitivityReport::item &item, double value)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::Temperature:
+        return convert(value,temperature[globalpara.unitindex_temperature],temperature[3]);
+    case sensitivityReport::MassFlow:
+        return convert(value,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[1]);
+    case sensitivityReport::Pressure:
+        return convert(value,pressure[globalpara.unitindex_pressure],pressure[8]);
+    case sensitivityReport::HeatSpec:
+        if(item.iht == 0)
+            return convert(value,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[7]);
+        if(item.iht == 1)
+            return convert(value,UA[globalpara.unitindex_UA],UA[1]);
+        if(item.iht == 4 || item.iht == 5)
+            return value*heatSpecScale();
+        return value;
+    default:
+        return value;
+    }
+}
+
+double resultDialog::resultToCase(const sensitivityReport::item &item, double value)
+{
+    if(item.quantity == sensitivityReport::Temperature)
+        return convert(value,temperature[3],temperature[globalpara.unitindex_temperature]);
+    QString unitName;
+    return value*displayScale(item.quantity,item.iht,unitName);
+}
+
+double resultDialog::resultToEngine(const sensitivityReport::item &item, double value)
+{
+    if(item.quantity == sensitivityReport::Temperature)
+        return convert(value,temperature[globalpara.unitindex_temperature],temperature[3]);
+    QString unitName;
+    return value/displayScale(item.quantity,item.iht,unitName);
+}
+
 resultDialog::resultDialog(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::resultDialog)
@@ -291,12 +456,21 @@ resultDialog::resultDialog(QWidget *parent) :
         iterator = iterator->next;
     }
 
+    sensTable = NULL;
+    if(globalpara.lastSensitivity.isValid())
+    {
+        sensTable = new QTableWidget();
+        setupSensitivityTable();
+        ui->tabWidget->insertTab(-1,sensTable,"Sensitivity");
+    }
+
     ui->exportBox->addItem("Export...");
     ui->exportBox->addItem("Copy table content");
     ui->exportBox->addItem("Copy table w/ header");
     ui->exportBox->addItem("Copy selected content");
     ui->exportBox->addItem("Copy selected w/ header");
     ui->exportBox->addItem("Export to file..");
+    ui->exportBox->addItem("Export to CSV..");
 
     initializing = false;
 }
@@ -592,6 +766,8 @@ void resultDialog::on_exportBox_activated(const QString &arg1)
         }
         setGeometry(oldGeo);
     }
+    else if(arg1 == "Export to CSV..")
+        exportCsv(currentTable);
 
     if(copied)
     {
@@ -603,6 +779,77 @@ void resultDialog::on_exportBox_activated(const QString &arg1)
     ui->exportBox->setCurrentIndex(0);
 }
 
+void resultDialog::setupSensitivityTable()
+{
+    const sensitivityReport &report = globalpara.lastSensitivity;
+    sensTable->setRowCount(report.outputs.count());
+    sensTable->setColumnCount(report.inputs.count()+1);
+
+    QStringList header;
+    header<<"Result";
+    QVector<double> inScale;
+    QString unitName;
+    foreach(const sensitivityReport::item &input, report.inputs)
+    {
+        inScale.append(displayScale(input.quantity,input.iht,unitName));
+        header<<"d/d "+sensitivityName(input)+"\n["+unitName+"]";
+    }
+    sensTable->setHorizontalHeaderLabels(header);
+    QHeaderView *sensheader = sensTable->horizontalHeader();
+    sensheader->setSectionResizeMode(QHeaderView::ResizeToContents);
+    sensTable->setAlternatingRowColors(true);
+    sensTable->verticalHeader()->setVisible(false);
+
+    for(int o = 0; o < report.outputs.count(); o++)
+    {
+        const sensitivityReport::item &output = report.outputs.at(o);
+        double outScale = displayScale(output.quantity,output.iht,unitName);
+
+        QTableWidgetItem *item = new QTableWidgetItem;
+        item->setText(sensitivityName(output)+" ["+unitName+"]");
+        item->setFlags(Qt::ItemIsSelectable|Qt::ItemIsEnabled);
+        sensTable->setItem(o,0,item);
+
+        for(int i = 0; i < report.inputs.count(); i++)
+        {
+            item = new QTableWidgetItem;
+            item->setText(QString::number(report.value(o,i)*outScale/inScale.at(i),'g',4));
+            item->setFlags(Qt::ItemIsSelectable|Qt::ItemIsEnabled);
+            sensTable->setItem(o,i+1,item);
+        }
+    }
+}
+
+void resultDialog::exportCsv(QTableWidget *table)
+{
+    QString fileName = QFileDialog::getSaveFileName(this,"Export table as..","./","CSV File(*.csv)");
+    if(fileName=="")
+        return;
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Text))
+    {
+        globalpara.reportError("Fail to create and write into the new CSV file.",this);
+        return;
+    }
+    QTextStream stream(&file);
+    QStringList fields;
+    for(int j = 0; j < table->columnCount(); j++)
+        fields.append(csvField(table->horizontalHeaderItem(j)->text()));
+    stream<<fields.join(",")<<"\n";
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        fields.clear();
+        for(int j = 0; j < table->columnCount(); j++)
+        {
+            QTableWidgetItem *item = table->item(i,j);
+            fields.append(item == NULL ? QString() : csvField(item->text()));
+        }
+        stream<<fields.join(",")<<"\n";
+    }
+    file.close();
+}
+
 void resultDialog::adjustTableSize(bool onlySize)
 {
     QTableWidget * currentTable = dynamic_cast<QTableWidget *>(ui->tabWidget->currentWidget());
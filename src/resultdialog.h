@@ -20,6 +20,8 @@
 #include <QTableWidgetItem>
 #include <QTableWidget>
 
+#include "dataComm.h"
+
 namespace Ui {
 class resultDialog;
 }
@@ -27,6 +29,7 @@ class resultDialog;
 /// Dialog to display the calculation results of state points and components in tabular form
 /// - results stored in state point and component data structure are all in british units
 /// - this dialog converts the raw result values into the unit system of current case
+/// - with sensitivities calculated (see sensitivityReport), shows them in a tab of their own
 /// - called by mainwindow.cpp
 class resultDialog : public QDialog
 {
@@ -36,6 +39,23 @@ public:
     explicit resultDialog(QWidget *parent = 0);
     ~resultDialog();
 
+    /// Per unit of the engine, the value of quantity (sensitivityReport::Quantity)
+    /// in the unit system of the current case, whose name goes to unitName.
+    /// Temperatures are scaled as differences, without the offsets of the scales.
+    static double displayScale(int quantity, int iht, QString &unitName);
+    /// Name of an input or output of the sensitivity report, as "sp#3 T" or "ABS#2 UA"
+    static QString sensitivityName(const sensitivityReport::item &item);
+    /// Name of the unit an input or output of the sensitivity report is shown in
+    static QString sensitivityUnit(const sensitivityReport::item &item);
+    /// \name Values of the sensitivity report between the engine and the unit system of the case
+    /// A fixed input as the case holds it (inverse of calculate::buildInputs()), and a result as it is shown.
+    /// \{
+    static double inputToCase(const sensitivityReport::item &item, double value);
+    static double inputToEngine(const sensitivityReport::item &item, double value);
+    static double resultToCase(const sensitivityReport::item &item, double value);
+    static double resultToEngine(const sensitivityReport::item &item, double value);
+    /// \}
+
 private slots:
 
     void onTableItemChanged();
@@ -48,6 +68,8 @@ private slots:
 
 private:
     void adjustTableSize(bool onlySize=false);
+    void setupSensitivityTable();
+    void exportCsv(QTableWidget *table);
     void showEvent(QShowEvent *e);
 
     Ui::resultDialog *ui;
@@ -57,6 +79,7 @@ private:
     QTableWidget * unitTable;
     QTableWidget *LDACTable;
     QTableWidget *sysTable;
+    QTableWidget *sensTable;
     bool initializing;
 
     bool event(QEvent *e);
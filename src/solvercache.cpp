@@ -0,0 +1,229 @@
+/*! \file solvercache.cpp
+    \brief Cache of converged engine results, keyed by the inputs
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QScopedPointer>
+
+#include <math.h>
+
+#include "solvercache.h"
+#include "solverpool.h"
+#include "sorputils.h"
+
+namespace {
+
+const int memoryRuns = 64;
+const int neighboursPerCase = 32;
+const int diskRuns = 512;
+const int pruneInterval = 32;
+/// largest relative difference of any input value for nearest()
+const double nearLimit = 0.25;
+const quint32 diskMagic = 0x534f5243;
+const QDataStream::Version streamVersion = QDataStream::Qt_5_6;
+
+bool converged(const calOutputs &result)
+{
+    return !result.stopped && result.IER >= 1 && result.IER <= 3;
+}
+
+}
+
+solverCache::solverCache() :
+    enabled(true),
+    disk(false),
+    diskWrites(0),
+    results(memoryRuns)
+{
+}
+
+solverCache *solverCache::shared()
+{
+    static solverCache cache;
+    return &cache;
+}
+
+void solverCache::setEnabled(bool on)
+{
+    enabled = on;
+}
+
+bool solverCache::isEnabled() const
+{
+    return enabled;
+}
+
+void solverCache::setDiskStore(bool on)
+{
+    disk = on;
+}
+
+bool solverCache::hasDiskStore() const
+{
+    return disk;
+}
+
+void solverCache::clear()
+{
+    results.clear();
+    neighbours.clear();
+    QDir dir = diskDir();
+    if(dir.exists())
+        dir.removeRecursively();
+}
+
+bool solverCache::lookup(const calInputs &in, calOutputs &result)
+{
+    if(!enabled)
+        return false;
+    QString key = solverInputHash(in);
+    calOutputs *cached = results.object(key);
+    if(cached == NULL && disk)
+    {
+        QScopedPointer<calOutputs> read(new calOutputs);
+        if(readDisk(key, *read))
+        {
+            cached = read.take();
+            results.insert(key, cached);
+        }
+    }
+    if(cached == NULL)
+        return false;
+    result = *cached;
+    result.fromCache = true;
+    return true;
+}
+
+void solverCache::store(const calInputs &in, const calOutputs &result)
+{
+    if(!enabled || !converged(result))
+        return;
+    QString key = solverInputHash(in);
+    calOutputs *kept = new calOutputs(result);
+    kept->fromCache = false;
+    kept->warmStarted = false;
+    results.insert(key, kept);
+
+    if(kept->state.isValid())
+    {
+        QList<neighbour> &list = neighbours[kept->state.structureHash];
+        for(int i = 0; i < list.count(); i++)
+            if(list.at(i).key == key)
+            {
+                list.removeAt(i);
+                break;
+            }
+        neighbour entry;
+        entry.key = key;
+        entry.values = values(in);
+        entry.state = kept->state;
+        list.append(entry);
+        if(list.count() > neighboursPerCase)
+            list.removeFirst();
+    }
+
+    if(disk)
+        writeDisk(key, *kept);
+}
+
+solverState solverCache::nearest(const calInputs &in) const
+{
+    if(!enabled)
+        return solverState();
+    QString structure = solverStructureHash(in);
+    if(!neighbours.contains(structure))
+        return solverState();
+
+    QVector<double> target = values(in);
+    const QList<neighbour> list = neighbours.value(structure);
+    int best = -1;
+    double bestDistance = nearLimit;
+    for(int n = 0; n < list.count(); n++)
+    {
+        const neighbour &entry = list.at(n);
+        if(entry.values.count() != target.count())
+            continue;
+        // the largest relative change decides, so one far off value rules a run out
+        double distance = 0;
+        for(int i = 0; i < target.count() && distance <= bestDistance; i++)
+        {
+            double a = target.at(i), b = entry.values.at(i);
+            double scale = qMax(fabs(a), fabs(b));
+            if(scale > 0)
+                distance = qMax(distance, fabs(a-b)/scale);
+        }
+        if(distance <= bestDistance)
+        {
+            best = n;
+            bestDistance = distance;
+        }
+    }
+    return best < 0 ? solverState() : list.at(best).state;
+}
+
+QVector<double> solverCache::values(const calInputs &in)
+{
+    QVector<double> v;
+    for(int i = 1; i <= in.nunits && i < 50; i++)
+        v << in.ht[i] << in.devl[i] << in.devg[i] << in.wetness[i] << in.ntum[i]
+          << in.ntuw[i] << in.ntua[i] << in.le[i];
+    for(int i = 1; i <= in.nsp && i < 150; i++)
+        v << in.t[i] << in.f[i] << in.c[i] << in.p[i] << in.w[i];
+    return v;
+}
+
+QDir solverCache::diskDir() const
+{
+    QDir dir = Sorputils::sorpTempDir();
+    dir.mkpath("solverCache");
+    dir.cd("solverCache");
+    return dir;
+}
+
+bool solverCache::readDisk(const QString &key, calOutputs &result) const
+{
+    QFile file(diskDir().absoluteFilePath(key+".dat"));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(streamVersion);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+    // files of other versions are simply solved again and overwritten
+    if(magic != diskMagic || version != solverPool::protocolVersion)
+        return false;
+    stream >> result;
+    return stream.status() == QDataStream::Ok;
+}
+
+void solverCache::writeDisk(const QString &key, const calOutputs &result)
+{
+    QSaveFile file(diskDir().absoluteFilePath(key+".dat"));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug()<<"solver cache: can't write"<<file.fileName();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(streamVersion);
+    stream << diskMagic << solverPool::protocolVersion << result;
+    if(!file.commit())
+        qDebug()<<"solver cache: can't write"<<file.fileName();
+
+    if(++diskWrites % pruneInterval == 0)
+        pruneDisk();
+}
+
+void solverCache::pruneDisk()
+{
+    QFileInfoList files = diskDir().entryInfoList(QStringList()<<"*.dat", QDir::Files, QDir::Time);
+    for(int i = diskRuns; i < files.count(); i++)
+        QFile::remove(files.at(i).absoluteFilePath());
+}
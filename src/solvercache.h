@@ -0,0 +1,83 @@
+/*! \file solvercache.h
+    \brief Cache of converged engine results, keyed by the inputs
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SOLVERCACHE_H
+#define SOLVERCACHE_H
+
+#include <QCache>
+#include <QDir>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "dataComm.h"
+
+/*!
+Keeps the results of converged runs so that identical runs are not solved again.
+
+Re-running a table, switching a parameter back and forth or re-opening a case
+hands the engine inputs it has already solved. The results are kept under
+solverInputHash() of the inputs:
+- in memory for the most recent runs of this process
+- optionally as files in the "solverCache" folder of the temp directory, so
+  they survive a restart of the program (and are shared by running instances)
+
+For inputs that miss the cache, nearest() finds the cached run of the same
+flowsheet with the closest values, whose solver state is a better starting
+point than the guess values (see calInputs::warmStart).
+
+Only converged runs are kept. The cache is used by absdCal() for runs solved
+in this process and by the solverPool for runs sent to the workers; the
+workers themselves don't cache.
+*/
+class solverCache
+{
+public:
+    /// The cache of this process.
+    static solverCache *shared();
+
+    void setEnabled(bool on);
+    bool isEnabled() const;
+    /// Also keep results on disk.
+    void setDiskStore(bool on);
+    bool hasDiskStore() const;
+    /// Forgets all results, including the ones on disk.
+    void clear();
+
+    /// \return true and the results of an identical earlier run in result
+    bool lookup(const calInputs &in, calOutputs &result);
+    /// Keeps the results of a run if it converged.
+    void store(const calInputs &in, const calOutputs &result);
+    /// Solver state of the cached run of the same flowsheet closest to the inputs.
+    /// \return an invalid state if no run is close enough
+    solverState nearest(const calInputs &in) const;
+
+private:
+    solverCache();
+
+    struct neighbour
+    {
+        QString key;
+        QVector<double> values;
+        solverState state;
+    };
+
+    bool enabled;
+    bool disk;
+    int diskWrites;
+    QCache<QString,calOutputs> results;
+    /// recent runs by solverStructureHash(), newest last
+    QHash<QString,QList<neighbour> > neighbours;
+
+    QDir diskDir() const;
+    bool readDisk(const QString &key, calOutputs &result) const;
+    void writeDisk(const QString &key, const calOutputs &result);
+    void pruneDisk();
+    static QVector<double> values(const calInputs &in);
+};
+
+#endif // SOLVERCACHE_H
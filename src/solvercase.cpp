@@ -0,0 +1,339 @@
+/*! \file solvercase.cpp
+    \brief Engine inputs of a saved case, built without the GUI
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QDomDocument>
+#include <QFile>
+#include <QSet>
+#include <QStringList>
+
+#include "solvercase.h"
+#include "unitconvert.h"
+
+solverCase::solverCase() :
+    loaded(false),
+    base(),
+    original()
+{
+}
+
+bool solverCase::load(const QString &fileName, int temperatureUnit, QString *error)
+{
+    QFile file(fileName);
+    QDomDocument doc;
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        if(error)
+            *error = "Failed to open the case file "+fileName+".";
+        return false;
+    }
+    if(!doc.setContent(&file))
+    {
+        if(error)
+            *error = "Failed to load xml document from the case file "+fileName+".";
+        file.close();
+        return false;
+    }
+    file.close();
+
+    if(!load(doc.elementsByTagName("CaseData").at(0).toElement(), temperatureUnit, error))
+        return false;
+    caseFile = fileName;
+    return true;
+}
+
+bool solverCase::load(const QDomElement &caseData, int temperatureUnit, QString *error)
+{
+    loaded = false;
+    caseFile.clear();
+    spIndexes.clear();
+    base = calInputs();
+
+    QDomElement globalData = caseData.elementsByTagName("globalData").at(0).toElement();
+    if(globalData.isNull())
+    {
+        if(error)
+            *error = "The case file has no case data.";
+        return false;
+    }
+    int nunits = globalData.attribute("globalcount").toInt();
+    int nsp = globalData.attribute("spnumber").toInt();
+    if(nunits < 1 || nunits >= 50 || nsp < 1 || nsp >= 150)
+    {
+        if(error)
+            *error = "The case has "+QString::number(nunits)+" components and "
+                    +QString::number(nsp)+" state points, which the engine can't handle.";
+        return false;
+    }
+
+    base.title = "title";
+    base.tmax = globalData.attribute("tmax").toFloat();
+    base.tmin = globalData.attribute("tmin").toFloat();
+    base.fmax = globalData.attribute("fmax").toFloat();
+    base.pmax = globalData.attribute("pmax").toFloat();
+    base.maxfev = globalData.attribute("maxfev").toInt();
+    base.msglvl = base.maxfev;
+    base.ftol = globalData.attribute("ftol").toDouble();
+    base.xtol = globalData.attribute("xtol").toDouble();
+    base.fastProperties = globalData.attribute("fastProperties") == "1";
+    base.if97Water = globalData.attribute("if97Water") == "1";
+    base.solverMethod = qBound(int(calInputs::Hybrid), globalData.attribute("solverMethod").toInt(),
+                               int(calInputs::BoundedTrustRegion));
+    base.autoScaling = globalData.attribute("autoScaling") == "1" && base.solverMethod == calInputs::Hybrid;
+    base.nunits = nunits;
+    base.nsp = nsp;
+
+    // same factor as calculate::calc(): temperature differences to F
+    double conv = 10;
+    if(temperatureUnit==3)
+    {
+        conv = 1;
+    }
+    else if(temperatureUnit ==1)
+    {
+        conv = 1.8;
+    }
+
+    QSet<int> spFound;
+    QMap<int,int> sensors;// thermostatic valve sensor point -> point it reads
+    for(int count = 1; count <= nunits; count++)
+    {
+        QDomElement unitData = caseData.elementsByTagName("Unit"+QString::number(count)).at(0).toElement();
+        if(unitData.isNull())
+        {
+            if(error)
+                *error = "Component "+QString::number(count)+" is missing in the case file.";
+            return false;
+        }
+        int idunit = unitData.attribute("idunit").toInt();
+        int iht = unitData.attribute("iht").toInt();
+        int usp = unitData.attribute("usp").toInt();
+        double ht = unitData.attribute("ht").toDouble();
+        double devl = unitData.attribute("devl").toDouble();
+        double devg = unitData.attribute("devg").toDouble();
+
+        base.idunit[count] = idunit;
+        base.iht[count] = iht;
+        if(idunit==81||idunit==82)
+        {
+            base.ht[count] = ht;
+            base.ipinch[count] = 0;
+            base.devl[count] = 0;
+            base.devg[count] = 0;
+            base.icop[count] = 0;
+        }
+        else
+        {
+            // ht is stored in engine units, except that the temperature based
+            // specifications went through a temperature (not difference) conversion
+            if(iht==4||iht==5)
+                base.ht[count] = convert(ht,temperature[3],temperature[temperatureUnit])*conv;
+            else
+                base.ht[count] = ht;
+            base.ipinch[count] = unitData.attribute("ipinch").toInt();
+            if(idunit==62||idunit==63)//power law of throttle valve, sensor of thermostatic valve
+                base.devl[count] = devl;
+            else
+                base.devl[count] = devl*conv;
+            base.devg[count] = devg*conv;
+            base.icop[count] = unitData.attribute("icop").toInt();
+        }
+        base.wetness[count] = unitData.attribute("wetness").toDouble();
+        base.ntua[count] = unitData.attribute("ntua").toDouble();
+        base.ntum[count] = unitData.attribute("ntum").toDouble();
+        base.ntuw[count] = unitData.attribute("ntut").toDouble();
+        base.nIter[count] = unitData.attribute("nIter").toInt();
+        base.le[count] = unitData.attribute("le").toDouble();
+
+        for(int j = 0; j < 7; j++)
+            base.isp[count][j] = 0;
+        for(int j = 0; j < usp && j < 7; j++)
+        {
+            QDomElement spData = unitData.elementsByTagName("StatePoint"+QString::number(j+1)).at(0).toElement();
+            int ndum = spData.attribute("ndum").toInt();
+            if(ndum < 1 || ndum > nsp)
+            {
+                if(error)
+                    *error = "State point "+QString::number(count)+" "+QString::number(j+1)
+                            +" has no valid index in the case file.";
+                return false;
+            }
+            base.isp[count][j] = ndum;
+            spIndexes.insert(QString::number(count)+" "+QString::number(j+1), ndum);
+            if(idunit==63&&j==2)
+                sensors.insert(ndum, int(devl));
+
+            // the first point found defines the state point, as in calculate::calc()
+            if(spFound.contains(ndum))
+                continue;
+            spFound.insert(ndum);
+            base.ksub[ndum] = spData.attribute("ksub").toInt();
+            base.itfix[ndum] = spData.attribute("itfix").toInt();
+            base.iffix[ndum] = spData.attribute("iffix").toInt();
+            base.icfix[ndum] = spData.attribute("icfix").toInt();
+            base.ipfix[ndum] = spData.attribute("ipfix").toInt();
+            base.iwfix[ndum] = spData.attribute("iwfix").toInt();
+            base.t[ndum] = spData.attribute("t").toFloat();
+            base.f[ndum] = spData.attribute("f").toFloat();
+            base.c[ndum] = spData.attribute("c").toFloat();
+            base.p[ndum] = spData.attribute("p").toFloat();
+            base.w[ndum] = spData.attribute("w").toFloat();
+        }
+    }
+    if(spFound.count() != nsp)
+    {
+        if(error)
+            *error = "The state point indexes in the case file are not continuous.";
+        return false;
+    }
+
+    // the sensor of a thermostatic valve mirrors the point it reads, see MainWindow::loadCase()
+    foreach(int sensor, sensors.keys())
+    {
+        int read = sensors.value(sensor);
+        if(read < 1 || read > nsp)
+            continue;
+        base.itfix[sensor] = base.itfix[read];
+        base.t[sensor] = base.t[read];
+        base.iffix[sensor] = 0;
+        base.icfix[sensor] = 0;
+        base.ipfix[sensor] = 0;
+        base.iwfix[sensor] = 0;
+    }
+
+    // scaling ranges have to cover the guess values, see globalparameter::checkMinMax()
+    for(int i = 1; i <= nsp; i++)
+    {
+        base.tmax = qMax(base.tmax, base.t[i]);
+        base.tmin = qMin(base.tmin, base.t[i]);
+        base.fmax = qMax(base.fmax, base.f[i]);
+        base.pmax = qMax(base.pmax, base.p[i]);
+    }
+
+    original = base;
+    loaded = true;
+    return true;
+}
+
+bool solverCase::isLoaded() const
+{
+    return loaded;
+}
+
+QString solverCase::fileName() const
+{
+    return caseFile;
+}
+
+const calInputs &solverCase::inputs() const
+{
+    return base;
+}
+
+int solverCase::spIndex(const QString &index) const
+{
+    QStringList parts = index.simplified().split(" ");
+    if(parts.count() == 2)
+        return spIndexes.value(parts.first()+" "+parts.last(), 0);
+    int ndum = index.toInt();
+    if(ndum < 1 || ndum > base.nsp)
+        return 0;
+    return ndum;
+}
+
+bool solverCase::applyOverride(calInputs &runInputs, const QString &type, const QString &index,
+                               const QString &parameter, double value, QString *error) const
+{
+    if(type == "sp")
+    {
+        int ndum = spIndex(index);
+        if(ndum == 0)
+        {
+            if(error)
+                *error = "No state point "+index+".";
+            return false;
+        }
+        if(parameter == "T")
+            runInputs.t[ndum] = value;
+        else if(parameter == "P")
+            runInputs.p[ndum] = value;
+        else if(parameter == "F")
+            runInputs.f[ndum] = value;
+        else if(parameter == "W")
+            runInputs.w[ndum] = value;
+        else if(parameter == "C")
+            runInputs.c[ndum] = value;
+        else
+        {
+            if(error)
+                *error = "Unknown state point parameter "+parameter+".";
+            return false;
+        }
+        if(parameter == "T")
+        {
+            runInputs.tmax = qMax<float>(runInputs.tmax, value);
+            runInputs.tmin = qMin<float>(runInputs.tmin, value);
+        }
+        else if(parameter == "P")
+            runInputs.pmax = qMax<float>(runInputs.pmax, value);
+        else if(parameter == "F")
+            runInputs.fmax = qMax<float>(runInputs.fmax, value);
+        return true;
+    }
+    if(type == "unit")
+    {
+        int uInd = index.toInt();
+        if(uInd < 1 || uInd > base.nunits)
+        {
+            if(error)
+                *error = "No component "+index+".";
+            return false;
+        }
+        if(parameter=="WT")
+            runInputs.wetness[uInd] = value;
+        else if(parameter=="NM")
+            runInputs.ntum[uInd] = value;
+        else if(parameter=="NW")
+            runInputs.ntuw[uInd] = value;
+        else if(parameter=="NA")
+            runInputs.ntua[uInd] = value;
+        else if(parameter=="HT")
+            runInputs.ht[uInd] = value;
+        else
+        {
+            if(error)
+                *error = "Unknown component parameter "+parameter+".";
+            return false;
+        }
+        return true;
+    }
+    if(error)
+        *error = "Unknown input type "+type+".";
+    return false;
+}
+
+void solverCase::updateGuesses(const calOutputs &result)
+{
+    if(result.state.isValid())
+        base.warmStart = result.state;
+    for(int i = 1; i <= base.nsp; i++)
+    {
+        if(base.itfix[i]>0)
+            base.t[i] = result.t[i];
+        if(base.icfix[i]>0)
+            base.c[i] = result.c[i];
+        if(base.iffix[i]>0)
+            base.f[i] = result.f[i];
+        if(base.ipfix[i]>0)
+            base.p[i] = result.p[i];
+        if(base.iwfix[i]>0)
+            base.w[i] = result.w[i];
+    }
+}
+
+void solverCase::resetGuesses()
+{
+    base = original;
+}
@@ -0,0 +1,78 @@
+/*! \file solvercase.h
+    \brief Engine inputs of a saved case, built without the GUI
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SOLVERCASE_H
+#define SOLVERCASE_H
+
+#include <QString>
+#include <QMap>
+#include <QDomElement>
+
+#include "dataComm.h"
+
+/*!
+Engine inputs of a saved case, built directly from the case file.
+
+MainWindow::loadCase() rebuilds the whole scene (units, nodes, links) before
+calculate::calc() collects the calInputs from it. Headless users (the solver
+server) only need the calInputs, so this class reads them straight from the
+CaseData element, using the state point indexes (ndum) stored in the file.
+
+- all values are in the units of the case file, i.e. the engine's own units
+  (F, psia, lb/min, Btu/lb, Btu/min, Btu/min-F)
+- devl/devg and the temperature based heat transfer specifications (iht 4/5) are
+  stored as temperature differences in the unit system that was active when the
+  case was saved, which the file does not record; it has to be given to load()
+- overrides use the same addressing and parameter names as the parametric
+  table inputs (see tableDialog::calcTable()), but are applied to the engine
+  state point only, the engine's equations take care of points tied to it
+- called by solverServer
+*/
+class solverCase
+{
+public:
+    solverCase();
+
+    /// Reads the case file.
+    /// \param temperatureUnit index into temperature[] the case was saved with
+    bool load(const QString &fileName, int temperatureUnit, QString *error);
+    /// \overload for an already parsed case file
+    bool load(const QDomElement &caseData, int temperatureUnit, QString *error);
+
+    bool isLoaded() const;
+    QString fileName() const;
+
+    /// The inputs as read from the file (with guess values updated by updateGuesses()).
+    const calInputs &inputs() const;
+
+    /// Engine state point index of a point given as "unit local" (as in the table) or as its index.
+    /// \return 0 if there is no such point
+    int spIndex(const QString &index) const;
+
+    /// Applies one table style input to a copy of the case inputs.
+    /// \param type "sp" or "unit"
+    /// \param parameter T/P/F/W/C for state points, WT/NM/NW/NA/HT for units
+    bool applyOverride(calInputs &runInputs, const QString &type, const QString &index,
+                       const QString &parameter, double value, QString *error) const;
+
+    /// Uses the converged values as guess values of the variables for the next runs
+    /// (same as the "update guess values" option of the table), and the solver
+    /// state of the run as their warm start.
+    void updateGuesses(const calOutputs &result);
+
+    /// Restores the guess values read from the file.
+    void resetGuesses();
+
+private:
+    QString caseFile;
+    bool loaded;
+    calInputs base;
+    calInputs original;
+    /// "unit local" to engine state point index
+    QMap<QString,int> spIndexes;
+};
+
+#endif // SOLVERCASE_H
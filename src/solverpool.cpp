@@ -0,0 +1,413 @@
+/*! \file solverpool.cpp
+    \brief Pool of solver worker processes for crash-isolated parallel runs
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QEventLoop>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include <stdio.h>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#define sorp_dup _dup
+#define sorp_dup2 _dup2
+#define sorp_fdopen _fdopen
+#define sorp_fileno _fileno
+#else
+#include <unistd.h>
+#define sorp_dup dup
+#define sorp_dup2 dup2
+#define sorp_fdopen fdopen
+#define sorp_fileno fileno
+#endif
+
+#include "solvercache.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+const QDataStream::Version streamVersion = QDataStream::Qt_5_6;
+
+/// Every message is a 4 byte big endian length followed by a QDataStream payload.
+QByteArray frame(const QByteArray &payload)
+{
+    uchar size[4];
+    qToBigEndian<quint32>(payload.size(), size);
+    return QByteArray(reinterpret_cast<const char *>(size), 4) + payload;
+}
+
+/// Removes one complete message from the front of the buffer, if there is one.
+bool takeFrame(QByteArray &buffer, QByteArray &payload)
+{
+    if(buffer.size() < 4)
+        return false;
+    quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(buffer.constData()));
+    if(quint32(buffer.size()) < 4 + size)
+        return false;
+    payload = buffer.mid(4, size);
+    buffer.remove(0, 4 + size);
+    return true;
+}
+
+bool readExactly(FILE *file, char *data, size_t size)
+{
+    while(size > 0)
+    {
+        size_t got = fread(data, 1, size, file);
+        if(got == 0)
+            return false;
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+const calOutputs &noOutputs()
+{
+    static const calOutputs empty = calOutputs();
+    return empty;
+}
+
+}
+
+solverPool::solverPool(int workerCount, QObject *parent) :
+    QObject(parent),
+    nWorkers(workerCount > 0 ? workerCount : QThread::idealThreadCount()),
+    pending(0),
+    nextRun(0),
+    remaining(0),
+    runTimeout(0),
+    cancelled(false),
+    loop(0)
+{
+    if(nWorkers < 1)
+        nWorkers = 1;
+}
+
+solverPool::~solverPool()
+{
+    for(int i = 0; i < workers.count(); i++)
+    {
+        QProcess *process = workers[i].process;
+        if(process == NULL)
+            continue;
+        process->disconnect(this);
+        process->closeWriteChannel();
+        if(!process->waitForFinished(1000))
+            process->kill();
+    }
+}
+
+solverPool *solverPool::shared()
+{
+    static solverPool *pool = NULL;
+    if(pool == NULL)
+        pool = new solverPool(0, QCoreApplication::instance());
+    return pool;
+}
+
+int solverPool::workerCount() const
+{
+    return nWorkers;
+}
+
+bool solverPool::startWorker(int index)
+{
+    worker &w = workers[index];
+    if(w.process != NULL)
+    {
+        w.process->disconnect(this);
+        w.process->deleteLater();
+    }
+    w.buffer.clear();
+    w.run = -1;
+    w.killed = false;
+    w.aborted = false;
+
+    w.process = new QProcess(this);
+    // the engine is chatty on stderr (qDebug); nobody reads it
+    w.process->setStandardErrorFile(QProcess::nullDevice());
+    connect(w.process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadyRead()));
+    connect(w.process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onFinished()));
+    w.process->start(QCoreApplication::applicationFilePath(), QStringList() << "--solver-worker");
+    if(!w.process->waitForStarted())
+    {
+        qDebug()<<"solver worker"<<index<<"failed to start:"<<w.process->errorString();
+        w.process->disconnect(this);
+        w.process->deleteLater();
+        w.process = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool solverPool::solve(const QVector<calInputs> &runs, int timeoutMs, const resultHandler &onResult,
+                       const warmStartHandler &warmStart)
+{
+    if(loop != NULL)
+        return false;
+
+    while(workers.count() < nWorkers)
+    {
+        worker w;
+        w.process = NULL;
+        w.timer = new QTimer(this);
+        w.timer->setSingleShot(true);
+        connect(w.timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+        w.run = -1;
+        w.killed = false;
+        w.aborted = false;
+        workers.append(w);
+    }
+    int running = 0;
+    for(int i = 0; i < workers.count(); i++)
+    {
+        if(workers[i].process == NULL || workers[i].process->state() != QProcess::Running)
+            startWorker(i);
+        if(workers[i].process != NULL)
+            running++;
+    }
+    if(running == 0)
+        return false;
+
+    pending = &runs;
+    handler = onResult;
+    seeder = warmStart;
+    nextRun = 0;
+    remaining = runs.count();
+    runTimeout = timeoutMs;
+    cancelled = false;
+
+    if(remaining > 0)
+    {
+        QEventLoop eventLoop;
+        loop = &eventLoop;
+        dispatch();
+        if(remaining > 0)
+            eventLoop.exec();
+        loop = NULL;
+    }
+
+    pending = NULL;
+    handler = resultHandler();
+    seeder = warmStartHandler();
+    return true;
+}
+
+void solverPool::cancel()
+{
+    cancelled = true;
+}
+
+void solverPool::abort()
+{
+    cancelled = true;
+    for(int i = 0; i < workers.count(); i++)
+    {
+        worker &w = workers[i];
+        if(w.process == NULL || w.run < 0 || w.aborted)
+            continue;
+        w.aborted = true;
+        // onFinished() reports the run as cancelled and restarts the worker
+        w.process->kill();
+    }
+}
+
+void solverPool::dispatch()
+{
+    solverCache *cache = solverCache::shared();
+    // calInputs and calOutputs are too large for the stack
+    QScopedPointer<calOutputs> cached(new calOutputs);
+    QScopedPointer<calInputs> job(new calInputs);
+    for(int i = 0; i < workers.count(); i++)
+    {
+        worker &w = workers[i];
+        if(w.process == NULL || w.run >= 0)
+            continue;
+
+        if(cancelled)
+            break;
+        // runs solved before don't need a worker
+        while(nextRun < pending->count() && cache->lookup(pending->at(nextRun), *cached))
+            report(nextRun++, Finished, *cached);
+        if(nextRun >= pending->count())
+            break;
+
+        w.run = nextRun++;
+        *job = pending->at(w.run);
+        if(!job->warmStart.isValid() && seeder)
+            job->warmStart = seeder(w.run);
+        if(!job->warmStart.isValid())
+            job->warmStart = cache->nearest(*job);
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(streamVersion);
+        stream << protocolVersion << qint32(w.run) << *job;
+        w.process->write(frame(payload));
+        if(runTimeout > 0)
+            w.timer->start(runTimeout);
+    }
+
+    if(cancelled)
+    {
+        while(nextRun < pending->count())
+            report(nextRun++, Cancelled, noOutputs());
+    }
+}
+
+void solverPool::report(int run, Status status, const calOutputs &result)
+{
+    if(handler)
+        handler(run, status, result);
+    remaining--;
+    if(remaining <= 0 && loop != NULL)
+        loop->quit();
+}
+
+int solverPool::indexOf(QObject *object) const
+{
+    for(int i = 0; i < workers.count(); i++)
+        if(workers[i].process == object || workers[i].timer == object)
+            return i;
+    return -1;
+}
+
+void solverPool::onReadyRead()
+{
+    int index = indexOf(sender());
+    if(index < 0)
+        return;
+    worker &w = workers[index];
+    w.buffer.append(w.process->readAllStandardOutput());
+
+    QByteArray payload;
+    while(takeFrame(w.buffer, payload))
+    {
+        QDataStream stream(payload);
+        stream.setVersion(streamVersion);
+        qint32 run = -1, code = 0;
+        // calOutputs is too large for the stack
+        QScopedPointer<calOutputs> result(new calOutputs);
+        stream >> run >> code >> *result;
+        if(stream.status() != QDataStream::Ok || run != w.run)
+        {
+            // out of sync with the worker; onFinished() reports the run as crashed
+            qDebug()<<"solver worker"<<index<<"sent a malformed reply for run"<<w.run;
+            w.process->kill();
+            return;
+        }
+        w.timer->stop();
+        w.run = -1;
+        if(pending != NULL)
+            solverCache::shared()->store(pending->at(run), *result);
+        report(run, Finished, *result);
+    }
+    if(pending != NULL)
+        dispatch();
+}
+
+void solverPool::onFinished()
+{
+    int index = indexOf(sender());
+    if(index < 0)
+        return;
+    worker &w = workers[index];
+    w.timer->stop();
+    int run = w.run;
+    Status status = w.killed ? TimedOut : (w.aborted ? Cancelled : Crashed);
+    if(!startWorker(index))
+        qDebug()<<"solver worker"<<index<<"could not be restarted";
+    if(run >= 0)
+        report(run, status, noOutputs());
+
+    if(pending == NULL)
+        return;
+    bool anyAlive = false;
+    for(int i = 0; i < workers.count(); i++)
+        anyAlive = anyAlive || workers[i].process != NULL;
+    if(!anyAlive)
+    {
+        // nobody left to do the work
+        cancelled = true;
+        dispatch();
+        return;
+    }
+    dispatch();
+}
+
+void solverPool::onTimeout()
+{
+    int index = indexOf(sender());
+    if(index < 0 || workers[index].process == NULL)
+        return;
+    qDebug()<<"solver worker"<<index<<"timed out on run"<<workers[index].run;
+    workers[index].killed = true;
+    // onFinished() reports the run and restarts the worker
+    workers[index].process->kill();
+}
+
+int solverPool::workerMain()
+{
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    // Keep the protocol channel to ourselves: anything else written to stdout
+    // (by the engine or by libraries) is sent to stderr instead.
+    FILE *channel = sorp_fdopen(sorp_dup(sorp_fileno(stdout)), "wb");
+    if(channel == NULL)
+        return 1;
+    sorp_dup2(sorp_fileno(stderr), sorp_fileno(stdout));
+    // the pool caches the results on its side
+    solverCache::shared()->setEnabled(false);
+
+    QScopedPointer<calInputs> request(new calInputs);
+    QByteArray payload;
+    for(;;)
+    {
+        uchar sizeBytes[4];
+        if(!readExactly(stdin, reinterpret_cast<char *>(sizeBytes), 4))
+            break;
+        payload.resize(qFromBigEndian<quint32>(sizeBytes));
+        if(!readExactly(stdin, payload.data(), payload.size()))
+            break;
+
+        QDataStream in(payload);
+        in.setVersion(streamVersion);
+        qint32 version, run;
+        in >> version >> run >> *request;
+        if(version != protocolVersion || in.status() != QDataStream::Ok)
+            return 2;
+
+        outputs.ivart.clear();
+        outputs.ivarf.clear();
+        outputs.ivarc.clear();
+        outputs.ivarp.clear();
+        outputs.ivarw.clear();
+        int code = absdCal(0, 0, *request, false);
+
+        QByteArray reply;
+        QDataStream out(&reply, QIODevice::WriteOnly);
+        out.setVersion(streamVersion);
+        out << run << qint32(code) << outputs;
+        QByteArray message = frame(reply);
+        if(fwrite(message.constData(), 1, message.size(), channel) != size_t(message.size()))
+            break;
+        fflush(channel);
+    }
+    fclose(channel);
+    return 0;
+}
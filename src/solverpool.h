@@ -0,0 +1,121 @@
+/*! \file solverpool.h
+    \brief Pool of solver worker processes for crash-isolated parallel runs
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SOLVERPOOL_H
+#define SOLVERPOOL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <functional>
+
+#include "dataComm.h"
+
+class QProcess;
+class QTimer;
+class QEventLoop;
+
+/*!
+Pool of long-lived solver worker processes.
+
+The simulation engine keeps its state in globals and stops on fatal errors
+(e.g. NaN during iteration) via FEM_STOP, so it can neither run two cases at
+once in one process nor be trusted not to take the GUI down with it. The pool
+instead launches copies of this executable with the "--solver-worker" option
+(see workerMain()), hands them serialized calInputs through stdin and reads
+back calOutputs from stdout.
+
+- runs are distributed over all workers, one run per worker at a time
+- each run has its own timeout; a worker that hangs is killed and restarted
+- a worker that crashes is restarted, only the run it was working on is lost
+- results are reported through a callback as soon as they arrive (not in run order),
+  so callers never have to hold all outputs of a sweep in memory
+- abort() gives up the runs being solved by killing their workers
+- called by tableDialog::calcTable() when runs are independent
+*/
+class solverPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Outcome of one run.
+    enum Status {
+        Finished,   ///< the worker returned outputs (check IER/stopped for convergence)
+        Crashed,    ///< the worker died while solving this run
+        TimedOut,   ///< the run exceeded its time limit and the worker was killed
+        Cancelled   ///< the run was never started, or was stopped by abort()
+    };
+
+    /// Called on the GUI thread for each run, in order of completion.
+    typedef std::function<void(int run, Status status, const calOutputs &result)> resultHandler;
+    /// Called on the GUI thread just before a run without a warm start is sent to a
+    /// worker; an invalid state falls back to the nearest state in the solverCache.
+    typedef std::function<solverState(int run)> warmStartHandler;
+
+    explicit solverPool(int workerCount = 0, QObject *parent = 0);
+    ~solverPool();
+
+    /// Application wide pool, created on first use; the workers are kept alive between calls.
+    static solverPool *shared();
+
+    int workerCount() const;
+
+    /// Solves all runs and returns when every run has either finished or failed.
+    /// An event loop is spun meanwhile, so the GUI stays responsive.
+    /// \param timeoutMs time limit per run, <= 0 for none
+    /// \param warmStart chooses the starting point of each run when it is dispatched,
+    ///        so it can use the results of runs that finished before
+    /// \return false if the pool is already busy or no worker could be started
+    bool solve(const QVector<calInputs> &runs, int timeoutMs, const resultHandler &onResult,
+               const warmStartHandler &warmStart = warmStartHandler());
+
+    /// Stop dispatching new runs; runs that are already being solved are allowed to finish.
+    void cancel();
+    /// Stop dispatching new runs and kill the workers solving the others, which are
+    /// restarted; e.g. once one of several starts of a case has converged (see multiStart).
+    void abort();
+
+    /// Entry point of a worker process: serves requests on stdin until it is closed.
+    static int workerMain();
+
+    /// Changes whenever the message layout (or the calInputs/calOutputs streaming) changes.
+    static const qint32 protocolVersion = 9;
+
+private slots:
+    void onReadyRead();
+    void onFinished();
+    void onTimeout();
+
+private:
+    struct worker
+    {
+        QProcess *process;
+        QTimer *timer;
+        QByteArray buffer;
+        int run;          ///< index of the run being solved, -1 if idle
+        bool killed;      ///< killed by us because of a timeout
+        bool aborted;     ///< killed by us because of abort()
+    };
+
+    QVector<worker> workers;
+    int nWorkers;
+
+    const QVector<calInputs> *pending;
+    resultHandler handler;
+    warmStartHandler seeder;
+    int nextRun;
+    int remaining;
+    int runTimeout;
+    bool cancelled;
+    QEventLoop *loop;
+
+    bool startWorker(int index);
+    void dispatch();
+    void report(int run, Status status, const calOutputs &result);
+    int indexOf(QObject *sender) const;
+};
+
+#endif // SOLVERPOOL_H
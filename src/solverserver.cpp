@@ -0,0 +1,404 @@
+/*! \file solverserver.cpp
+    \brief Local solver server for scripted design studies
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+#include "solverserver.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+/// Index into temperature[] from its unit letter, -1 if unknown.
+int temperatureIndex(const QString &name)
+{
+    for(int i = 0; i < 4; i++)
+        if(name.size() == 1 && name.at(0).toUpper() == QLatin1Char(temperature[i]))
+            return i;
+    return -1;
+}
+
+}
+
+solverServer::solverServer(QObject *parent) :
+    QObject(parent),
+    localServer(NULL),
+    tcpServer(NULL),
+    tUnit(3),
+    busy(false)
+{
+}
+
+bool solverServer::loadCase(const QString &fileName, int temperatureUnit, QString *error)
+{
+    if(!hotCase.load(fileName, temperatureUnit, error))
+        return false;
+    tUnit = temperatureUnit;
+    return true;
+}
+
+bool solverServer::listenLocal(const QString &name, QString *error)
+{
+    localServer = new QLocalServer(this);
+    localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    if(!localServer->listen(name))
+    {
+        // a stale socket file of a crashed server blocks the name on Unix
+        QLocalServer::removeServer(name);
+        if(!localServer->listen(name))
+        {
+            if(error)
+                *error = localServer->errorString();
+            return false;
+        }
+    }
+    connect(localServer, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    return true;
+}
+
+bool solverServer::listenTcp(quint16 port, QString *error)
+{
+    tcpServer = new QTcpServer(this);
+    if(!tcpServer->listen(QHostAddress::LocalHost, port))
+    {
+        if(error)
+            *error = tcpServer->errorString();
+        return false;
+    }
+    connect(tcpServer, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    return true;
+}
+
+QString solverServer::address() const
+{
+    if(localServer != NULL)
+        return localServer->fullServerName();
+    if(tcpServer != NULL)
+        return tcpServer->serverAddress().toString()+":"+QString::number(tcpServer->serverPort());
+    return QString();
+}
+
+void solverServer::onNewConnection()
+{
+    if(localServer != NULL)
+        while(localServer->hasPendingConnections())
+        {
+            QLocalSocket *socket = localServer->nextPendingConnection();
+            connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+            addClient(socket);
+        }
+    if(tcpServer != NULL)
+        while(tcpServer->hasPendingConnections())
+        {
+            QTcpSocket *socket = tcpServer->nextPendingConnection();
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+            addClient(socket);
+        }
+}
+
+void solverServer::addClient(QIODevice *client)
+{
+    buffers.insert(client, QByteArray());
+    connect(client, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+}
+
+void solverServer::onReadyRead()
+{
+    QIODevice *client = qobject_cast<QIODevice *>(sender());
+    if(client == NULL || !buffers.contains(client))
+        return;
+    QByteArray &buffer = buffers[client];
+    buffer.append(client->readAll());
+    int end;
+    while((end = buffer.indexOf('\n')) >= 0)
+    {
+        request r;
+        r.client = client;
+        r.line = buffer.left(end).trimmed();
+        buffer.remove(0, end+1);
+        if(!r.line.isEmpty())
+            queue.enqueue(r);
+    }
+    if(!queue.isEmpty())
+        QTimer::singleShot(0, this, SLOT(processQueue()));
+}
+
+void solverServer::onDisconnected()
+{
+    QIODevice *client = qobject_cast<QIODevice *>(sender());
+    buffers.remove(client);
+    // queued requests of this client are dropped once the socket is gone
+    if(client != NULL)
+        client->deleteLater();
+}
+
+void solverServer::processQueue()
+{
+    // solving a batch spins an event loop, don't start the next request from within it
+    if(busy || queue.isEmpty())
+        return;
+
+    // one request per pass, so replies go out and new requests come in between solves
+    request r = queue.dequeue();
+    if(!r.client.isNull())
+    {
+        QJsonParseError parseError;
+        QJsonDocument message = QJsonDocument::fromJson(r.line, &parseError);
+        QJsonObject reply;
+        busy = true;
+        if(parseError.error != QJsonParseError::NoError || !message.isObject())
+            reply = errorObject("Request is not a JSON object: "+parseError.errorString());
+        else
+        {
+            reply = handle(message.object());
+            if(message.object().contains("id"))
+                reply.insert("id", message.object().value("id"));
+        }
+        busy = false;
+
+        if(!r.client.isNull())
+            r.client->write(QJsonDocument(reply).toJson(QJsonDocument::Compact)+"\n");
+    }
+    if(!queue.isEmpty())
+        QTimer::singleShot(0, this, SLOT(processQueue()));
+}
+
+QJsonObject solverServer::handle(const QJsonObject &message)
+{
+    if(message.contains("command"))
+        return command(message);
+    if(!hotCase.isLoaded())
+        return errorObject("No case is loaded.");
+    if(message.contains("runs"))
+        return solveBatch(message.value("runs").toArray());
+    return solveRun(message);
+}
+
+QJsonObject solverServer::command(const QJsonObject &message)
+{
+    QString name = message.value("command").toString();
+    QJsonObject reply;
+    if(name == "load")
+    {
+        int unit = tUnit;
+        if(message.contains("temperatureUnit"))
+            unit = temperatureIndex(message.value("temperatureUnit").toString());
+        if(unit < 0)
+            return errorObject("Unknown temperature unit.");
+        QString error;
+        if(!loadCase(message.value("file").toString(), unit, &error))
+            return errorObject(error);
+    }
+    else if(name == "reset")
+        hotCase.resetGuesses();
+    else if(name != "info")
+        return errorObject("Unknown command "+name+".");
+
+    reply.insert("ok", true);
+    reply.insert("file", hotCase.fileName());
+    if(hotCase.isLoaded())
+    {
+        reply.insert("components", hotCase.inputs().nunits);
+        reply.insert("statePoints", hotCase.inputs().nsp);
+    }
+    reply.insert("workers", solverPool::shared()->workerCount());
+    return reply;
+}
+
+bool solverServer::buildRun(const QJsonObject &run, calInputs &runInputs, QString *error) const
+{
+    runInputs = hotCase.inputs();
+    QStringList types = QStringList()<<"sp"<<"unit";
+    foreach(QString type, types)
+    {
+        foreach(QJsonValue entry, run.value(type).toArray())
+        {
+            QJsonObject input = entry.toObject();
+            QJsonValue index = input.value("index");
+            QString indexText = index.isString() ? index.toString() : QString::number(index.toInt());
+            if(!hotCase.applyOverride(runInputs, type, indexText, input.value("parameter").toString(),
+                                      input.value("value").toDouble(), error))
+                return false;
+        }
+    }
+    return true;
+}
+
+QJsonObject solverServer::solveRun(const QJsonObject &run)
+{
+    // calInputs is too large for the stack
+    QScopedPointer<calInputs> runInputs(new calInputs);
+    QString error;
+    if(!buildRun(run, *runInputs, &error))
+        return errorObject(error);
+
+    outputs.ivart.clear();
+    outputs.ivarf.clear();
+    outputs.ivarc.clear();
+    outputs.ivarp.clear();
+    outputs.ivarw.clear();
+    absdCal(0, 0, *runInputs, false);
+
+    if(run.value("updateGuess").toBool() && outputs.IER<4 && !outputs.stopped)
+        hotCase.updateGuesses(outputs);
+    return resultObject(outputs);
+}
+
+QJsonObject solverServer::solveBatch(const QJsonArray &runs)
+{
+    QVector<calInputs> jobs(runs.count());
+    for(int i = 0; i < runs.count(); i++)
+    {
+        QString error;
+        if(!buildRun(runs.at(i).toObject(), jobs[i], &error))
+            return errorObject("Run "+QString::number(i)+": "+error);
+    }
+
+    QVector<QJsonObject> results(runs.count());
+    bool started = solverPool::shared()->solve(jobs, 0,
+        [&](int run, solverPool::Status status, const calOutputs &result)
+    {
+        if(status == solverPool::Finished)
+            results[run] = resultObject(result);
+        else if(status == solverPool::Crashed)
+            results[run] = errorObject("The solver crashed.");
+        else
+            results[run] = errorObject("Not calculated.");
+    });
+    if(!started)
+        return errorObject("No solver worker could be started.");
+
+    QJsonArray replies;
+    foreach(QJsonObject result, results)
+        replies.append(result);
+    QJsonObject reply;
+    reply.insert("ok", true);
+    reply.insert("runs", replies);
+    return reply;
+}
+
+QJsonObject solverServer::resultObject(const calOutputs &result) const
+{
+    QJsonObject reply;
+    bool converged = result.IER<4 && !result.stopped;
+    reply.insert("ok", true);
+    reply.insert("converged", converged);
+    reply.insert("ier", result.IER);
+    reply.insert("stopped", result.stopped);
+    if(result.stopped)
+        reply.insert("message", result.myMsg);
+    else if(result.IER >= -1 && result.IER < 8)
+        reply.insert("message", result.Msgs[result.IER+1]);
+    reply.insert("iterations", result.noIter);
+    reply.insert("cop", result.cop);
+    reply.insert("capacity", result.capacity);
+
+    const calInputs &in = hotCase.inputs();
+    QJsonArray sp;
+    for(int i = 1; i <= in.nsp; i++)
+    {
+        QJsonObject point;
+        point.insert("index", i);
+        point.insert("T", result.t[i]);
+        point.insert("P", result.p[i]);
+        point.insert("F", result.f[i]);
+        point.insert("C", result.c[i]);
+        point.insert("W", result.w[i]);
+        point.insert("H", result.h[i]);
+        sp.append(point);
+    }
+    reply.insert("sp", sp);
+
+    QJsonArray units;
+    for(int i = 1; i <= in.nunits; i++)
+    {
+        QJsonObject comp;
+        comp.insert("index", i);
+        comp.insert("HT", result.heat[i]);
+        comp.insert("UA", result.ua[i]);
+        comp.insert("NT", result.ntu[i]);
+        comp.insert("EF", result.eff[i]);
+        comp.insert("CA", result.cat[i]);
+        comp.insert("LM", result.lmtd[i]);
+        comp.insert("MR", result.mrate[i]);
+        comp.insert("HE", result.humeff[i]);
+        comp.insert("EE", result.enthalpyeff[i]);
+        units.append(comp);
+    }
+    reply.insert("unit", units);
+    return reply;
+}
+
+QJsonObject solverServer::errorObject(const QString &error)
+{
+    QJsonObject reply;
+    reply.insert("ok", false);
+    reply.insert("error", error);
+    return reply;
+}
+
+int solverServer::serverMain(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList args = app.arguments();
+    QString caseFile, socketName = "sorpsim-solver";
+    int port = -1, unit = 3;
+    for(int i = 2; i < args.count(); i++)
+    {
+        if(args.at(i) == "--socket" && i+1 < args.count())
+            socketName = args.at(++i);
+        else if(args.at(i) == "--port" && i+1 < args.count())
+            port = args.at(++i).toInt();
+        else if(args.at(i) == "--temperature-unit" && i+1 < args.count())
+            unit = temperatureIndex(args.at(++i));
+        else if(caseFile.isEmpty())
+            caseFile = args.at(i);
+        else
+            unit = -1;
+    }
+    if(caseFile.isEmpty() || unit < 0)
+    {
+        err << "usage: " << args.first()
+            << " --solver-server <case file> [--socket <name> | --port <n>] [--temperature-unit K|C|R|F]" << Qt::endl;
+        return 1;
+    }
+
+    solverServer server;
+    QString error;
+    if(!server.loadCase(caseFile, unit, &error))
+    {
+        err << error << Qt::endl;
+        return 1;
+    }
+    bool listening = port >= 0 ? server.listenTcp(quint16(port), &error)
+                               : server.listenLocal(socketName, &error);
+    if(!listening)
+    {
+        err << "cannot listen: " << error << Qt::endl;
+        return 1;
+    }
+    out << "listening on " << server.address() << Qt::endl;
+    return app.exec();
+}
@@ -0,0 +1,100 @@
+/*! \file solverserver.h
+    \brief Local solver server for scripted design studies
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SOLVERSERVER_H
+#define SOLVERSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QPointer>
+#include <QQueue>
+
+#include "solvercase.h"
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+/*!
+Keeps one case loaded and solves it on request for clients on the same machine.
+
+Scripts that evaluate a case thousands of times would otherwise pay for a
+process start and a case file parse per evaluation. The server is started with
+"--solver-server <case file>" (see serverMain()) and listens on a local socket
+(Unix domain socket / named pipe) or on a TCP port bound to localhost.
+
+Protocol: one JSON object per line in each direction. Every request may carry
+an "id" that is echoed in its reply. Values are in the units of the case file
+(see solverCase).
+- a run: {"id":1, "sp":[{"index":"2 1","parameter":"T","value":95}],
+  "unit":[{"index":3,"parameter":"HT","value":120}], "updateGuess":true}
+  - inputs are addressed like the inputs of a parametric table
+  - with "updateGuess" the converged values become the guess values of later
+    runs, like the table's "update guess values" option
+- a batch: {"id":2, "runs":[{...run...},{...run...}]}; the runs are independent
+  and solved in parallel by the solverPool, the reply has one result per run in "runs"
+- commands: {"command":"load","file":...,"temperatureUnit":"F"}, {"command":"reset"}
+  (restore the guess values of the case file), {"command":"info"}
+
+Requests of a client are answered in order; a client may send any number of
+requests without waiting for the replies (pipelining). Single runs are solved
+in the server process itself for the lowest latency, so it shares the engine's
+state between calls; batches go to the crash-isolated worker processes.
+*/
+class solverServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit solverServer(QObject *parent = 0);
+
+    bool loadCase(const QString &fileName, int temperatureUnit, QString *error);
+
+    /// Listens on a local socket with the given name.
+    bool listenLocal(const QString &name, QString *error);
+    /// Listens on a TCP port of localhost, 0 picks a free one.
+    bool listenTcp(quint16 port, QString *error);
+    /// Where clients can connect, for the startup message.
+    QString address() const;
+
+    /// Entry point of "--solver-server <case file> [--socket <name>|--port <n>] [--temperature-unit K|C|R|F]".
+    static int serverMain(int argc, char *argv[]);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void processQueue();
+
+private:
+    struct request
+    {
+        QPointer<QIODevice> client;
+        QByteArray line;
+    };
+
+    QLocalServer *localServer;
+    QTcpServer *tcpServer;
+    solverCase hotCase;
+    int tUnit;
+
+    QHash<QIODevice*,QByteArray> buffers;
+    QQueue<request> queue;
+    bool busy;
+
+    void addClient(QIODevice *client);
+    QJsonObject handle(const QJsonObject &message);
+    QJsonObject command(const QJsonObject &message);
+    bool buildRun(const QJsonObject &run, calInputs &runInputs, QString *error) const;
+    QJsonObject solveRun(const QJsonObject &run);
+    QJsonObject solveBatch(const QJsonArray &runs);
+    QJsonObject resultObject(const calOutputs &result) const;
+    static QJsonObject errorObject(const QString &error);
+};
+
+#endif // SOLVERSERVER_H
@@ -0,0 +1,481 @@
+/*! \file if97.cpp
+    \brief IAPWS-IF97 water and steam, regions 1, 2 and 4 with the backward equations
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include "if97.h"
+#include "propkernels.h"
+
+#include <array>
+
+namespace sorpprops {
+
+namespace if97 {
+
+namespace {
+
+/// n * x^i * y^j of a sum
+struct term
+{
+    int i;
+    int j;
+    double n;
+};
+
+/// specific gas constant [kJ/(kg K)]
+const double R = 0.461526;
+
+/// limits of the implemented regions
+const double tMin = 273.15, t13 = 623.15, tMax = 1073.15, pMax = 100.0;
+const double tCritical = 647.096, pCritical = 22.064, pTriple = 611.213e-6;
+
+/// region 4, table 34
+constexpr std::array<double,10> sat = {{
+    0.11670521452767e4, -0.72421316703206e6, -0.17073846940092e2, 0.12020824702470e5,
+    -0.32325550322333e7, 0.14915108613530e2, -0.48232657361591e4, 0.40511340542057e6,
+    -0.23855557567849, 0.65017534844798e3
+}};
+
+/// region 1, table 2
+constexpr std::array<term,34> region1 = {{
+    {0, -2, 0.14632971213167}, {0, -1, -0.84548187169114}, {0, 0, -0.37563603672040e1},
+    {0, 1, 0.33855169168385e1}, {0, 2, -0.95791963387872}, {0, 3, 0.15772038513228},
+    {0, 4, -0.16616417199501e-1}, {0, 5, 0.81214629983568e-3}, {1, -9, 0.28319080123804e-3},
+    {1, -7, -0.60706301565874e-3}, {1, -1, -0.18990068218419e-1}, {1, 0, -0.32529748770505e-1},
+    {1, 1, -0.21841717175414e-1}, {1, 3, -0.52838357969930e-4}, {2, -3, -0.47184321073267e-3},
+    {2, 0, -0.30001780793026e-3}, {2, 1, 0.47661393906987e-4}, {2, 3, -0.44141845330846e-5},
+    {2, 17, -0.72694996297594e-15}, {3, -4, -0.31679644845054e-4}, {3, 0, -0.28270797985312e-5},
+    {3, 6, -0.85205128120103e-9}, {4, -5, -0.22425281908000e-5}, {4, -2, -0.65171222895601e-6},
+    {4, 10, -0.14341729937924e-12}, {5, -8, -0.40516996860117e-6}, {8, -11, -0.12734301741641e-8},
+    {8, -6, -0.17424871230634e-9}, {21, -29, -0.68762131295531e-18}, {23, -31, 0.14478307828521e-19},
+    {29, -38, 0.26335781662795e-22}, {30, -39, -0.11947622640071e-22}, {31, -40, 0.18228094581404e-23},
+    {32, -41, -0.93537087292458e-25}
+}};
+
+/// region 1 backward T(p,h), table 6
+constexpr std::array<term,20> region1PH = {{
+    {0, 0, -0.23872489924521e3}, {0, 1, 0.40421188637945e3}, {0, 2, 0.11349746881718e3},
+    {0, 6, -0.58457616048039e1}, {0, 22, -0.15285482413140e-3}, {0, 32, -0.10866707695377e-5},
+    {1, 0, -0.13391744872602e2}, {1, 1, 0.43211039183559e2}, {1, 2, -0.54010067170506e2},
+    {1, 3, 0.30535892203916e2}, {1, 4, -0.65964749423638e1}, {1, 10, 0.93965400878363e-2},
+    {1, 32, 0.11573647505340e-6}, {2, 10, -0.25858641282073e-4}, {2, 32, -0.40644363084799e-8},
+    {3, 10, 0.66456186191635e-7}, {3, 32, 0.80670734103027e-10}, {4, 32, -0.93477771213947e-12},
+    {5, 32, 0.58265442020601e-14}, {6, 32, -0.15020185953503e-16}
+}};
+
+/// region 1 backward T(p,s), table 8
+constexpr std::array<term,20> region1PS = {{
+    {0, 0, 0.17478268058307e3}, {0, 1, 0.34806930892873e2}, {0, 2, 0.65292584978455e1},
+    {0, 3, 0.33039981775489}, {0, 11, -0.19281382923196e-6}, {0, 31, -0.24909197244573e-22},
+    {1, 0, -0.26107636489332}, {1, 1, 0.22592965981586}, {1, 2, -0.64256463395226e-1},
+    {1, 3, 0.78876289270526e-2}, {1, 12, 0.35672110607366e-9}, {1, 31, 0.17332496994895e-23},
+    {2, 0, 0.56608900654837e-3}, {2, 1, -0.32635483139717e-3}, {2, 2, 0.44778286690632e-4},
+    {2, 9, -0.51322156908507e-9}, {2, 31, -0.42522657042207e-25}, {3, 10, 0.26400441360689e-12},
+    {3, 32, 0.78124600459723e-28}, {4, 32, -0.30732199903668e-30}
+}};
+
+/// region 2 ideal gas part, table 10 (i unused)
+constexpr std::array<term,9> region2Ideal = {{
+    {0, 0, -0.96927686500217e1}, {0, 1, 0.10086655968018e2}, {0, -5, -0.56087911283020e-2},
+    {0, -4, 0.71452738081455e-1}, {0, -3, -0.40710498223928}, {0, -2, 0.14240819171444e1},
+    {0, -1, -0.43839511319450e1}, {0, 2, -0.28408632460772}, {0, 3, 0.21268463753307e-1}
+}};
+
+/// region 2 residual part, table 11
+constexpr std::array<term,43> region2Residual = {{
+    {1, 0, -0.17731742473213e-2}, {1, 1, -0.17834862292358e-1}, {1, 2, -0.45996013696365e-1},
+    {1, 3, -0.57581259083432e-1}, {1, 6, -0.50325278727930e-1}, {2, 1, -0.33032641670203e-4},
+    {2, 2, -0.18948987516315e-3}, {2, 4, -0.39392777243355e-2}, {2, 7, -0.43797295650573e-1},
+    {2, 36, -0.26674547914087e-4}, {3, 0, 0.20481737692309e-7}, {3, 1, 0.43870667284435e-6},
+    {3, 3, -0.32277677238570e-4}, {3, 6, -0.15033924542148e-2}, {3, 35, -0.40668253562649e-1},
+    {4, 1, -0.78847309559367e-9}, {4, 2, 0.12790717852285e-7}, {4, 3, 0.48225372718507e-6},
+    {5, 7, 0.22922076337661e-5}, {6, 3, -0.16714766451061e-10}, {6, 16, -0.21171472321355e-2},
+    {6, 35, -0.23895741934104e2}, {7, 0, -0.59059564324270e-17}, {7, 11, -0.12621808899101e-5},
+    {7, 25, -0.38946842435739e-1}, {8, 8, 0.11256211360459e-10}, {8, 36, -0.82311340897998e1},
+    {9, 13, 0.19809712802088e-7}, {10, 4, 0.10406965210174e-18}, {10, 10, -0.10234747095929e-12},
+    {10, 14, -0.10018179379511e-8}, {16, 29, -0.80882908646985e-10}, {16, 50, 0.10693031879409},
+    {18, 57, -0.33662250574171}, {20, 20, 0.89185845355421e-24}, {20, 35, 0.30629316876232e-12},
+    {20, 48, -0.42002467698208e-5}, {21, 21, -0.59056029685639e-25}, {22, 53, 0.37826947613457e-5},
+    {23, 39, -0.12768608934681e-14}, {24, 26, 0.73087610595061e-28}, {24, 40, 0.55414715350778e-16},
+    {24, 58, -0.94369707241210e-6}
+}};
+
+/// boundary between regions 2 and 3, table 1
+constexpr std::array<double,5> b23 = {{
+    0.34805185628969e3, -0.11671859879975e1, 0.10192970039326e-2, 0.57254459862746e3,
+    0.13918839778870e2
+}};
+
+/// boundary between sub-regions 2b and 2c, table 19
+constexpr std::array<double,5> b2bc = {{
+    0.90584278514723e3, -0.67955786399241, 0.12809002730136e-3, 0.26526571908428e4,
+    0.45257578905948e1
+}};
+
+/// region 2a backward T(p,h), table 20
+constexpr std::array<term,34> region2aPH = {{
+    {0, 0, 0.10898952318288e4}, {0, 1, 0.84951654495535e3}, {0, 2, -0.10781748091826e3},
+    {0, 3, 0.33153654801263e2}, {0, 7, -0.74232016790248e1}, {0, 20, 0.11765048724356e2},
+    {1, 0, 0.18445749355790e1}, {1, 1, -0.41792700549624e1}, {1, 2, 0.62478196935812e1},
+    {1, 3, -0.17344563108114e2}, {1, 7, -0.20058176862096e3}, {1, 9, 0.27196065473796e3},
+    {1, 11, -0.45511318285818e3}, {1, 18, 0.30919688604755e4}, {1, 44, 0.25226640357872e6},
+    {2, 0, -0.61707422868339e-2}, {2, 2, -0.31078046629583}, {2, 7, 0.11670873077107e2},
+    {2, 36, 0.12812798404046e9}, {2, 38, -0.98554909623276e9}, {2, 40, 0.28224546973002e10},
+    {2, 42, -0.35948971410703e10}, {2, 44, 0.17227349913197e10}, {3, 24, -0.13551334240775e5},
+    {3, 44, 0.12848734664650e8}, {4, 12, 0.13865724283226e1}, {4, 32, 0.23598832556514e6},
+    {4, 44, -0.13105236545054e8}, {5, 32, 0.73999835474766e4}, {5, 36, -0.55196697030060e6},
+    {5, 42, 0.37154085996233e7}, {6, 34, 0.19127729239660e5}, {6, 44, -0.41535164835634e6},
+    {7, 28, -0.62459855192507e2}
+}};
+
+/// region 2b backward T(p,h), table 21
+constexpr std::array<term,38> region2bPH = {{
+    {0, 0, 0.14895041079516e4}, {0, 1, 0.74307798314034e3}, {0, 2, -0.97708318797837e2},
+    {0, 12, 0.24742464705674e1}, {0, 18, -0.63281320016026}, {0, 24, 0.11385952129658e1},
+    {0, 28, -0.47811863648625}, {0, 40, 0.85208123431544e-2}, {1, 0, 0.93747147377932},
+    {1, 2, 0.33593118604916e1}, {1, 6, 0.33809355601454e1}, {1, 12, 0.16844539671904},
+    {1, 18, 0.73875745236695}, {1, 24, -0.47128737436186}, {1, 28, 0.15020273139707},
+    {1, 40, -0.21764114219750e-2}, {2, 2, -0.21810755324761e-1}, {2, 8, -0.10829784403677},
+    {2, 18, -0.46333324635812e-1}, {2, 40, 0.71280351959551e-4}, {3, 1, 0.11032831789999e-3},
+    {3, 2, 0.18955248387902e-3}, {3, 12, 0.30891541160537e-2}, {3, 24, 0.13555504554949e-2},
+    {4, 2, 0.28640237477456e-6}, {4, 12, -0.10779857357512e-4}, {4, 18, -0.76462712454814e-4},
+    {4, 24, 0.14052392818316e-4}, {4, 28, -0.31083814331434e-4}, {4, 40, -0.10302738212103e-5},
+    {5, 18, 0.28217281635040e-6}, {5, 24, 0.12704902271945e-5}, {5, 40, 0.73803353468292e-7},
+    {6, 28, -0.11030139238909e-7}, {7, 2, -0.81456365207833e-13}, {7, 28, -0.25180545682962e-10},
+    {9, 1, -0.17565233969407e-17}, {9, 40, 0.86934156344163e-14}
+}};
+
+/// region 2c backward T(p,h), table 22
+constexpr std::array<term,23> region2cPH = {{
+    {-7, 0, -0.32368398555242e13}, {-7, 4, 0.73263350902181e13}, {-6, 0, 0.35825089945447e12},
+    {-6, 2, -0.58340131851590e12}, {-5, 0, -0.10783068217470e11}, {-5, 2, 0.20825544563171e11},
+    {-2, 0, 0.61074783564516e6}, {-2, 1, 0.85977722535580e6}, {-1, 0, -0.25745723604170e5},
+    {-1, 2, 0.31081088422714e5}, {0, 0, 0.12082315865936e4}, {0, 1, 0.48219755109255e3},
+    {1, 4, 0.37966001272486e1}, {1, 8, -0.10842984880077e2}, {2, 4, -0.45364172676660e-1},
+    {6, 0, 0.14559115658698e-12}, {6, 1, 0.11261597407230e-11}, {6, 4, -0.17804982240686e-10},
+    {6, 10, 0.12324579690832e-6}, {6, 12, -0.11606921130984e-5}, {6, 16, 0.27846367088554e-4},
+    {6, 20, -0.59270038474176e-3}, {6, 22, 0.12918582991878e-2}
+}};
+
+/// region 2a backward T(p,s), table 25, with i in quarters
+constexpr std::array<term,46> region2aPS = {{
+    {-6, -24, -0.39235983861984e6}, {-6, -23, 0.51526573827270e6}, {-6, -19, 0.40482443161048e5},
+    {-6, -13, -0.32193790923902e3}, {-6, -11, 0.96961424218694e2}, {-6, -10, -0.22867846371773e2},
+    {-5, -19, -0.44942914124357e6}, {-5, -15, -0.50118336020166e4}, {-5, -6, 0.35684463560015},
+    {-4, -26, 0.44235335848190e5}, {-4, -21, -0.13673388811708e5}, {-4, -17, 0.42163260207864e6},
+    {-4, -16, 0.22516925837475e5}, {-4, -9, 0.47442144865646e3}, {-4, -8, -0.14931130797647e3},
+    {-3, -15, -0.19781126320452e6}, {-3, -14, -0.23554399470760e5}, {-2, -26, -0.19070616302076e5},
+    {-2, -13, 0.55375669883164e5}, {-2, -9, 0.38293691437363e4}, {-2, -7, -0.60391860580567e3},
+    {-1, -27, 0.19363102620331e4}, {-1, -25, 0.42660643698610e4}, {-1, -11, -0.59780638872718e4},
+    {-1, -6, -0.70401463926862e3}, {1, 1, 0.33836784107553e3}, {1, 4, 0.20862786635187e2},
+    {1, 8, 0.33834172656196e-1}, {1, 11, -0.43124428414893e-4}, {2, 0, 0.16653791356412e3},
+    {2, 1, -0.13986292055898e3}, {2, 5, -0.78849547999872}, {2, 6, 0.72132411753872e-1},
+    {2, 10, -0.59754839398283e-2}, {2, 14, -0.12141358953904e-4}, {2, 16, 0.23227096733871e-6},
+    {3, 0, -0.10538463566194e2}, {3, 4, 0.20718925496502e1}, {3, 9, -0.72193155260427e-1},
+    {3, 17, 0.20749887081120e-6}, {4, 7, -0.18340657911379e-1}, {4, 18, 0.29036272348696e-6},
+    {5, 3, 0.21037527893619}, {5, 15, 0.25681239729999e-3}, {6, 5, -0.12799002933781e-1},
+    {6, 18, -0.82198102652018e-5}
+}};
+
+/// region 2b backward T(p,s), table 26
+constexpr std::array<term,44> region2bPS = {{
+    {-6, 0, 0.31687665083497e6}, {-6, 11, 0.20864175881858e2}, {-5, 0, -0.39859399803599e6},
+    {-5, 11, -0.21816058518877e2}, {-4, 0, 0.22369785194242e6}, {-4, 1, -0.27841703445817e4},
+    {-4, 11, 0.99207436071480e1}, {-3, 0, -0.75197512299157e5}, {-3, 1, 0.29708605951158e4},
+    {-3, 11, -0.34406878548526e1}, {-3, 12, 0.38815564249115}, {-2, 0, 0.17511295085750e5},
+    {-2, 1, -0.14237112854449e4}, {-2, 6, 0.10943803364167e1}, {-2, 10, 0.89971619308495},
+    {-1, 0, -0.33759740098958e4}, {-1, 1, 0.47162885818355e3}, {-1, 5, -0.19188241993679e1},
+    {-1, 8, 0.41078580492196}, {-1, 9, -0.33465378172097}, {0, 0, 0.13870034777505e4},
+    {0, 1, -0.40663326195838e3}, {0, 2, 0.41727347159610e2}, {0, 4, 0.21932549434532e1},
+    {0, 5, -0.10320050009077e1}, {0, 6, 0.35882943516703}, {0, 9, 0.52511453726066e-2},
+    {1, 0, 0.12838916450705e2}, {1, 1, -0.28642437219381e1}, {1, 2, 0.56912683664855},
+    {1, 3, -0.99962954584931e-1}, {1, 7, -0.32632037778459e-2}, {1, 8, 0.23320922576723e-3},
+    {2, 0, -0.15334809857450}, {2, 1, 0.29072288239902e-1}, {2, 5, 0.37534702741167e-3},
+    {3, 0, 0.17296691702411e-2}, {3, 1, -0.38556050844504e-3}, {3, 3, -0.35017712292608e-4},
+    {4, 0, -0.14566393631492e-4}, {4, 1, 0.56420857267269e-5}, {5, 0, 0.41286150074605e-7},
+    {5, 1, -0.20684671118824e-7}, {5, 2, 0.16409393674725e-8}
+}};
+
+/// region 2c backward T(p,s), table 27
+constexpr std::array<term,30> region2cPS = {{
+    {-2, 0, 0.90968501005365e3}, {-2, 1, 0.24045667088420e4}, {-1, 0, -0.59162326387130e3},
+    {0, 0, 0.54145404128074e3}, {0, 1, -0.27098308411192e3}, {0, 2, 0.97976525097926e3},
+    {0, 3, -0.46966772959435e3}, {1, 0, 0.14399274604723e2}, {1, 1, -0.19104204230429e2},
+    {1, 3, 0.53299167111971e1}, {1, 4, -0.21252975375934e2}, {2, 0, -0.31147334413760},
+    {2, 1, 0.60334840894623}, {2, 2, -0.42764839702509e-1}, {3, 0, 0.58185597255259e-2},
+    {3, 1, -0.14597008284753e-1}, {3, 5, 0.56631175631027e-2}, {4, 0, -0.76155864584577e-4},
+    {4, 1, 0.22440342919332e-3}, {4, 4, -0.12561095013413e-4}, {5, 0, 0.63323132660934e-6},
+    {5, 1, -0.20541989675375e-5}, {5, 2, 0.36405370390082e-7}, {6, 0, -0.29759897789215e-8},
+    {6, 1, 0.10136618529763e-7}, {7, 0, 0.59925719692351e-11}, {7, 1, -0.20677870105164e-10},
+    {7, 3, -0.20874278181886e-10}, {7, 4, 0.10162166825089e-9}, {7, 5, -0.16429828281347e-9}
+}};
+
+/// x^n by repeated squaring, the exponents of IF97 are integers
+inline double ipow(double x, int n)
+{
+    unsigned int m = n < 0 ? -n : n;
+    double r = 1.0;
+    while(m)
+    {
+        if(m & 1)
+            r *= x;
+        x *= x;
+        m >>= 1;
+    }
+    return n < 0 ? 1.0 / r : r;
+}
+
+/// sum n * x^i * y^j
+template <std::size_t N>
+double series(const std::array<term,N> &c, double x, double y)
+{
+    double sum = 0;
+    for(std::size_t k = 0; k < N; k++)
+        sum += c[k].n * ipow(x, c[k].i) * ipow(y, c[k].j);
+    return sum;
+}
+
+/// dimensionless Gibbs free energy and its derivatives
+struct gibbs
+{
+    double g, gp, gt, gtt;
+};
+
+/// relative slack on the saturation line between regions 1 and 2, wide enough
+/// for saturationPressure(saturationTemperature(p)) to come back to p
+const double satTolerance = 1e-12;
+
+bool inRegion1(double p, double t)
+{
+    if(!(t >= tMin && t <= t13 && p > 0 && p <= pMax))
+        return false;
+    // compressed liquid lies on or above the saturation line
+    return p >= saturationPressure(t) * (1 - satTolerance);
+}
+
+bool inRegion2(double p, double t)
+{
+    if(!(t >= tMin && t <= tMax && p > 0 && p <= pMax))
+        return false;
+    // up to 623.15 K superheated vapor lies on or below the saturation line,
+    // above it region 3 starts at the B23 boundary
+    if(t <= t13)
+        return p <= saturationPressure(t) * (1 + satTolerance);
+    return p <= b23[0] + b23[1] * t + b23[2] * t * t;
+}
+
+/// region 1 at pi = p/16.53 MPa, tau = 1386 K/T
+gibbs gibbs1(double p, double t)
+{
+    double pi = p / 16.53, tau = 1386.0 / t;
+    double a = 7.1 - pi, b = tau - 1.222;
+    gibbs r = {0, 0, 0, 0};
+    for(std::size_t k = 0; k < region1.size(); k++)
+    {
+        const term &c = region1[k];
+        double ai = ipow(a, c.i), bj = ipow(b, c.j);
+        r.g += c.n * ai * bj;
+        r.gp -= c.n * c.i * ipow(a, c.i - 1) * bj;
+        r.gt += c.n * ai * c.j * ipow(b, c.j - 1);
+        r.gtt += c.n * ai * c.j * (c.j - 1) * ipow(b, c.j - 2);
+    }
+    return r;
+}
+
+/// region 2 at pi = p/1 MPa, tau = 540 K/T, gp of the residual part only
+gibbs gibbs2(double p, double t)
+{
+    double pi = p, tau = 540.0 / t;
+    gibbs r = {log(pi), 0, 0, 0};
+    for(std::size_t k = 0; k < region2Ideal.size(); k++)
+    {
+        const term &c = region2Ideal[k];
+        r.g += c.n * ipow(tau, c.j);
+        r.gt += c.n * c.j * ipow(tau, c.j - 1);
+        r.gtt += c.n * c.j * (c.j - 1) * ipow(tau, c.j - 2);
+    }
+    double b = tau - 0.5;
+    for(std::size_t k = 0; k < region2Residual.size(); k++)
+    {
+        const term &c = region2Residual[k];
+        double pi_ = ipow(pi, c.i), bj = ipow(b, c.j);
+        r.g += c.n * pi_ * bj;
+        r.gp += c.n * c.i * ipow(pi, c.i - 1) * bj;
+        r.gt += c.n * pi_ * c.j * ipow(b, c.j - 1);
+        r.gtt += c.n * pi_ * c.j * (c.j - 1) * ipow(b, c.j - 2);
+    }
+    return r;
+}
+
+}
+
+double saturationPressure(double t)
+{
+    if(!(t >= tMin && t <= tCritical))
+        return notANumber();
+    double theta = t + sat[8] / (t - sat[9]);
+    double a = theta * theta + sat[0] * theta + sat[1];
+    double b = sat[2] * theta * theta + sat[3] * theta + sat[4];
+    double c = sat[5] * theta * theta + sat[6] * theta + sat[7];
+    double x = 2.0 * c / (-b + sqrt(b * b - 4.0 * a * c));
+    x *= x;
+    return x * x;
+}
+
+double saturationTemperature(double p)
+{
+    if(!(p >= pTriple && p <= pCritical))
+        return notANumber();
+    double beta = sqrt(sqrt(p));
+    double e = beta * beta + sat[2] * beta + sat[5];
+    double f = sat[0] * beta * beta + sat[3] * beta + sat[6];
+    double g = sat[1] * beta * beta + sat[4] * beta + sat[7];
+    double d = 2.0 * g / (-f - sqrt(f * f - 4.0 * e * g));
+    return (sat[9] + d - sqrt((sat[9] + d) * (sat[9] + d) - 4.0 * (sat[8] + sat[9] * d))) / 2.0;
+}
+
+double liquidVolume(double p, double t)
+{
+    if(!inRegion1(p, t))
+        return notANumber();
+    return R * t / p * (p / 16.53) * gibbs1(p, t).gp * 1.e-3;
+}
+
+double liquidEnthalpy(double p, double t)
+{
+    if(!inRegion1(p, t))
+        return notANumber();
+    return R * 1386.0 * gibbs1(p, t).gt;
+}
+
+double liquidEntropy(double p, double t)
+{
+    if(!inRegion1(p, t))
+        return notANumber();
+    gibbs g = gibbs1(p, t);
+    return R * (1386.0 / t * g.gt - g.g);
+}
+
+double liquidHeatCapacity(double p, double t)
+{
+    if(!inRegion1(p, t))
+        return notANumber();
+    double tau = 1386.0 / t;
+    return -R * tau * tau * gibbs1(p, t).gtt;
+}
+
+double vaporVolume(double p, double t)
+{
+    if(!inRegion2(p, t))
+        return notANumber();
+    return R * t / p * (1.0 + p * gibbs2(p, t).gp) * 1.e-3;
+}
+
+double vaporEnthalpy(double p, double t)
+{
+    if(!inRegion2(p, t))
+        return notANumber();
+    return R * 540.0 * gibbs2(p, t).gt;
+}
+
+double vaporEntropy(double p, double t)
+{
+    if(!inRegion2(p, t))
+        return notANumber();
+    gibbs g = gibbs2(p, t);
+    return R * (540.0 / t * g.gt - g.g);
+}
+
+double vaporHeatCapacity(double p, double t)
+{
+    if(!inRegion2(p, t))
+        return notANumber();
+    double tau = 540.0 / t;
+    return -R * tau * tau * gibbs2(p, t).gtt;
+}
+
+double liquidTemperaturePH(double p, double h)
+{
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    return series(region1PH, p, h / 2500.0 + 1.0);
+}
+
+double liquidTemperaturePS(double p, double s)
+{
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    return series(region1PS, p, s + 2.0);
+}
+
+double vaporTemperaturePH(double p, double h)
+{
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    double eta = h / 2000.0;
+    if(p <= 4.0)
+        return series(region2aPH, p, eta - 2.1);
+    // the 2b/2c boundary starts at 6.5467 MPa, all states below it are in 2b
+    if(p <= b2bc[4] || h >= b2bc[3] + sqrt((p - b2bc[4]) / b2bc[2]))
+        return series(region2bPH, p - 2.0, eta - 2.6);
+    return series(region2cPH, p + 25.0, eta - 1.8);
+}
+
+double vaporTemperaturePS(double p, double s)
+{
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    if(p <= 4.0)
+        return series(region2aPS, sqrt(sqrt(p)), s / 2.0 - 2.0);
+    if(s >= 5.85)
+        return series(region2bPS, p, 10.0 - s / 0.7853);
+    return series(region2cPS, p, 2.0 - s / 2.9251);
+}
+
+double temperaturePH(double p, double h)
+{
+    double ts = saturationTemperature(p);
+    if(ts == ts && ts <= t13)
+    {
+        if(h <= liquidEnthalpy(p, ts))
+            return liquidTemperaturePH(p, h);
+        if(h >= vaporEnthalpy(p, ts))
+            return vaporTemperaturePH(p, h);
+        return ts;// two phase
+    }
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    // above the saturation line of region 4, region 3 lies between 1 and 2
+    double t23 = p < b23[4] ? t13 : b23[3] + sqrt((p - b23[4]) / b23[2]);
+    if(h <= liquidEnthalpy(p, t13))
+        return liquidTemperaturePH(p, h);
+    if(h >= vaporEnthalpy(p, t23))
+        return vaporTemperaturePH(p, h);
+    return notANumber();
+}
+
+double temperaturePS(double p, double s)
+{
+    double ts = saturationTemperature(p);
+    if(ts == ts && ts <= t13)
+    {
+        if(s <= liquidEntropy(p, ts))
+            return liquidTemperaturePS(p, s);
+        if(s >= vaporEntropy(p, ts))
+            return vaporTemperaturePS(p, s);
+        return ts;
+    }
+    if(!(p > 0 && p <= pMax))
+        return notANumber();
+    double t23 = p < b23[4] ? t13 : b23[3] + sqrt((p - b23[4]) / b23[2]);
+    if(s <= liquidEntropy(p, t13))
+        return liquidTemperaturePS(p, s);
+    if(s >= vaporEntropy(p, t23))
+        return vaporTemperaturePS(p, s);
+    return notANumber();
+}
+
+}
+
+}
@@ -0,0 +1,74 @@
+/*! \file if97.h
+    \brief IAPWS-IF97 water and steam, regions 1, 2 and 4 with the backward equations
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef IF97_H
+#define IF97_H
+
+namespace sorpprops {
+
+/*!
+The IAPWS Industrial Formulation 1997 for the thermodynamic properties of
+water and steam (IAPWS R7-97(2012)), for the regions the cycles use:
+- region 1, compressed liquid, 273.15 K <= T <= 623.15 K, p <= 100 MPa and
+  at or above the saturation pressure
+- region 2, superheated vapor, up to 1073.15 K and at or below the saturation
+  pressure (the metastable vapor region is not included)
+- region 4, saturation from 273.15 K to the critical point, by the explicit
+  equations for p(T) and T(p)
+
+The backward equations T(p,h) and T(p,s) of regions 1 and 2 give the
+temperature without iterating, consistent with the forward equations to
+within 25 mK.
+Region 3 (near the critical point) is not implemented; all functions give
+NaN outside the regions above, and callers use their own correlations there.
+
+SI units throughout: K, MPa, kJ/kg, kJ/(kg K), m3/kg. Pure functions, safe
+to call from several threads.
+*/
+namespace if97 {
+
+/// \name Region 4, saturation
+/// \{
+/// saturation pressure [MPa] from temperature [K], 273.15..647.096 K
+double saturationPressure(double t);
+/// saturation temperature [K] from pressure [MPa], 611.213 Pa..22.064 MPa
+double saturationTemperature(double p);
+/// \}
+
+/// \name Region 1, liquid, from pressure [MPa] and temperature [K]
+/// \{
+double liquidVolume(double p, double t);
+double liquidEnthalpy(double p, double t);
+double liquidEntropy(double p, double t);
+double liquidHeatCapacity(double p, double t);
+/// \}
+
+/// \name Region 2, vapor, from pressure [MPa] and temperature [K]
+/// \{
+double vaporVolume(double p, double t);
+double vaporEnthalpy(double p, double t);
+double vaporEntropy(double p, double t);
+double vaporHeatCapacity(double p, double t);
+/// \}
+
+/// \name Backward equations, temperature [K] from pressure [MPa] and enthalpy or entropy
+/// \{
+/// region 1 only
+double liquidTemperaturePH(double p, double h);
+double liquidTemperaturePS(double p, double s);
+/// region 2 only (sub-regions 2a, 2b, 2c)
+double vaporTemperaturePH(double p, double h);
+double vaporTemperaturePS(double p, double s);
+/// region 1, 2 or the saturation temperature in between
+double temperaturePH(double p, double h);
+double temperaturePS(double p, double s);
+/// \}
+
+}
+
+}
+
+#endif // IF97_H
@@ -0,0 +1,391 @@
+/*! \file propbatch.cpp
+    \brief Property evaluation for arrays of points
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include "propbatch.h"
+#include "propkernels.h"
+
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SORPPROPS_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SORPPROPS_AVX2
+#include <intrin.h>
+#endif
+
+#ifdef SORPPROPS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace sorpprops {
+
+namespace {
+
+bool detectSimd()
+{
+#if defined(SORPPROPS_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS has to save the ymm registers
+    if(!fma || !osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SORPPROPS_AVX2)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+std::atomic<bool> &simdSwitch()
+{
+    static std::atomic<bool> on(simdAvailable());
+    return on;
+}
+
+#ifdef SORPPROPS_AVX2
+
+/// horner() for four points
+template <std::size_t N>
+SORPPROPS_AVX2 inline __m256d hornerAvx(const std::array<double,N> &c, __m256d x)
+{
+    __m256d y = _mm256_set1_pd(c[N-1]);
+    for(std::size_t i = N-1; i > 0; i--)
+        y = _mm256_fmadd_pd(y, x, _mm256_set1_pd(c[i-1]));
+    return y;
+}
+
+/// (t - 32)/1.8, F to C
+SORPPROPS_AVX2 inline __m256d celsiusAvx(__m256d t)
+{
+    return _mm256_div_pd(_mm256_sub_pd(t, _mm256_set1_pd(32.0)), _mm256_set1_pd(1.8));
+}
+
+/// t*1.8 + 32, C to F
+SORPPROPS_AVX2 inline __m256d fahrenheitAvx(__m256d t)
+{
+    return _mm256_fmadd_pd(t, _mm256_set1_pd(1.8), _mm256_set1_pd(32.0));
+}
+
+/// waterSatPressure() of four points, the exponential is taken per point
+SORPPROPS_AVX2 void satPressure4(const double *t, double *p)
+{
+    __m256d tk = _mm256_add_pd(celsiusAvx(_mm256_loadu_pd(t)), _mm256_set1_pd(273.15));
+    __m256d tau = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_div_pd(tk, _mm256_set1_pd(647.14)));
+    __m256d valid = _mm256_cmp_pd(tau, _mm256_setzero_pd(), _CMP_GE_OQ);
+    tau = _mm256_max_pd(tau, _mm256_setzero_pd());
+    __m256d sq = _mm256_sqrt_pd(tau);
+    __m256d tau3 = _mm256_mul_pd(_mm256_mul_pd(tau, tau), tau);
+    __m256d tau7 = _mm256_mul_pd(_mm256_mul_pd(tau3, tau3), tau);
+    const std::array<double,6> &f = waterSatPressureF;
+    __m256d sum = _mm256_mul_pd(_mm256_set1_pd(f[0]), tau);
+    sum = _mm256_fmadd_pd(_mm256_set1_pd(f[1]), _mm256_mul_pd(tau, sq), sum);
+    sum = _mm256_fmadd_pd(_mm256_set1_pd(f[2]), tau3, sum);
+    sum = _mm256_fmadd_pd(_mm256_set1_pd(f[3]), _mm256_mul_pd(tau3, sq), sum);
+    sum = _mm256_fmadd_pd(_mm256_set1_pd(f[4]), _mm256_mul_pd(tau3, tau), sum);
+    sum = _mm256_fmadd_pd(_mm256_set1_pd(f[5]), _mm256_mul_pd(tau7, sq), sum);
+    __m256d pkpa = _mm256_mul_pd(_mm256_div_pd(_mm256_set1_pd(647.14), tk), sum);
+    double e[4];
+    _mm256_storeu_pd(e, pkpa);
+    int ok = _mm256_movemask_pd(valid);
+    for(int j = 0; j < 4; j++)
+        p[j] = (ok & (1 << j)) ? 22064.0 * exp(e[j]) / 6.895 : notANumber();
+}
+
+SORPPROPS_AVX2 int waterSatPressureAvx(int n, const double *t, double *p)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        satPressure4(t + i, p + i);
+    return i;
+}
+
+/// saturation temperatures [C] of four pressures, per point
+SORPPROPS_AVX2 inline __m256d satTemperatureC4(const double *p)
+{
+    double th[4];
+    for(int j = 0; j < 4; j++)
+        th[j] = waterSatTemperature(p[j]);
+    return celsiusAvx(_mm256_loadu_pd(th));
+}
+
+SORPPROPS_AVX2 int librTemperatureAvx(int n, const double *p, const double *x, double *t)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d xv = _mm256_loadu_pd(x + i);
+        __m256d slope = _mm256_fmadd_pd(xv, hornerAvx(librDuhringA, xv), _mm256_set1_pd(1.0));
+        __m256d offset = _mm256_mul_pd(xv, hornerAvx(librDuhringB, xv));
+        __m256d th = satTemperatureC4(p + i);
+        _mm256_storeu_pd(t + i, fahrenheitAvx(_mm256_fmadd_pd(slope, th, offset)));
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int librPressureAvx(int n, const double *t, const double *x, double *p)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d xv = _mm256_loadu_pd(x + i);
+        __m256d slope = _mm256_fmadd_pd(xv, hornerAvx(librDuhringA, xv), _mm256_set1_pd(1.0));
+        __m256d offset = _mm256_mul_pd(xv, hornerAvx(librDuhringB, xv));
+        __m256d th = _mm256_div_pd(_mm256_sub_pd(celsiusAvx(_mm256_loadu_pd(t + i)), offset), slope);
+        double tsat[4];
+        _mm256_storeu_pd(tsat, fahrenheitAvx(th));
+        satPressure4(tsat, p + i);
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int librHumidityAvx(int n, const double *t, const double *x, double *w)
+{
+    int done = librPressureAvx(n, t, x, w);
+    for(int i = 0; i < done; i += 4)
+    {
+        __m256d pv = _mm256_mul_pd(_mm256_loadu_pd(w + i), _mm256_set1_pd(6.89475729));
+        __m256d ratio = _mm256_div_pd(pv, _mm256_sub_pd(_mm256_set1_pd(101.3), pv));
+        _mm256_storeu_pd(w + i, _mm256_mul_pd(_mm256_set1_pd(0.622), ratio));
+    }
+    return done;
+}
+
+SORPPROPS_AVX2 int librEnthalpyAvx(int n, const double *t, const double *x, double *h)
+{
+    const std::array<double,21> &c = librEnthalpyX;
+    // coefficients of hlibr and the excess enthalpy terms in powers of tc
+    const std::array<double,5> cl = {{c[0], c[13], c[14], c[15], c[16]}};
+    const std::array<double,4> ca = {{c[1], c[4], c[7], c[18]}};
+    const std::array<double,3> cb = {{c[2], c[5], c[8]}};
+    const std::array<double,3> cc = {{c[3], c[6], c[9]}};
+    const std::array<double,3> cd = {{c[10], c[11], c[12]}};
+    const std::array<double,3> ce = {{c[17], c[19], c[20]}};
+    const __m256d one = _mm256_set1_pd(1.0);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        double hw[4];
+        for(int j = 0; j < 4; j++)
+            hw[j] = waterLiquidEnthalpy(t[i+j]);
+        __m256d hh2o = _mm256_div_pd(_mm256_loadu_pd(hw), _mm256_set1_pd(0.43));
+        __m256d tc = celsiusAvx(_mm256_loadu_pd(t + i));
+        __m256d hlibr = hornerAvx(cl, tc);
+        __m256d xi = _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_set1_pd(1.e2));
+        __m256d dx = _mm256_fmsub_pd(_mm256_set1_pd(2.0), xi, one);
+        __m256d dh = hornerAvx(ce, tc);
+        dh = _mm256_fmadd_pd(dh, dx, hornerAvx(cd, tc));
+        dh = _mm256_fmadd_pd(dh, dx, hornerAvx(cc, tc));
+        dh = _mm256_fmadd_pd(dh, dx, hornerAvx(cb, tc));
+        dh = _mm256_fmadd_pd(dh, dx, hornerAvx(ca, tc));
+        __m256d xw = _mm256_sub_pd(one, xi);
+        dh = _mm256_mul_pd(_mm256_mul_pd(dh, xi), xw);
+        __m256d hs = _mm256_fmadd_pd(xi, hlibr, _mm256_fmadd_pd(xw, hh2o, dh));
+        _mm256_storeu_pd(h + i, _mm256_mul_pd(hs, _mm256_set1_pd(0.43)));
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int liclTemperatureAvx(int n, const double *p, const double *x, double *t)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d xv = _mm256_loadu_pd(x + i);
+        __m256d aa = _mm256_fmadd_pd(xv, _mm256_set1_pd(0.0047935f), _mm256_set1_pd(0.9456f));
+        aa = _mm256_fnmadd_pd(_mm256_mul_pd(_mm256_set1_pd(1.7385e-04), xv), xv, aa);
+        __m256d bb = _mm256_fnmadd_pd(_mm256_set1_pd(0.6764f), xv, _mm256_set1_pd(7.82f));
+        double tf[4];
+        for(int j = 0; j < 4; j++)
+            tf[j] = waterSatTemperature(p[i+j]);
+        __m256d tsat = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(tf), _mm256_set1_pd(32.0f)),
+                                     _mm256_set1_pd(1.8f));
+        __m256d tsol = _mm256_div_pd(_mm256_sub_pd(tsat, bb), aa);
+        _mm256_storeu_pd(t + i, _mm256_fmadd_pd(tsol, _mm256_set1_pd(1.8f), _mm256_set1_pd(32.0f)));
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int liclEnthalpyAvx(int n, const double *t, const double *x, double *h)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d xv = _mm256_loadu_pd(x + i);
+        __m256d ts = celsiusAvx(_mm256_loadu_pd(t + i));
+        __m256d hv = _mm256_fmadd_pd(hornerAvx(liclEnthalpyC, xv), ts, hornerAvx(liclEnthalpyB, xv));
+        hv = _mm256_fmadd_pd(hv, ts, hornerAvx(liclEnthalpyA, xv));
+        _mm256_storeu_pd(h + i, _mm256_div_pd(hv, _mm256_set1_pd(2.326)));
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int ammoniaTemperatureAvx(int n, const double *p, const double *x, double *t)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d w = _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_set1_pd(1.e2));
+        __m256d aa = _mm256_mul_pd(w, hornerAvx(ammoniaBoilingA, w));
+        __m256d bb = _mm256_fmadd_pd(w, hornerAvx(ammoniaBoilingB, w), _mm256_set1_pd(1.0));
+        __m256d cc = _mm256_mul_pd(w, hornerAvx(ammoniaBoilingC, w));
+        __m256d thc = satTemperatureC4(p + i);
+        __m256d tc = _mm256_fmadd_pd(_mm256_fmadd_pd(cc, thc, bb), thc, aa);
+        _mm256_storeu_pd(t + i, fahrenheitAvx(tc));
+    }
+    return i;
+}
+
+SORPPROPS_AVX2 int airEnthalpyAvx(int n, const double *t, const double *w, double *h)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d tc = celsiusAvx(_mm256_loadu_pd(t + i));
+        __m256d hv = _mm256_fmadd_pd(_mm256_set1_pd(1.84), tc, _mm256_set1_pd(2501));
+        hv = _mm256_mul_pd(_mm256_loadu_pd(w + i), hv);
+        hv = _mm256_fmadd_pd(_mm256_set1_pd(1.006), tc, hv);
+        _mm256_storeu_pd(h + i, _mm256_div_pd(hv, _mm256_set1_pd(2.326)));
+    }
+    return i;
+}
+
+#define SORPPROPS_SIMD(call) (simdSwitch().load(std::memory_order_relaxed) ? call : 0)
+#else
+#define SORPPROPS_SIMD(call) 0
+#endif
+
+}
+
+bool simdAvailable()
+{
+    static const bool available = detectSimd();
+    return available;
+}
+
+bool simdEnabled()
+{
+    return simdSwitch().load();
+}
+
+void setSimdEnabled(bool on)
+{
+    simdSwitch().store(on && simdAvailable());
+}
+
+namespace water {
+
+void satPressure(int n, const double *t, double *p)
+{
+    for(int i = SORPPROPS_SIMD(waterSatPressureAvx(n, t, p)); i < n; i++)
+        p[i] = waterSatPressure(t[i]);
+}
+
+void satTemperature(int n, const double *p, double *t)
+{
+    for(int i = 0; i < n; i++)
+        t[i] = waterSatTemperature(p[i]);
+}
+
+void liquidEnthalpy(int n, const double *t, double *h)
+{
+    for(int i = 0; i < n; i++)
+        h[i] = waterLiquidEnthalpy(t[i]);
+}
+
+}
+
+namespace libr {
+
+void temperature(int n, const double *p, const double *x, double *t)
+{
+    for(int i = SORPPROPS_SIMD(librTemperatureAvx(n, p, x, t)); i < n; i++)
+        t[i] = librTemperature(p[i], x[i]);
+}
+
+void pressure(int n, const double *t, const double *x, double *p)
+{
+    for(int i = SORPPROPS_SIMD(librPressureAvx(n, t, x, p)); i < n; i++)
+        p[i] = librPressure(t[i], x[i]);
+}
+
+void humidity(int n, const double *t, const double *x, double *w)
+{
+    for(int i = SORPPROPS_SIMD(librHumidityAvx(n, t, x, w)); i < n; i++)
+        w[i] = librHumidity(t[i], x[i]);
+}
+
+void enthalpy(int n, const double *t, const double *x, double *h)
+{
+    for(int i = SORPPROPS_SIMD(librEnthalpyAvx(n, t, x, h)); i < n; i++)
+        h[i] = librEnthalpy(t[i], x[i]);
+}
+
+}
+
+namespace licl {
+
+void temperature(int n, const double *p, const double *x, double *t)
+{
+    for(int i = SORPPROPS_SIMD(liclTemperatureAvx(n, p, x, t)); i < n; i++)
+        t[i] = liclTemperature(p[i], x[i]);
+}
+
+void humidity(int n, const double *t, const double *x, double *w)
+{
+    for(int i = 0; i < n; i++)
+        w[i] = liclHumidity(t[i], x[i]);
+}
+
+void heatCapacity(int n, const double *t, const double *x, double *cp)
+{
+    for(int i = 0; i < n; i++)
+        cp[i] = liclHeatCapacity(t[i], x[i]);
+}
+
+void enthalpy(int n, const double *t, const double *x, double *h)
+{
+    for(int i = SORPPROPS_SIMD(liclEnthalpyAvx(n, t, x, h)); i < n; i++)
+        h[i] = liclEnthalpy(t[i], x[i]);
+}
+
+}
+
+namespace ammonia {
+
+void temperature(int n, const double *p, const double *x, double *t)
+{
+    for(int i = SORPPROPS_SIMD(ammoniaTemperatureAvx(n, p, x, t)); i < n; i++)
+        t[i] = ammoniaTemperature(p[i], x[i]);
+}
+
+void concentration(int n, const double *t, const double *p, double *x)
+{
+    for(int i = 0; i < n; i++)
+        x[i] = ammoniaConcentration(t[i], p[i]);
+}
+
+}
+
+namespace air {
+
+void enthalpy(int n, const double *t, const double *w, double *h)
+{
+    for(int i = SORPPROPS_SIMD(airEnthalpyAvx(n, t, w, h)); i < n; i++)
+        h[i] = airEnthalpy(t[i], w[i]);
+}
+
+}
+
+}
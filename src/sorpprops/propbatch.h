@@ -0,0 +1,82 @@
+/*! \file propbatch.h
+    \brief Property evaluation for arrays of points
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPBATCH_H
+#define PROPBATCH_H
+
+/*!
+Batch versions of the kernels in propkernels.h, one group per fluid family.
+
+Each function evaluates n points, reading the i-th input from each input array
+and writing the i-th result to the output array, so results come out
+contiguously in the order of the inputs. The arrays may not overlap.
+
+The polynomial stages (Duhring relations, enthalpy and boiling temperature
+polynomials) are evaluated four points at a time with AVX2/FMA if the processor
+has it, with the scalar kernels otherwise and for the remaining points.
+Iterative inversions (waterSatTemperature(), ammoniaConcentration()) and the
+pow/exp stages run point by point in both cases. With FMA, results may differ
+from the scalar kernels in the last bits.
+
+- units are those of propkernels.h (F, psia, weight %, Btu/lb)
+- points with invalid input give NaN, the other points are not affected
+- the functions have no state and can be called from several threads
+*/
+namespace sorpprops {
+
+/// \return true if the batch functions use AVX2
+bool simdEnabled();
+/// Selects the AVX2 (if the processor has it) or the scalar path, e.g. to compare them.
+void setSimdEnabled(bool on);
+/// \return true if the processor has AVX2 and FMA
+bool simdAvailable();
+
+namespace water {
+/// saturation pressure from temperature
+void satPressure(int n, const double *t, double *p);
+/// saturation temperature from pressure
+void satTemperature(int n, const double *p, double *t);
+/// enthalpy of saturated liquid from temperature
+void liquidEnthalpy(int n, const double *t, double *h);
+}
+
+namespace libr {
+/// equilibrium temperature from pressure and concentration
+void temperature(int n, const double *p, const double *x, double *t);
+/// equilibrium pressure from temperature and concentration
+void pressure(int n, const double *t, const double *x, double *p);
+/// humidity ratio of air in equilibrium from temperature and concentration
+void humidity(int n, const double *t, const double *x, double *w);
+/// enthalpy from temperature and concentration
+void enthalpy(int n, const double *t, const double *x, double *h);
+}
+
+namespace licl {
+/// equilibrium temperature from pressure and concentration
+void temperature(int n, const double *p, const double *x, double *t);
+/// humidity ratio of air in equilibrium from temperature and concentration
+void humidity(int n, const double *t, const double *x, double *w);
+/// specific heat from temperature and concentration
+void heatCapacity(int n, const double *t, const double *x, double *cp);
+/// enthalpy from temperature and concentration
+void enthalpy(int n, const double *t, const double *x, double *h);
+}
+
+namespace ammonia {
+/// boiling temperature from pressure and NH3 concentration
+void temperature(int n, const double *p, const double *x, double *t);
+/// NH3 concentration of the liquid from temperature and pressure
+void concentration(int n, const double *t, const double *p, double *x);
+}
+
+namespace air {
+/// enthalpy from temperature and humidity ratio
+void enthalpy(int n, const double *t, const double *w, double *h);
+}
+
+}
+
+#endif // PROPBATCH_H
@@ -0,0 +1,140 @@
+/*! \file propcoefficients.h
+    \brief Coefficient tables of the property correlations
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPCOEFFICIENTS_H
+#define PROPCOEFFICIENTS_H
+
+#include <array>
+#include <cstddef>
+
+/*!
+Coefficients of the property correlations as compile time tables, shared by
+the engine's routines and the kernels in propkernels.h.
+
+The engine used to keep them in save blocks of sorpsim4l::common that were
+filled on the first call. Tables that are constant expressions need no
+initialization, no first-call check and no locking, and the compiler can
+fold them into the polynomial evaluation (see horner()).
+*/
+namespace sorpprops {
+
+namespace detail {
+
+template <std::size_t I, std::size_t N>
+struct hornerStep
+{
+    static constexpr double eval(const std::array<double,N> &c, double x, double y)
+    {
+        return hornerStep<I-1,N>::eval(c, x, y*x + c[I-1]);
+    }
+};
+
+template <std::size_t N>
+struct hornerStep<0,N>
+{
+    static constexpr double eval(const std::array<double,N> &, double, double y)
+    {
+        return y;
+    }
+};
+
+}
+
+/// c[0] + c[1]*x + ... + c[N-1]*x^(N-1), unrolled at compile time
+template <std::size_t N>
+constexpr double horner(const std::array<double,N> &c, double x)
+{
+    return detail::hornerStep<N-1,N>::eval(c, x, c[N-1]);
+}
+
+/// c[0]*x + c[1]*x^2 + ... + c[N-1]*x^N, the form of the Fortran DO loops
+/// "sum = sum + c(i)*x**i"
+template <std::size_t N>
+constexpr double hornerFromFirst(const std::array<double,N> &c, double x)
+{
+    return x * horner(c, x);
+}
+
+/// \name Water (pft3, yvtp2)
+/// \{
+
+/// coefficients of tau, tau^1.5, tau^3, tau^3.5, tau^4 and tau^7.5 of the
+/// saturation pressure (Wagner/Pruss)
+constexpr std::array<double,6> waterSatPressureF = {{
+    -7.85823, 1.83991, -11.7811, 22.6705, -15.9393, 1.77516
+}};
+/// \}
+
+/// \name LiBr/water (tfpx1, pftx1, hftx1, hwftx1)
+/// \{
+
+/// Duhring relation: slope 1 + sum a[i]*x^(i+1), offset sum b[i]*x^(i+1) [C]
+constexpr std::array<double,10> librDuhringA = {{
+    -.68242821e-03, +.58736190e-03, -.10278186e-03, +.93032374e-05, -.48223940e-06,
+    +.15189038e-07, -.29412863e-09, +.34100528e-11, -.21671480e-13, +.57995604e-16
+}};
+constexpr std::array<double,10> librDuhringB = {{
+    +.16634856e+00, -.55338169e-01, +.11228336e-01, -.11028390e-02, +.62109464e-04,
+    -.21112567e-05, +.43851901e-07, -.54098115e-09, +.36266742e-11, -.10153059e-13
+}};
+
+/// Kuck/Pohl enthalpy coefficients, X(1)..X(21) of hftx1 at [0]..[20]
+constexpr std::array<double,21> librEnthalpyX = {{
+    0.5086682481e+03, -0.1021608631e+04, -0.5333082110e+03, 0.4836280661e+03, 0.3687726426e+02,
+    0.4028472553e+02, 0.3991418127e+02, -0.1860514100e+00, -0.1911981148e+00, -0.1992131652e+00,
+    0.1155132809e+04, 0.3335722311e+02, -0.1782584073e+00, -0.1862407335e+02, 0.9859458321e-01,
+    -0.2509791095e-04, 0.4158007710e-07, 0.6406219484e+03, -0.7512766773e-05, 0.1310318363e+02,
+    -0.7751011421e-01
+}};
+/// \}
+
+/// \name LiCl/water (hftx9)
+/// \{
+
+/// enthalpy [kJ/kg] = A(x) + B(x)*tC + C(x)*tC^2, polynomials in the concentration [%]
+constexpr std::array<double,5> liclEnthalpyA = {{
+    -66.2324, 11.2711, -0.79853, 2.1534E-02, -1.66352E-04
+}};
+constexpr std::array<double,5> liclEnthalpyB = {{
+    4.5751, -0.146924, 6.307226E-03, -1.38054E-04, 1.06690E-06
+}};
+constexpr std::array<double,5> liclEnthalpyC = {{
+    -8.09689E-04, 2.18145E-04, -1.36194E-05, 3.20998E-07, -2.64266E-09
+}};
+/// \}
+
+/// \name Ammonia/water (tfpx2, xftp2, yvtp2)
+/// \{
+
+/// boiling temperature: aa = sum a[i]*w^(i+1), bb = 1 + sum b[i]*w^(i+1),
+/// cc = sum c[i]*w^(i+1) with the NH3 mass fraction w
+constexpr std::array<double,7> ammoniaBoilingA = {{
+    -555.42808, 2890.3954, -9999.3985, 20707.756, -25032.344, 16201.291, -4315.3626
+}};
+constexpr std::array<double,7> ammoniaBoilingB = {{
+    2.9401340, -29.746632, 113.01928, -254.44689, 337.26490, -235.87537, 66.517338
+}};
+constexpr std::array<double,7> ammoniaBoilingC = {{
+    -0.0073825347, 0.070452714, -0.26091336, 0.57941902, -0.77216652, 0.5479346, -0.15714291
+}};
+
+/// vapor phase of yvtp2: molar volume of water (AvW), virial coefficients of
+/// water (CW) and excess Gibbs energy (E)
+constexpr std::array<double,4> ammoniaVaporAvw = {{
+    2.748796e-02, -1.016665e-05, -4.452025e-03, 8.389246e-04
+}};
+constexpr std::array<double,4> ammoniaVaporCw = {{
+    2.136131e-02, -3.169291e+01, -4.634611e+04, 0.0
+}};
+constexpr std::array<double,16> ammoniaVaporE = {{
+    -41.733398, 0.02414, 6.702285, -0.011475, 63.608967, -62.490768, 1.761064, 0.008626,
+    0.387983, -0.004772, -4.648107, 0.836376, -3.553627, 0.000904, 24.361723, -20.736547
+}};
+/// \}
+
+}
+
+#endif // PROPCOEFFICIENTS_H
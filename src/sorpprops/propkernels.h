@@ -0,0 +1,345 @@
+/*! \file propkernels.h
+    \brief Pure scalar kernels of the property correlations used by the engine
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPKERNELS_H
+#define PROPKERNELS_H
+
+#include <math.h>
+#include <limits>
+
+#include "propcoefficients.h"
+
+/*!
+Property correlations of the engine as pure functions.
+
+The engine's routines (pft3, tfp3, tfpx1, hftx1, ...) take sorpsim4l::common
+and stop the calculation on invalid input. The kernels here compute the same
+correlations, with the coefficients of propcoefficients.h, with no state and no
+side effects, so they can be evaluated for many points at once (see propbatch.h) and
+from several threads.
+- units are the engine's: deg F, psia, concentration in weight %, Btu/lb
+- invalid input (e.g. water above its critical point) gives NaN instead of stopping
+- polynomials are evaluated in Horner form, results agree with the engine's
+  routines to rounding
+*/
+namespace sorpprops {
+
+inline double notANumber()
+{
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+/// \name Water (pft3, tfp3, hft3)
+/// \{
+
+/// saturation pressure [psia] from temperature [F], as pft3
+inline double waterSatPressure(double t)
+{
+    double tk = (t - 32.0) / 1.8 + 273.15;
+    double tau = 1.0 - tk / 647.14;
+    if(tau < 0.0)
+        return notANumber();
+    const std::array<double,6> &f = waterSatPressureF;
+    double sq = sqrt(tau);
+    double tau3 = tau*tau*tau;
+    double pkpa = 647.14 / tk * (f[0] * tau + f[1] * tau*sq + f[2] * tau3 + f[3] * tau3*sq
+                                 + f[4] * tau3*tau + f[5] * tau3*tau3*tau*sq);
+    return 22064.0 * exp(pkpa) / 6.895;
+}
+
+/// saturation temperature [F] from pressure [psia], as tfp3 (regula falsi on
+/// waterSatPressure() to a relative residual of 1e-14)
+/// \param iterations if given, receives the number of pressure evaluations
+inline double waterSatTemperature(double p, int *iterations = 0)
+{
+    int i = 0;
+    if(iterations)
+        *iterations = 0;
+    if(!(p <= 3200.0) || !(p >= 2.5491e-6))
+        return notANumber();
+    double tcr = (647.14 - 273.15) * 1.8 + 32.0;
+    double t;
+    if(p * 6.895 < 9500.0)
+        t = 0.426776e2 - 0.389270e4 / (log(p * 6.895e-3) - 0.948654e1);
+    else
+        t = -0.387592e3 - 0.125875e5 / (log(p * 6.895e-3) - 0.152578e2);
+    t = (t - 273.15) * 1.8 + 32.0;
+    i++;
+    double tmax = t + 0.9;
+    if(tmax > tcr)
+        tmax = tcr;
+    double fmax = (p - waterSatPressure(tmax)) / p;
+    if(fabs(fmax) < 1.e-14)
+    {
+        if(iterations)
+            *iterations = i;
+        return tmax;
+    }
+    i++;
+    double tmin = tmax - 7.2;
+    double fmin = (p - waterSatPressure(tmin)) / p;
+    if(fmin * fmax > 0.0)
+        return notANumber();
+    for(;;)
+    {
+        i++;
+        t = tmax - fmax / ((fmax - fmin) / (tmax - tmin));
+        double f = (p - waterSatPressure(t)) / p;
+        if(i > 500 || fabs(f) < 1.e-14)
+            break;
+        if(f * fmin > 0.0)
+        {
+            tmin = t;
+            fmin = f;
+        }
+        else
+        {
+            tmax = t;
+            fmax = f;
+        }
+    }
+    if(iterations)
+        *iterations = i;
+    return t;
+}
+
+/// enthalpy of saturated liquid [Btu/lb] from temperature [F], as hft3
+inline double waterLiquidEnthalpy(double t)
+{
+    double tk = (t - 32.0) / 1.8 + 273.15;
+    double tau = 1.0 - tk / 647.14;
+    if(tau < 0.0)
+        return notANumber();
+    double teta = tk / 647.14;
+    double sq = sqrt(tau);
+    double tau2 = tau*tau, tau3 = tau2*tau;
+    double pspc = 647.14 / tk * (-7.85823 * tau + 1.83991 * tau*sq - 11.7811 * tau3
+                                 + 22.6705 * tau3*sq - 15.9393 * tau3*tau
+                                 + 1.77516 * tau3*tau3*tau*sq);
+    double ps = 22064000.0 * exp(pspc);
+    double dpdt = -ps / tk * (pspc - 7.85823 + 1.5 * 1.83991 * sq - 3.0 * 11.7811 * tau2
+                              + 3.5 * 22.6705 * tau2*sq - 4.0 * 15.9393 * tau3
+                              + 7.5 * 1.77516 * tau3*tau3*sq);
+    double cb = cbrt(tau);
+    double dkgm3 = 322.0 * (1.0 + 1.99206 * cb + 1.10123 * cb*cb - 5.12506e-1 * pow(tau, 5.0/3.0)
+                            - 1.75263 * pow(tau, 16.0/3.0) - 45.4485 * pow(tau, 43.0/3.0)
+                            - 6.75615e5 * pow(tau, 110.0/3.0));
+    double alpha = 1.e3 * (-1135.481615639 - 5.71756e-8 * pow(teta, -19) + 2689.81 * teta
+                           + 129.889 * pow(teta, 4.5) - 137.181 * pow(teta, 5)
+                           + 9.68874e-1 * pow(teta, 54.5));
+    return (alpha + tk / dkgm3 * dpdt) / 2326.0;
+}
+/// \}
+
+/// \name LiBr/water (tfpx1, pftx1, hftx1, wftx1)
+/// \{
+
+inline double librDuhringSlope(double x)
+{
+    return 1.0 + hornerFromFirst(librDuhringA, x);
+}
+
+inline double librDuhringOffset(double x)
+{
+    return hornerFromFirst(librDuhringB, x);
+}
+
+/// equilibrium temperature [F] from pressure [psia] and LiBr concentration [%], as tfpx1
+inline double librTemperature(double p, double x)
+{
+    double th = (waterSatTemperature(p) - 32.0) / 1.8;
+    return (librDuhringOffset(x) + librDuhringSlope(x) * th) * 1.8 + 32.0;
+}
+
+/// equilibrium pressure [psia] from temperature [F] and LiBr concentration [%], as pftx1
+inline double librPressure(double t, double x)
+{
+    double tc = (t - 32.0) / 1.8;
+    double th = (tc - librDuhringOffset(x)) / librDuhringSlope(x);
+    return waterSatPressure(th * 1.8 + 32.0);
+}
+
+/// humidity ratio of air in equilibrium with the solution, from temperature [F]
+/// and LiBr concentration [%], as wftx1
+inline double librHumidity(double t, double x)
+{
+    double pv = librPressure(t, x) * 6.89475729;
+    return 0.622 * (pv / (101.3 - pv));
+}
+
+/// enthalpy [Btu/lb] from temperature [F] and LiBr concentration [%], as hftx1
+inline double librEnthalpy(double t, double cl)
+{
+    const std::array<double,21> &x = librEnthalpyX;
+    double hh2o = waterLiquidEnthalpy(t) / 0.43;
+    double tc = (t - 32.0) / 1.8;
+    double hlibr = x[0] + tc * (x[13] + tc * (x[14] + tc * (x[15] + tc * x[16])));
+    // excess enthalpy
+    double a = x[1] + tc * (x[4] + tc * (x[7] + tc * x[18]));
+    double b = x[2] + tc * (x[5] + tc * x[8]);
+    double c = x[3] + tc * (x[6] + tc * x[9]);
+    double d = x[10] + tc * (x[11] + tc * x[12]);
+    double e = x[17] + tc * (x[19] + tc * x[20]);
+    double xi = cl / 1.e2;
+    double dx = 2.0 * xi - 1.0;
+    double dh = (a + dx * (b + dx * (c + dx * (d + dx * e)))) * xi * (1.0 - xi);
+    return (xi * hlibr + (1.0 - xi) * hh2o + dh) * 0.43;
+}
+/// \}
+
+/// \name LiCl/water (tfpx9, pftx9, wftx9, cpftx9, hftx9)
+/// The float constants are the engine's.
+/// \{
+
+/// equilibrium temperature [F] from pressure [psia] and LiCl concentration [%], as tfpx9
+inline double liclTemperature(double p, double x)
+{
+    double aa = 0.9456f + 0.0047935f * x - (1.7385e-04) * x * x;
+    double bb = 7.82f - 0.6764f * x;
+    double tsat = (waterSatTemperature(p) - 32.0f) / 1.8f;
+    return (tsat - bb) / aa * 1.8f + 32.0f;
+}
+
+/// equilibrium pressure [psia] from temperature [F] and LiCl concentration [%], as pftx9
+inline double liclPressure(double t, double x)
+{
+    double aa = 0.9456f + 0.0047935f * x - (1.7385e-04) * x * x;
+    double bb = 7.82f - 0.6764f * x;
+    double tsol = (t - 32.0f) / 1.8f;
+    double tsat = aa * tsol + bb;
+    return waterSatPressure(tsat * 1.8f + 32);
+}
+
+/// humidity ratio of air in equilibrium with the solution (Conde), from
+/// temperature [F] and LiCl concentration [%], as wftx9
+inline double liclHumidity(double t, double xi)
+{
+    double x = xi / 100;
+    double psatKpa = waterSatPressure(t) * 6.895;
+    double tk = (t - 32) / 1.8 + 273.15;
+    double A = 2 - pow(1 + pow(x / 0.28, 4.3), 0.6);
+    double B = pow(1 + pow(x / 0.21, 5.1), 0.49) - 1;
+    double a25 = 1 - pow(1 + pow(x / 0.362, -4.75), -0.4) - 0.03 * exp(-(x - 0.1) * (x - 0.1) / 0.005);
+    double pv = psatKpa * a25 * (A + B * tk / 647.1);
+    return 0.622 * (pv / (101.3 - pv));
+}
+
+/// specific heat [Btu/lb-F] from temperature [F] and LiCl concentration [%], as cpftx9
+inline double liclHeatCapacity(double t, double xs)
+{
+    double theta = ((t - 32) / 1.8 + 273.15) / 228 - 1;
+    double xi = xs / 100;
+    double cpH2O = 88.7891 - 120.1959 * pow(theta, 0.02) - 16.9264 * pow(theta, 0.04)
+            + 52.4654 * pow(theta, 0.06) + 0.10826 * pow(theta, 1.8) + 0.46988 * pow(theta, 8);
+    double f1;
+    if(xi < 0.31)
+        f1 = xi * (1.43980 + xi * (-1.24317 + xi * -0.12070));
+    else
+        f1 = 0.12825 + 0.62934 * xi;
+    double f2 = 58.5225 * pow(theta, 0.02) - 105.6343 * pow(theta, 0.04) + 47.7948 * pow(theta, 0.06);
+    return cpH2O * (1 - f1 * f2) / 4.186798188;
+}
+
+/// enthalpy [Btu/lb] from temperature [F] and LiCl concentration [%], as hftx9
+inline double liclEnthalpy(double t, double x)
+{
+    double ts = (t - 32) / 1.8;
+    double h = horner(liclEnthalpyA, x)
+            + ts * (horner(liclEnthalpyB, x) + ts * horner(liclEnthalpyC, x));
+    return h / 2.326;
+}
+/// \}
+
+/// \name Ammonia/water (tfpx2, xftp2)
+/// \{
+
+/// boiling temperature [F] of the solution with NH3 mass fraction w and water
+/// saturation temperature thc [C]
+inline double ammoniaBoilingTemperature(double w, double thc)
+{
+    double aa = hornerFromFirst(ammoniaBoilingA, w);
+    double bb = 1.0 + hornerFromFirst(ammoniaBoilingB, w);
+    double cc = hornerFromFirst(ammoniaBoilingC, w);
+    return (aa + bb * thc + cc * thc * thc) * 1.8 + 32.0;
+}
+
+/// boiling temperature [F] from pressure [psia] and NH3 concentration [%], as tfpx2
+inline double ammoniaTemperature(double p, double wnl)
+{
+    double thc = (waterSatTemperature(p) - 32.0) / 1.8;
+    return ammoniaBoilingTemperature(wnl / 1.e2, thc);
+}
+
+/// NH3 concentration [%] of the liquid from temperature [F] and pressure [psia],
+/// as xftp2 (bisection to 1e-8 F)
+/// \param iterations if given, receives the number of temperature evaluations
+inline double ammoniaConcentration(double t, double p, int *iterations = 0)
+{
+    int iter = 0;
+    if(iterations)
+        *iterations = 0;
+    double th = waterSatTemperature(p);
+    if(th != th)
+        return notANumber();
+    if(t >= th)
+        return 0.0;// superheated water vapor
+    double thc = (th - 32.0) / 1.8;
+    double wmax = 1.0, wmin = 0.0;
+    double wnl = notANumber();
+    iter++;
+    double fmax = t - ammoniaBoilingTemperature(1.0, thc);
+    iter++;
+    double fmin = t - th;
+    if(fabs(fmax) < 1.e-8)
+        wnl = 1.e2;
+    else if(fabs(fmin) < 1.e-8)
+        wnl = 0.0;
+    else if(fmin * fmax > 0.0)
+        wnl = 1.e2;// subcooled pure NH3
+    else
+        for(;;)
+        {
+            iter++;
+            double w = (wmax + wmin) / 2.0;
+            double f = t - ammoniaBoilingTemperature(w, thc);
+            if(iter > 500)
+                break;
+            if(fabs(f) < 1.e-8)
+            {
+                wnl = w * 1.e2;
+                break;
+            }
+            if(f * fmin > 0.0)
+            {
+                wmin = w;
+                fmin = f;
+            }
+            else
+            {
+                wmax = w;
+                fmax = f;
+            }
+        }
+    if(iterations)
+        *iterations = iter;
+    return wnl;
+}
+/// \}
+
+/// \name Moist air (hftx10)
+/// \{
+
+/// enthalpy [Btu/lb dry air] from temperature [F] and humidity ratio [lb/lb], as hftx10
+inline double airEnthalpy(double t, double x)
+{
+    double tc = (t - 32.0) / 1.8;
+    return (1.006 * tc + x * (1.84 * tc + 2501)) / 2.326;
+}
+/// \}
+
+}
+
+#endif // PROPKERNELS_H
@@ -0,0 +1,286 @@
+/*! \file propspline.cpp
+    \brief Cubic Hermite tables of property functions
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include "propspline.h"
+#include "propkernels.h"
+
+#include <istream>
+#include <ostream>
+
+namespace sorpprops {
+
+namespace {
+
+/// slopes of n >= 4 equally spaced values y[0], y[stride], ... into d[0], d[stride], ...
+/// (4th order central differences inside, 3rd order one sided ones at the ends)
+void slopes(const double *y, int n, int stride, double h, double *d)
+{
+    for(int i = 0; i < n; i++)
+    {
+        const double *p = y + i * stride;
+        double s;
+        if(i == 0)
+            s = -11 * p[0] + 18 * p[stride] - 9 * p[2*stride] + 2 * p[3*stride];
+        else if(i == n-1)
+            s = 11 * p[0] - 18 * p[-stride] + 9 * p[-2*stride] - 2 * p[-3*stride];
+        else if(i == 1)
+            s = -2 * p[-stride] - 3 * p[0] + 6 * p[stride] - p[2*stride];
+        else if(i == n-2)
+            s = 2 * p[stride] + 3 * p[0] - 6 * p[-stride] + p[-2*stride];
+        else
+            s = (p[-2*stride] - 8 * p[-stride] + 8 * p[stride] - p[2*stride]) / 2;
+        d[i * stride] = s / (6 * h);
+    }
+}
+
+bool allFinite(const std::vector<double> &values)
+{
+    for(size_t i = 0; i < values.size(); i++)
+        if(!(values[i] - values[i] == 0))
+            return false;
+    return true;
+}
+
+/// cell index and position in the cell of t = (x - x0)/h, for n nodes
+inline int cell(double t, int n, double &s)
+{
+    int i = int(t);
+    if(i > n - 2)
+        i = n - 2;
+    s = t - i;
+    return i;
+}
+
+void writeDoubles(std::ostream &out, const std::vector<double> &values)
+{
+    unsigned int n = values.size();
+    out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char *>(values.data()), n * sizeof(double));
+}
+
+bool readDoubles(std::istream &in, std::vector<double> &values)
+{
+    unsigned int n = 0;
+    in.read(reinterpret_cast<char *>(&n), sizeof(n));
+    if(!in || n > (1u << 24))
+        return false;
+    values.resize(n);
+    in.read(reinterpret_cast<char *>(values.data()), n * sizeof(double));
+    return bool(in);
+}
+
+template <typename T>
+void writeValue(std::ostream &out, T value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::istream &in, T &value)
+{
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return bool(in);
+}
+
+}
+
+cubicTable::cubicTable() :
+    x0(0),
+    h(0),
+    error(0)
+{
+}
+
+bool cubicTable::setValues(double from, double to, const std::vector<double> &values)
+{
+    y.clear();
+    dy.clear();
+    error = 0;
+    if(values.size() < 4 || !(to > from) || !allFinite(values))
+        return false;
+    x0 = from;
+    h = (to - from) / (values.size() - 1);
+    y = values;
+    dy.resize(y.size());
+    slopes(y.data(), y.size(), 1, h, dy.data());
+    return true;
+}
+
+double cubicTable::operator()(double x) const
+{
+    if(!covers(x))
+        return notANumber();
+    double s;
+    int i = cell((x - x0) / h, y.size(), s);
+    double s2 = s * s, s3 = s2 * s;
+    return (2*s3 - 3*s2 + 1) * y[i] + (s3 - 2*s2 + s) * h * dy[i]
+            + (3*s2 - 2*s3) * y[i+1] + (s3 - s2) * h * dy[i+1];
+}
+
+bool cubicTable::covers(double x) const
+{
+    return !y.empty() && x >= x0 && x <= last();
+}
+
+bool cubicTable::isValid() const
+{
+    return !y.empty();
+}
+
+double cubicTable::first() const
+{
+    return x0;
+}
+
+double cubicTable::last() const
+{
+    return x0 + h * (int(y.size()) - 1);
+}
+
+int cubicTable::nodes() const
+{
+    return y.size();
+}
+
+double cubicTable::maxError() const
+{
+    return error;
+}
+
+void cubicTable::write(std::ostream &out) const
+{
+    writeValue(out, x0);
+    writeValue(out, h);
+    writeValue(out, error);
+    writeDoubles(out, y);
+}
+
+bool cubicTable::read(std::istream &in)
+{
+    std::vector<double> values;
+    double from = 0, step = 0, measured = 0;
+    if(!readValue(in, from) || !readValue(in, step) || !readValue(in, measured)
+            || !readDoubles(in, values))
+        return false;
+    if(!setValues(from, from + step * (int(values.size()) - 1), values))
+        return false;
+    h = step;// exactly as written
+    error = measured;
+    return true;
+}
+
+bicubicTable::bicubicTable() :
+    x0(0),
+    y0(0),
+    hx(0),
+    hy(0),
+    nx(0),
+    ny(0),
+    error(0)
+{
+}
+
+bool bicubicTable::setValues(double xFrom, double xTo, int xNodes, double yFrom, double yTo, int yNodes,
+                             const std::vector<double> &values)
+{
+    v.clear();
+    vx.clear();
+    vy.clear();
+    vxy.clear();
+    nx = ny = 0;
+    error = 0;
+    if(xNodes < 4 || yNodes < 4 || values.size() != size_t(xNodes) * yNodes
+            || !(xTo > xFrom) || !(yTo > yFrom) || !allFinite(values))
+        return false;
+    x0 = xFrom;
+    y0 = yFrom;
+    nx = xNodes;
+    ny = yNodes;
+    hx = (xTo - xFrom) / (nx - 1);
+    hy = (yTo - yFrom) / (ny - 1);
+    v = values;
+    vx.resize(v.size());
+    vy.resize(v.size());
+    vxy.resize(v.size());
+    for(int j = 0; j < ny; j++)
+        slopes(v.data() + size_t(j) * nx, nx, 1, hx, vx.data() + size_t(j) * nx);
+    for(int i = 0; i < nx; i++)
+    {
+        slopes(v.data() + i, ny, nx, hy, vy.data() + i);
+        slopes(vx.data() + i, ny, nx, hy, vxy.data() + i);
+    }
+    return true;
+}
+
+double bicubicTable::operator()(double x, double y) const
+{
+    if(!covers(x, y))
+        return notANumber();
+    double s, u;
+    int i = cell((x - x0) / hx, nx, s);
+    int j = cell((y - y0) / hy, ny, u);
+    double s2 = s * s, s3 = s2 * s, u2 = u * u, u3 = u2 * u;
+    // Hermite basis of the values and (scaled) slopes at both ends of the cell
+    double a[2] = {2*s3 - 3*s2 + 1, 3*s2 - 2*s3};
+    double ad[2] = {(s3 - 2*s2 + s) * hx, (s3 - s2) * hx};
+    double b[2] = {2*u3 - 3*u2 + 1, 3*u2 - 2*u3};
+    double bd[2] = {(u3 - 2*u2 + u) * hy, (u3 - u2) * hy};
+    double sum = 0;
+    for(int l = 0; l < 2; l++)
+        for(int k = 0; k < 2; k++)
+        {
+            size_t n = size_t(j + l) * nx + i + k;
+            sum += a[k] * b[l] * v[n] + ad[k] * b[l] * vx[n]
+                    + a[k] * bd[l] * vy[n] + ad[k] * bd[l] * vxy[n];
+        }
+    return sum;
+}
+
+bool bicubicTable::covers(double x, double y) const
+{
+    return !v.empty() && x >= x0 && x <= x0 + hx * (nx - 1) && y >= y0 && y <= y0 + hy * (ny - 1);
+}
+
+bool bicubicTable::isValid() const
+{
+    return !v.empty();
+}
+
+double bicubicTable::maxError() const
+{
+    return error;
+}
+
+void bicubicTable::write(std::ostream &out) const
+{
+    writeValue(out, x0);
+    writeValue(out, hx);
+    writeValue(out, nx);
+    writeValue(out, y0);
+    writeValue(out, hy);
+    writeValue(out, ny);
+    writeValue(out, error);
+    writeDoubles(out, v);
+}
+
+bool bicubicTable::read(std::istream &in)
+{
+    std::vector<double> values;
+    double xFrom = 0, xStep = 0, yFrom = 0, yStep = 0, measured = 0;
+    int xNodes = 0, yNodes = 0;
+    if(!readValue(in, xFrom) || !readValue(in, xStep) || !readValue(in, xNodes)
+            || !readValue(in, yFrom) || !readValue(in, yStep) || !readValue(in, yNodes)
+            || !readValue(in, measured) || !readDoubles(in, values))
+        return false;
+    if(!setValues(xFrom, xFrom + xStep * (xNodes - 1), xNodes, yFrom, yFrom + yStep * (yNodes - 1), yNodes, values))
+        return false;
+    hx = xStep;
+    hy = yStep;
+    error = measured;
+    return true;
+}
+
+}
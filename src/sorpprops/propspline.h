@@ -0,0 +1,150 @@
+/*! \file propspline.h
+    \brief Cubic Hermite tables of property functions
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPSPLINE_H
+#define PROPSPLINE_H
+
+#include <iosfwd>
+#include <vector>
+
+namespace sorpprops {
+
+/*!
+A function of one variable tabulated at equally spaced nodes and interpolated
+with cubic Hermite polynomials.
+
+The slopes at the nodes are 4th order finite differences of the tabulated
+values, so the interpolation error falls with the 4th power of the node
+spacing for smooth functions. measure() compares the table with the function it
+was built from between the nodes and keeps the largest difference.
+*/
+class cubicTable
+{
+public:
+    cubicTable();
+
+    /// Tabulates f at n (at least 4) nodes from x0 to x1.
+    /// \return false if f is not finite at a node, the table is then empty
+    template <typename F>
+    bool build(double x0, double x1, int n, F f)
+    {
+        std::vector<double> v(n > 4 ? n : 4);
+        double step = (x1 - x0) / (v.size() - 1);
+        for(size_t i = 0; i < v.size(); i++)
+            v[i] = f(x0 + i * step);
+        return setValues(x0, x1, v);
+    }
+
+    /// Largest difference to f at 3 points in each interval; stored as maxError().
+    template <typename F>
+    double measure(F f)
+    {
+        error = 0;
+        for(size_t i = 0; i + 1 < y.size(); i++)
+            for(int k = 1; k <= 3; k++)
+            {
+                double x = x0 + (i + k / 4.0) * h;
+                double d = (*this)(x) - f(x);
+                if(d < 0)
+                    d = -d;
+                if(!(d <= error))
+                    error = d;
+            }
+        return error;
+    }
+
+    /// \return the interpolated value, NaN outside the table
+    double operator()(double x) const;
+    bool covers(double x) const;
+    bool isValid() const;
+
+    double first() const;
+    double last() const;
+    int nodes() const;
+    /// from measure(), in the units of the function
+    double maxError() const;
+
+    void write(std::ostream &out) const;
+    bool read(std::istream &in);
+
+private:
+    double x0;
+    double h;
+    double error;
+    std::vector<double> y;
+    std::vector<double> dy;
+
+    bool setValues(double from, double to, const std::vector<double> &values);
+};
+
+/*!
+A function of two variables tabulated on an equally spaced grid and
+interpolated with bicubic Hermite patches (see cubicTable for the slopes).
+*/
+class bicubicTable
+{
+public:
+    bicubicTable();
+
+    /// Tabulates f(x,y) at nx by ny (at least 4 each) nodes.
+    /// \return false if f is not finite at a node, the table is then empty
+    template <typename F>
+    bool build(double x0, double x1, int nx, double y0, double y1, int ny, F f)
+    {
+        nx = nx > 4 ? nx : 4;
+        ny = ny > 4 ? ny : 4;
+        std::vector<double> v(size_t(nx) * ny);
+        double sx = (x1 - x0) / (nx - 1), sy = (y1 - y0) / (ny - 1);
+        for(int j = 0; j < ny; j++)
+            for(int i = 0; i < nx; i++)
+                v[size_t(j) * nx + i] = f(x0 + i * sx, y0 + j * sy);
+        return setValues(x0, x1, nx, y0, y1, ny, v);
+    }
+
+    /// Largest difference to f at 3 by 3 points in each cell; stored as maxError().
+    template <typename F>
+    double measure(F f)
+    {
+        error = 0;
+        for(int j = 0; j + 1 < ny; j++)
+            for(int i = 0; i + 1 < nx; i++)
+                for(int l = 1; l <= 3; l++)
+                    for(int k = 1; k <= 3; k++)
+                    {
+                        double x = x0 + (i + k / 4.0) * hx;
+                        double y = y0 + (j + l / 4.0) * hy;
+                        double d = (*this)(x, y) - f(x, y);
+                        if(d < 0)
+                            d = -d;
+                        if(!(d <= error))
+                            error = d;
+                    }
+        return error;
+    }
+
+    /// \return the interpolated value, NaN outside the table
+    double operator()(double x, double y) const;
+    bool covers(double x, double y) const;
+    bool isValid() const;
+    double maxError() const;
+
+    void write(std::ostream &out) const;
+    bool read(std::istream &in);
+
+private:
+    double x0, y0;
+    double hx, hy;
+    int nx, ny;
+    double error;
+    std::vector<double> v, vx, vy, vxy;
+
+    bool setValues(double xFrom, double xTo, int xNodes, double yFrom, double yTo, int yNodes,
+                   const std::vector<double> &values);
+};
+
+}
+
+#endif // PROPSPLINE_H
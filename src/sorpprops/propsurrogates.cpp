@@ -0,0 +1,231 @@
+/*! \file propsurrogates.cpp
+    \brief Spline tables in place of the iterative property inversions
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include "propsurrogates.h"
+#include "propkernels.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace sorpprops {
+
+namespace {
+
+const unsigned int fileMagic = 0x53505354;// "SPST"
+
+/// table ranges, see the table in propsurrogates.h
+const double waterPressureMin = 2.5491e-6, waterPressureMax = 3200.0;
+const int waterNodes = 2048;
+const double ammoniaPressureMin = 2.9, ammoniaPressureMax = 1595.0;
+const int ammoniaNodes = 129;
+
+/// boiling temperatures [F] of pure NH3 and pure water at the pressure [psia]
+inline void ammoniaBounds(double th, double &t0, double &t1)
+{
+    t1 = th;
+    t0 = ammoniaBoilingTemperature(1.0, (th - 32.0) / 1.8);
+}
+
+void writeName(std::ostream &out, const std::string &name)
+{
+    unsigned int n = name.size();
+    out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    out.write(name.data(), n);
+}
+
+bool readName(std::istream &in, std::string &name)
+{
+    unsigned int n = 0;
+    in.read(reinterpret_cast<char *>(&n), sizeof(n));
+    if(!in || n > 256)
+        return false;
+    name.resize(n);
+    in.read(&name[0], n);
+    return bool(in);
+}
+
+}
+
+propSurrogates &propSurrogates::shared()
+{
+    static propSurrogates surrogates;
+    return surrogates;
+}
+
+propSurrogates::propSurrogates() :
+    prepared(false)
+{
+}
+
+bool propSurrogates::prepare(const std::string &cacheFile)
+{
+    if(prepared)
+        return true;
+    std::lock_guard<std::mutex> lock(mutex);
+    if(prepared)
+        return true;
+    fileName = cacheFile;
+    if(!readFile())
+    {
+        build();
+        if(!water.isValid() || !ammonia.isValid())
+            return false;
+        writeFile();
+    }
+    prepared = true;
+    return true;
+}
+
+bool propSurrogates::isPrepared() const
+{
+    return prepared;
+}
+
+void propSurrogates::build()
+{
+    // exp(log(p)) may round past the ends of the range
+    auto waterT = [](double lp) {
+        double p = exp(lp);
+        return sorpprops::waterSatTemperature(p < waterPressureMin ? waterPressureMin
+                                              : p > waterPressureMax ? waterPressureMax : p);
+    };
+    if(water.build(log(waterPressureMin), log(waterPressureMax), waterNodes, waterT))
+        water.measure(waterT);
+
+    // u = s^(1/4) stretches the steep part next to pure NH3; the correlation
+    // has a flat minimum just below w = 1 there, so the concentration jumps
+    // from 100 % at s = 0 to about 99.7 % right above, and the table takes the
+    // limit from above at u = 0 (xftp2 gives 100 % up to 1e-8 F above)
+    auto ammoniaX = [](double u, double lp) {
+        double p = exp(lp), t0, t1;
+        ammoniaBounds(sorpprops::waterSatTemperature(p), t0, t1);
+        double dt = u * u * u * u * (t1 - t0);
+        return sorpprops::ammoniaConcentration(t0 + (dt > 2.e-8 ? dt : 2.e-8), p);
+    };
+    if(ammonia.build(0.0, 1.0, ammoniaNodes, log(ammoniaPressureMin), log(ammoniaPressureMax),
+                     ammoniaNodes, ammoniaX))
+        ammonia.measure(ammoniaX);
+}
+
+double propSurrogates::waterSatTemperature(double p) const
+{
+    if(!(p > 0))
+        return notANumber();
+    return water(log(p));
+}
+
+double propSurrogates::ammoniaConcentration(double t, double p) const
+{
+    double th = waterSatTemperature(p);
+    if(th != th || !(p >= ammoniaPressureMin && p <= ammoniaPressureMax))
+        return notANumber();
+    double t0, t1;
+    ammoniaBounds(th, t0, t1);
+    // the ends as in xftp2, including its tolerance
+    if(t >= t1 || t1 - t < 1.e-8)
+        return 0.0;
+    if(t - t0 < 1.e-8)
+        return 1.e2;
+    return ammonia(sqrt(sqrt((t - t0) / (t1 - t0))), log(p));
+}
+
+const cubicTable *propSurrogates::table(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = named.find(name);
+    return found == named.end() ? 0 : found->second.get();
+}
+
+const cubicTable *propSurrogates::addTable(const std::string &name, const cubicTable &table)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<cubicTable> &kept = named[name];
+    // tables handed out before stay valid, they are not replaced once added
+    if(!kept)
+        kept.reset(new cubicTable(table));
+    if(prepared)
+        writeFile();
+    return kept.get();
+}
+
+std::string propSurrogates::report() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << "water saturation temperature: " << water.nodes() << " nodes, max. error "
+        << water.maxError() << " F\n";
+    out << "NH3 concentration: max. error " << ammonia.maxError() << " %\n";
+    for(auto i = named.begin(); i != named.end(); ++i)
+        out << i->first << ": " << i->second->nodes() << " nodes, max. error "
+            << i->second->maxError() << "\n";
+    return out.str();
+}
+
+bool propSurrogates::readFile()
+{
+    if(fileName.empty())
+        return false;
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    unsigned int magic = 0;
+    int version = 0, count = 0;
+    in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    // files of other versions are built again and overwritten
+    if(!in || magic != fileMagic || version != formatVersion)
+        return false;
+    cubicTable readWater;
+    bicubicTable readAmmonia;
+    if(!readWater.read(in) || !readAmmonia.read(in))
+        return false;
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if(!in || count < 0)
+        return false;
+    std::map<std::string, std::unique_ptr<cubicTable> > readNamed;
+    for(int i = 0; i < count; i++)
+    {
+        std::string name;
+        std::unique_ptr<cubicTable> table(new cubicTable);
+        if(!readName(in, name) || !table->read(in))
+            return false;
+        readNamed[name] = std::move(table);
+    }
+    water = readWater;
+    ammonia = readAmmonia;
+    // keep tables added before the file was read
+    for(auto i = readNamed.begin(); i != readNamed.end(); ++i)
+        if(!named[i->first])
+            named[i->first] = std::move(i->second);
+    return true;
+}
+
+void propSurrogates::writeFile() const
+{
+    if(fileName.empty())
+        return;
+    // written next to the file and renamed, so other processes never read half a file
+    std::string temporary = fileName + ".part";
+    {
+        std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        int version = formatVersion, count = named.size();
+        out.write(reinterpret_cast<const char *>(&fileMagic), sizeof(fileMagic));
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        water.write(out);
+        ammonia.write(out);
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        for(auto i = named.begin(); i != named.end(); ++i)
+        {
+            writeName(out, i->first);
+            i->second->write(out);
+        }
+        if(!out)
+            return;
+    }
+    std::remove(fileName.c_str());
+    std::rename(temporary.c_str(), fileName.c_str());
+}
+
+}
@@ -0,0 +1,87 @@
+/*! \file propsurrogates.h
+    \brief Spline tables in place of the iterative property inversions
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef PROPSURROGATES_H
+#define PROPSURROGATES_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "propspline.h"
+
+namespace sorpprops {
+
+/*!
+Tables of the property functions that the engine finds by iteration, for the
+"fast properties" mode of a case (calInputs::fastProperties).
+
+| function | reference | table | max. error |
+| -------- | --------- | ----- | ---------- |
+| water saturation temperature T(p) | tfp3, regula falsi | cubic in ln p, 2.55e-6..3200 psia, 2048 nodes | 4e-4 F next to the critical point, 2e-7 F below 3000 psia |
+| NH3 concentration x(T,p) | xftp2, bisection | bicubic in (s^(1/4), ln p), 2.9..1595 psia, 129 x 129 nodes | 0.01 % |
+| refrigerant saturation temperature | tsat, Newton to 0.01 R | cubic in ln p, 1 psia..0.95 pc, 512 nodes | 1e-5 F |
+
+The NH3 table is over s = (T - T(NH3))/(T(H2O) - T(NH3)), the position between
+the boiling points of pure ammonia and pure water at the pressure, where the
+concentration is a smooth function (of s^(1/4), which stretches the steep part
+next to pure NH3); outside 0 <= s <= 1 it is 100 % or 0 % as in xftp2. The
+errors are measured when a table is built (see cubicTable::measure()) and kept
+with it. Inputs outside a table give NaN, and the engine then calls the
+reference routine.
+
+The water and NH3 tables are built by prepare(), other fluids (the refrigerants
+of the engine) are added under a name with addTable(). All tables are kept in a
+cache file so later runs and other processes only read them.
+*/
+class propSurrogates
+{
+public:
+    static propSurrogates &shared();
+
+    /// Builds the water and NH3 tables or reads them from cacheFile (no file
+    /// if empty). Only the first call does any work. Thread safe.
+    /// \return false if the tables could not be built
+    bool prepare(const std::string &cacheFile);
+    bool isPrepared() const;
+
+    /// saturation temperature [F] from pressure [psia], NaN outside the table
+    double waterSatTemperature(double p) const;
+    /// NH3 concentration [%] from temperature [F] and pressure [psia], NaN outside the table
+    double ammoniaConcentration(double t, double p) const;
+
+    /// \return the table of that name, read from the cache file or added, or 0. Thread safe.
+    const cubicTable *table(const std::string &name) const;
+    /// Keeps the table under the name (replacing one of the same name) and
+    /// writes the cache file. Thread safe.
+    const cubicTable *addTable(const std::string &name, const cubicTable &table);
+
+    /// table names with their ranges and measured errors, one per line
+    std::string report() const;
+
+    /// Changes whenever the tables (ranges, nodes) or the file layout change.
+    static const int formatVersion = 1;
+
+private:
+    propSurrogates();
+
+    mutable std::mutex mutex;
+    std::atomic<bool> prepared;
+    std::string fileName;
+    cubicTable water;
+    bicubicTable ammonia;
+    std::map<std::string, std::unique_ptr<cubicTable> > named;
+
+    void build();
+    bool readFile();
+    void writeFile() const;
+};
+
+}
+
+#endif // PROPSURROGATES_H
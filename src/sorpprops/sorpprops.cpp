@@ -0,0 +1,361 @@
+/*! \file sorpprops.cpp
+    \brief C interface of the property library (libsorpprops)
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include "sorpprops.h"
+#include "if97.h"
+#include "propbatch.h"
+#include "propkernels.h"
+
+#include <string>
+
+namespace sorpprops {
+
+namespace {
+
+const int interfaceVersion = 1;
+
+/// quantities of the inputs and results, for the unit conversions
+enum quantity
+{
+    none,
+    temperature,
+    pressure,
+    concentration,  // weight %
+    humidity,       // humidity ratio, lb/lb or kg/kg
+    enthalpy,
+    heatCapacity,   // also entropy
+    volume
+};
+
+/// the units the functions of a property take
+enum nativeUnits
+{
+    engineUnits,    // F, psia, Btu/lb: the engine's correlations
+    if97Units       // K, MPa, kJ/kg
+};
+
+typedef double (*scalarFunction)(double, double);
+typedef void (*batchFunction)(int, const double *, const double *, double *);
+
+struct property
+{
+    int id;
+    const char *name;
+    quantity out, in0, in1;
+    nativeUnits native;
+    scalarFunction scalar;
+    batchFunction batch;    // 0 if there is no vector kernel
+};
+
+/// one-input functions in the shape of the table
+template <double (*F)(double)>
+double firstOnly(double a, double)
+{
+    return F(a);
+}
+
+template <void (*F)(int, const double *, double *)>
+void firstOnlyBatch(int n, const double *a, const double *, double *r)
+{
+    F(n, a, r);
+}
+
+// the kernels have default arguments for the iteration count
+double waterSatTemperature1(double p) { return waterSatTemperature(p); }
+double ammoniaConcentration2(double t, double p) { return ammoniaConcentration(t, p); }
+
+const property properties[] = {
+    {SORPPROPS_WATER_SAT_PRESSURE, "water saturation pressure", pressure, temperature, none, engineUnits,
+     firstOnly<waterSatPressure>, firstOnlyBatch<water::satPressure>},
+    {SORPPROPS_WATER_SAT_TEMPERATURE, "water saturation temperature", temperature, pressure, none, engineUnits,
+     firstOnly<waterSatTemperature1>, firstOnlyBatch<water::satTemperature>},
+    {SORPPROPS_WATER_LIQUID_ENTHALPY, "water saturated liquid enthalpy", enthalpy, temperature, none, engineUnits,
+     firstOnly<waterLiquidEnthalpy>, firstOnlyBatch<water::liquidEnthalpy>},
+
+    {SORPPROPS_LIBR_TEMPERATURE, "LiBr equilibrium temperature", temperature, pressure, concentration, engineUnits,
+     librTemperature, libr::temperature},
+    {SORPPROPS_LIBR_PRESSURE, "LiBr equilibrium pressure", pressure, temperature, concentration, engineUnits,
+     librPressure, libr::pressure},
+    {SORPPROPS_LIBR_HUMIDITY, "LiBr equilibrium humidity ratio", humidity, temperature, concentration, engineUnits,
+     librHumidity, libr::humidity},
+    {SORPPROPS_LIBR_ENTHALPY, "LiBr enthalpy", enthalpy, temperature, concentration, engineUnits,
+     librEnthalpy, libr::enthalpy},
+
+    {SORPPROPS_LICL_TEMPERATURE, "LiCl equilibrium temperature", temperature, pressure, concentration, engineUnits,
+     liclTemperature, licl::temperature},
+    {SORPPROPS_LICL_PRESSURE, "LiCl equilibrium pressure", pressure, temperature, concentration, engineUnits,
+     liclPressure, 0},
+    {SORPPROPS_LICL_HUMIDITY, "LiCl equilibrium humidity ratio", humidity, temperature, concentration, engineUnits,
+     liclHumidity, licl::humidity},
+    {SORPPROPS_LICL_HEAT_CAPACITY, "LiCl specific heat", heatCapacity, temperature, concentration, engineUnits,
+     liclHeatCapacity, licl::heatCapacity},
+    {SORPPROPS_LICL_ENTHALPY, "LiCl enthalpy", enthalpy, temperature, concentration, engineUnits,
+     liclEnthalpy, licl::enthalpy},
+
+    {SORPPROPS_AMMONIA_TEMPERATURE, "NH3/water boiling temperature", temperature, pressure, concentration, engineUnits,
+     ammoniaTemperature, ammonia::temperature},
+    {SORPPROPS_AMMONIA_CONCENTRATION, "NH3/water liquid concentration", concentration, temperature, pressure, engineUnits,
+     ammoniaConcentration2, ammonia::concentration},
+
+    {SORPPROPS_AIR_ENTHALPY, "moist air enthalpy", enthalpy, temperature, humidity, engineUnits,
+     airEnthalpy, air::enthalpy},
+
+    {SORPPROPS_IF97_SAT_PRESSURE, "IF97 saturation pressure", pressure, temperature, none, if97Units,
+     firstOnly<if97::saturationPressure>, 0},
+    {SORPPROPS_IF97_SAT_TEMPERATURE, "IF97 saturation temperature", temperature, pressure, none, if97Units,
+     firstOnly<if97::saturationTemperature>, 0},
+    {SORPPROPS_IF97_LIQUID_VOLUME, "IF97 liquid specific volume", volume, pressure, temperature, if97Units,
+     if97::liquidVolume, 0},
+    {SORPPROPS_IF97_LIQUID_ENTHALPY, "IF97 liquid enthalpy", enthalpy, pressure, temperature, if97Units,
+     if97::liquidEnthalpy, 0},
+    {SORPPROPS_IF97_LIQUID_ENTROPY, "IF97 liquid entropy", heatCapacity, pressure, temperature, if97Units,
+     if97::liquidEntropy, 0},
+    {SORPPROPS_IF97_VAPOR_VOLUME, "IF97 vapor specific volume", volume, pressure, temperature, if97Units,
+     if97::vaporVolume, 0},
+    {SORPPROPS_IF97_VAPOR_ENTHALPY, "IF97 vapor enthalpy", enthalpy, pressure, temperature, if97Units,
+     if97::vaporEnthalpy, 0},
+    {SORPPROPS_IF97_VAPOR_ENTROPY, "IF97 vapor entropy", heatCapacity, pressure, temperature, if97Units,
+     if97::vaporEntropy, 0},
+    {SORPPROPS_IF97_TEMPERATURE_PH, "IF97 temperature", temperature, pressure, enthalpy, if97Units,
+     if97::temperaturePH, 0},
+    {SORPPROPS_IF97_TEMPERATURE_PS, "IF97 temperature", temperature, pressure, heatCapacity, if97Units,
+     if97::temperaturePS, 0},
+};
+
+const int propertyCount = sizeof(properties) / sizeof(properties[0]);
+
+const property *find(int id)
+{
+    for(int i = 0; i < propertyCount; i++)
+        if(properties[i].id == id)
+            return &properties[i];
+    return 0;
+}
+
+/// a value of the quantity in the engine's IP units to the given units
+double fromIp(quantity q, int units, double v)
+{
+    if(units == SORPPROPS_IP)
+        return v;
+    switch(q)
+    {
+    case temperature:
+        return (v - 32.0) / 1.8 + 273.15;
+    case pressure:
+        return v * 6.895;
+    case enthalpy:
+        return v * 2.326;
+    case heatCapacity:
+        return v * 4.1868;
+    case volume:
+        return v * 0.0624279606;
+    default:
+        return v;
+    }
+}
+
+double toIp(quantity q, int units, double v)
+{
+    if(units == SORPPROPS_IP)
+        return v;
+    switch(q)
+    {
+    case temperature:
+        return (v - 273.15) * 1.8 + 32.0;
+    case pressure:
+        return v / 6.895;
+    case enthalpy:
+        return v / 2.326;
+    case heatCapacity:
+        return v / 4.1868;
+    case volume:
+        return v / 0.0624279606;
+    default:
+        return v;
+    }
+}
+
+/// a value in the given units to the units the property's functions take
+double toNative(const property &p, quantity q, int units, double v)
+{
+    if(p.native == engineUnits)
+        return toIp(q, units, v);
+    // IF97 takes SI with pressure in MPa
+    if(units == SORPPROPS_IP)
+        v = fromIp(q, SORPPROPS_SI, v);
+    return q == pressure ? v * 1.e-3 : v;
+}
+
+double fromNative(const property &p, quantity q, int units, double v)
+{
+    if(p.native == engineUnits)
+        return fromIp(q, units, v);
+    if(q == pressure)
+        v *= 1.e3;
+    return units == SORPPROPS_IP ? toIp(q, SORPPROPS_SI, v) : v;
+}
+
+bool needsConversion(const property &p, int units)
+{
+    return p.native == if97Units || units != SORPPROPS_IP;
+}
+
+const char *unitName(quantity q, int units)
+{
+    bool si = units == SORPPROPS_SI;
+    switch(q)
+    {
+    case temperature:
+        return si ? "K" : "F";
+    case pressure:
+        return si ? "kPa" : "psia";
+    case enthalpy:
+        return si ? "kJ/kg" : "Btu/lb";
+    case heatCapacity:
+        return si ? "kJ/(kg K)" : "Btu/(lb F)";
+    case volume:
+        return si ? "m3/kg" : "ft3/lb";
+    case concentration:
+        return "%";
+    case humidity:
+        return si ? "kg/kg" : "lb/lb";
+    default:
+        return "";
+    }
+}
+
+const char *inputName(quantity q)
+{
+    switch(q)
+    {
+    case temperature:
+        return "temperature";
+    case pressure:
+        return "pressure";
+    case enthalpy:
+        return "enthalpy";
+    case heatCapacity:
+        return "entropy";
+    case humidity:
+        return "humidity ratio";
+    default:
+        return "concentration";
+    }
+}
+
+std::string describe(const property &p, int units)
+{
+    std::string text = p.name;
+    text += std::string(" [") + unitName(p.out, units) + "] from ";
+    text += std::string(inputName(p.in0)) + " [" + unitName(p.in0, units) + "]";
+    if(p.in1 != none)
+        text += std::string(", ") + inputName(p.in1) + " [" + unitName(p.in1, units) + "]";
+    return text;
+}
+
+bool knownUnits(int units)
+{
+    return units == SORPPROPS_IP || units == SORPPROPS_SI;
+}
+
+}
+
+}
+
+using namespace sorpprops;
+
+int sorpprops_version(void)
+{
+    return interfaceVersion;
+}
+
+int sorpprops_arguments(int id)
+{
+    const property *p = find(id);
+    if(!p)
+        return 0;
+    return p->in1 == none ? 1 : 2;
+}
+
+const char *sorpprops_describe(int id, int units)
+{
+    const property *p = find(id);
+    if(!p || !knownUnits(units))
+        return 0;
+    // built once, the statics are initialized thread safe
+    static const struct descriptions
+    {
+        std::string text[2][propertyCount];
+        descriptions()
+        {
+            for(int u = 0; u < 2; u++)
+                for(int i = 0; i < propertyCount; i++)
+                    text[u][i] = describe(properties[i], u);
+        }
+    } all;
+    return all.text[units][p - properties].c_str();
+}
+
+double sorpprops_value(int id, int units, double a, double b)
+{
+    const property *p = find(id);
+    if(!p || !knownUnits(units))
+        return notANumber();
+    double r = p->scalar(toNative(*p, p->in0, units, a), toNative(*p, p->in1, units, b));
+    return fromNative(*p, p->out, units, r);
+}
+
+int sorpprops_values(int id, int units, size_t n, const double *a, const double *b, double *result)
+{
+    const property *p = find(id);
+    if(!p)
+        return SORPPROPS_UNKNOWN_PROPERTY;
+    if(!knownUnits(units))
+        return SORPPROPS_UNKNOWN_UNITS;
+    if(n == 0)
+        return SORPPROPS_OK;
+    if(!a || !result || (p->in1 != none && !b))
+        return SORPPROPS_INVALID_ARGUMENT;
+
+    if(!needsConversion(*p, units))
+    {
+        if(p->batch)
+        {
+            // the batch functions count in int
+            const size_t chunk = 1 << 30;
+            for(size_t i = 0; i < n; i += chunk)
+            {
+                int m = int(n - i < chunk ? n - i : chunk);
+                p->batch(m, a + i, b ? b + i : 0, result + i);
+            }
+        }
+        else
+            for(size_t i = 0; i < n; i++)
+                result[i] = p->scalar(a[i], b ? b[i] : 0.0);
+        return SORPPROPS_OK;
+    }
+
+    // converted inputs in blocks on the stack, so there is nothing to allocate or share
+    const int block = 256;
+    double na[block], nb[block];
+    for(size_t i = 0; i < n; i += block)
+    {
+        int m = int(n - i < size_t(block) ? n - i : block);
+        for(int j = 0; j < m; j++)
+        {
+            na[j] = toNative(*p, p->in0, units, a[i + j]);
+            nb[j] = b ? toNative(*p, p->in1, units, b[i + j]) : 0.0;
+        }
+        if(p->batch)
+            p->batch(m, na, nb, result + i);
+        else
+            for(int j = 0; j < m; j++)
+                result[i + j] = p->scalar(na[j], nb[j]);
+        for(int j = 0; j < m; j++)
+            result[i + j] = fromNative(*p, p->out, units, result[i + j]);
+    }
+    return SORPPROPS_OK;
+}
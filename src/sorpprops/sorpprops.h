@@ -0,0 +1,143 @@
+/*! \file sorpprops.h
+    \brief C interface of the property library (libsorpprops)
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SORPPROPS_H
+#define SORPPROPS_H
+
+#include <stddef.h>
+
+/*
+Clients of the shared library on Windows define SORPPROPS_SHARED before
+including this file; the library itself is built with SORPPROPS_BUILD
+(see sorpprops.pro).
+*/
+#if defined(SORPPROPS_SHARED) && defined(_WIN32)
+#  ifdef SORPPROPS_BUILD
+#    define SORPPROPS_API __declspec(dllexport)
+#  else
+#    define SORPPROPS_API __declspec(dllimport)
+#  endif
+#elif defined(SORPPROPS_SHARED) && defined(__GNUC__)
+#  define SORPPROPS_API __attribute__((visibility("default")))
+#else
+#  define SORPPROPS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+Unit systems of the inputs and results. Every call names one; there is no
+global unit setting.
+
+| quantity      | SORPPROPS_IP | SORPPROPS_SI |
+| ------------- | ------------ | ------------ |
+| temperature   | F            | K            |
+| pressure      | psia         | kPa          |
+| concentration | weight %     | weight %     |
+| humidity ratio| lb/lb dry air| kg/kg dry air|
+| enthalpy      | Btu/lb       | kJ/kg        |
+| heat capacity, entropy | Btu/(lb F) | kJ/(kg K) |
+| specific volume | ft3/lb     | m3/kg        |
+
+Pressures convert with the factor 6.895 kPa/psia used inside the correlations,
+so SI results are the correlations' own values.
+*/
+typedef enum sorpprops_units
+{
+    SORPPROPS_IP = 0,
+    SORPPROPS_SI = 1
+} sorpprops_units;
+
+/*!
+The properties, with their inputs in the order they are passed. The numbers
+are part of the interface and do not change; new properties get new numbers.
+
+Water is by the engine's correlations (Saul and Wagner) or, for the
+SORPPROPS_IF97_ properties, by IAPWS-IF97 regions 1, 2 and 4.
+*/
+typedef enum sorpprops_property
+{
+    SORPPROPS_WATER_SAT_PRESSURE = 1,       /*!< (temperature) */
+    SORPPROPS_WATER_SAT_TEMPERATURE = 2,    /*!< (pressure) */
+    SORPPROPS_WATER_LIQUID_ENTHALPY = 3,    /*!< saturated liquid (temperature) */
+
+    SORPPROPS_LIBR_TEMPERATURE = 10,        /*!< (pressure, concentration) */
+    SORPPROPS_LIBR_PRESSURE = 11,           /*!< (temperature, concentration) */
+    SORPPROPS_LIBR_HUMIDITY = 12,           /*!< air in equilibrium (temperature, concentration) */
+    SORPPROPS_LIBR_ENTHALPY = 13,           /*!< (temperature, concentration) */
+
+    SORPPROPS_LICL_TEMPERATURE = 20,        /*!< (pressure, concentration) */
+    SORPPROPS_LICL_PRESSURE = 21,           /*!< (temperature, concentration) */
+    SORPPROPS_LICL_HUMIDITY = 22,           /*!< air in equilibrium (temperature, concentration) */
+    SORPPROPS_LICL_HEAT_CAPACITY = 23,      /*!< (temperature, concentration) */
+    SORPPROPS_LICL_ENTHALPY = 24,           /*!< (temperature, concentration) */
+
+    SORPPROPS_AMMONIA_TEMPERATURE = 30,     /*!< boiling (pressure, NH3 concentration) */
+    SORPPROPS_AMMONIA_CONCENTRATION = 31,   /*!< NH3 in the liquid (temperature, pressure) */
+
+    SORPPROPS_AIR_ENTHALPY = 40,            /*!< moist air (temperature, humidity ratio) */
+
+    SORPPROPS_IF97_SAT_PRESSURE = 50,       /*!< (temperature) */
+    SORPPROPS_IF97_SAT_TEMPERATURE = 51,    /*!< (pressure) */
+    SORPPROPS_IF97_LIQUID_VOLUME = 52,      /*!< (pressure, temperature) */
+    SORPPROPS_IF97_LIQUID_ENTHALPY = 53,    /*!< (pressure, temperature) */
+    SORPPROPS_IF97_LIQUID_ENTROPY = 54,     /*!< (pressure, temperature) */
+    SORPPROPS_IF97_VAPOR_VOLUME = 55,       /*!< (pressure, temperature) */
+    SORPPROPS_IF97_VAPOR_ENTHALPY = 56,     /*!< (pressure, temperature) */
+    SORPPROPS_IF97_VAPOR_ENTROPY = 57,      /*!< (pressure, temperature) */
+    SORPPROPS_IF97_TEMPERATURE_PH = 58,     /*!< (pressure, enthalpy) */
+    SORPPROPS_IF97_TEMPERATURE_PS = 59      /*!< (pressure, entropy) */
+} sorpprops_property;
+
+/*!
+Return values of sorpprops_values(). Invalid points (out of the range of a
+correlation) are not errors; they give NaN in the results.
+*/
+#define SORPPROPS_OK 0
+#define SORPPROPS_UNKNOWN_PROPERTY (-1)
+#define SORPPROPS_UNKNOWN_UNITS (-2)
+#define SORPPROPS_INVALID_ARGUMENT (-3)
+
+/*! Version of this interface; changes when functions are added or changed. */
+SORPPROPS_API int sorpprops_version(void);
+
+/*! \return the number of inputs of the property (1 or 2), 0 if it is unknown */
+SORPPROPS_API int sorpprops_arguments(int property);
+
+/*!
+\return a description of the property with its inputs and units, e.g.
+"LiBr equilibrium temperature [F] from pressure [psia], concentration [%]",
+or 0 if the property or units are unknown. The string is static.
+*/
+SORPPROPS_API const char *sorpprops_describe(int property, int units);
+
+/*!
+Evaluates one point. b is ignored for properties with one input.
+\return the property, NaN if the point is invalid or the property or units are unknown
+*/
+SORPPROPS_API double sorpprops_value(int property, int units, double a, double b);
+
+/*!
+Evaluates n points: result[i] from a[i] and b[i] (b may be 0 for properties
+with one input). The arrays may not overlap. Where the library has a vector
+kernel for the property the points are evaluated four at a time.
+\return SORPPROPS_OK or one of the error codes above, in which case result is not written
+*/
+SORPPROPS_API int sorpprops_values(int property, int units, size_t n,
+                                   const double *a, const double *b, double *result);
+
+/*
+All functions have no state and may be called from any number of threads at
+the same time.
+*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SORPPROPS_H */
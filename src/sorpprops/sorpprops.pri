@@ -0,0 +1,18 @@
+# Sources of the property library, shared by the application (SorpSim.pro)
+# and the standalone library target (sorpprops.pro).
+
+SOURCES += \
+    $$PWD/if97.cpp \
+    $$PWD/propbatch.cpp \
+    $$PWD/propspline.cpp \
+    $$PWD/propsurrogates.cpp \
+    $$PWD/sorpprops.cpp
+
+HEADERS += \
+    $$PWD/if97.h \
+    $$PWD/propbatch.h \
+    $$PWD/propcoefficients.h \
+    $$PWD/propkernels.h \
+    $$PWD/propspline.h \
+    $$PWD/propsurrogates.h \
+    $$PWD/sorpprops.h
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# libsorpprops: the property correlations as a library without Qt,
+# for use by other programs through the C interface in sorpprops.h
+#
+#-------------------------------------------------
+
+# Usage: qmake sorpprops.pro && make
+# Then you get libsorpprops.so / sorpprops.dll (CONFIG += staticlib for a static library)
+TARGET = sorpprops
+TEMPLATE = lib
+CONFIG -= qt
+CONFIG += c++14 hide_symbols
+VERSION = 1.0.0
+
+# only the functions marked SORPPROPS_API are exported
+DEFINES += SORPPROPS_SHARED SORPPROPS_BUILD
+staticlib:DEFINES -= SORPPROPS_SHARED
+
+include(sorpprops.pri)
+
+headers.files = sorpprops.h
+headers.path = $$OUT_PWD/include
+target.path = $$OUT_PWD/lib
+INSTALLS += target headers
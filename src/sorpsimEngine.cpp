@@ -35,12 +35,25 @@
 #include <vector>
 
 #include "sorpsimEngine.h"
+#include "sorpprops/if97.h"
+#include "sorpprops/propcoefficients.h"
+#include "sorpprops/propkernels.h"
+#include "sorpprops/propsurrogates.h"
 #include "dataComm.h"
+#include "solvercache.h"
+#include "sorputils.h"
 #include "unit.h"
 
 calInputs inputs;     ///< Used to pass simulation inputs
 calOutputs outputs;   ///< Used to pass simulation outputs
 bool printOut = true;
+/// take tfp3, xftp2 and tsat from sorpprops::propSurrogates, only during
+/// absdCal() of a case with calInputs::fastProperties
+bool fastProperties = false;
+/// take the water properties from IAPWS-IF97 (sorpprops/if97.h) where it is
+/// valid, only during absdCal() of a case with calInputs::if97Water
+bool if97Water = false;
+solveCounts *solveCounting = 0;
 using namespace sorpsim4l;
 extern int globalcount;
 extern int spnumber;
@@ -53,6 +66,50 @@ bool calcLink[150];
 QSet<Node*> chosenNodes;
 QSet<int> chosenIndexes;
 
+solveCount::solveCount() :
+    calls(0),
+    iterations(0),
+    maxIterations(0)
+{
+    worstInputs[0] = worstInputs[1] = 0.0;
+}
+
+void solveCount::add(int n, double a, double b)
+{
+    calls++;
+    iterations += n;
+    if(n > maxIterations || calls == 1)
+    {
+        maxIterations = n;
+        worstInputs[0] = a;
+        worstInputs[1] = b;
+    }
+}
+
+namespace {
+
+/// adds the iterations of a solve to solveCounting when the routine returns
+class countSolve
+{
+public:
+    countSolve(solveCount solveCounts::*which, const int &iterations, double a, double b = 0.0) :
+        which(which), iterations(iterations), a(a), b(b)
+    {
+    }
+    ~countSolve()
+    {
+        if(solveCounting)
+            (solveCounting->*which).add(iterations, a, b);
+    }
+
+private:
+    solveCount solveCounts::*which;
+    const int &iterations;
+    double a, b;
+};
+
+}
+
 //C***********************************************************************
 void
 pft3(
@@ -77,6 +134,12 @@ pft3(
       outputs.myMsg = " Guess value for water temperature is above critical point.Calculation terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    p = sorpprops::if97::saturationPressure(tk) * 1.e3 / 6.895e0;
+    if (p == p) {
+      return;
+    }
+  }
   double pkpa = 647.14e0 / tk * (-7.85823e0 * tau + 1.83991e0 * fem::pow(tau,
     1.5e0) - 11.7811e0 * fem::pow3(tau) + 22.6705e0 * fem::pow(tau,
     3.5e0) - 15.9393e0 * fem::pow4(tau) + 1.77516e0 * fem::pow(tau,
@@ -128,6 +191,20 @@ tfp3(
     t = -133.e0;
     return;
   }
+  if (if97Water) {
+    t = sorpprops::if97::saturationTemperature(p * 6.895e-3);
+    if (t == t) {
+      t = (t - 273.15e0) * 1.8e0 + 32.e0;
+      return;
+    }
+  }
+  if (fastProperties) {
+    t = sorpprops::propSurrogates::shared().waterSatTemperature(p);
+    if (t == t) {
+      return;
+    }
+  }
+  countSolve counted(&solveCounts::tfp3, i, p);
   //C --  Estimation of temparature range  ---------------------------------
   tcr = (647.14e0 - 273.15e0) * 1.8e0 + 32.e0;
   if (p * 6.895e0 < 9500.e0) {
@@ -189,17 +266,6 @@ tfp3(
   goto statement_10;
 }
 
-struct tfpx1_save
-{
-  arr<double> a;
-  arr<double> b;
-
-  tfpx1_save() :
-    a(dimension(10), fem::fill0),
-    b(dimension(10), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 tfpx1(
@@ -208,46 +274,14 @@ tfpx1(
   double const& p,
   double const& w0l)
 {
-  FEM_CMN_SVE(tfpx1);
-  // SAVE
-  arr_ref<double> a(sve.a, dimension(10));
-  arr_ref<double> b(sve.b, dimension(10));
-  //
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        -.68242821e-03, +.58736190e-03, -.10278186e-03,
-          +.93032374e-05, -.48223940e-06, +.15189038e-07,
-          -.29412863e-09, +.34100528e-11, -.21671480e-13,
-          +.57995604e-16
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        a;
-    }
-    {
-      static const double values[] = {
-        +.16634856e+00, -.55338169e-01, +.11228336e-01,
-          -.11028390e-02, +.62109464e-04, -.21112567e-05,
-          +.43851901e-07, -.54098115e-09, +.36266742e-11,
-          -.10153059e-13
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        b;
-    }
-  }
   //C*********************************************************************
   //C******  SUBROUTINE CALCULATES EQUILIBRIUM TEMP IN DEG F    **********
   //C******       OF LI-BR/WATER SOLUTION AS A FUNCTION         **********
   //C******    OF PRESS IN PSIA AND CONC IN WEIGHT PERCENT      **********
   //C*********************************************************************
   //C      IMPLICIT REAL*8 (A-H,O-Z)
-  double aa = 1.e0;
-  double bb = 0.e0;
-  int i = fem::int0;
-  FEM_DO_SAFE(i, 1, 10) {
-    aa += a(i) * fem::pow(w0l, i);
-    bb += b(i) * fem::pow(w0l, i);
-  }
+  double aa = 1.e0 + sorpprops::hornerFromFirst(sorpprops::librDuhringA, w0l);
+  double bb = sorpprops::hornerFromFirst(sorpprops::librDuhringB, w0l);
   double th = fem::float0;
   tfp3(cmn, th, p);
   th = (th - 32.e0) / 1.8e0;
@@ -279,6 +313,12 @@ hft3(
 //      qDebug()<<"the faulty t is"<<tc;
     FEM_STOP(0);
   }
+  if (if97Water) {
+    h = sorpprops::if97::liquidEnthalpy(sorpprops::if97::saturationPressure(tk), tk) / 2.326e0;
+    if (h == h) {
+      return;
+    }
+  }
   double teta = tk / 647.14e0;
   double pspc = 647.14e0 / tk * (-7.85823e0 * tau + 1.83991e0 * fem::pow(tau,
     1.5e0) - 11.7811e0 * fem::pow3(tau) + 22.6705e0 * fem::pow(tau,
@@ -377,15 +417,6 @@ cpftx1(common&cmn, const double &t, const double &x)
     return cpip;//convert to lbm/ft3
 }
 
-struct hftx1_save
-{
-  arr<double> x;
-
-  hftx1_save() :
-    x(dimension(21), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 hftx1(
@@ -394,23 +425,7 @@ hftx1(
   double const& t,
   double const& cl)
 {
-  FEM_CMN_SVE(hftx1);
-  // SAVE
-  arr_ref<double> x(sve.x, dimension(21));
-  //
-  if (is_called_first_time) {
-    static const double values[] = {
-      0.5086682481e+03, -0.1021608631e+04, -0.5333082110e+03,
-        0.4836280661e+03, 0.3687726426e+02, 0.4028472553e+02,
-        0.3991418127e+02, -0.1860514100e+00, -0.1911981148e+00,
-        -0.1992131652e+00, 0.1155132809e+04, 0.3335722311e+02,
-        -0.1782584073e+00, -0.1862407335e+02, 0.9859458321e-01,
-        -0.2509791095e-04, 0.4158007710e-07, 0.6406219484e+03,
-        -0.7512766773e-05, 0.1310318363e+02, -0.7751011421e-01
-    };
-    fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-      x;
-  }
+  const std::array<double,21> &x = sorpprops::librEnthalpyX;
   //C*********************************************************************
   //C******     SUBROUTINE  CALCULATES  ENTHALPY  IN  BTU/LB    **********
   //C******       OF LI-BR/WATER SOLUTION AS A FUNCTION OF      **********
@@ -436,13 +451,13 @@ hftx1(
   double t2 = tc * tc;
   double t3 = tc * t2;
   double t4 = tc * t3;
-  double hlibr = x(1) + x(14) * tc + x(15) * t2 + x(16) * t3 + x(17) * t4;
+  double hlibr = x[0] + x[13] * tc + x[14] * t2 + x[15] * t3 + x[16] * t4;
   //C --- Calculating excess enthalpy DH ---
-  double a = x(2) + x(5) * tc + x(8) * t2 + x(19) * t3;
-  double b = x(3) + x(6) * tc + x(9) * t2;
-  double c = x(4) + x(7) * tc + x(10) * t2;
-  double d = x(11) + x(12) * tc + x(13) * t2;
-  double e = x(18) + x(20) * tc + x(21) * t2;
+  double a = x[1] + x[4] * tc + x[7] * t2 + x[18] * t3;
+  double b = x[2] + x[5] * tc + x[8] * t2;
+  double c = x[3] + x[6] * tc + x[9] * t2;
+  double d = x[10] + x[11] * tc + x[12] * t2;
+  double e = x[17] + x[19] * tc + x[20] * t2;
   double xi = cl / 1.e2;
   double dx = 2.e0 * xi - 1.e0;
   double dx2 = dx * dx;
@@ -541,19 +556,6 @@ eqb1(
   statement_400:;
 }
 
-struct tfpx2_save
-{
-  arr<double> a;
-  arr<double> b;
-  arr<double> c;
-
-  tfpx2_save() :
-    a(dimension(7), fem::fill0),
-    b(dimension(7), fem::fill0),
-    c(dimension(7), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 tfpx2(
@@ -562,38 +564,6 @@ tfpx2(
   double const& p,
   double const& wnl)
 {
-  FEM_CMN_SVE(tfpx2);
-  // SAVE
-  arr_ref<double> a(sve.a, dimension(7));
-  arr_ref<double> b(sve.b, dimension(7));
-  arr_ref<double> c(sve.c, dimension(7));
-  //
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        -555.42808e0, 2890.3954e0, -9999.3985e0, 20707.756e0,
-          -25032.344e0, 16201.291e0, -4315.3626e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        a;
-    }
-    {
-      static const double values[] = {
-        2.9401340e0, -29.746632e0, 113.01928e0, -254.44689e0,
-          337.26490e0, -235.87537e0, 66.517338e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        b;
-    }
-    {
-      static const double values[] = {
-        -0.0073825347e0, 0.070452714e0, -0.26091336e0, 0.57941902e0,
-          -0.77216652e0, 0.5479346e0, -0.15714291e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        c;
-    }
-  }
   //C*********************************************************************
   //C******  SUBROUTINE CALCULATES BOILING TEMPERATURE IN DEG F **********
   //C******       OF WATER/AMMONIA SOLUTION AS A FUNCTION       **********
@@ -603,34 +573,15 @@ tfpx2(
   //C*********************************************************************
   //C      IMPLICIT REAL*8 (A-H,O-Z)
   double wnl1 = wnl / 1.e2;
-  double aa = 0.e0;
-  double bb = 1.e0;
-  double cc = 0.e0;
-  int i = fem::int0;
-  FEM_DO_SAFE(i, 1, 7) {
-    aa += a(i) * fem::pow(wnl1, i);
-    bb += b(i) * fem::pow(wnl1, i);
-    cc += c(i) * fem::pow(wnl1, i);
-  }
+  double aa = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingA, wnl1);
+  double bb = 1.e0 + sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingB, wnl1);
+  double cc = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingC, wnl1);
   double th = fem::float0;
   tfp3(cmn, th, p);
   th = (th - 32.e0) / 1.8e0;
   t = (aa + bb * th + cc * th * th) * 1.8e0 + 32.e0;
 }
 
-struct xftp2_save
-{
-  arr<double> a;
-  arr<double> b;
-  arr<double> c;
-
-  xftp2_save() :
-    a(dimension(7), fem::fill0),
-    b(dimension(7), fem::fill0),
-    c(dimension(7), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 xftp2(
@@ -639,37 +590,7 @@ xftp2(
   double const& t,
   double const& p)
 {
-  FEM_CMN_SVE(xftp2);
   common_write write(cmn);
-  arr_ref<double> a(sve.a, dimension(7));
-  arr_ref<double> b(sve.b, dimension(7));
-  arr_ref<double> c(sve.c, dimension(7));
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        -555.42808e0, 2890.3954e0, -9999.3985e0, 20707.756e0,
-          -25032.344e0, 16201.291e0, -4315.3626e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        a;
-    }
-    {
-      static const double values[] = {
-        2.9401340e0, -29.746632e0, 113.01928e0, -254.44689e0,
-          337.26490e0, -235.87537e0, 66.517338e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        b;
-    }
-    {
-      static const double values[] = {
-        -0.0073825347e0, 0.070452714e0, -0.26091336e0, 0.57941902e0,
-          -0.77216652e0, 0.5479346e0, -0.15714291e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        c;
-    }
-  }
   int iter = fem::int0;
   double th = fem::float0;
   double thc = fem::float0;
@@ -678,7 +599,6 @@ xftp2(
   double aa = fem::float0;
   double bb = fem::float0;
   double cc = fem::float0;
-  int i = fem::int0;
   double fmax = fem::float0;
   double fmin = fem::float0;
   double wnl1 = fem::float0;
@@ -691,7 +611,15 @@ xftp2(
   //C******        (-45.4oF...620.6oF  2.9 psi...1595 psi)      **********
   //C*********************************************************************
   //C      IMPLICIT REAL*8 (A-H,O-Z)
+  // the table is of the Saul/Wagner water saturation line
+  if (fastProperties && !if97Water) {
+    wnl = sorpprops::propSurrogates::shared().ammoniaConcentration(t, p);
+    if (wnl == wnl) {
+      return;
+    }
+  }
   iter = 0;
+  countSolve counted(&solveCounts::xftp2, iter, t, p);
   tfp3(cmn, th, p);
   if (t >= th) {
     //C       t > tH2O(p): Input p and t in superheated region of pure H2O
@@ -703,14 +631,9 @@ xftp2(
   wmin = 0.e0;
   //C --  Initilizing fmax and fmin  ---------------------------------------
   iter++;
-  aa = 0.e0;
-  bb = 1.e0;
-  cc = 0.e0;
-  FEM_DO_SAFE(i, 1, 7) {
-    aa += a(i);
-    bb += b(i);
-    cc += c(i);
-  }
+  aa = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingA, 1.e0);
+  bb = 1.e0 + sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingB, 1.e0);
+  cc = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingC, 1.e0);
   fmax = t - ((aa + bb * thc + cc * thc * thc) * 1.8e0 + 32.e0);
   if (fem::dabs(fmax) < 1.e-8) {
     wnl = 1.e2;
@@ -733,14 +656,9 @@ xftp2(
   iter++;
   //C     wNL1 = wmax - fmax / ( (fmax-fmin)/(wmax-wmin) )
   wnl1 = (wmax + wmin) / 2.e0;
-  aa = 0.e0;
-  bb = 1.e0;
-  cc = 0.e0;
-  FEM_DO_SAFE(i, 1, 7) {
-    aa += a(i) * fem::pow(wnl1, i);
-    bb += b(i) * fem::pow(wnl1, i);
-    cc += c(i) * fem::pow(wnl1, i);
-  }
+  aa = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingA, wnl1);
+  bb = 1.e0 + sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingB, wnl1);
+  cc = sorpprops::hornerFromFirst(sorpprops::ammoniaBoilingC, wnl1);
   f = t - ((aa + bb * thc + cc * thc * thc) * 1.8e0 + 32.e0);
   if (iter > 500) {
       if(printOut)
@@ -766,21 +684,6 @@ xftp2(
   goto statement_20;
 }
 
-struct yvtp2_save
-{
-  arr<fem::real_star_8> avw;
-  arr<fem::real_star_8> cw;
-  arr<fem::real_star_8> e;
-  arr<fem::real_star_8> f1;
-
-  yvtp2_save() :
-    avw(dimension(4), fem::fill0),
-    cw(dimension(4), fem::fill0),
-    e(dimension(16), fem::fill0),
-    f1(dimension(6), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 yvtp2(
@@ -789,46 +692,10 @@ yvtp2(
   double const& t,
   double const& p)
 {
-  FEM_CMN_SVE(yvtp2);
-  // SAVE
-  arr_ref<fem::real_star_8> avw(sve.avw, dimension(4));
-  arr_ref<fem::real_star_8> cw(sve.cw, dimension(4));
-  arr_ref<fem::real_star_8> e(sve.e, dimension(16));
-  arr_ref<fem::real_star_8> f1(sve.f1, dimension(6));
-  //
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        2.748796e-02, -1.016665e-05, -4.452025e-03, 8.389246e-04
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        avw;
-    }
-    {
-      static const double values[] = {
-        2.136131e-02, -3.169291e+01, -4.634611e+04, 0.e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        cw;
-    }
-    {
-      static const double values[] = {
-        -41.733398e0, 0.02414e0, 6.702285e0, -0.011475e0,
-          63.608967e0, -62.490768e0, 1.761064e0, 0.008626e0,
-          0.387983e0, -0.004772e0, -4.648107e0, 0.836376e0,
-          -3.553627e0, 0.000904e0, 24.361723e0, -20.736547e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        e;
-    }
-    {
-      static const double values[] = {
-        -7.85823e0, 1.83991e0, -11.7811e0, 22.6705e0, -15.9393e0, 1.77516e0
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        f1;
-    }
-  }
+  const std::array<double,4> &avw = sorpprops::ammoniaVaporAvw;
+  const std::array<double,4> &cw = sorpprops::ammoniaVaporCw;
+  const std::array<double,16> &e = sorpprops::ammoniaVaporE;
+  const std::array<double,6> &f1 = sorpprops::waterSatPressureF;
   //C*********************************************************************
   //C******  SUBROUTINE CALCULATES NH3-CONCENTR. IN WEIGHT PERCENT  ******
   //C******       OF WATER/AMMONIA VAPOUR AS A FUNCTION         **********
@@ -873,10 +740,10 @@ yvtp2(
   //C --- phiW: fugacity coefficient of water in mixture (at p)-------------
   double pi = 0.1e0;
   double c0 = trel * fem::dlog(prel / pi);
-  double c1 = cw(1) * (prel - pi);
-  double c2 = cw(2) * (prel / fem::pow3(trel) - pi / fem::pow3(trel));
-  double c3 = cw(3) * (prel / fem::pow(trel, 11) - pi / fem::pow(trel, 11));
-  double c4 = cw(4) * (fem::pow3(prel) / fem::pow(trel, 11) -
+  double c1 = cw[0] * (prel - pi);
+  double c2 = cw[1] * (prel / fem::pow3(trel) - pi / fem::pow3(trel));
+  double c3 = cw[2] * (prel / fem::pow(trel, 11) - pi / fem::pow(trel, 11));
+  double c4 = cw[3] * (fem::pow3(prel) / fem::pow(trel, 11) -
     fem::pow3(pi) / fem::pow(trel, 11)) / 3.e0;
   double dg = c0 + c1 + c2 + c3 + c4;
   double phiw = fem::dexp(dg / trel) * pi / prel;
@@ -891,15 +758,15 @@ yvtp2(
   //C     PFA= dexp(prel*vA/trel)
   //C     fA = dexp(fA/trel)*PFA
   //C --- fW: activity coeff. times Poynting fac. of water in mix (at p) ---
-  double a = e(1) + e(2) * prel + (e(3) + e(4) * prel) * trel + e(5) /
-    trel + e(6) / fem::pow2(trel);
-  double b = e(7) + e(8) * prel + (e(9) + e(10) * prel) * trel + e(
-    11) / trel + e(12) / fem::pow2(trel);
-  double c = e(13) + e(14) * prel + e(15) / trel + e(16) / fem::pow2(trel);
+  double a = e[0] + e[1] * prel + (e[2] + e[3] * prel) * trel + e[4] /
+    trel + e[5] / fem::pow2(trel);
+  double b = e[6] + e[7] * prel + (e[8] + e[9] * prel) * trel + e[
+    10] / trel + e[11] / fem::pow2(trel);
+  double c = e[12] + e[13] * prel + e[14] / trel + e[15] / fem::pow2(trel);
   double fw = (a - 3.e0 * b + 5.e0 * c) * fem::pow2(xn) + 4.e0 * (b -
     4.e0 * c) * fem::pow3(xn) + 12.e0 * c * fem::pow4(xn);
   //C     PFW: Poynting factor of water in mixture (at p)
-  double vw = avw(1) + avw(3) * trel + avw(4) * fem::pow2(trel) + avw(2) * prel;
+  double vw = avw[0] + avw[2] * trel + avw[3] * fem::pow2(trel) + avw[1] * prel;
   double pfw = fem::dexp(prel * vw / trel);
   fw = fem::dexp(fw / trel) * pfw;
   //C --- Fpsat2: pure NH3: sat.press. * fug.coeff. / Poynt.fac. (at ps,A) -
@@ -946,22 +813,22 @@ yvtp2(
   double pc = 220.89e0;
   double tc = 647.286e0;
   double tt = fem::dabs(1.e0 - tk / tc);
-  double sum = f1(1) * tt + f1(2) * fem::pow(tt, 1.5f) + f1(3) *
-    fem::pow3(tt) + f1(4) * fem::pow(tt, 3.5f) + f1(5) * fem::pow4(
-    tt) + f1(6) * fem::pow(tt, 7.5f);
+  double sum = f1[0] * tt + f1[1] * fem::pow(tt, 1.5f) + f1[2] *
+    fem::pow3(tt) + f1[3] * fem::pow(tt, 3.5f) + f1[4] * fem::pow4(
+    tt) + f1[5] * fem::pow(tt, 7.5f);
   double psw = pc * fem::dexp(tc / tk * sum) / 10.e0;
   //C     phiWpu: fugacity coefficient of pure water (at ps,W)
   pi = 0.1e0;
   c0 = trel * fem::dlog(psw / pi);
-  c1 = cw(1) * (psw - pi);
-  c2 = cw(2) * (psw / fem::pow3(trel) - pi / fem::pow3(trel));
-  c3 = cw(3) * (psw / fem::pow(trel, 11) - pi / fem::pow(trel, 11));
-  c4 = cw(4) * (fem::pow3(psw) / fem::pow(trel, 11) - fem::pow3(pi) /
+  c1 = cw[0] * (psw - pi);
+  c2 = cw[1] * (psw / fem::pow3(trel) - pi / fem::pow3(trel));
+  c3 = cw[2] * (psw / fem::pow(trel, 11) - pi / fem::pow(trel, 11));
+  c4 = cw[3] * (fem::pow3(psw) / fem::pow(trel, 11) - fem::pow3(pi) /
     fem::pow(trel, 11)) / 3.e0;
   dg = c0 + c1 + c2 + c3 + c4;
   double phiwpu = fem::dexp(dg / trel) * pi / psw;
   //C     PFW: Poynting factor of pure water (at ps,W)
-  vw = avw(1) + avw(3) * trel + avw(4) * fem::pow2(trel) + avw(2) * psw;
+  vw = avw[0] + avw[2] * trel + avw[3] * fem::pow2(trel) + avw[1] * psw;
   pfw = fem::dexp(psw * vw / trel);
   double fpsat1 = phiwpu * psw / pfw;
   //C ----------------------------------------------------------------------
@@ -1542,6 +1409,12 @@ hvt3(
       outputs.myMsg = " Guess value for water temperature above critical point.Program terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    h = sorpprops::if97::vaporEnthalpy(sorpprops::if97::saturationPressure(tk), tk) / 2.326e0;
+    if (h == h) {
+      return;
+    }
+  }
   double teta = tk / 647.14e0;
   double pspc = 647.14e0 / tk * (-7.85823e0 * tau + 1.83991e0 * fem::pow(tau,
     1.5e0) - 11.7811e0 * fem::pow3(tau) + 22.6705e0 * fem::pow(tau,
@@ -1605,6 +1478,12 @@ svt3(
       outputs.myMsg = " Guess value for water temperature above critical point.Program terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    s = sorpprops::if97::vaporEntropy(sorpprops::if97::saturationPressure(tk), tk) / 4.1868e0;
+    if (s == s) {
+      return;
+    }
+  }
   double teta = tk / 647.14e0;
   double pspc = 647.14e0 / tk * (-7.85823e0 * tau + 1.83991e0 * fem::pow(tau,
     1.5e0) - 11.7811e0 * fem::pow3(tau) + 22.6705e0 * fem::pow(tau,
@@ -1651,6 +1530,12 @@ dft3(
       outputs.myMsg = " Guess value for water temperature above critical point.Program terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    ds = 1.e-3 / sorpprops::if97::liquidVolume(sorpprops::if97::saturationPressure(tk), tk);
+    if (ds == ds) {
+      return;
+    }
+  }
   ds = 322.e-3 * (1.e0 + 1.99206e0 * fem::pow(tau, (1.e0 / 3.e0)) +
     1.10123e0 * fem::pow(tau, (2.e0 / 3.e0)) - 5.12506e-1 * fem::pow(tau,
     (5.e0 / 3.e0)) - 1.75263e0 * fem::pow(tau, (16.e0 / 3.e0)) -
@@ -2715,17 +2600,6 @@ eqb9(
   statement_400:;
 }
 
-struct hftx10_save
-{
-  arr<double, 2> a;
-  arr<double, 2> b;
-
-  hftx10_save() :
-    a(dimension(3, 3), fem::fill0),
-    b(dimension(3, 3), fem::fill0)
-  {}
-};
-
 //C***********************************************************************
 void
 hftx10(
@@ -2735,31 +2609,6 @@ hftx10(
   double const& xi,
   double const& pi)
 {
-  FEM_CMN_SVE(hftx10);
-  // SAVE
-  arr_ref<double, 2> a(sve.a, dimension(3, 3));
-  arr_ref<double, 2> b(sve.b, dimension(3, 3));
-  //
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        1.005402766e0, -2.981539611e-3, 3.554467994e-3,
-          -4.141814567e-5, 2.222804206e-4, -1.737859955e-4,
-          1.072823941e-6, -2.390061220e-6, 1.811226734e-6
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        a;
-    }
-    {
-      static const double values[] = {
-        1.859480885e0, 6.366656563e-1, -4.779806171e-2,
-          1.439748255e-4, -8.602739944e-3, 2.454135766e-3,
-          1.583330072e-6, 3.481615050e-5, -1.815684492e-5
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        b;
-    }
-  }
 //  //C***********************************************************************
 //  //C******  SUBROUTINE CALCULATES ENTHALPY IN BTU/LB OF AIR AS A **********
 //  //C******  FUNCTION OF TEMPERATURE IN DEG F, CONCENTRATION IN   **********
@@ -3162,6 +3011,41 @@ eqb11(
     return;
   }
 }
+double tsat(common& cmn, double const& psat, int& iflag);
+
+/// tsat() of the refrigerant cmn.nr from its propSurrogates table, which is
+/// built from tsat() on first use; NaN outside the table
+double fastTsat(common& cmn, double psat)
+{
+    static int tableNr = -1;
+    static const sorpprops::cubicTable* table = 0;
+    if(cmn.nr != tableNr)
+    {
+        sorpprops::propSurrogates &surrogates = sorpprops::propSurrogates::shared();
+        std::string name = "tsat R" + std::to_string(cmn.nr);
+        table = surrogates.table(name);
+        if(!table)
+        {
+            // from 1 psia to close to the critical point, in ln p
+            auto reference = [&cmn](double lp) {
+                int flag = 0;
+                double t = tsat(cmn, exp(lp), flag);
+                return flag == 0 ? t : sorpprops::notANumber();
+            };
+            sorpprops::cubicTable built;
+            fastProperties = false;
+            if(built.build(0, log(0.95 * cmn.pc), 512, reference))
+                built.measure(reference);
+            fastProperties = true;
+            // also kept if it failed, so the reference is used without trying again
+            table = surrogates.addTable(name, built);
+        }
+        tableNr = cmn.nr;
+    }
+    double lp = log(psat);
+    return table->covers(lp) ? (*table)(lp) : sorpprops::notANumber();
+}
+
 //C**********************************************************************
 double
 tsat(
@@ -3217,6 +3101,14 @@ tsat(
   //C        TSAT -  SATURATION TEMPERATURE (F)
   //C        IFLAG -  ERROR FLAG
   //C
+  if (fastProperties && psat > 0.0f) {
+    tr = fastTsat(cmn, psat);
+    if (tr == tr) {
+      iflag = 0;
+      return tr;
+    }
+  }
+  countSolve counted(&solveCounts::tsat, iter, psat);
   if (psat != psato) {
     goto statement_100;
   }
@@ -3385,6 +3277,7 @@ spvol(
   //C     CONVERT 'TF' TO 'T' AND CHECK VALUE
   //C
   t = tf + cmn.tfr;
+  countSolve counted(&solveCounts::spvol, iter, tf, ppsia);
   if (tf != tfold || ppsia != psiold) {
     goto statement_100;
   }
@@ -5731,6 +5624,14 @@ cpvm3(
   }
   double tk = (t - 32.e0) / 1.8e0 + 273.15e0;
   double tsk = (ts - 32.e0) / 1.8e0 + 273.15e0;
+  if (if97Water) {
+    double psk = sorpprops::if97::saturationPressure(tsk);
+    cp = (sorpprops::if97::vaporEnthalpy(psk, tk) - sorpprops::if97::vaporEnthalpy(psk, tsk))
+        / (tk - tsk) / 4.1868e0;
+    if (cp == cp) {
+      return;
+    }
+  }
   double p = fem::float0;
 //  qDebug()<<"pft3 called by cpvm3";
   pft3(cmn, p, ts);
@@ -8488,6 +8389,12 @@ entrop(
     s = ssat + fem::dlog(tk / tsk);
     return;
   }
+  if (if97Water) {
+    s = sorpprops::if97::vaporEntropy(pkpa * 1.e-3, tk) / 4.1868e0;
+    if (s == s) {
+      return;
+    }
+  }
   dels = 1.039008e-2 * (tk - tsk) - 9.873085e-6 * (fem::pow2(tk) -
     fem::pow2(tsk)) + 5.43411e-9 * (fem::pow3(tk) - fem::pow3(tsk)) -
     1.170465e-12 * (fem::pow4(tk) - fem::pow4(tsk)) + (1.777804e0 -
@@ -16022,6 +15929,9 @@ hybrdm(
 }
 
 /// \brief Sets up entry into the hybrid solver hybrdm().
+///
+/// With jacobianGiven, the first pass starts from the Q and R factors already
+/// in wa (see program_sorpsimEngine's warm start) instead of a new Jacobian.
 //C
 //C     //ABSORB JOB (MERGE01,E121),ELIZ,MSGCLASS=9                       HYB00010
 //C     /*R UL                                                            HYB00020
@@ -16040,7 +15950,8 @@ hybrd1(
   int& maxfev,
   int& ier,
   int const& lwa,
-  arr_ref<double> wa)
+  arr_ref<double> wa,
+  bool const& jacobianGiven)
 {
   x(dimension(n));
   f(dimension(n));
@@ -16064,7 +15975,7 @@ hybrd1(
   m2 = n - 1;
   nhold = n * n + 3 * n + 1;
   lrwa = (n * (n + 1)) / 2;
-  jeval = true;
+  jeval = !jacobianGiven;
   ntry = 10;
   nfe1 = maxfev;
   hybrdm(cmn, n, fcn, x, f, m1, m2, ftol, xtol, nfe1, jeval, ntry,
@@ -16085,17 +15996,6 @@ hybrd1(
   //C                                                                       HYB00370
 }
 
-struct pftx1_save
-{
-  arr<double> a;
-  arr<double> b;
-
-  pftx1_save() :
-    a(dimension(10), fem::fill0),
-    b(dimension(10), fem::fill0)
-  {}
-};
-
 //C**********************************************************************
 void
 pftx1(
@@ -16104,33 +16004,6 @@ pftx1(
   double const& t,
   double const& w0l)
 {
-  FEM_CMN_SVE(pftx1);
-  // SAVE
-  arr_ref<double> a(sve.a, dimension(10));
-  arr_ref<double> b(sve.b, dimension(10));
-  //
-  if (is_called_first_time) {
-    {
-      static const double values[] = {
-        -.68242821e-03, +.58736190e-03, -.10278186e-03,
-          +.93032374e-05, -.48223940e-06, +.15189038e-07,
-          -.29412863e-09, +.34100528e-11, -.21671480e-13,
-          +.57995604e-16
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        a;
-    }
-    {
-      static const double values[] = {
-        +.16634856e+00, -.55338169e-01, +.11228336e-01,
-          -.11028390e-02, +.62109464e-04, -.21112567e-05,
-          +.43851901e-07, -.54098115e-09, +.36266742e-11,
-          -.10153059e-13
-      };
-      fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-        b;
-    }
-  }
   //C*********************************************************************
   //C******  SUBROUTINE CALCULATES EQUILIBRIUM PRESSURE IN PSIA **********
   //C******       OF LI-BR/WATER SOLUTION AS A FUNCTION         **********
@@ -16139,13 +16012,8 @@ pftx1(
   //C*********************************************************************
   //C      IMPLICIT REAL*8 (A-H,O-Z)
   double tc = (t - 32.e0) / 1.8e0;
-  double aa = 1.e0;
-  double bb = 0.e0;
-  int i = fem::int0;
-  FEM_DO_SAFE(i, 1, 10) {
-    aa += a(i) * fem::pow(w0l, i);
-    bb += b(i) * fem::pow(w0l, i);
-  }
+  double aa = 1.e0 + sorpprops::hornerFromFirst(sorpprops::librDuhringA, w0l);
+  double bb = sorpprops::hornerFromFirst(sorpprops::librDuhringB, w0l);
   double th = (tc - bb) / aa;
   th = th * 1.8e0 + 32.e0;
 //  qDebug()<<"pft3 called by pftx1";
@@ -16163,15 +16031,6 @@ pftx1(
 //    w = 0.6218*p/(14.7-p);
 //}
 
-struct hwftx1_save
-{
-  arr<double> x;
-
-  hwftx1_save() :
-    x(dimension(21), fem::fill0)
-  {}
-};
-
 //C*********************************************************************
 void
 hwftx1(
@@ -16180,23 +16039,7 @@ hwftx1(
   double const& t,
   double const& cl)
 {
-  FEM_CMN_SVE(hwftx1);
-  // SAVE
-  arr_ref<double> x(sve.x, dimension(21));
-  //
-  if (is_called_first_time) {
-    static const double values[] = {
-      0.5086682481e+03, -0.1021608631e+04, -0.5333082110e+03,
-        0.4836280661e+03, 0.3687726426e+02, 0.4028472553e+02,
-        0.3991418127e+02, -0.1860514100e+00, -0.1911981148e+00,
-        -0.1992131652e+00, 0.1155132809e+04, 0.3335722311e+02,
-        -0.1782584073e+00, -0.1862407335e+02, 0.9859458321e-01,
-        -0.2509791095e-04, 0.4158007710e-07, 0.6406219484e+03,
-        -0.7512766773e-05, 0.1310318363e+02, -0.7751011421e-01
-    };
-    fem::data_of_type<double>(FEM_VALUES_AND_SIZE),
-      x;
-  }
+  const std::array<double,21> &x = sorpprops::librEnthalpyX;
   //C*********************************************************************
   //C******  SUBROUTINE  CALCULATES PARTIAL ENTHALPY            **********
   //C******  IN  BTU/LB  OF WATER IN LI-BR/WATER SOLUTION AS    **********
@@ -16221,13 +16064,13 @@ hwftx1(
   double t2 = tc * tc;
   double t3 = tc * t2;
   double t4 = tc * t3;
-  double hlibr = x(1) + x(14) * tc + x(15) * t2 + x(16) * t3 + x(17) * t4;
+  double hlibr = x[0] + x[13] * tc + x[14] * t2 + x[15] * t3 + x[16] * t4;
   //C --- Calculating excess enthalpy DH ---
-  double a = x(2) + x(5) * tc + x(8) * t2 + x(19) * t3;
-  double b = x(3) + x(6) * tc + x(9) * t2;
-  double c = x(4) + x(7) * tc + x(10) * t2;
-  double d = x(11) + x(12) * tc + x(13) * t2;
-  double e = x(18) + x(20) * tc + x(21) * t2;
+  double a = x[1] + x[4] * tc + x[7] * t2 + x[18] * t3;
+  double b = x[2] + x[5] * tc + x[8] * t2;
+  double c = x[3] + x[6] * tc + x[9] * t2;
+  double d = x[10] + x[11] * tc + x[12] * t2;
+  double e = x[17] + x[19] * tc + x[20] * t2;
   double xi = cl / 1.e2;
   double dx = 2.e0 * xi - 1.e0;
   double dx2 = dx * dx;
@@ -16573,6 +16416,12 @@ sft3(
       outputs.myMsg = " Guess value for water temperature above critical point.Program terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    s = sorpprops::if97::liquidEntropy(sorpprops::if97::saturationPressure(tk), tk) / 4.1868e0;
+    if (s == s) {
+      return;
+    }
+  }
   double teta = tk / 647.14e0;
   double pspc = 647.14e0 / tk * (-7.85823e0 * tau + 1.83991e0 * fem::pow(tau,
     1.5e0) - 11.7811e0 * fem::pow3(tau) + 22.6705e0 * fem::pow(tau,
@@ -16652,6 +16501,12 @@ dvt3(
       outputs.myMsg = " Guess value for water temperature above critical point.Program terminated.";
     FEM_STOP(0);
   }
+  if (if97Water) {
+    ds = 1.e-3 / sorpprops::if97::vaporVolume(sorpprops::if97::saturationPressure(tk), tk);
+    if (ds == ds) {
+      return;
+    }
+  }
   ds = 322.e-3 * fem::dexp(-2.02957e0 * fem::pow(tau, (1.e0 /
     3.e0)) - 2.68781e0 * fem::pow(tau, (2.e0 / 3.e0)) - 5.38107e0 *
     fem::pow(tau, (4.e0 / 3.e0)) - 17.3151e0 * fem::pow3(tau) -
@@ -16776,6 +16631,1080 @@ redun(
 ///
 /// \{
 
+namespace {
+
+/// \brief One result of the engine, as left by fcn() and fcn1() with jjf=5.
+double
+sensitivityResult(
+  common& cmn,
+  sensitivityReport::item const& item,
+  arr_cref<int> icop)
+{
+  icop(dimension(50));
+  switch (item.quantity) {
+    case sensitivityReport::Temperature: return cmn.t(item.index);
+    case sensitivityReport::Enthalpy: return cmn.h(item.index);
+    case sensitivityReport::MassFlow: return cmn.f(item.index);
+    case sensitivityReport::Concentration: return cmn.c(item.index);
+    case sensitivityReport::Pressure: return cmn.p(item.index);
+    case sensitivityReport::VaporFraction: return cmn.w(item.index);
+    case sensitivityReport::HeatSpec: return cmn.ht(item.index);
+    case sensitivityReport::HeatTransfer: return cmn.q(item.index);
+    case sensitivityReport::UAValue: return fem::dabs(cmn.ua(item.index));
+    default: break;
+  }
+  // as the main program calculates the COP
+  double copn = 0.0;
+  double copd = 0.0;
+  int i = fem::int0;
+  FEM_DO_SAFE(i, 1, cmn.nunits) {
+    if (icop(i) == 1) {
+      copn += cmn.q(i);
+    }
+    if (icop(i) == -1) {
+      copd += cmn.q(i);
+    }
+  }
+  if (item.quantity == sensitivityReport::Capacity) {
+    return copn;
+  }
+  return copd != 0.0 ? copn / copd : 0.0;
+}
+
+/// \brief The fixed value of the engine an input of the report stands for.
+double&
+sensitivityInput(
+  common& cmn,
+  sensitivityReport::item const& item)
+{
+  switch (item.quantity) {
+    case sensitivityReport::MassFlow: return cmn.f(item.index);
+    case sensitivityReport::Concentration: return cmn.c(item.index);
+    case sensitivityReport::Pressure: return cmn.p(item.index);
+    case sensitivityReport::HeatSpec: return cmn.ht(item.index);
+    default: return cmn.t(item.index);
+  }
+}
+
+/// \brief Whether the component has heat transfer results (q, UA) and a ht
+/// specification of one of the types 0..5.
+bool
+sensitivityUnit(
+  common& cmn,
+  int const& iunit)
+{
+  int id = cmn.idunit(iunit) / 10;
+  return id <= 5 || id == 9 || id == 10;
+}
+
+}
+
+/// \brief Sensitivities of the results to the fixed inputs at the solution x.
+///
+/// With the residuals F(x,p) = 0 at the solution, the implicit function theorem
+/// gives dx/dp = -J^-1 dF/dp. J is formed once at x by fder() and factored by
+/// qrdcom() (the factors hybrdm() ends with are Broyden updates, not accurate
+/// enough for derivatives). Each input then costs one residual evaluation for
+/// dF/dp, one solve with the factors, and one evaluation at x + dx, p + dp,
+/// where the difference of the results over dp gives their total derivatives,
+/// including those of the enthalpies, heat quantities and COP that are not
+/// variables of the solver. Direct rather than adjoint mode: a case has fewer
+/// fixed inputs than results.
+///
+/// The inputs are the fixed temperatures, flow rates, concentrations and
+/// pressures of the state points (nonzero ones, except for temperatures) and
+/// the ht of the components with heat transfer; the results are the COP and
+/// capacity if defined, q and UA of those components and the unknowns and
+/// enthalpies of the state points. Everything in British units.
+///
+/// The fixed values and the iteration count are restored; the state points are
+/// left at the last evaluation, so the caller calls fcn() at x again.
+void
+sensitivity(
+  common& cmn,
+  int const& n,
+  arr_cref<double> x,
+  arr_cref<int> icop,
+  sensitivityReport& report)
+{
+  x(dimension(n));
+  icop(dimension(50));
+  arr_cref<int> iht(cmn.iht, dimension(50));
+  arr_cref<int> itfix(cmn.itfix, dimension(150));
+  arr_cref<int> iffix(cmn.iffix, dimension(150));
+  arr_cref<int> icfix(cmn.icfix, dimension(150));
+  arr_cref<int> ipfix(cmn.ipfix, dimension(150));
+  arr_cref<int> iwfix(cmn.iwfix, dimension(150));
+  int i = fem::int0;
+  int j = fem::int0;
+  int k = fem::int0;
+  int ii = fem::int0;
+  int ij = fem::int0;
+  report = sensitivityReport();
+
+  sensitivityReport::item item;
+  FEM_DO_SAFE(i, 1, cmn.nsp) {
+    item.index = i;
+    item.quantity = sensitivityReport::Temperature;
+    if (itfix(i) == 0) {
+      report.inputs.append(item);
+    }
+    item.quantity = sensitivityReport::MassFlow;
+    if (iffix(i) == 0 && cmn.f(i) != 0.0) {
+      report.inputs.append(item);
+    }
+    item.quantity = sensitivityReport::Concentration;
+    if (icfix(i) == 0 && cmn.c(i) != 0.0) {
+      report.inputs.append(item);
+    }
+    item.quantity = sensitivityReport::Pressure;
+    if (ipfix(i) == 0 && cmn.p(i) != 0.0) {
+      report.inputs.append(item);
+    }
+  }
+  item.quantity = sensitivityReport::HeatSpec;
+  FEM_DO_SAFE(i, 1, cmn.nunits) {
+    if (sensitivityUnit(cmn, i) && iht(i) >= 0 && iht(i) <= 5) {
+      item.index = i;
+      item.iht = iht(i);
+      report.inputs.append(item);
+    }
+  }
+  item.iht = 0;
+  if (report.inputs.isEmpty()) {
+    report.message = "The case has no fixed inputs.";
+    return;
+  }
+
+  bool numerator = false;
+  bool denominator = false;
+  FEM_DO_SAFE(i, 1, cmn.nunits) {
+    numerator = numerator || icop(i) == 1;
+    denominator = denominator || icop(i) == -1;
+  }
+  item.index = 0;
+  item.quantity = sensitivityReport::COP;
+  if (numerator && denominator) {
+    report.outputs.append(item);
+  }
+  item.quantity = sensitivityReport::Capacity;
+  if (numerator) {
+    report.outputs.append(item);
+  }
+  FEM_DO_SAFE(i, 1, cmn.nunits) {
+    if (sensitivityUnit(cmn, i)) {
+      item.index = i;
+      item.quantity = sensitivityReport::HeatTransfer;
+      report.outputs.append(item);
+      item.quantity = sensitivityReport::UAValue;
+      report.outputs.append(item);
+    }
+  }
+  FEM_DO_SAFE(i, 1, cmn.nsp) {
+    item.index = i;
+    int fixes[6] = {itfix(i), 1, iffix(i), icfix(i), ipfix(i), iwfix(i)};
+    for (int quantity = sensitivityReport::Temperature;
+        quantity <= sensitivityReport::VaporFraction; quantity++) {
+      if (fixes[quantity] > 0) {
+        item.quantity = quantity;
+        report.outputs.append(item);
+      }
+    }
+  }
+
+  int const lr = (n * (n + 1)) / 2;
+  arr<double, 2> a(dimension(n, n), fem::fill0);
+  arr<double> r(dimension(lr), fem::fill0);
+  arr<double> xp(dimension(n), fem::fill0);
+  arr<double> f0(dimension(n), fem::fill0);
+  arr<double> fp(dimension(n), fem::fill0);
+  arr<double> dx(dimension(n), fem::fill0);
+  arr<double> wa1(dimension(n), fem::fill0);
+  arr<double> wa2(dimension(n), fem::fill0);
+  arr<double> wa3(dimension(n), fem::fill0);
+  arr_1d<150, double> fun(fem::fill0);
+  int ier = 0;
+  int ialter = 0;
+  bool sing = false;
+  int const iter = cmn.iter;
+  int const nout = report.outputs.count();
+  QVector<double> y0(nout);
+  int current = -1;
+  double base = 0.0;
+
+  try {
+    // results at the solution, J = Q*R
+    FEM_DO_SAFE(i, 1, n) {
+      xp(i) = x(i);
+    }
+    fcn(cmn, n, xp, f0, ier);
+    fcn1(cmn, fun, 5, ialter);
+    for (int o = 0; o < nout; o++) {
+      y0[o] = sensitivityResult(cmn, report.outputs.at(o), icop);
+    }
+    report.results = y0;
+    fder(cmn, n, fcn, xp, f0, n - 1, n - 1, a, wa1, wa2, wa3, ier);
+    qrdcom(cmn, n, a, lr, r, wa1, sing);
+    if (sing) {
+      report.message = "The Jacobian is singular at the solution.";
+    }
+
+    report.values.reserve(report.inputs.count() * nout);
+    for (current = 0; !sing && current < report.inputs.count(); current++) {
+      double& value = sensitivityInput(cmn, report.inputs.at(current));
+      base = value;
+      double dp = 1.e-6 * fem::dmax1(fem::dabs(base), 1.0);
+      value = base + dp;
+
+      // dx = -R^-1 * Q^T * (F(x,p+dp) - F(x,p))
+      FEM_DO_SAFE(i, 1, n) {
+        xp(i) = x(i);
+      }
+      fcn(cmn, n, xp, fp, ier);
+      FEM_DO_SAFE(j, 1, n) {
+        double sum = 0.0;
+        FEM_DO_SAFE(i, 1, n) {
+          sum += a(i, j) * (fp(i) - f0(i));
+        }
+        wa2(j) = -sum;
+      }
+      ii = lr;
+      dx(n) = wa2(n) / r(ii);
+      FEM_DO_SAFE(k, 2, n) {
+        i = n - k + 1;
+        ii = ii - k;
+        double sum = 0.0;
+        ij = ii;
+        FEM_DO_SAFE(j, i + 1, n) {
+          ij++;
+          sum += r(ij) * dx(j);
+        }
+        dx(i) = (wa2(i) - sum) / r(ii);
+      }
+
+      FEM_DO_SAFE(i, 1, n) {
+        xp(i) = x(i) + dx(i);
+      }
+      fcn(cmn, n, xp, fp, ier);
+      fcn1(cmn, fun, 5, ialter);
+      for (int o = 0; o < nout; o++) {
+        report.values.append((sensitivityResult(cmn, report.outputs.at(o), icop) - y0[o]) / dp);
+      }
+      value = base;
+    }
+  }
+  catch (fem::stop_info const&) {
+    // a NaN in fcn(): the report is lost, not the solution
+    if (current >= 0 && current < report.inputs.count()) {
+      sensitivityInput(cmn, report.inputs.at(current)) = base;
+    }
+    outputs.stopped = false;
+    report.message = "Sensitivities failed: " + outputs.myMsg;
+  }
+  cmn.iter = iter;
+  if (!report.isValid()) {
+    report.values.clear();
+    report.results.clear();
+    qDebug()<<"no sensitivities:"<<report.message;
+  }
+}
+
+namespace {
+
+/// lambda of the homotopy evaluated by fcnHomotopy()
+double homotopyLambda = 1.0;
+/// the start x0 of the homotopy path
+std::vector<double> homotopyStart;
+
+/// \brief The residuals H(x,lambda) = lambda*F(x) + (1-lambda)*(x-x0) of the
+/// homotopy, with F from fcn() and lambda, x0 as set by homotopy().
+void
+fcnHomotopy(
+  common& cmn,
+  int const& n,
+  arr_ref<double> xx,
+  arr_ref<double> xfun,
+  int const& ier)
+{
+  xx(dimension(n));
+  xfun(dimension(n));
+  int i = fem::int0;
+  // fcn() may move x back into its physical range, H takes the moved x
+  fcn(cmn, n, xx, xfun, ier);
+  FEM_DO_SAFE(i, 1, n) {
+    xfun(i) = homotopyLambda * xfun(i)
+        + (1.0 - homotopyLambda) * (xx(i) - homotopyStart[i-1]);
+  }
+}
+
+}
+
+/// \brief Solves fcn() = 0 by homotopy continuation from x, for starting points
+/// far from the solution (see calInputs::Homotopy).
+///
+/// Follows the path of H(x,lambda) = lambda*F(x) + (1-lambda)*(x-x0) from
+/// lambda = 0, where the start x0 is the solution, to lambda = 1, where H is
+/// the residuals F of fcn(). Each step predicts x at the next lambda from the
+/// last two points of the path (secant predictor) and corrects it with
+/// hybrd1() on H at a loose tolerance, reusing the factors of the last
+/// correction. The step in lambda doubles after a correction that took at
+/// most about one Jacobian of evaluations, up to a quarter, and is halved
+/// after one that failed; below 1e-4 the path is abandoned. The end of the
+/// path, or the last point reached, is then solved by hybrd1() on fcn() with
+/// ftol and xtol.
+///
+/// The path and the last solve may take maxfev evaluations each; on return
+/// maxfev is the number taken and ier is that of the last solve, as hybrd1().
+void
+homotopy(
+  common& cmn,
+  int const& n,
+  arr_ref<double> x,
+  arr_ref<double> f,
+  double const& ftol,
+  double const& xtol,
+  int& maxfev,
+  int& ier,
+  int const& lwa,
+  arr_ref<double> wa)
+{
+  x(dimension(n));
+  f(dimension(n));
+  wa(dimension(lwa));
+  double const maxStep = 0.25;
+  double const minStep = 1.0e-4;
+  double const correctorTol = qMax(ftol, 1.0e-3);
+  int const budget = maxfev;
+  arr<double> xPath(dimension(n), fem::fill0);
+  arr<double> xPrev(dimension(n), fem::fill0);
+  int i = fem::int0;
+  int nfev = 0;
+  int used = 0;
+  int steps = 0;
+  double lambda = 0.0;
+  double lambdaPrev = 0.0;
+  double step = 0.05;
+  bool havePrev = false;
+  bool reuse = false;
+
+  homotopyStart.assign(n, 0.0);
+  FEM_DO_SAFE(i, 1, n) {
+    homotopyStart[i-1] = x(i);
+    xPath(i) = x(i);
+  }
+  while (lambda < 1.0 && step >= minStep && nfev < budget) {
+    double next = qMin(1.0, lambda + step);
+    // predictor
+    FEM_DO_SAFE(i, 1, n) {
+      x(i) = xPath(i);
+      if (havePrev) {
+        x(i) += (next - lambda) / (lambda - lambdaPrev) * (xPath(i) - xPrev(i));
+      }
+    }
+    // corrector
+    homotopyLambda = next;
+    used = qMin(budget - nfev, 10 * (n + 1));
+    hybrd1(cmn, n, fcnHomotopy, x, f, correctorTol, correctorTol, used,
+      ier, lwa, wa, reuse);
+    nfev += used;
+    if (ier >= 1 && ier <= 3) {
+      FEM_DO_SAFE(i, 1, n) {
+        xPrev(i) = xPath(i);
+        xPath(i) = x(i);
+      }
+      lambdaPrev = lambda;
+      lambda = next;
+      havePrev = true;
+      reuse = true;
+      steps++;
+      if (used <= n + 5) {
+        step = qMin(2.0 * step, maxStep);
+      }
+    }
+    else {
+      step *= 0.5;
+      reuse = false;
+    }
+  }
+  homotopyLambda = 1.0;
+  qDebug()<<"homotopy reached lambda"<<lambda<<"in"<<steps<<"steps and"<<nfev<<"evaluations";
+
+  // H is F at lambda = 1, so the factors of the last correction still fit
+  FEM_DO_SAFE(i, 1, n) {
+    x(i) = xPath(i);
+  }
+  used = budget;
+  hybrd1(cmn, n, fcn, x, f, ftol, xtol, used, ier, lwa, wa,
+    reuse && lambda >= 1.0);
+  maxfev = nfev + used;
+}
+
+namespace {
+
+/// \brief The bounds of the scaled variables x of the bounded solver, from the
+/// kind of each variable and the fluid of its state point.
+///
+/// Concentrations lie between 0 and 100 %, and for the salt solutions below
+/// the end of their correlations near crystallization (LiBr-H2O 75 %, NaOH-H2O
+/// 70 %, LiCl-H2O 55 %); flows are not negative, pressures at least 0.001 psia
+/// and vapor fractions between 0 and 1. Temperatures are free, fcn1() enforces
+/// their constraints.
+void
+variableBounds(
+  common& cmn,
+  int const& n,
+  arr_ref<double> lower,
+  arr_ref<double> upper)
+{
+  lower(dimension(n));
+  upper(dimension(n));
+  arr_cref<int> ksub(cmn.ksub, dimension(150));
+  arr_cref<int> ivc(cmn.ivc, dimension(150));
+  int const nt = cmn.nukt;
+  int const nc = nt + cmn.nconc;
+  int const nf = nc + cmn.nflow;
+  int const np = nf + cmn.npress;
+  int const nw = np + cmn.nw;
+  double const big = 1.0e30;
+  int i = fem::int0;
+  FEM_DO_SAFE(i, 1, n) {
+    lower(i) = -big;
+    upper(i) = big;
+    if (i > nt && i <= nc) {
+      double cmax = 100.0;
+      switch (ksub(ivc(i))) {
+        case 1: cmax = 75.0; break;
+        case 8: cmax = 70.0; break;
+        case 9: cmax = 55.0; break;
+        default: break;
+      }
+      lower(i) = 0.0;
+      upper(i) = cmax / cmn.ctt;
+    }
+    else if (i > nc && i <= nf) {
+      lower(i) = 0.0;
+    }
+    else if (i > nf && i <= np) {
+      lower(i) = 0.001 / cmn.pmax;
+    }
+    else if (i > np && i <= nw) {
+      lower(i) = 0.0;
+      upper(i) = 1.0;
+    }
+  }
+}
+
+/// \brief Forward-difference Jacobian of fcn() at x, f that stays within the
+/// bounds: a variable at its upper bound is moved down instead.
+void
+boundedJacobian(
+  common& cmn,
+  int const& n,
+  arr_cref<double> x,
+  arr_cref<double> f,
+  arr_cref<double> upper,
+  arr_ref<double, 2> jac)
+{
+  x(dimension(n));
+  f(dimension(n));
+  upper(dimension(n));
+  jac(dimension(n, n));
+  double const eps = fem::dsqrt(fem::pow(16.e0, (-13)));
+  arr<double> xh(dimension(n), fem::fill0);
+  arr<double> fh(dimension(n), fem::fill0);
+  int const iflag = 1;
+  int i = fem::int0;
+  int j = fem::int0;
+  FEM_DO_SAFE(j, 1, n) {
+    // fcn() may change other variables (temperature constraints), start afresh
+    FEM_DO_SAFE(i, 1, n) {
+      xh(i) = x(i);
+    }
+    double h = eps * fem::dabs(x(j));
+    if (h == 0.0) {
+      h = eps;
+    }
+    if (x(j) + h > upper(j)) {
+      h = -h;
+    }
+    xh(j) = x(j) + h;
+    fcn(cmn, n, xh, fh, iflag);
+    FEM_DO_SAFE(i, 1, n) {
+      jac(i, j) = (fh(i) - f(i)) / h;
+    }
+  }
+}
+
+}
+
+/// \brief Solves fcn() = 0 within the bounds of variableBounds() by a projected
+/// dogleg trust-region method (see calInputs::BoundedTrustRegion).
+///
+/// fcn() keeps concentrations, flows, pressures and vapor fractions physical by
+/// reflecting them (x = -x, x = 1/x), which puts kinks into the residuals where
+/// the steps of hybrdm() cross the bounds. Here the iterates stay within the
+/// bounds: each step is the dogleg between the Cauchy and the Newton step of
+/// the trust region, projected onto the bounds (or, if that doesn't move, the
+/// projected steepest descent step), and is judged by the reduction of the
+/// residuals predicted for the projected step. The Jacobian is by forward
+/// differences (see boundedJacobian()), updated by Broyden's formula after
+/// every step and evaluated again after two failed steps or slow progress.
+/// The trust region updates and the termination codes ier 1 to 7 are those
+/// of hybrdm().
+///
+/// With jacobianGiven the first Jacobian is Q*R from the factors in wa (warm
+/// start); on return wa holds the factors of the last Jacobian, where hybrd1()
+/// leaves them, and maxfev is the number of evaluations.
+void
+boundedTrustRegion(
+  common& cmn,
+  int const& n,
+  arr_ref<double> x,
+  arr_ref<double> f,
+  double const& ftol,
+  double const& xtol,
+  int& maxfev,
+  int& ier,
+  int const& lwa,
+  arr_ref<double> wa,
+  bool const& jacobianGiven)
+{
+  x(dimension(n));
+  f(dimension(n));
+  wa(dimension(lwa));
+  double const epsmch = fem::pow(16.e0, (-13));
+  double const eps = fem::dsqrt(epsmch);
+  int const ntry = 10;
+  int const iflag = 1;
+  int const lr = (n * (n + 1)) / 2;
+  int const nq = 3 * n;
+  int const nr = n * n + 3 * n;
+  int i = fem::int0;
+  int j = fem::int0;
+  int k = fem::int0;
+  int ii = fem::int0;
+  int ij = fem::int0;
+  int nfev = 0;
+  int iter = 0;
+  int ncsuc = 0;
+  int ncfail = 0;
+  int nconv = 0;
+  bool sing = false;
+  bool jeval = !jacobianGiven;
+  double fn = 0.0;
+  double xn = 0.0;
+  double delta = 0.0;
+  double temp1 = 0.0;
+  double temp2 = 0.0;
+  ier = 0;
+  if (n <= 0 || lwa < (n * (3 * n + 7)) / 2 || maxfev <= 0 || ftol < 0.0 || xtol < 0.0) {
+    maxfev = 0;
+    return;
+  }
+  arr<double> lower(dimension(n), fem::fill0);
+  arr<double> upper(dimension(n), fem::fill0);
+  arr<double, 2> jac(dimension(n, n), fem::fill0);
+  arr<double, 2> q(dimension(n, n), fem::fill0);
+  arr<double> r(dimension(lr), fem::fill0);
+  arr<double> g(dimension(n), fem::fill0);
+  arr<double> pn(dimension(n), fem::fill0);
+  arr<double> p(dimension(n), fem::fill0);
+  arr<double> s(dimension(n), fem::fill0);
+  arr<double> xt(dimension(n), fem::fill0);
+  arr<double> ft(dimension(n), fem::fill0);
+  arr<double> wa1(dimension(n), fem::fill0);
+
+  variableBounds(cmn, n, lower, upper);
+  FEM_DO_SAFE(i, 1, n) {
+    x(i) = fem::dmax1(lower(i), fem::dmin1(x(i), upper(i)));
+  }
+  fcn(cmn, n, x, f, iflag);
+  nfev = 1;
+  fn = enorm(cmn, n, f);
+  if (fn <= ftol) {
+    ier = 1;
+    maxfev = nfev;
+    return;
+  }
+  if (jacobianGiven) {
+    // J = Q*R, Q column major, R packed by rows
+    FEM_DO_SAFE(i, 1, n) {
+      FEM_DO_SAFE(j, 1, n) {
+        double sum = 0.0;
+        ij = j;
+        FEM_DO_SAFE(k, 1, j) {
+          sum += wa(nq + (k - 1) * n + i) * wa(nr + ij);
+          ij += n - k;
+        }
+        jac(i, j) = sum;
+      }
+    }
+  }
+  xn = enorm(cmn, n, x);
+  delta = xn > 0.0 ? xn : 1.0;
+
+  while (ier == 0) {
+    if (jeval) {
+      boundedJacobian(cmn, n, x, f, upper, jac);
+      nfev += n;
+      jeval = false;
+      ncfail = 0;
+    }
+    iter++;
+    FEM_DO_SAFE(i, 1, n) {
+      FEM_DO_SAFE(j, 1, n) {
+        q(i, j) = jac(i, j);
+      }
+    }
+    qrdcom(cmn, n, q, lr, r, wa1, sing);
+    FEM_DO_SAFE(i, 1, n * n) {
+      wa(nq + i) = q(((i - 1) % n) + 1, ((i - 1) / n) + 1);
+    }
+    FEM_DO_SAFE(i, 1, lr) {
+      wa(nr + i) = r(i);
+    }
+
+    // gradient of |f|^2/2 and the Newton step -R^-1 Q^T f
+    FEM_DO_SAFE(j, 1, n) {
+      double sum = 0.0;
+      double qf = 0.0;
+      FEM_DO_SAFE(i, 1, n) {
+        sum += jac(i, j) * f(i);
+        qf += q(i, j) * f(i);
+      }
+      g(j) = sum;
+      wa1(j) = -qf;
+    }
+    double gn = enorm(cmn, n, g);
+    double pnn = 0.0;
+    if (!sing) {
+      ii = lr;
+      pn(n) = wa1(n) / r(ii);
+      FEM_DO_SAFE(k, 2, n) {
+        i = n - k + 1;
+        ii = ii - k;
+        double sum = 0.0;
+        ij = ii;
+        FEM_DO_SAFE(j, i + 1, n) {
+          ij++;
+          sum += r(ij) * pn(j);
+        }
+        pn(i) = (wa1(i) - sum) / r(ii);
+      }
+      pnn = enorm(cmn, n, pn);
+    }
+    if (gn == 0.0 && sing) {
+      ier = 6;
+      break;
+    }
+
+    // dogleg step in the trust region
+    if (!sing && pnn <= delta) {
+      FEM_DO_SAFE(i, 1, n) {
+        p(i) = pn(i);
+      }
+    }
+    else {
+      // the Cauchy point minimizes the linear model along -g
+      FEM_DO_SAFE(i, 1, n) {
+        double sum = 0.0;
+        FEM_DO_SAFE(j, 1, n) {
+          sum += jac(i, j) * g(j);
+        }
+        wa1(i) = sum;
+      }
+      double jgn = enorm(cmn, n, wa1);
+      double alpha = jgn > 0.0 ? (gn / jgn) * (gn / jgn) : delta / gn;
+      if (sing || alpha * gn >= delta) {
+        FEM_DO_SAFE(i, 1, n) {
+          p(i) = -delta / gn * g(i);
+        }
+      }
+      else {
+        double a = 0.0;
+        double b = 0.0;
+        double c = (alpha * gn) * (alpha * gn) - delta * delta;
+        FEM_DO_SAFE(i, 1, n) {
+          double d = pn(i) + alpha * g(i);
+          a += d * d;
+          b -= 2.0 * alpha * g(i) * d;
+        }
+        double tau = a > 0.0 ? (-b + fem::dsqrt(b * b - 4.0 * a * c)) / (2.0 * a) : 0.0;
+        FEM_DO_SAFE(i, 1, n) {
+          p(i) = -alpha * g(i) + tau * (pn(i) + alpha * g(i));
+        }
+      }
+    }
+
+    // projected onto the bounds
+    FEM_DO_SAFE(i, 1, n) {
+      xt(i) = fem::dmax1(lower(i), fem::dmin1(x(i) + p(i), upper(i)));
+      s(i) = xt(i) - x(i);
+    }
+    double qn = enorm(cmn, n, s);
+    if (qn == 0.0 && gn > 0.0) {
+      // the step points out of the bounds everywhere, descend along them
+      FEM_DO_SAFE(i, 1, n) {
+        xt(i) = fem::dmax1(lower(i), fem::dmin1(x(i) - delta / gn * g(i), upper(i)));
+        s(i) = xt(i) - x(i);
+      }
+      qn = enorm(cmn, n, s);
+    }
+    if (qn == 0.0) {
+      // stationary on the bounds
+      ier = 5;
+      break;
+    }
+    if (iter == 1) {
+      delta = fem::dmin1(delta, qn);
+    }
+
+    // reduction of |f| predicted by the linear model, and the actual one
+    FEM_DO_SAFE(i, 1, n) {
+      double sum = f(i);
+      FEM_DO_SAFE(j, 1, n) {
+        sum += jac(i, j) * s(j);
+      }
+      wa1(i) = sum;
+    }
+    double fpn = enorm(cmn, n, wa1);
+    double prered = 1.0 - (fpn / fn) * (fpn / fn);
+    fcn(cmn, n, xt, ft, iflag);
+    nfev++;
+    double ftn = enorm(cmn, n, ft);
+    double actred = ftn < fn ? 1.0 - (ftn / fn) * (ftn / fn) : -1.0;
+    double ratio = prered > 0.0 ? actred / prered : 0.0;
+
+    // step bound
+    if (ratio < 0.1) {
+      ncsuc = 0;
+      ncfail++;
+      delta = 0.5 * delta;
+    }
+    else {
+      ncfail = 0;
+      ncsuc++;
+      if (ncsuc > 1 || ratio >= 1.0) {
+        delta = fem::dmax1(delta, qn / 0.5);
+      }
+    }
+
+    // Broyden update of the Jacobian with the step fcn() took (it may move
+    // temperatures to their constraints)
+    double ss = 0.0;
+    FEM_DO_SAFE(i, 1, n) {
+      s(i) = xt(i) - x(i);
+      ss += s(i) * s(i);
+    }
+    if (ss > 0.0) {
+      FEM_DO_SAFE(i, 1, n) {
+        double sum = ft(i) - f(i);
+        FEM_DO_SAFE(j, 1, n) {
+          sum -= jac(i, j) * s(j);
+        }
+        FEM_DO_SAFE(j, 1, n) {
+          jac(i, j) += sum * s(j) / ss;
+        }
+      }
+    }
+
+    if (ratio >= 1.0e-4) {
+      FEM_DO_SAFE(i, 1, n) {
+        x(i) = xt(i);
+        f(i) = ft(i);
+      }
+      xn = enorm(cmn, n, x);
+      fn = ftn;
+      if (fn <= ftol) {
+        ier = 1;
+      }
+      if (qn <= xtol * xn) {
+        ier = ier == 1 ? 3 : 2;
+      }
+      if (ier != 0) {
+        break;
+      }
+    }
+
+    // progress
+    nconv++;
+    if (fn > eps && qn > eps * xn) {
+      nconv = 0;
+    }
+    if (fem::mod(ncsuc, 5) <= 1) {
+      temp1 = fn;
+    }
+    if (fem::mod(iter, ntry) == 1) {
+      temp2 = fn;
+    }
+    if ((fem::mod(ncsuc, 10) == 0 && ncsuc != 0 && fn >= 0.1 * temp1) || ncfail == 2) {
+      jeval = true;
+    }
+    if (nfev >= maxfev) {
+      ier = 4;
+    }
+    else if (fem::mod(iter, ntry) == 0 && temp2 - fn < 0.01 * temp2) {
+      ier = 5;
+    }
+    else if (nconv == 15) {
+      ier = 6;
+    }
+    else if (delta <= epsmch * xn) {
+      ier = 7;
+    }
+  }
+  maxfev = nfev;
+}
+
+namespace {
+
+/// scales D of the variables and E of the residuals of fcnScaled(), set by scaledHybrid()
+std::vector<double> variableScale;
+std::vector<double> residualScale;
+
+/// \brief The residuals E*F(x) of fcn() in the variables y = D*x.
+void
+fcnScaled(
+  common& cmn,
+  int const& n,
+  arr_ref<double> yy,
+  arr_ref<double> yfun,
+  int const& ier)
+{
+  yy(dimension(n));
+  yfun(dimension(n));
+  arr<double> xx(dimension(n), fem::fill0);
+  int i = fem::int0;
+  FEM_DO_SAFE(i, 1, n) {
+    xx(i) = yy(i) / variableScale[i-1];
+  }
+  fcn(cmn, n, xx, yfun, ier);
+  // fcn() may move x back into its physical range
+  FEM_DO_SAFE(i, 1, n) {
+    yy(i) = variableScale[i-1] * xx(i);
+    yfun(i) = residualScale[i-1] * yfun(i);
+  }
+}
+
+/// \brief Sets E to the inverse norms of the rows of the Jacobian jac of fcn(),
+/// and D to the norms of the columns of E*jac; a zero norm gives a scale of 1.
+void
+jacobianScales(
+  int const& n,
+  arr_cref<double, 2> jac)
+{
+  jac(dimension(n, n));
+  int i = fem::int0;
+  int j = fem::int0;
+  variableScale.assign(n, 1.0);
+  residualScale.assign(n, 1.0);
+  FEM_DO_SAFE(i, 1, n) {
+    double sum = 0.0;
+    FEM_DO_SAFE(j, 1, n) {
+      sum += jac(i, j) * jac(i, j);
+    }
+    if (sum > 0.0) {
+      residualScale[i-1] = 1.0 / fem::dsqrt(sum);
+    }
+  }
+  FEM_DO_SAFE(j, 1, n) {
+    double sum = 0.0;
+    FEM_DO_SAFE(i, 1, n) {
+      double e = residualScale[i-1] * jac(i, j);
+      sum += e * e;
+    }
+    if (sum > 0.0) {
+      variableScale[j-1] = fem::dsqrt(sum);
+    }
+  }
+}
+
+/// \brief Q*R from the factors in wa, where hybrd1() keeps them.
+void
+jacobianFromFactors(
+  int const& n,
+  arr_cref<double> wa,
+  arr_ref<double, 2> jac)
+{
+  jac(dimension(n, n));
+  int const nq = 3 * n;
+  int const nr = n * n + 3 * n;
+  int i = fem::int0;
+  int j = fem::int0;
+  int k = fem::int0;
+  FEM_DO_SAFE(i, 1, n) {
+    FEM_DO_SAFE(j, 1, n) {
+      double sum = 0.0;
+      int ij = j;
+      FEM_DO_SAFE(k, 1, j) {
+        sum += wa(nq + (k - 1) * n + i) * wa(nr + ij);
+        ij += n - k;
+      }
+      jac(i, j) = sum;
+    }
+  }
+}
+
+/// \brief Factors jac into Q and R and puts them into wa, where hybrd1() takes
+/// them from.
+void
+factorsToWork(
+  common& cmn,
+  int const& n,
+  arr_cref<double, 2> jac,
+  arr_ref<double> wa)
+{
+  jac(dimension(n, n));
+  int const lr = (n * (n + 1)) / 2;
+  arr<double, 2> q(dimension(n, n), fem::fill0);
+  arr<double> r(dimension(lr), fem::fill0);
+  arr<double> wa1(dimension(n), fem::fill0);
+  bool sing = false;
+  int i = fem::int0;
+  int j = fem::int0;
+  FEM_DO_SAFE(i, 1, n) {
+    FEM_DO_SAFE(j, 1, n) {
+      q(i, j) = jac(i, j);
+    }
+  }
+  qrdcom(cmn, n, q, lr, r, wa1, sing);
+  FEM_DO_SAFE(i, 1, n * n) {
+    wa(3 * n + i) = q(((i - 1) % n) + 1, ((i - 1) / n) + 1);
+  }
+  FEM_DO_SAFE(i, 1, lr) {
+    wa(n * n + 3 * n + i) = r(i);
+  }
+}
+
+}
+
+/// \brief Solves fcn() = 0 by hybrd1() in automatically scaled variables and
+/// residuals (see calInputs::autoScaling).
+///
+/// The variables x of fcn() are scaled by tmax, tmin, fmax and pmax, and each
+/// component normalizes its residuals its own way, so poorly chosen maxima give
+/// an ill-conditioned Jacobian J. Here hybrd1() solves E*F(x) = 0 in y = D*x
+/// instead, E being the inverse norms of the rows of J and D the norms of the
+/// columns of E*J, which makes the scaling independent of the maxima. The
+/// scales are set again from the Jacobian at the current point after every
+/// 20*(n+1) evaluations that didn't converge, and after hybrd1() stalled (ier
+/// 5 to 7) if the residuals went down; each round starts from the factors of
+/// that Jacobian, scaled. The scaled tolerance is ftol times the smallest
+/// residual scale, so that |F| <= ftol still holds at convergence.
+///
+/// With jacobianGiven the first Jacobian is Q*R from the factors in wa (warm
+/// start); on return wa holds the factors of the last Jacobian unscaled, as
+/// hybrd1() leaves them, maxfev is the number of evaluations and ier is that
+/// of hybrd1().
+void
+scaledHybrid(
+  common& cmn,
+  int const& n,
+  arr_ref<double> x,
+  arr_ref<double> f,
+  double const& ftol,
+  double const& xtol,
+  int& maxfev,
+  int& ier,
+  int const& lwa,
+  arr_ref<double> wa,
+  bool const& jacobianGiven)
+{
+  x(dimension(n));
+  f(dimension(n));
+  wa(dimension(lwa));
+  int const budget = maxfev;
+  int const slice = 20 * (n + 1);
+  int const iflag = 1;
+  arr<double, 2> jac(dimension(n, n), fem::fill0);
+  arr<double> xp(dimension(n), fem::fill0);
+  arr<double> y(dimension(n), fem::fill0);
+  arr<double> g(dimension(n), fem::fill0);
+  arr<double> wa1(dimension(n), fem::fill0);
+  arr<double> wa2(dimension(n), fem::fill0);
+  arr<double> wa3(dimension(n), fem::fill0);
+  int i = fem::int0;
+  int j = fem::int0;
+  int nfev = 0;
+  int used = 0;
+  int rounds = 0;
+  bool given = jacobianGiven;
+  ier = 0;
+  if (n <= 0 || lwa < (n * (3 * n + 7)) / 2 || maxfev <= 0) {
+    maxfev = 0;
+    return;
+  }
+
+  fcn(cmn, n, x, f, iflag);
+  nfev = 1;
+  double fn = enorm(cmn, n, f);
+  while (ier == 0) {
+    if (fn <= ftol) {
+      ier = 1;
+      break;
+    }
+    if (nfev >= budget) {
+      ier = 4;
+      break;
+    }
+    if (given) {
+      jacobianFromFactors(n, wa, jac);
+      given = false;
+    }
+    else {
+      FEM_DO_SAFE(i, 1, n) {
+        xp(i) = x(i);
+      }
+      fder(cmn, n, fcn, xp, f, n - 1, n - 1, jac, wa1, wa2, wa3, iflag);
+      nfev += n;
+    }
+    jacobianScales(n, jac);
+    double smallest = residualScale[0];
+    FEM_DO_SAFE(i, 1, n) {
+      smallest = fem::dmin1(smallest, residualScale[i-1]);
+      y(i) = variableScale[i-1] * x(i);
+      FEM_DO_SAFE(j, 1, n) {
+        jac(i, j) *= residualScale[i-1] / variableScale[j-1];
+      }
+    }
+    factorsToWork(cmn, n, jac, wa);
+    rounds++;
+
+    double fnRound = fn;
+    used = qMin(budget - nfev, slice);
+    hybrd1(cmn, n, fcnScaled, y, g, ftol * smallest, xtol, used, ier, lwa, wa, true);
+    nfev += used;
+    FEM_DO_SAFE(i, 1, n) {
+      x(i) = y(i) / variableScale[i-1];
+      f(i) = g(i) / residualScale[i-1];
+    }
+    fn = enorm(cmn, n, f);
+    if (ier >= 1 && ier <= 3) {
+      break;
+    }
+    if (nfev >= budget) {
+      ier = 4;
+    }
+    else if (ier == 4 || fn < fnRound) {
+      // the slice is used up, or hybrd1() stalled after some progress: scale again
+      ier = 0;
+    }
+  }
+  qDebug()<<"scaled hybrid solve in"<<rounds<<"rounds and"<<nfev<<"evaluations, ier"<<ier;
+
+  // the factors of the unscaled Jacobian, for the warm start
+  if (rounds > 0) {
+    jacobianFromFactors(n, wa, jac);
+    FEM_DO_SAFE(i, 1, n) {
+      FEM_DO_SAFE(j, 1, n) {
+        jac(i, j) *= variableScale[j-1] / residualScale[i-1];
+      }
+    }
+    factorsToWork(cmn, n, jac, wa);
+  }
+  maxfev = nfev;
+}
+
 struct program_sorpsimEngine_save
 {
   fem::variant_bindings afdata_bindings;
@@ -17519,7 +18448,115 @@ program_sorpsimEngine(
   //C****              ACTIVATING THE SOLVER ROUTINE                  *****
   //C*********************************************************************
   lwa = (n * (3 * n + 7)) / 2;
-  hybrd1(cmn, n, fcn, x, fun, ftol, xtol, maxfev, ier, lwa, wa);
+  bool jacobianGiven = false;
+  outputs.warmStarted = false;
+  outputs.state = solverState();
+  outputs.sensitivity = sensitivityReport();
+  QString structureHash = solverStructureHash(inputs);
+  {
+    // warm start: the same flowsheet converged before, start from its solution
+    const solverState& warm = inputs.warmStart;
+    bool sameVariables = warm.isValid() && warm.structureHash == structureHash
+        && warm.n() == n && nv == n && warm.ivt.count() == n
+        && warm.ivc.count() == n && warm.ivf.count() == n
+        && warm.ivp.count() == n && warm.ivw.count() == n;
+    FEM_DO_SAFE(i, 1, n) {
+      if (!sameVariables) {
+        break;
+      }
+      // only the entry of the variable's own type is meaningful
+      if (i <= nukt) {
+        sameVariables = warm.ivt[i-1] == ivt(i);
+      }
+      else if (i <= nukt + nconc) {
+        sameVariables = warm.ivc[i-1] == ivc(i);
+      }
+      else if (i <= nukt + nconc + nflow) {
+        sameVariables = warm.ivf[i-1] == ivf(i);
+      }
+      else if (i <= nukt + nconc + nflow + npress) {
+        sameVariables = warm.ivp[i-1] == ivp(i);
+      }
+      else {
+        sameVariables = warm.ivw[i-1] == ivw(i);
+      }
+    }
+    if (sameVariables) {
+      // rescale from the normalization of the old run to the current one
+      FEM_DO_SAFE(i, 1, n) {
+        double xOld = warm.x[i-1];
+        if (i <= nukt) {
+          x(i) = (xOld * warm.txn + warm.tmin - tmin) / txn;
+        }
+        else if (i <= nukt + nconc) {
+          x(i) = xOld;
+        }
+        else if (i <= nukt + nconc + nflow) {
+          x(i) = xOld * warm.fmax / fmax;
+        }
+        else if (i <= nukt + nconc + nflow + npress) {
+          x(i) = xOld * warm.pmax / pmax;
+        }
+        else {
+          x(i) = xOld;
+        }
+      }
+      // the factors only fit the same scaling of variables and residuals
+      if (warm.tmin == tmin && warm.txn == txn && warm.fmax == fmax
+          && warm.pmax == pmax && warm.q.count() == n * n
+          && warm.r.count() == (n * (n + 1)) / 2) {
+        FEM_DO_SAFE(i, 1, n * n) {
+          wa(3 * n + i) = warm.q[i-1];
+        }
+        FEM_DO_SAFE(i, 1, (n * (n + 1)) / 2) {
+          wa(n * n + 3 * n + i) = warm.r[i-1];
+        }
+        jacobianGiven = true;
+      }
+      outputs.warmStarted = true;
+      qDebug()<<"warm start from the saved solver state, reusing the Jacobian:"<<jacobianGiven;
+    }
+  }
+  if (inputs.solverMethod == calInputs::Homotopy) {
+    homotopy(cmn, n, x, fun, ftol, xtol, maxfev, ier, lwa, wa);
+  }
+  else if (inputs.solverMethod == calInputs::BoundedTrustRegion) {
+    boundedTrustRegion(cmn, n, x, fun, ftol, xtol, maxfev, ier, lwa, wa, jacobianGiven);
+  }
+  else if (inputs.autoScaling) {
+    scaledHybrid(cmn, n, x, fun, ftol, xtol, maxfev, ier, lwa, wa, jacobianGiven);
+  }
+  else {
+    hybrd1(cmn, n, fcn, x, fun, ftol, xtol, maxfev, ier, lwa, wa, jacobianGiven);
+  }
+  if (ier >= 1 && ier <= 3 && nv == n) {
+    solverState& state = outputs.state;
+    state.structureHash = structureHash;
+    state.tmin = tmin;
+    state.txn = txn;
+    state.fmax = fmax;
+    state.pmax = pmax;
+    FEM_DO_SAFE(i, 1, n) {
+      state.x.append(x(i));
+      int nt = nukt, nc = nt + nconc, nf = nc + nflow, np = nf + npress;
+      state.ivt.append(i <= nt ? ivt(i) : 0);
+      state.ivc.append(i > nt && i <= nc ? ivc(i) : 0);
+      state.ivf.append(i > nc && i <= nf ? ivf(i) : 0);
+      state.ivp.append(i > nf && i <= np ? ivp(i) : 0);
+      state.ivw.append(i > np ? ivw(i) : 0);
+    }
+    FEM_DO_SAFE(i, 1, n * n) {
+      state.q.append(wa(3 * n + i));
+    }
+    FEM_DO_SAFE(i, 1, (n * (n + 1)) / 2) {
+      state.r.append(wa(n * n + 3 * n + i));
+    }
+  }
+  if (inputs.sensitivity && ier >= 1 && ier <= 3 && nv == n) {
+    sensitivity(cmn, n, x, icop, outputs.sensitivity);
+    // back to the solution for the results below
+    fcn(cmn, n, x, fun, ier);
+  }
 
 
   //C*********************************************************************
@@ -17827,13 +18864,53 @@ int absdCal(int argc,char const* argv[], const calInputs &myCalInput, bool print
     outputs.stopped = false;
     outputs.myMsg = "empty";
     outputs.currentSp = 0;
+    outputs.state = solverState();
+    outputs.sensitivity = sensitivityReport();
+    outputs.warmStarted = false;
+    outputs.fromCache = false;
     for(int i = 0;i<50;i++)
         outputs.distributionW[i][0]=0;
     printOut = print;
     inputs = myCalInput;
     first = true;
+
+    // printed runs are wanted for their output files, they are always solved
+    solverCache *cache = solverCache::shared();
+    if(!print && cache->lookup(myCalInput, outputs))
+        return 0;
+    if(!print && !inputs.warmStart.isValid())
+        inputs.warmStart = cache->nearest(myCalInput);
+
+    // the tables are built once per process, or read from the temporary folder
+    if97Water = myCalInput.if97Water;
+    fastProperties = myCalInput.fastProperties
+            && sorpprops::propSurrogates::shared().prepare(
+                Sorputils::sorpTempDir().absoluteFilePath("propertyTables.dat").toLocal8Bit().constData());
+
     int code = fem::main_with_catch(argc, argv, program_sorpsimEngine);
 
+    // a warm start that goes astray must not do worse than the guess values
+    if(outputs.warmStarted && (outputs.stopped || outputs.IER < 1 || outputs.IER > 3))
+    {
+        qDebug()<<"warm start failed, solving again from the guess values";
+        inputs.warmStart = solverState();
+        outputs.ivart.clear();
+        outputs.ivarf.clear();
+        outputs.ivarc.clear();
+        outputs.ivarp.clear();
+        outputs.ivarw.clear();
+        outputs.stopped = false;
+        outputs.myMsg = "empty";
+        outputs.currentSp = 0;
+        first = true;
+        code = fem::main_with_catch(argc, argv, program_sorpsimEngine);
+    }
+
+    // property calls from the dialogs and plots always use the reference routines
+    fastProperties = false;
+    if97Water = false;
+    if(!print)
+        cache->store(myCalInput, outputs);
     return code;
 }
 
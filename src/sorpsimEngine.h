@@ -412,16 +412,10 @@ struct common :
   common_con
 {
   fem::variant_core common_afdata;
-  fem::cmn_sve tfpx1_sve;
-  fem::cmn_sve hftx1_sve;
-  fem::cmn_sve tfpx2_sve;
-  fem::cmn_sve xftp2_sve;
-  fem::cmn_sve yvtp2_sve;
   fem::cmn_sve dftpx2_sve;
   fem::cmn_sve hftpx2_sve;
   fem::cmn_sve hvtpy2_sve;
   fem::cmn_sve svtpy2_sve;
-  fem::cmn_sve hftx10_sve;
   fem::cmn_sve satprp_sve;
   fem::cmn_sve vapor_sve;
   fem::cmn_sve qheat_sve;
@@ -450,8 +444,6 @@ struct common :
   fem::cmn_sve enorm_sve;
   fem::cmn_sve hybrdm_sve;
   fem::cmn_sve program_sorpsimEngine_sve;
-  fem::cmn_sve pftx1_sve;
-  fem::cmn_sve hwftx1_sve;
   fem::cmn_sve pftx2_sve;
   fem::cmn_sve sftpx2_sve;
   fem::cmn_sve dvtpy2_sve;
@@ -471,6 +463,53 @@ struct common :
 
 void pft3(sorpsim4l::common& cmn,double& p,double const& t);
 
+void tfp3(sorpsim4l::common& cmn,double& t,double const& p);
+
+void hft3(sorpsim4l::common& cmn,double& h,double const& t);
+
+void
+tfpx1(
+  sorpsim4l::common& cmn,
+  double& t,
+  double const& p,
+  double const& w0l);
+
+void
+hftx1(
+  sorpsim4l::common& cmn,
+  double& hs,
+  double const& t,
+  double const& cl);
+
+void
+tfpx2(
+  sorpsim4l::common& cmn,
+  double& t,
+  double const& p,
+  double const& wnl);
+
+void
+xftp2(
+  sorpsim4l::common& cmn,
+  double& wnl,
+  double const& t,
+  double const& p);
+
+void
+tfpx9(
+  sorpsim4l::common& cmn,
+  double& t,
+  double const& p,
+  double const& x);
+
+void
+hftx10(
+  sorpsim4l::common& cmn,
+  double& hf,
+  double const& ti,
+  double const& xi,
+  double const& pi);
+
 void
 pftx9(
   sorpsim4l::common& cmn,
@@ -523,6 +562,102 @@ double calcSolEnthalpy(sorpsim4l::common& cmn,
 double calcEnthalpy(sorpsim4l::common& cmn, int ksub, double t,
                     double p, double c, double w);
 
+/// equilibrium of substance kk (see globalparameter::fluidInventory); for
+/// kk > 11 other than 14 it selects the refrigerant with that number by tables()
+/// and then evaluates eqb14, the components call eqb12() for refrigerants
+void
+eqb(
+  sorpsim4l::common& cmn,
+  double const& pp,
+  double& cc,
+  double& tt,
+  double& hh,
+  int const& klv,
+  int const& kent,
+  int const& kk);
+
+/// silica gel/water, not reachable through eqb()
+void
+eqb13(
+  sorpsim4l::common& cmn,
+  double & pi,
+  double const& xi,
+  double& tio1,
+  double& hout,
+  int const& k,
+  int const& kent);
+
+/// \name Refrigerant properties of the refrigerant selected by tables()
+/// \{
+void tables(sorpsim4l::common& cmn, int const& nrr);
+
+/// saturated liquid (klv 1) or vapor (klv 2, at temperature xx if above
+/// saturation) of the refrigerant
+void
+eqb12(
+  sorpsim4l::common& cmn,
+  double const& p,
+  double const& xx,
+  double& t,
+  double& hh,
+  int const& klv,
+  int const& kent);
+
+double tsat(sorpsim4l::common& cmn, double const& psat, int& iflag);
+
+double spvol(sorpsim4l::common& cmn, double const& tf, double const& ppsia);
+
+void
+satprp(
+  sorpsim4l::common& cmn,
+  double const& tf,
+  double& psat,
+  double& vf,
+  double& vg,
+  double& hf,
+  double& hfg,
+  double& hg,
+  double& sf,
+  double& sg,
+  int& iflag);
+
+void
+vapor(
+  sorpsim4l::common& cmn,
+  double const& tf,
+  double const& ppsia,
+  double& vvap,
+  double& hvap,
+  double& svap,
+  int& ierror);
+/// \}
+
+/// Iterations of one of the engine's inner solves, see solveCounting
+struct solveCount
+{
+    long long calls;        ///< calls that reached the solve
+    long long iterations;   ///< iterations summed over the calls
+    int maxIterations;
+    double worstInputs[2];  ///< inputs of the first call that took maxIterations
+
+    solveCount();
+    void add(int n, double a, double b);
+};
+
+/// Iteration counters of the inner solves of the property routines
+struct solveCounts
+{
+    solveCount tfp3;    ///< water saturation temperature from p, regula falsi
+    solveCount xftp2;   ///< NH3 concentration from t, p, bisection
+    solveCount tsat;    ///< refrigerant saturation temperature from p, Newton;
+                        ///< 0 iterations where the previous result is reused
+    solveCount spvol;   ///< refrigerant vapor volume from t, p, Newton
+};
+
+/// The routines count their iterations in this while it is set, e.g. by
+/// correlationBench; 0 (not counted) otherwise.
+extern solveCounts *solveCounting;
+
 /// \brief The entry point for starting a simulation calculation
 ///
 /// Loads myCal into inputs, then calls program_sorpsimEngine.
@@ -0,0 +1,564 @@
+/*! \file surrogate.cpp
+    \brief Response surfaces fitted to the runs of a parametric table
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <cmath>
+
+#include <QtAlgorithms>
+
+#include "surrogate.h"
+
+namespace {
+
+double dot(const QVector<double> &a, const QVector<double> &b)
+{
+    double sum = 0;
+    for(int i = 0; i < a.count(); i++)
+        sum += a.at(i)*b.at(i);
+    return sum;
+}
+
+QString joinValues(const QVector<double> &values)
+{
+    QStringList list;
+    for(int i = 0; i < values.count(); i++)
+        list<<QString::number(values.at(i),'g',17);
+    return list.join(",");
+}
+
+bool splitValues(const QString &text, QVector<double> &values)
+{
+    values.clear();
+    if(text.trimmed().isEmpty())
+        return true;
+    QStringList list = text.split(",");
+    for(int i = 0; i < list.count(); i++)
+    {
+        bool ok = false;
+        values<<list.at(i).toDouble(&ok);
+        if(!ok)
+            return false;
+    }
+    return true;
+}
+
+/// Least squares solution of rows * c = rhs[k] for each right hand side k, by Householder QR.
+/// \return false if the columns of rows are (nearly) dependent
+bool leastSquares(const QVector<QVector<double> > &rows, const QVector<QVector<double> > &rhs,
+                  QVector<QVector<double> > &solution)
+{
+    int n = rows.count(), m = rows.first().count();
+    // columns of the matrix, and the right hand sides, are reduced in place
+    QVector<QVector<double> > a(m, QVector<double>(n, 0));
+    double largest = 0;
+    for(int j = 0; j < m; j++)
+    {
+        for(int i = 0; i < n; i++)
+            a[j][i] = rows.at(i).at(j);
+        largest = qMax(largest, std::sqrt(dot(a.at(j), a.at(j))));
+    }
+    QVector<QVector<double> > b = rhs;
+    QVector<double> diagonal(m, 0);
+    QVector<double> v(n, 0);
+    for(int k = 0; k < m; k++)
+    {
+        double norm = 0;
+        for(int i = k; i < n; i++)
+            norm += a.at(k).at(i)*a.at(k).at(i);
+        norm = std::sqrt(norm);
+        if(norm <= 1e-10*largest)
+            return false;
+        double alpha = a.at(k).at(k) > 0 ? -norm : norm;
+        for(int i = 0; i < n; i++)
+            v[i] = i < k ? 0 : a.at(k).at(i);
+        v[k] -= alpha;
+        double vv = 0;
+        for(int i = k; i < n; i++)
+            vv += v.at(i)*v.at(i);
+        diagonal[k] = alpha;
+        for(int j = k+1; j < m; j++)
+        {
+            double s = 0;
+            for(int i = k; i < n; i++)
+                s += v.at(i)*a.at(j).at(i);
+            s = 2*s/vv;
+            for(int i = k; i < n; i++)
+                a[j][i] -= s*v.at(i);
+        }
+        for(int r = 0; r < b.count(); r++)
+        {
+            double s = 0;
+            for(int i = k; i < n; i++)
+                s += v.at(i)*b.at(r).at(i);
+            s = 2*s/vv;
+            for(int i = k; i < n; i++)
+                b[r][i] -= s*v.at(i);
+        }
+    }
+    solution = QVector<QVector<double> >(b.count(), QVector<double>(m, 0));
+    for(int r = 0; r < b.count(); r++)
+        for(int k = m-1; k >= 0; k--)
+        {
+            double s = b.at(r).at(k);
+            for(int j = k+1; j < m; j++)
+                s -= a.at(j).at(k)*solution.at(r).at(j);
+            solution[r][k] = s/diagonal.at(k);
+        }
+    return true;
+}
+
+/// Solution of matrix * x = rhs[k] for each right hand side k, by LU decomposition with partial pivoting.
+/// \return false if the matrix is (nearly) singular
+bool solveLinear(QVector<QVector<double> > matrix, const QVector<QVector<double> > &rhs,
+                 QVector<QVector<double> > &solution)
+{
+    int n = matrix.count();
+    double largest = 0;
+    for(int i = 0; i < n; i++)
+        for(int j = 0; j < n; j++)
+            largest = qMax(largest, qAbs(matrix.at(i).at(j)));
+    solution = rhs;
+    for(int k = 0; k < n; k++)
+    {
+        int pivot = k;
+        for(int i = k+1; i < n; i++)
+            if(qAbs(matrix.at(i).at(k)) > qAbs(matrix.at(pivot).at(k)))
+                pivot = i;
+        if(qAbs(matrix.at(pivot).at(k)) <= 1e-12*largest)
+            return false;
+        if(pivot != k)
+        {
+            matrix[k].swap(matrix[pivot]);
+            for(int r = 0; r < solution.count(); r++)
+                qSwap(solution[r][k], solution[r][pivot]);
+        }
+        const QVector<double> row = matrix.at(k);
+        for(int i = k+1; i < n; i++)
+        {
+            double factor = matrix.at(i).at(k)/row.at(k);
+            if(factor == 0)
+                continue;
+            QVector<double> &target = matrix[i];
+            for(int j = k; j < n; j++)
+                target[j] -= factor*row.at(j);
+            for(int r = 0; r < solution.count(); r++)
+                solution[r][i] -= factor*solution.at(r).at(k);
+        }
+    }
+    for(int r = 0; r < solution.count(); r++)
+        for(int k = n-1; k >= 0; k--)
+        {
+            double s = solution.at(r).at(k);
+            for(int j = k+1; j < n; j++)
+                s -= matrix.at(k).at(j)*solution.at(r).at(j);
+            solution[r][k] = s/matrix.at(k).at(k);
+        }
+    return true;
+}
+
+/// every list of exponents of count variables whose sum is at most degree, by increasing sum
+void addTerms(QVector<QVector<int> > &terms, QVector<int> &term, int variable, int left)
+{
+    if(variable == term.count())
+    {
+        terms<<term;
+        return;
+    }
+    for(int e = 0; e <= left; e++)
+    {
+        term[variable] = e;
+        addTerms(terms, term, variable+1, left-e);
+    }
+    term[variable] = 0;
+}
+
+}
+
+responseSurface::responseSurface() :
+    surfaceMethod(Polynomial),
+    polynomialDegree(2),
+    nRuns(0)
+{
+}
+
+void responseSurface::setMethod(int method, int degree)
+{
+    surfaceMethod = method;
+    polynomialDegree = qBound(1, degree, 3);
+    coefficients.clear();
+}
+
+void responseSurface::setEntries(const QStringList &inputs, const QStringList &outputs)
+{
+    this->inputs = inputs;
+    this->outputs = outputs;
+    coefficients.clear();
+}
+
+bool responseSurface::isValid() const
+{
+    return !coefficients.isEmpty() && coefficients.count() == outputs.count();
+}
+
+int responseSurface::method() const
+{
+    return surfaceMethod;
+}
+
+int responseSurface::degree() const
+{
+    return polynomialDegree;
+}
+
+QString responseSurface::description() const
+{
+    if(surfaceMethod == RadialBasis)
+        return "cubic radial basis functions";
+    const char *names[] = {"linear", "quadratic", "cubic"};
+    return QString(names[polynomialDegree-1])+" polynomial";
+}
+
+QStringList responseSurface::inputEntries() const
+{
+    return inputs;
+}
+
+QStringList responseSurface::outputEntries() const
+{
+    return outputs;
+}
+
+int responseSurface::runs() const
+{
+    return nRuns;
+}
+
+double responseSurface::lower(int input) const
+{
+    return low.at(input);
+}
+
+double responseSurface::upper(int input) const
+{
+    return high.at(input);
+}
+
+double responseSurface::rmse(int o) const
+{
+    return cvRmse.at(o);
+}
+
+double responseSurface::maxError(int o) const
+{
+    return cvMaxError.at(o);
+}
+
+double responseSurface::r2(int o) const
+{
+    return cvR2.at(o);
+}
+
+void responseSurface::setRange(const QVector<QVector<double> > &points)
+{
+    low = points.first();
+    high = points.first();
+    for(int r = 1; r < points.count(); r++)
+        for(int i = 0; i < low.count(); i++)
+        {
+            low[i] = qMin(low.at(i), points.at(r).at(i));
+            high[i] = qMax(high.at(i), points.at(r).at(i));
+        }
+}
+
+void responseSurface::setupTerms()
+{
+    active.clear();
+    for(int i = 0; i < low.count(); i++)
+        if(high.at(i)-low.at(i) > 1e-12*qMax(1.0, qAbs(high.at(i))))
+            active<<i;
+    // the radial basis functions come with a linear polynomial
+    terms.clear();
+    QVector<int> term(active.count(), 0);
+    addTerms(terms, term, 0, surfaceMethod == RadialBasis ? 1 : polynomialDegree);
+}
+
+QVector<double> responseSurface::scaled(const QVector<double> &x) const
+{
+    QVector<double> u(active.count(), 0);
+    for(int k = 0; k < active.count(); k++)
+    {
+        int i = active.at(k);
+        u[k] = 2*(x.at(i)-low.at(i))/(high.at(i)-low.at(i))-1;
+    }
+    return u;
+}
+
+QVector<double> responseSurface::basis(const QVector<double> &u) const
+{
+    QVector<double> values;
+    values.reserve(centers.count()+terms.count());
+    for(int c = 0; c < centers.count(); c++)
+    {
+        double r2 = 0;
+        for(int k = 0; k < u.count(); k++)
+            r2 += (u.at(k)-centers.at(c).at(k))*(u.at(k)-centers.at(c).at(k));
+        values<<r2*std::sqrt(r2);
+    }
+    for(int t = 0; t < terms.count(); t++)
+    {
+        double value = 1;
+        for(int k = 0; k < u.count(); k++)
+            for(int e = 0; e < terms.at(t).at(k); e++)
+                value *= u.at(k);
+        values<<value;
+    }
+    return values;
+}
+
+bool responseSurface::fit(const QVector<QVector<double> > &points, const QVector<QVector<double> > &values,
+                          QString *error)
+{
+    int n = points.count();
+    setRange(points);
+    setupTerms();
+    centers.clear();
+    coefficients.clear();
+    QVector<QVector<double> > rhs(outputs.count(), QVector<double>(n, 0));
+    for(int r = 0; r < n; r++)
+        for(int o = 0; o < outputs.count(); o++)
+            rhs[o][r] = values.at(r).at(o);
+
+    if(surfaceMethod == Polynomial)
+    {
+        if(n < terms.count())
+        {
+            *error = "A "+description()+" in "+QString::number(active.count())+" varying inputs has "
+                    +QString::number(terms.count())+" terms and needs at least as many runs, there are "
+                    +QString::number(n)+".";
+            return false;
+        }
+        QVector<QVector<double> > rows;
+        rows.reserve(n);
+        for(int r = 0; r < n; r++)
+            rows<<basis(scaled(points.at(r)));
+        if(!leastSquares(rows, rhs, coefficients))
+        {
+            coefficients.clear();
+            *error = "The runs don't determine every term of the "+description()
+                    +", use a lower degree or runs that vary the inputs more independently.";
+            return false;
+        }
+        return true;
+    }
+
+    if(n > maxRadialRuns)
+    {
+        *error = "Radial basis functions are limited to "+QString::number(maxRadialRuns)
+                +" runs, use a polynomial for "+QString::number(n)+" runs.";
+        return false;
+    }
+    if(n < terms.count())
+    {
+        *error = "Radial basis functions in "+QString::number(active.count())+" varying inputs need at least "
+                +QString::number(terms.count())+" runs, there are "+QString::number(n)+".";
+        return false;
+    }
+    for(int r = 0; r < n; r++)
+        centers<<scaled(points.at(r));
+    // interpolation conditions at the runs, and the radial weights orthogonal to the polynomial
+    int size = n+terms.count();
+    QVector<QVector<double> > matrix(size, QVector<double>(size, 0));
+    for(int r = 0; r < n; r++)
+    {
+        QVector<double> row = basis(centers.at(r));
+        for(int j = 0; j < size; j++)
+        {
+            matrix[r][j] = row.at(j);
+            if(j >= n)
+                matrix[j][r] = row.at(j);
+        }
+    }
+    for(int o = 0; o < rhs.count(); o++)
+        rhs[o].resize(size);
+    if(!solveLinear(matrix, rhs, coefficients))
+    {
+        coefficients.clear();
+        centers.clear();
+        *error = "Some runs have the same inputs, or the runs don't span the inputs; "
+                 "radial basis functions need distinct runs.";
+        return false;
+    }
+    return true;
+}
+
+bool responseSurface::build(const QVector<QVector<double> > &points, const QVector<QVector<double> > &values,
+                            QString *error)
+{
+    int n = points.count();
+    coefficients.clear();
+    if(inputs.isEmpty() || outputs.isEmpty())
+    {
+        *error = "No inputs or outputs to fit.";
+        return false;
+    }
+    if(n < 3)
+    {
+        *error = "At least three calculated runs are needed to fit and cross-validate a surface.";
+        return false;
+    }
+
+    // k-fold cross-validation, run r in fold r % k
+    int folds = qMin(10, n);
+    QVector<double> sse(outputs.count(), 0), largest(outputs.count(), 0);
+    for(int f = 0; f < folds; f++)
+    {
+        QVector<QVector<double> > trainPoints, trainValues;
+        for(int r = 0; r < n; r++)
+            if(r % folds != f)
+            {
+                trainPoints<<points.at(r);
+                trainValues<<values.at(r);
+            }
+        responseSurface part(*this);
+        QString partError;
+        if(!part.fit(trainPoints, trainValues, &partError))
+        {
+            *error = "Not enough runs to cross-validate: "+partError;
+            return false;
+        }
+        for(int r = f; r < n; r += folds)
+        {
+            QVector<double> predicted = part.predict(points.at(r));
+            for(int o = 0; o < outputs.count(); o++)
+            {
+                double e = predicted.at(o)-values.at(r).at(o);
+                sse[o] += e*e;
+                largest[o] = qMax(largest.at(o), qAbs(e));
+            }
+        }
+    }
+    cvRmse.clear();
+    cvMaxError = largest;
+    cvR2.clear();
+    for(int o = 0; o < outputs.count(); o++)
+    {
+        double mean = 0, sst = 0;
+        for(int r = 0; r < n; r++)
+            mean += values.at(r).at(o)/n;
+        for(int r = 0; r < n; r++)
+            sst += (values.at(r).at(o)-mean)*(values.at(r).at(o)-mean);
+        cvRmse<<std::sqrt(sse.at(o)/n);
+        cvR2<<(sst > 0 ? 1-sse.at(o)/sst : 1);
+    }
+
+    if(!fit(points, values, error))
+        return false;
+    nRuns = n;
+    return true;
+}
+
+bool responseSurface::inRange(const QVector<double> &x) const
+{
+    for(int i = 0; i < low.count(); i++)
+    {
+        double tolerance = 1e-9*qMax(qAbs(low.at(i)), qAbs(high.at(i)));
+        if(x.at(i) < low.at(i)-tolerance || x.at(i) > high.at(i)+tolerance)
+            return false;
+    }
+    return true;
+}
+
+QVector<double> responseSurface::predict(const QVector<double> &x, bool *inRange) const
+{
+    if(inRange)
+        *inRange = this->inRange(x);
+    QVector<double> b = basis(scaled(x));
+    QVector<double> y(coefficients.count(), 0);
+    for(int o = 0; o < coefficients.count(); o++)
+        y[o] = dot(coefficients.at(o), b);
+    return y;
+}
+
+QDomElement responseSurface::toXml(QDomDocument &doc) const
+{
+    QDomElement element = doc.createElement("surrogate");
+    element.setAttribute("method", surfaceMethod == RadialBasis ? "radialBasis" : "polynomial");
+    element.setAttribute("degree", polynomialDegree);
+    element.setAttribute("runs", nRuns);
+    element.setAttribute("inputEntries", inputs.join(";"));
+    element.setAttribute("outputEntries", outputs.join(";"));
+    for(int i = 0; i < low.count(); i++)
+    {
+        QDomElement factor = doc.createElement("factor");
+        factor.setAttribute("lower", QString::number(low.at(i),'g',17));
+        factor.setAttribute("upper", QString::number(high.at(i),'g',17));
+        element.appendChild(factor);
+    }
+    for(int c = 0; c < centers.count(); c++)
+    {
+        QDomElement center = doc.createElement("center");
+        center.appendChild(doc.createTextNode(joinValues(centers.at(c))));
+        element.appendChild(center);
+    }
+    for(int o = 0; o < coefficients.count(); o++)
+    {
+        QDomElement response = doc.createElement("response");
+        response.setAttribute("rmse", QString::number(cvRmse.at(o),'g',6));
+        response.setAttribute("maxError", QString::number(cvMaxError.at(o),'g',6));
+        response.setAttribute("r2", QString::number(cvR2.at(o),'g',6));
+        response.appendChild(doc.createTextNode(joinValues(coefficients.at(o))));
+        element.appendChild(response);
+    }
+    return element;
+}
+
+responseSurface responseSurface::fromXml(const QDomElement &element)
+{
+    responseSurface surface;
+    if(element.isNull() || element.tagName() != "surrogate")
+        return responseSurface();
+    surface.setMethod(element.attribute("method") == "radialBasis" ? RadialBasis : Polynomial,
+                      element.attribute("degree", "2").toInt());
+    surface.setEntries(element.attribute("inputEntries").split(";"), element.attribute("outputEntries").split(";"));
+    surface.nRuns = element.attribute("runs").toInt();
+
+    QDomNodeList factors = element.elementsByTagName("factor");
+    if(factors.count() != surface.inputs.count())
+        return responseSurface();
+    for(int i = 0; i < factors.count(); i++)
+    {
+        surface.low<<factors.at(i).toElement().attribute("lower").toDouble();
+        surface.high<<factors.at(i).toElement().attribute("upper").toDouble();
+    }
+    surface.setupTerms();
+
+    QDomNodeList centers = element.elementsByTagName("center");
+    for(int c = 0; c < centers.count(); c++)
+    {
+        QVector<double> center;
+        if(!splitValues(centers.at(c).toElement().text(), center) || center.count() != surface.active.count())
+            return responseSurface();
+        surface.centers<<center;
+    }
+    if(surface.surfaceMethod == RadialBasis && surface.centers.isEmpty())
+        return responseSurface();
+
+    QDomNodeList responses = element.elementsByTagName("response");
+    if(responses.count() != surface.outputs.count())
+        return responseSurface();
+    int size = surface.centers.count()+surface.terms.count();
+    for(int o = 0; o < responses.count(); o++)
+    {
+        QDomElement response = responses.at(o).toElement();
+        QVector<double> coefficient;
+        if(!splitValues(response.text(), coefficient) || coefficient.count() != size)
+            return responseSurface();
+        surface.coefficients<<coefficient;
+        surface.cvRmse<<response.attribute("rmse").toDouble();
+        surface.cvMaxError<<response.attribute("maxError").toDouble();
+        surface.cvR2<<response.attribute("r2").toDouble();
+    }
+    return surface;
+}
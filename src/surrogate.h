@@ -0,0 +1,112 @@
+/*! \file surrogate.h
+    \brief Response surfaces fitted to the runs of a parametric table
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*!
+A surrogate of the case over the inputs of a parametric table: a response
+surface for each of some outputs of the table, fitted to its calculated runs,
+that gives the outputs at any input values at once, without solving.
+
+Two kinds of surface:
+- Polynomial: all the terms up to the degree (1 to 3) in the inputs, fitted by
+  least squares (Householder QR)
+- RadialBasis: cubic radial basis functions centered on the runs, plus a
+  linear polynomial, interpolating the runs exactly
+
+The inputs are scaled by their range over the runs; inputs that are the same
+in every run are left out. The quality of each surface is estimated by k-fold
+cross-validation: the runs are split into (up to) ten folds, each predicted by
+a surface fitted to the other folds, which gives the root mean square and the
+largest error of the predictions and the fraction of the variance of the
+output they explain (R2).
+
+A query is within range if every input is within its range over the runs;
+outside it the surface extrapolates, and the callers flag the result.
+
+Values are in the units of the table. The surrogate is kept in the case file
+as a "surrogate" element of its table (see toXml() and fromXml()). Used by
+surrogateDialog, tableDialog and newParaPlotDialog.
+*/
+class responseSurface
+{
+public:
+    enum Method { Polynomial, RadialBasis };
+
+    /// the largest number of runs of a radial basis surface, which solves a dense system of that size
+    static const int maxRadialRuns = 1000;
+
+    responseSurface();
+
+    void setMethod(int method, int degree = 2);
+    /// The entries of the table (inputEntries, outputEntries) of the inputs and the fitted outputs.
+    void setEntries(const QStringList &inputs, const QStringList &outputs);
+
+    /// Cross-validates and fits the surfaces to the runs, points[run][input] and values[run][output].
+    /// \return false, and why in error, if the runs don't determine the surfaces
+    bool build(const QVector<QVector<double> > &points, const QVector<QVector<double> > &values, QString *error);
+
+    bool isValid() const;
+    int method() const;
+    int degree() const;
+    /// e.g. "quadratic polynomial"
+    QString description() const;
+    QStringList inputEntries() const;
+    QStringList outputEntries() const;
+    int runs() const;
+    double lower(int input) const;
+    double upper(int input) const;
+    /// cross-validation of output o
+    double rmse(int o) const;
+    double maxError(int o) const;
+    double r2(int o) const;
+
+    /// The outputs at the inputs x; inRange, if given, is false when x is outside the range of the runs.
+    QVector<double> predict(const QVector<double> &x, bool *inRange = 0) const;
+    bool inRange(const QVector<double> &x) const;
+
+    QDomElement toXml(QDomDocument &doc) const;
+    /// \return an invalid surface if the element isn't a complete surrogate
+    static responseSurface fromXml(const QDomElement &element);
+
+private:
+    /// fits the coefficients to the runs, without cross-validation
+    bool fit(const QVector<QVector<double> > &points, const QVector<QVector<double> > &values, QString *error);
+    /// inputs scaled to [-1,1] by their range, constant inputs left out
+    QVector<double> scaled(const QVector<double> &x) const;
+    /// the polynomial terms, or the radial basis functions and the linear terms, at the scaled inputs u
+    QVector<double> basis(const QVector<double> &u) const;
+    void setRange(const QVector<QVector<double> > &points);
+    void setupTerms();
+
+    int surfaceMethod;
+    int polynomialDegree;
+    QStringList inputs;
+    QStringList outputs;
+    int nRuns;
+    QVector<double> low;
+    QVector<double> high;
+    /// inputs that vary over the runs
+    QVector<int> active;
+    /// exponents of the active inputs in each polynomial term
+    QVector<QVector<int> > terms;
+    /// scaled inputs of the runs, the centers of the radial basis functions
+    QVector<QVector<double> > centers;
+    /// coefficients[output][basis function]
+    QVector<QVector<double> > coefficients;
+    QVector<double> cvRmse;
+    QVector<double> cvMaxError;
+    QVector<double> cvR2;
+};
+
+#endif // SURROGATE_H
@@ -0,0 +1,260 @@
+/*! \file surrogatedialog.cpp
+    \brief Dialog to fit a response surface surrogate to the runs of a parametric table
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QTableWidget>
+
+#include "surrogatedialog.h"
+#include "ui_surrogatedialog.h"
+#include "dataComm.h"
+
+extern globalparameter globalpara;
+
+namespace {
+
+enum OutputColumns { UseColumn, NameColumn, RmseColumn, MaxErrorColumn, R2Column };
+enum QueryColumns { InputColumn, ValueColumn, LowerColumn, UpperColumn };
+
+QTableWidgetItem *fixedItem(const QString &text)
+{
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+
+QTableWidgetItem *useItem(bool checked)
+{
+    QTableWidgetItem *item = new QTableWidgetItem;
+    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+    item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    return item;
+}
+
+}
+
+surrogateDialog::surrogateDialog(const QStringList &inputNames, const QStringList &inputEntries,
+                                 const QStringList &outputNames, const QStringList &outputEntries,
+                                 const QVector<QVector<double> > &points, const QVector<QVector<double> > &values,
+                                 const responseSurface &existing, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::surrogateDialog),
+    inputNames(inputNames),
+    inputEntries(inputEntries),
+    outputNames(outputNames),
+    outputEntries(outputEntries),
+    points(points),
+    values(values)
+{
+    ui->setupUi(this);
+    setWindowTitle("Table Surrogate");
+    setWindowModality(Qt::ApplicationModal);
+
+    ui->runsLabel->setText(QString::number(points.count())+" runs calculated with their current inputs");
+    // a surrogate fitted before the inputs of the table were edited no longer applies
+    if(existing.isValid() && existing.inputEntries() == inputEntries)
+    {
+        current = existing;
+        ui->methodBox->setCurrentIndex(existing.method() == responseSurface::RadialBasis ? 3 : existing.degree()-1);
+        ui->logText->appendPlainText("The table has a surrogate, "+existing.description()+" fitted to "
+                                     +QString::number(existing.runs())+" runs.");
+    }
+    else if(existing.isValid())
+        ui->logText->appendPlainText("The inputs of the table changed since its surrogate was fitted, "
+                                     "it has to be fitted again.");
+    else
+        ui->logText->appendPlainText("Choose the outputs and the kind of surface, and fit them to the runs.");
+    ui->removeButton->setEnabled(existing.isValid());
+    setupTables();
+    showSurface();
+}
+
+surrogateDialog::~surrogateDialog()
+{
+    delete ui;
+}
+
+responseSurface surrogateDialog::surface() const
+{
+    return current;
+}
+
+void surrogateDialog::setupTables()
+{
+    QStringList headers;
+    headers<<"Use"<<"Output"<<"CV RMS Error"<<"CV Max Error"<<"CV R2";
+    QTableWidget *table = ui->outputTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->horizontalHeaderItem(R2Column)->setToolTip("Fraction of the variance of the output that the "
+                                                      "cross-validated predictions explain");
+    table->setRowCount(outputNames.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    QStringList fitted = current.outputEntries();
+    for(int o = 0; o < outputNames.count(); o++)
+    {
+        table->setItem(o,UseColumn,useItem(!current.isValid() || fitted.contains(outputEntries.at(o))));
+        table->setItem(o,NameColumn,fixedItem(outputNames.at(o)));
+        table->setItem(o,RmseColumn,fixedItem(""));
+        table->setItem(o,MaxErrorColumn,fixedItem(""));
+        table->setItem(o,R2Column,fixedItem(""));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    headers.clear();
+    headers<<"Input"<<"Value"<<"Lowest Run"<<"Highest Run";
+    table = ui->queryTable;
+    table->blockSignals(true);
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(inputNames.count());
+    table->verticalHeader()->setVisible(false);
+    for(int i = 0; i < inputNames.count(); i++)
+    {
+        double lower = 0, upper = 0;
+        for(int r = 0; r < points.count(); r++)
+        {
+            if(r == 0 || points.at(r).at(i) < lower)
+                lower = points.at(r).at(i);
+            if(r == 0 || points.at(r).at(i) > upper)
+                upper = points.at(r).at(i);
+        }
+        table->setItem(i,InputColumn,fixedItem(inputNames.at(i)));
+        table->setItem(i,ValueColumn,new QTableWidgetItem(QString::number((lower+upper)/2,'g',6)));
+        table->setItem(i,LowerColumn,fixedItem(QString::number(lower,'g',6)));
+        table->setItem(i,UpperColumn,fixedItem(QString::number(upper,'g',6)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->blockSignals(false);
+
+    headers.clear();
+    headers<<"Output"<<"Estimate";
+    ui->estimateTable->setColumnCount(headers.count());
+    ui->estimateTable->setHorizontalHeaderLabels(headers);
+    ui->estimateTable->verticalHeader()->setVisible(false);
+    ui->estimateTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+}
+
+void surrogateDialog::showSurface()
+{
+    QStringList fitted = current.outputEntries();
+    for(int o = 0; o < outputEntries.count(); o++)
+    {
+        int f = current.isValid() ? fitted.indexOf(outputEntries.at(o)) : -1;
+        ui->outputTable->item(o,RmseColumn)->setText(f < 0 ? "" : QString::number(current.rmse(f),'g',4));
+        ui->outputTable->item(o,MaxErrorColumn)->setText(f < 0 ? "" : QString::number(current.maxError(f),'g',4));
+        ui->outputTable->item(o,R2Column)->setText(f < 0 ? "" : QString::number(current.r2(f),'g',4));
+    }
+    ui->okButton->setEnabled(current.isValid());
+    estimate();
+}
+
+void surrogateDialog::on_fitButton_clicked()
+{
+    QStringList names, entries;
+    QVector<int> columns;
+    for(int o = 0; o < outputEntries.count(); o++)
+        if(ui->outputTable->item(o,UseColumn)->checkState() == Qt::Checked)
+        {
+            names<<outputNames.at(o);
+            entries<<outputEntries.at(o);
+            columns<<o;
+        }
+    if(columns.isEmpty())
+    {
+        globalpara.reportError("Please check at least one output to fit.",this);
+        return;
+    }
+    QVector<QVector<double> > fittedValues;
+    fittedValues.reserve(values.count());
+    for(int r = 0; r < values.count(); r++)
+    {
+        QVector<double> row;
+        for(int c = 0; c < columns.count(); c++)
+            row<<values.at(r).at(columns.at(c));
+        fittedValues<<row;
+    }
+
+    responseSurface fitted;
+    int method = ui->methodBox->currentIndex();
+    fitted.setMethod(method == 3 ? responseSurface::RadialBasis : responseSurface::Polynomial, method+1);
+    fitted.setEntries(inputEntries, entries);
+    QString error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool built = fitted.build(points, fittedValues, &error);
+    QApplication::restoreOverrideCursor();
+    if(!built)
+    {
+        globalpara.reportError(error,this);
+        return;
+    }
+    current = fitted;
+    ui->logText->appendPlainText("Fitted "+current.description()+" to "+QString::number(points.count())
+                                 +" runs, cross-validated in "+QString::number(qMin(10,points.count()))+" folds.");
+    showSurface();
+}
+
+void surrogateDialog::estimate()
+{
+    QTableWidget *table = ui->estimateTable;
+    if(!current.isValid())
+    {
+        table->setRowCount(0);
+        ui->rangeLabel->clear();
+        return;
+    }
+    QVector<double> x;
+    for(int i = 0; i < inputEntries.count(); i++)
+    {
+        bool ok = false;
+        x<<ui->queryTable->item(i,ValueColumn)->text().toDouble(&ok);
+        if(!ok)
+        {
+            ui->rangeLabel->setText("Enter a number for "+inputNames.at(i)+".");
+            return;
+        }
+    }
+    bool inRange = true;
+    QVector<double> y = current.predict(x,&inRange);
+    QStringList fitted = current.outputEntries();
+    table->setRowCount(fitted.count());
+    for(int f = 0; f < fitted.count(); f++)
+    {
+        int o = outputEntries.indexOf(fitted.at(f));
+        table->setItem(f,0,fixedItem(o < 0 ? fitted.at(f) : outputNames.at(o)));
+        QTableWidgetItem *item = fixedItem(QString::number(y.at(f),'g',5));
+        if(!inRange)
+            item->setBackground(Qt::yellow);
+        table->setItem(f,1,item);
+    }
+    if(inRange)
+        ui->rangeLabel->setText("Within the range of the runs.");
+    else
+        ui->rangeLabel->setText("<font color=red>Outside the range of the runs, the estimates are extrapolated.</font>");
+}
+
+void surrogateDialog::on_queryTable_itemChanged(QTableWidgetItem *item)
+{
+    if(item->column() == ValueColumn)
+        estimate();
+}
+
+void surrogateDialog::on_removeButton_clicked()
+{
+    current = responseSurface();
+    accept();
+}
+
+void surrogateDialog::on_okButton_clicked()
+{
+    accept();
+}
+
+void surrogateDialog::on_cancelButton_clicked()
+{
+    reject();
+}
@@ -0,0 +1,66 @@
+/*! \file surrogatedialog.h
+    \brief Dialog to fit a response surface surrogate to the runs of a parametric table
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef SURROGATEDIALOG_H
+#define SURROGATEDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+
+#include "surrogate.h"
+
+namespace Ui {
+class surrogateDialog;
+}
+
+class QTableWidgetItem;
+
+/// Dialog to fit a surrogate (responseSurface) to the calculated runs of a table
+/// - the outputs to fit and the kind of surface are chosen, the cross-validation errors are shown
+/// - "What If" estimates the outputs at any input values at once, flagging values outside the runs
+/// - accepted, surface() is kept with the table in the case, an invalid one removes the surrogate
+/// - called by tabledialog.cpp
+class surrogateDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /// The names and entries of the inputs and outputs of the table, and its calculated runs,
+    /// points[run][input] and values[run][output]; existing is the surrogate the table has.
+    explicit surrogateDialog(const QStringList &inputNames, const QStringList &inputEntries,
+                             const QStringList &outputNames, const QStringList &outputEntries,
+                             const QVector<QVector<double> > &points, const QVector<QVector<double> > &values,
+                             const responseSurface &existing, QWidget *parent = 0);
+    ~surrogateDialog();
+
+    responseSurface surface() const;
+
+private slots:
+    void on_fitButton_clicked();
+
+    void on_removeButton_clicked();
+
+    void on_okButton_clicked();
+
+    void on_cancelButton_clicked();
+
+    void on_queryTable_itemChanged(QTableWidgetItem *item);
+
+private:
+    Ui::surrogateDialog *ui;
+
+    void setupTables();
+    void showSurface();
+    void estimate();
+
+    QStringList inputNames, inputEntries, outputNames, outputEntries;
+    QVector<QVector<double> > points;
+    QVector<QVector<double> > values;
+    responseSurface current;
+};
+
+#endif // SURROGATEDIALOG_H
@@ -26,6 +26,11 @@
 #include "sorpsimEngine.h"
 #include "edittabledialog.h"
 #include "sorputils.h"
+#include "solverpool.h"
+#include "doedesign.h"
+#include "doedialog.h"
+#include "surrogate.h"
+#include "surrogatedialog.h"
 
 #include <QStringList>
 #include <QString>
@@ -46,6 +51,8 @@
 #include <QPrintPreviewDialog>
 #include <QPrintDialog>
 #include <QPicture>
+#include <QCryptographicHash>
+#include <QScopedPointer>
 
 extern myScene * theScene;
 extern unit * dummy;
@@ -69,6 +76,88 @@ int alvMethod;
 int alvCol;
 int alvRowCount;
 
+/// time limit for one table run solved by the worker pool [ms]
+static const int tableRunTimeout = 60000;
+/// runs handed to the worker pool at a time, which bounds the memory of their inputs
+static const int tableChunkRuns = 512;
+
+namespace {
+
+/// Hash of what a run asks for: its input values, and the output columns and their units.
+QString runInputHash(const QDomElement &currentTable, const QDomElement &currentRun)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(currentTable.elementsByTagName("outputEntries").at(0).toElement().text().toUtf8());
+    QStringList units = QStringList()<<"tUnit"<<"pUnit"<<"fUnit"<<"hUnit"<<"qUnit"<<"uaUnit";
+    foreach(QString unitName, units)
+        hash.addData((";"+currentTable.attribute(unitName)).toUtf8());
+    QDomNodeList inputs = currentRun.elementsByTagName("Input");
+    for(int j = 0; j < inputs.count(); j++)
+    {
+        QDomElement currentInput = inputs.at(j).toElement();
+        QStringList fields;
+        fields<<currentInput.attribute("type")
+              <<currentInput.elementsByTagName("index").at(0).toElement().text()
+              <<currentInput.elementsByTagName("parameter").at(0).toElement().text()
+              <<currentInput.elementsByTagName("value").at(0).toElement().text();
+        hash.addData((";"+fields.join(",")).toUtf8());
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/// Hash of the case a run is solved in. Guess values and scaling ranges are left
+/// out, they change from run to run with "update guess values" but don't change
+/// the solution.
+QString runBaseHash(const calInputs &runInputs)
+{
+    // calInputs is too large for the stack
+    QScopedPointer<calInputs> base(new calInputs(runInputs));
+    base->tmax = 0;
+    base->tmin = 0;
+    base->fmax = 0;
+    base->pmax = 0;
+    for(int i = 1; i <= base->nsp && i < 150; i++)
+    {
+        if(base->itfix[i]>0)
+            base->t[i] = 0;
+        if(base->iffix[i]>0)
+            base->f[i] = 0;
+        if(base->icfix[i]>0)
+            base->c[i] = 0;
+        if(base->ipfix[i]>0)
+            base->p[i] = 0;
+        if(base->iwfix[i]>0)
+            base->w[i] = 0;
+    }
+    return solverInputHash(*base);
+}
+
+/// Shows that an output of a run is estimated by the surrogate of the table, not calculated.
+void markEstimated(QTableWidgetItem *item, bool inRange)
+{
+    QFont font = item->font();
+    font.setItalic(true);
+    item->setFont(font);
+    if(inRange)
+        item->setToolTip("Estimated by the surrogate of the table");
+    else
+    {
+        item->setBackground(Qt::yellow);
+        item->setToolTip("Estimated by the surrogate of the table, outside the range of the runs it was fitted to");
+    }
+}
+
+/// The outputs of the run are calculated, no longer estimated by the surrogate.
+void clearEstimate(QDomElement run)
+{
+    run.removeAttribute("outOfRange");
+    QDomNodeList runOutputs = run.elementsByTagName("Output");
+    for(int j = 0; j < runOutputs.count(); j++)
+        runOutputs.at(j).toElement().removeAttribute("estimated");
+}
+
+}
+
 tableDialog::tableDialog(unit * dummy, QString startTable, QWidget * parent) :
     myDummy(dummy),
     QDialog(parent),
@@ -216,6 +305,8 @@ bool tableDialog::setupTables(bool init)
                     newItem->setData(Qt::DisplayRole,QString::number(theValue,'g',4));
                     newItem->setForeground(Qt::blue);
                     newItem->setTextAlignment(Qt::AlignCenter);
+                    if(currentOutput.attribute("estimated")=="1")
+                        markEstimated(newItem,currentRun.attribute("outOfRange")!="1");
                     newTable->setItem(i,inputEntries.count()+j,newItem);
                 }
             }
@@ -380,11 +471,11 @@ bool tableDialog::reshapeXml(int adrPosition, int adrIar)
         switch(adrPosition) {
         case 1://remove at top
             for(int i = 0;i < step;i++)
-                currentTable.removeChild(currentTable.elementsByTagName("Run").at(0));
+                currentTable.removeChild(currentTable.firstChildElement("Run"));
             break;
         case 2://remove at bottom
             for(int i = 0;i < step;i++)
-                currentTable.removeChild(currentTable.elementsByTagName("Run").at(currentTable.elementsByTagName("Run").count()-1));
+                currentTable.removeChild(currentTable.lastChildElement("Run"));
             break;
         case 3://remove at pos
             for(int i = 0;i < step;i++)
@@ -397,12 +488,13 @@ bool tableDialog::reshapeXml(int adrPosition, int adrIar)
     if(currentTable.elementsByTagName("Run").count() < tableToUpdate->rowCount())
     {
         qDebug()<<"Expanding, maybe at the end, why not?, haha!";
-        int step = tableToUpdate->rowCount()-currentTable.elementsByTagName("Run").count();
+        int existing = currentTable.elementsByTagName("Run").count();
+        int step = tableToUpdate->rowCount()-existing;
         for(int i = 1; i <= step; i++)
         {
             QDomElement newRun = doc.createElement("Run");
             currentTable.appendChild(newRun);
-            newRun.setAttribute("No.",i+currentTable.elementsByTagName("Run").count()-2);
+            newRun.setAttribute("No.",i+existing+i-2);
             for(int j = 0; j < inputEntries.count();j++)
             {
                 QDomElement newInput = doc.createElement("Input");
@@ -534,9 +626,13 @@ bool tableDialog::updateXml()
 
     qDebug()<<"updating";
 
+    QDomNodeList runList = currentTable.elementsByTagName("Run");
+    QVector<QDomElement> runs;
+    for(int i = 0; i < tableToUpdate->rowCount(); i++)
+        runs<<runList.at(i).toElement();
     for(int i = 0; i < tableToUpdate->rowCount(); i++)//put table value of parameters into the xml
     {
-        QDomElement currentRun = currentTable.elementsByTagName("Run").at(i).toElement();
+        QDomElement currentRun = runs.at(i);
         QDomNodeList inputs = currentRun.elementsByTagName("Input");
         for(int j = 0; j < inputEntries.count();j++)
         {
@@ -572,19 +668,23 @@ bool tableDialog::updateXml()
     return true;
 }
 
-bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
+bool tableDialog::buildInputs(calInputs &runInputs)
 {
-    tInputs.title = globalpara.title;
-    tInputs.tmax = convert(globalpara.tmax,temperature[globalpara.unitindex_temperature],temperature[3]);
-    tInputs.tmin = convert(globalpara.tmin,temperature[globalpara.unitindex_temperature],temperature[3]);
-    tInputs.fmax = convert(globalpara.fmax,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[1]);
-    tInputs.pmax = convert(globalpara.pmax,pressure[globalpara.unitindex_pressure],pressure[8]);
-    tInputs.maxfev = globalpara.maxfev;
-    tInputs.msglvl = globalpara.msglvl;
-    tInputs.ftol = globalpara.ftol;
-    tInputs.xtol = globalpara.xtol;
-    tInputs.nunits = globalcount;
-    tInputs.nsp = spnumber;
+    runInputs.title = globalpara.title;
+    runInputs.tmax = convert(globalpara.tmax,temperature[globalpara.unitindex_temperature],temperature[3]);
+    runInputs.tmin = convert(globalpara.tmin,temperature[globalpara.unitindex_temperature],temperature[3]);
+    runInputs.fmax = convert(globalpara.fmax,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[1]);
+    runInputs.pmax = convert(globalpara.pmax,pressure[globalpara.unitindex_pressure],pressure[8]);
+    runInputs.maxfev = globalpara.maxfev;
+    runInputs.msglvl = globalpara.msglvl;
+    runInputs.ftol = globalpara.ftol;
+    runInputs.xtol = globalpara.xtol;
+    runInputs.fastProperties = globalpara.fastProperties;
+    runInputs.if97Water = globalpara.if97Water;
+    runInputs.solverMethod = globalpara.solverMethod;
+    runInputs.autoScaling = globalpara.autoScaling;
+    runInputs.nunits = globalcount;
+    runInputs.nsp = spnumber;
 
     double conv = 10;
     if(globalpara.unitindex_temperature==3)
@@ -599,32 +699,32 @@ bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
     unit * myHead = myDummy->next;
     for(int count = 1; count-1 < globalcount;count++)
     {
-        tInputs.idunit[count] = myHead->idunit;
-        tInputs.iht[count] = myHead->iht;
+        runInputs.idunit[count] = myHead->idunit;
+        runInputs.iht[count] = myHead->iht;
         if(myHead->idunit==81||myHead->idunit==82)
         {
-            tInputs.ht[count] = myHead->ht;
-            tInputs.ipinch[count] =  0;
-            tInputs.devl[count] = 0;
-            tInputs.devg[count] = 0;
-            tInputs.icop[count] = 0;
+            runInputs.ht[count] = myHead->ht;
+            runInputs.ipinch[count] =  0;
+            runInputs.devl[count] = 0;
+            runInputs.devg[count] = 0;
+            runInputs.icop[count] = 0;
         }
         else
         {
             if (myHead->iht==0)
-                tInputs.ht[count] = convert(myHead->htT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[7]);
+                runInputs.ht[count] = convert(myHead->htT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[7]);
             else if(myHead->iht==1)
-                tInputs.ht[count] = convert(myHead->htT,UA[globalpara.unitindex_UA],UA[1]);
+                runInputs.ht[count] = convert(myHead->htT,UA[globalpara.unitindex_UA],UA[1]);
             else if(myHead->iht==4||myHead->iht==5)
-                tInputs.ht[count] = myHead->htT*conv;
-            else tInputs.ht[count] = myHead->htT;
-            tInputs.ipinch[count] =  myHead->ipinchT;
-            tInputs.icop[count] = myHead->icopT;
+                runInputs.ht[count] = myHead->htT*conv;
+            else runInputs.ht[count] = myHead->htT;
+            runInputs.ipinch[count] =  myHead->ipinchT;
+            runInputs.icop[count] = myHead->icopT;
 
             if(myHead->idunit==62)//for powerlaw of throttle valve
-                tInputs.devl[count] = myHead->devl;
+                runInputs.devl[count] = myHead->devl;
             else
-                tInputs.devl[count] = myHead->devl*conv;
+                runInputs.devl[count] = myHead->devl*conv;
             if(myHead->idunit==63)//for thermostatic valve
             {
                 if(myHead->sensor==NULL)
@@ -632,23 +732,23 @@ bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
                     globalpara.reportError("Please reset temperature sensor of the thermostatic valve!",this);
                     return false;
                 }
-                tInputs.devl[count] = myHead->devl;
+                runInputs.devl[count] = myHead->devl;
             }
-            tInputs.devg[count] = myHead->devg*conv;
-            tInputs.icop[count] = myHead->icop;
+            runInputs.devg[count] = myHead->devg*conv;
+            runInputs.icop[count] = myHead->icop;
         }
 
-        tInputs.wetness[count] = myHead->wetnessT;
-        tInputs.ntua[count] = myHead->NTUaT;
-        tInputs.ntum[count] = myHead->NTUmT;
-        tInputs.ntuw[count] = myHead->NTUtT;
-        tInputs.nIter[count] = myHead->nIter;
-        tInputs.le[count] = myHead->leT;
+        runInputs.wetness[count] = myHead->wetnessT;
+        runInputs.ntua[count] = myHead->NTUaT;
+        runInputs.ntum[count] = myHead->NTUmT;
+        runInputs.ntuw[count] = myHead->NTUtT;
+        runInputs.nIter[count] = myHead->nIter;
+        runInputs.le[count] = myHead->leT;
         for(int j = 0; j<7; j++)
         {
             if(j<myHead->usp)
-                tInputs.isp[count][j] = myHead->myNodes[j]->ndum;
-            else tInputs.isp[count][j] = 0;
+                runInputs.isp[count][j] = myHead->myNodes[j]->ndum;
+            else runInputs.isp[count][j] = 0;
         }
 
         myHead = myHead->next;
@@ -668,28 +768,36 @@ bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
                     if ( !iflag && myHead->myNodes[k]->ndum == i )
                     {
                         notFound = false;
-                        tInputs.t[i] = convert(myHead->myNodes[k]->tT,temperature[globalpara.unitindex_temperature],temperature[3]);
+                        runInputs.t[i] = convert(myHead->myNodes[k]->tT,temperature[globalpara.unitindex_temperature],temperature[3]);
                         if(i == 11){
-                            qDebug()<<"t 11 now is"<<tInputs.t[i];
+                            qDebug()<<"t 11 now is"<<runInputs.t[i];
                         }
-                        tInputs.f[i] = convert(myHead->myNodes[k]->fT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[1]);
-
-                        tInputs.c[i] = myHead->myNodes[k]->cT;
-                        tInputs.p[i] = convert(myHead->myNodes[k]->pT,pressure[globalpara.unitindex_pressure],pressure[8]);
-                        tInputs.w[i] = myHead->myNodes[k]->wT;
-
-                        tInputs.ksub[i] = myHead->myNodes[k]->ksub;
-                        tInputs.itfix[i] = myHead->myNodes[k]->itfix;
-                        tInputs.iffix[i] = myHead->myNodes[k]->iffix;
-                        tInputs.icfix[i] = myHead->myNodes[k]->icfix;
-                        tInputs.ipfix[i] = myHead->myNodes[k]->ipfix;
-                        tInputs.iwfix[i] = myHead->myNodes[k]->iwfix;
+                        runInputs.f[i] = convert(myHead->myNodes[k]->fT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[1]);
+
+                        runInputs.c[i] = myHead->myNodes[k]->cT;
+                        runInputs.p[i] = convert(myHead->myNodes[k]->pT,pressure[globalpara.unitindex_pressure],pressure[8]);
+                        runInputs.w[i] = myHead->myNodes[k]->wT;
+
+                        runInputs.ksub[i] = myHead->myNodes[k]->ksub;
+                        runInputs.itfix[i] = myHead->myNodes[k]->itfix;
+                        runInputs.iffix[i] = myHead->myNodes[k]->iffix;
+                        runInputs.icfix[i] = myHead->myNodes[k]->icfix;
+                        runInputs.ipfix[i] = myHead->myNodes[k]->ipfix;
+                        runInputs.iwfix[i] = myHead->myNodes[k]->iwfix;
                         iflag = true;
                     }
             }
             myHead = myHead->next;
         }
     }
+    return true;
+}
+
+bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
+{
+    if(!buildInputs(tInputs))
+        return false;
+
     //initialize calculation
     int cal = absdCal(0,0,tInputs,false);
     qDebug()<<run<<"message is "<<outputs.Msgs[outputs.IER+1];
@@ -751,6 +859,339 @@ bool tableDialog::calc(globalparameter globalpara, QString fileName, int run)
     return false;
 }
 
+void tableDialog::applyRunInputs(const QDomElement &currentTable, const QDomElement &currentRun)
+{
+    int tUnit = currentTable.attribute("tUnit").toInt(),
+            pUnit = currentTable.attribute("pUnit").toInt(),
+            fUnit = currentTable.attribute("fUnit").toInt();
+    QStringList inputEntries = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";");
+    QDomNodeList inputs = currentRun.elementsByTagName("Input");
+    for(int j = 0; j < inputEntries.count();j++)
+    {
+        QDomElement currentInput = inputs.at(j).toElement();
+        if(currentInput.attribute("type")=="sp")
+        {
+            QDomNodeList indexes = currentInput.elementsByTagName("index");
+            QDomElement index = indexes.at(0).toElement();
+            QString spInd = index.text();
+            QStringList spIndList = spInd.split(" ");
+            int unitInd = spIndList.first().toInt()-1;
+            int localInd = spIndList.last().toInt()-1;
+
+            QDomNodeList paras = currentInput.elementsByTagName("parameter");
+            QDomElement para = paras.at(0).toElement();
+            QString spPara = para.text();
+            QDomNodeList values = currentInput.elementsByTagName("value");
+            QDomElement value = values.at(0).toElement();
+            double spValue = value.text().toFloat();
+            unit * iterator = dummy->next;
+            for(;(iterator->next!=NULL)&&(iterator->nu<=unitInd);(iterator = iterator->next));
+            Node*node = iterator->myNodes[localInd];
+            if(spPara == "T")
+            {
+                spValue = convert(spValue,temperature[tUnit],temperature[globalpara.unitindex_temperature]);
+                globalpara.allSet.clear();
+                node->searchAllSet("t");
+                QSet<Node*>tSet = globalpara.allSet;
+                foreach(Node*theNode,tSet){
+                    theNode->tT = spValue;
+                }
+            }
+            else if(spPara == "P")
+            {
+                spValue = convert(spValue,pressure[pUnit],pressure[globalpara.unitindex_pressure]);
+
+                globalpara.allSet.clear();
+                node->searchAllSet("p");
+                QSet<Node*>pSet = globalpara.allSet;
+                foreach(Node*theNode,pSet)
+                    theNode->pT = spValue;
+            }
+            else if(spPara == "F")
+            {
+                spValue = convert(spValue,mass_flow_rate[fUnit],mass_flow_rate[globalpara.unitindex_massflow]);
+
+                globalpara.allSet.clear();
+                node->searchAllSet("f");
+                QSet<Node*>fSet = globalpara.allSet;
+                foreach(Node*theNode,fSet)
+                    theNode->fT = spValue;
+                qDebug()<<"taking flow"<<spValue<<"to calculate";
+
+            }
+            else if(spPara == "W")
+            {
+                globalpara.allSet.clear();
+                node->searchAllSet("w");
+                QSet<Node*>wSet = globalpara.allSet;
+                foreach(Node*theNode,wSet)
+                    theNode->wT = spValue;
+
+            }
+            else if(spPara == "C")
+            {
+                globalpara.allSet.clear();
+                node->searchAllSet("c");
+                QSet<Node*>cSet = globalpara.allSet;
+                foreach(Node*theNode,cSet)
+                    theNode->cT = spValue;
+
+            }
+        }
+        if(currentInput.attribute("type") == "unit")
+        {
+            QDomNodeList indexes = currentInput.elementsByTagName("index");
+            QDomElement index = indexes.at(0).toElement();
+            int uInd = index.text().toInt();
+            QDomNodeList paras = currentInput.elementsByTagName("parameter");
+            QDomElement para = paras.at(0).toElement();
+            QString uPara = para.text();
+            QDomNodeList values = currentInput.elementsByTagName("value");
+            QDomElement value = values.at(0).toElement();
+            double uValue = value.text().toFloat();
+            unit * iterator = dummy->next;
+            for(;(iterator->next!=NULL)&&(iterator->nu<uInd);(iterator = iterator->next));
+            if(uPara=="WT")
+                iterator->wetnessT = uValue;
+            else if(uPara=="NM")
+                iterator->NTUmT = uValue;
+            else if(uPara=="NW")
+                iterator->NTUtT = uValue;
+            else if(uPara=="NA")
+                iterator->NTUaT = uValue;
+            else
+                iterator->htT = uValue;
+        }
+    }
+}
+
+bool tableDialog::runBaseHashOf(const QDomElement &currentTable, const QDomElement &currentRun, QString &hash)
+{
+    // calInputs is too large for the stack
+    QScopedPointer<calInputs> runInputs(new calInputs);
+    applyRunInputs(currentTable, currentRun);
+    if(!buildInputs(*runInputs))
+        return false;
+    hash = runBaseHash(*runInputs);
+    return true;
+}
+
+/// runBaseHash() with every input of the table at 0, so that it doesn't depend on the runs
+bool tableDialog::caseHash(const QDomElement &currentTable, const QDomElement &anyRun, QString &hash)
+{
+    QDomElement neutral = anyRun.cloneNode(true).toElement();
+    QDomNodeList inputs = neutral.elementsByTagName("Input");
+    for(int j = 0; j < inputs.count(); j++)
+    {
+        QDomElement value = inputs.at(j).toElement().elementsByTagName("value").at(0).toElement();
+        while(value.hasChildNodes())
+            value.removeChild(value.firstChild());
+        value.appendChild(neutral.ownerDocument().createTextNode("0"));
+    }
+    return runBaseHashOf(currentTable, neutral, hash);
+}
+
+void tableDialog::storeRunOutputs(QDomDocument &doc, const QDomElement &currentTable, const QDomElement &currentRun,
+                                  QTableWidget *table, int run)
+{
+    int tUnit = currentTable.attribute("tUnit").toInt(),
+            pUnit = currentTable.attribute("pUnit").toInt(),
+            fUnit = currentTable.attribute("fUnit").toInt(),
+            hUnit = currentTable.attribute("hUnit").toInt(),
+            qUnit = currentTable.attribute("qUnit").toInt(),
+            uaUnit = currentTable.attribute("uaUnit").toInt();
+    QStringList inputEntries = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";");
+    QStringList outputEntries = currentTable.elementsByTagName("outputEntries").at(0).toElement().text().split(";");
+    QDomNodeList outputs = currentRun.elementsByTagName("Output");
+    for(int j = 0; j < outputEntries.count();j++)
+    {
+        QTableWidgetItem * item = new QTableWidgetItem;
+        QDomElement currentOutput = outputs.at(j).toElement();
+        if(currentOutput.attribute("type")=="sp")
+        {
+            QDomNodeList indexes = currentOutput.elementsByTagName("index");
+            QDomElement index = indexes.at(0).toElement();
+            QString spInd = index.text();
+            QStringList spIndList = spInd.split(" ");
+            int unitInd = spIndList.first().toInt();
+            int localInd = spIndList.last().toInt()-1;
+            QDomNodeList paras = currentOutput.elementsByTagName("parameter");
+            QDomElement para = paras.at(0).toElement();
+            QString spPara = para.text();
+            unit * iterator = dummy->next;
+            for(;(iterator->next!=NULL)&&(iterator->nu<unitInd);(iterator = iterator->next));
+            QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
+            QDomElement newElement = doc.createElement("value");
+            if(spPara == "T")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->tTr,temperature[globalpara.unitindex_temperature],temperature[tUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->tTr,temperature[globalpara.unitindex_temperature],temperature[tUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(spPara == "P")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->pTr,pressure[globalpara.unitindex_pressure],pressure[pUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->pTr,pressure[globalpara.unitindex_pressure],pressure[pUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(spPara == "F")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->fTr,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->fTr,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(spPara == "W")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->myNodes[localInd]->wTr));
+                item->setData(Qt::DisplayRole,QString::number(iterator->myNodes[localInd]->wTr,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(spPara == "C")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->myNodes[localInd]->cTr));
+                item->setData(Qt::DisplayRole,QString::number(iterator->myNodes[localInd]->cTr,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(spPara == "H")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->hTr,enthalpy[globalpara.unitindex_enthalpy],enthalpy[hUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->hTr,enthalpy[globalpara.unitindex_enthalpy],enthalpy[hUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            currentOutput.appendChild(newElement);
+            currentOutput.replaceChild(newElement,oldValue);
+        }
+        if(currentOutput.attribute("type") == "unit")
+        {
+            QDomNodeList indexes = currentOutput.elementsByTagName("index");
+            QDomElement index = indexes.at(0).toElement();
+            int uInd = index.text().toInt();
+            QDomNodeList paras = currentOutput.elementsByTagName("parameter");
+            QDomElement para = paras.at(0).toElement();
+            QString uPara = para.text();
+            unit * iterator = dummy->next;
+            for(;(iterator->next!=NULL)&&(iterator->nu<uInd);(iterator = iterator->next));
+            QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
+            QDomElement newElement = doc.createElement("value");
+            if(uPara == "UA")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->uaT,UA[globalpara.unitindex_UA],UA[uaUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->uaT,UA[globalpara.unitindex_UA],UA[uaUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "NT")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->ntuT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->ntuT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "EF")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->effT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->effT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "CA")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->catT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->catT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "LM")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->lmtdT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->lmtdT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "HT")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->htTr,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->htTr,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "HE")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->humeffT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->humeffT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "EE")
+            {
+                QDomText newText = doc.createTextNode(QString::number(iterator->enthalpyeffT));
+                item->setData(Qt::DisplayRole,QString::number(iterator->enthalpyeffT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(uPara == "MR"||uPara == "ME")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(iterator->mrateT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(iterator->mrateT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+
+            currentOutput.appendChild(newElement);
+            currentOutput.replaceChild(newElement,oldValue);
+        }
+        if(currentOutput.attribute("type") == "global")
+        {
+            QDomNodeList paras = currentOutput.elementsByTagName("parameter");
+            QDomElement para = paras.at(0).toElement();
+            QString gPara = para.text();
+            QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
+            QDomElement newElement = doc.createElement("value");
+            if(gPara == "COP")
+            {
+                QDomText newText = doc.createTextNode(QString::number(globalpara.copT));
+                item->setData(Qt::DisplayRole,QString::number(globalpara.copT,'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            else if(gPara == "CAP")
+            {
+                QDomText newText = doc.createTextNode(QString::number(convert(globalpara.capacityT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit])));
+                item->setData(Qt::DisplayRole,QString::number(convert(globalpara.capacityT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit]),'g',4));
+                item->setTextAlignment(Qt::AlignCenter);
+                newElement.appendChild(newText);
+            }
+            currentOutput.appendChild(newElement);
+            currentOutput.replaceChild(newElement,oldValue);
+        }
+        QBrush blueBrush(Qt::blue);
+        item->setForeground(blueBrush);
+        table->setItem(run,j+inputEntries.count(),item);
+    }
+}
+
+void tableDialog::markRunFailed(QTableWidget *table, int run, int nInputs, int nOutputs)
+{
+    for(int p = 0; p < nInputs;p++)
+    {
+        table->item(run,p)->setBackground(Qt::red);
+    }
+    for(int q = nInputs; q < nInputs+nOutputs; q++)
+    {
+        QTableWidgetItem * zeroItem = new QTableWidgetItem;
+        zeroItem->setData(Qt::DisplayRole,0);
+        zeroItem->setTextAlignment(Qt::AlignCenter);
+        table->setItem(run,q,zeroItem);
+    }
+    table->setCurrentCell(run,nInputs+1);
+}
+
 void tableDialog::calcTable()
 {
     QString tableTempXML = Sorputils::sorpTempDir().absoluteFilePath("tableTemp.xml");
@@ -777,320 +1218,338 @@ void tableDialog::calcTable()
     auto tablesByTitle = Sorputils::mapElementsByAttribute(tableData.childNodes(), "title");
     QDomElement currentTable = tablesByTitle[tableTitle];
     // ...        tableData.elementsByTagName(ui->tabWidget->tabText(ui->tabWidget->currentIndex())).at(0).toElement();
-    int tUnit = currentTable.attribute("tUnit").toInt(),
-            pUnit = currentTable.attribute("pUnit").toInt(),
-            fUnit = currentTable.attribute("fUnit").toInt(),
-            hUnit = currentTable.attribute("hUnit").toInt(),
-            qUnit = currentTable.attribute("qUnit").toInt(),
-            uaUnit = currentTable.attribute("uaUnit").toInt();
     QStringList inputEntries = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";");
     QStringList outputEntries = currentTable.elementsByTagName("outputEntries").at(0).toElement().text().split(";");
     int runs = currentTable.attribute("runs").toInt();
+    // the node list is rebuilt on each access after the document changed, so the runs are kept apart
+    QDomNodeList runNodes = currentTable.elementsByTagName("Run");
+    QVector<QDomElement> runList;
+    runList.reserve(runs);
+    for(int i = 0; i < runs; i++)
+        runList<<runNodes.at(i).toElement();
 
     qDebug()<<"runs"<<runs;
     for(int i = 0; i < runs; i ++)
         for(int p = 0; p < (inputEntries.count());p++)
             tableToCalculate->item(i,p)->setBackground(Qt::white);
 
+    if(ui->surrogateBox->isChecked())
+    {
+        if(estimateTable(doc, currentTable, tableToCalculate, runList))
+        {
+            file.resize(0);
+            doc.save(stream,4);
+        }
+        file.close();
+        return;
+    }
+
+    // A run is up to date if neither its inputs nor the case changed since its
+    // outputs were calculated; with "only calculate changed runs" those are skipped.
+    QVector<bool> stale(runs, true);
+    QStringList inputHashes, baseHashes;
+    QScopedPointer<calInputs> runInputs(new calInputs);
+    int staleRuns = 0;
     for(int i = 0; i < runs; i++)
     {
-        QDomElement currentRun = currentTable.elementsByTagName("Run").at(i).toElement();
-        QDomNodeList inputs = currentRun.elementsByTagName("Input");
-        for(int j = 0; j < inputEntries.count();j++)
+        QDomElement currentRun = runList.at(i);
+        applyRunInputs(currentTable, currentRun);
+        if(!buildInputs(*runInputs))
         {
-            QDomElement currentInput = inputs.at(j).toElement();
-            if(currentInput.attribute("type")=="sp")
-            {
-                QDomNodeList indexes = currentInput.elementsByTagName("index");
-                QDomElement index = indexes.at(0).toElement();
-                QString spInd = index.text();
-                QStringList spIndList = spInd.split(" ");
-                int unitInd = spIndList.first().toInt()-1;
-                int localInd = spIndList.last().toInt()-1;
-
-                QDomNodeList paras = currentInput.elementsByTagName("parameter");
-                QDomElement para = paras.at(0).toElement();
-                QString spPara = para.text();
-                QDomNodeList values = currentInput.elementsByTagName("value");
-                QDomElement value = values.at(0).toElement();
-                double spValue = value.text().toFloat();
-                unit * iterator = dummy->next;
-                for(;(iterator->next!=NULL)&&(iterator->nu<=unitInd);(iterator = iterator->next));
-                Node*node = iterator->myNodes[localInd];
-                if(spPara == "T")
-                {
-                    spValue = convert(spValue,temperature[tUnit],temperature[globalpara.unitindex_temperature]);
-                    globalpara.allSet.clear();
-                    node->searchAllSet("t");
-                    QSet<Node*>tSet = globalpara.allSet;
-                    foreach(Node*theNode,tSet){
-                        theNode->tT = spValue;
-                    }
-                }
-                else if(spPara == "P")
-                {
-                    spValue = convert(spValue,pressure[pUnit],pressure[globalpara.unitindex_pressure]);
+            file.close();
+            return;
+        }
+        inputHashes<<runInputHash(currentTable, currentRun);
+        baseHashes<<runBaseHash(*runInputs);
+        if(ui->changedBox->isChecked())
+            stale[i] = currentRun.attribute("inputHash") != inputHashes.last()
+                    || currentRun.attribute("baseHash") != baseHashes.last();
+        if(stale[i])
+            staleRuns++;
+    }
+    if(staleRuns == 0)
+    {
+        file.close();
+        QMessageBox infoBox(this);
+        infoBox.setWindowTitle("Parametric Table");
+        infoBox.setText("All runs are up to date, nothing to calculate.");
+        infoBox.exec();
+        return;
+    }
 
-                    globalpara.allSet.clear();
-                    node->searchAllSet("p");
-                    QSet<Node*>pSet = globalpara.allSet;
-                    foreach(Node*theNode,pSet)
-                        theNode->pT = spValue;
-                }
-                else if(spPara == "F")
-                {
-                    spValue = convert(spValue,mass_flow_rate[fUnit],mass_flow_rate[globalpara.unitindex_massflow]);
+    // Without guess updating the runs don't depend on each other, so they are
+    // handed to the worker pool all at once; otherwise they are solved in order.
+    if(!ui->updateBox->isChecked() && staleRuns > 1
+            && calcTableParallel(doc, currentTable, tableToCalculate, runList, stale, inputHashes, baseHashes))
+    {
+        file.resize(0);
+        doc.save(stream,4);
+        file.close();
+        return;
+    }
 
-                    globalpara.allSet.clear();
-                    node->searchAllSet("f");
-                    QSet<Node*>fSet = globalpara.allSet;
-                    foreach(Node*theNode,fSet)
-                        theNode->fT = spValue;
-                    qDebug()<<"taking flow"<<spValue<<"to calculate";
+    for(int i = 0; i < runs; i++)
+    {
+        if(!stale[i])
+            continue;
+        QDomElement currentRun = runList.at(i);
+        applyRunInputs(currentTable, currentRun);
 
-                }
-                else if(spPara == "W")
-                {
-                    globalpara.allSet.clear();
-                    node->searchAllSet("w");
-                    QSet<Node*>wSet = globalpara.allSet;
-                    foreach(Node*theNode,wSet)
-                        theNode->wT = spValue;
+        //calculation
+        if(!calc(globalpara,"tableCalc",i))
+        {
+            markRunFailed(tableToCalculate, i, inputEntries.count(), outputEntries.count());
+            currentRun.removeAttribute("inputHash");
+            currentRun.removeAttribute("baseHash");
+            clearEstimate(currentRun);
+        }
+        else
+        {
+            storeRunOutputs(doc, currentTable, currentRun, tableToCalculate, i);
+            currentRun.setAttribute("inputHash", inputHashes.at(i));
+            currentRun.setAttribute("baseHash", baseHashes.at(i));
+            clearEstimate(currentRun);
+        }
+    }
+    file.resize(0);
+    doc.save(stream,4);
+    file.close();
+}
 
-                }
-                else if(spPara == "C")
-                {
-                    globalpara.allSet.clear();
-                    node->searchAllSet("c");
-                    QSet<Node*>cSet = globalpara.allSet;
-                    foreach(Node*theNode,cSet)
-                        theNode->cT = spValue;
+bool tableDialog::calcTableParallel(QDomDocument &doc, const QDomElement &currentTable, QTableWidget *table,
+                                    const QVector<QDomElement> &runList, const QVector<bool> &stale,
+                                    const QStringList &inputHashes, const QStringList &baseHashes)
+{
+    int nInputs = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";").count();
+    int nOutputs = currentTable.elementsByTagName("outputEntries").at(0).toElement().text().split(";").count();
+    int runs = runList.count();
+
+    // Each run is started from the converged run nearest to it in input space,
+    // with the inputs scaled to [0,1] by their range over the table.
+    QVector<QVector<double> > point(runs, QVector<double>(nInputs, 0));
+    QVector<double> lower(nInputs, 0), upper(nInputs, 0);
+    for(int i = 0; i < runs; i++)
+    {
+        QDomNodeList inputs = runList.at(i).elementsByTagName("Input");
+        for(int j = 0; j < nInputs; j++)
+        {
+            double value = inputs.at(j).toElement().elementsByTagName("value").at(0).toElement().text().toDouble();
+            point[i][j] = value;
+            if(i == 0 || value < lower[j])
+                lower[j] = value;
+            if(i == 0 || value > upper[j])
+                upper[j] = value;
+        }
+    }
+    for(int i = 0; i < runs; i++)
+        for(int j = 0; j < nInputs; j++)
+            point[i][j] = upper[j] > lower[j] ? (point[i][j]-lower[j])/(upper[j]-lower[j]) : 0;
+    designSeeds seeds;
 
-                }
-            }
-            if(currentInput.attribute("type") == "unit")
+    int staleRuns = 0;
+    for(int i = 0; i < runs; i++)
+        if(stale.at(i))
+            staleRuns++;
+
+    QStringList failures;
+    QVector<calInputs> jobs;
+    QVector<int> jobRuns;// run of each job
+    int nextRun = 0, solved = 0;
+    while(nextRun < runs)
+    {
+        // the inputs of a run are large, so they are built one chunk at a time
+        jobs.clear();
+        jobRuns.clear();
+        jobs.reserve(tableChunkRuns);
+        for(; nextRun < runs && jobs.count() < tableChunkRuns; nextRun++)
+        {
+            if(!stale.at(nextRun))
+                continue;
+            QDomElement currentRun = runList.at(nextRun);
+            applyRunInputs(currentTable, currentRun);
+            jobs.resize(jobs.count()+1);
+            if(!buildInputs(jobs.last()))
             {
-                QDomNodeList indexes = currentInput.elementsByTagName("index");
-                QDomElement index = indexes.at(0).toElement();
-                int uInd = index.text().toInt();
-                QDomNodeList paras = currentInput.elementsByTagName("parameter");
-                QDomElement para = paras.at(0).toElement();
-                QString uPara = para.text();
-                QDomNodeList values = currentInput.elementsByTagName("value");
-                QDomElement value = values.at(0).toElement();
-                double uValue = value.text().toFloat();
-                unit * iterator = dummy->next;
-                for(;(iterator->next!=NULL)&&(iterator->nu<uInd);(iterator = iterator->next));
-                if(uPara=="WT")
-                    iterator->wetnessT = uValue;
-                else if(uPara=="NM")
-                    iterator->NTUmT = uValue;
-                else if(uPara=="NW")
-                    iterator->NTUtT = uValue;
-                else if(uPara=="NA")
-                    iterator->NTUaT = uValue;
-                else
-                    iterator->htT = uValue;
+                jobs.removeLast();
+                markRunFailed(table, nextRun, nInputs, nOutputs);
+                currentRun.removeAttribute("inputHash");
+                currentRun.removeAttribute("baseHash");
+                clearEstimate(currentRun);
+                failures<<"run #"+QString::number(nextRun+1)+": invalid inputs";
+                continue;
             }
-        }//insert all the input into the system for run # i
+            jobRuns.append(nextRun);
+        }
+        if(jobs.isEmpty())
+            break;
 
-        //calculation
-        if(!calc(globalpara,"tableCalc",i))
+        bool started = solverPool::shared()->solve(jobs, tableRunTimeout,
+            [&](int job, solverPool::Status status, const calOutputs &result)
         {
-            for(int p = 0; p < (inputEntries.count());p++)
+            int run = jobRuns.at(job);
+            QDomElement currentRun = runList.at(run);
+            if(status == solverPool::Finished && result.IER < 4 && !result.stopped)
             {
-                tableToCalculate->item(i,p)->setBackground(Qt::red);
+                seeds.add(point.at(run), result.state);
+                outputs = result;
+                updatesystem();
+                storeRunOutputs(doc, currentTable, currentRun, table, run);
+                currentRun.setAttribute("inputHash", inputHashes.at(run));
+                currentRun.setAttribute("baseHash", baseHashes.at(run));
+                clearEstimate(currentRun);
+                return;
             }
-            for(int q = inputEntries.count();
-                q < inputEntries.count()+outputEntries.count(); q++)
+            markRunFailed(table, run, nInputs, nOutputs);
+            currentRun.removeAttribute("inputHash");
+            currentRun.removeAttribute("baseHash");
+            clearEstimate(currentRun);
+            QString reason;
+            if(status == solverPool::Crashed)
+                reason = "the solver crashed";
+            else if(status == solverPool::TimedOut)
+                reason = "time limit exceeded";
+            else if(status == solverPool::Cancelled)
+                reason = "not calculated";
+            else if(result.stopped)
+                reason = "calculation stopped: "+result.myMsg;
+            else
+                reason = "failed to converge (ier = "+QString::number(result.IER)+")";
+            failures<<"run #"+QString::number(run+1)+": "+reason;
+        },
+            [&](int job)
+        {
+            return seeds.nearest(point.at(jobRuns.at(job)));
+        });
+        if(!started)
+        {
+            if(solved == 0)
+                return false;// no worker processes, fall back to solving in this process
+            // the workers were lost halfway, the runs left are reported as failed
+            QVector<int> lostRuns = jobRuns;
+            for(; nextRun < runs; nextRun++)
+                if(stale.at(nextRun))
+                    lostRuns.append(nextRun);
+            foreach(int run, lostRuns)
             {
-                QTableWidgetItem * zeroItem = new QTableWidgetItem;
-                zeroItem->setData(Qt::DisplayRole,0);
-                zeroItem->setTextAlignment(Qt::AlignCenter);
-                tableToCalculate->setItem(i,q,zeroItem);
+                QDomElement currentRun = runList.at(run);
+                markRunFailed(table, run, nInputs, nOutputs);
+                currentRun.removeAttribute("inputHash");
+                currentRun.removeAttribute("baseHash");
+                clearEstimate(currentRun);
+                failures<<"run #"+QString::number(run+1)+": no solver process available";
             }
-            tableToCalculate->setCurrentCell(i,inputEntries.count()+1);
+            break;
         }
+        solved += jobs.count();
+    }
+
+    if(!failures.isEmpty())
+    {
+        QMessageBox errorBox(this);
+        errorBox.setWindowTitle("Warning!");
+        errorBox.setText(QString::number(failures.count())+" of "+QString::number(staleRuns)
+                         +" runs were not successful:\n"+failures.join("\n"));
+        errorBox.exec();
+    }
+    return true;
+}
+
+/// Fills the outputs of the runs from the surrogate of the table instead of solving
+/// them; the runs outside the range of the runs it was fitted to are highlighted.
+bool tableDialog::estimateTable(QDomDocument &doc, const QDomElement &currentTable, QTableWidget *table,
+                                const QVector<QDomElement> &runList)
+{
+    QStringList inputEntries = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";");
+    QStringList outputEntries = currentTable.elementsByTagName("outputEntries").at(0).toElement().text().split(";");
+    responseSurface surface = responseSurface::fromXml(currentTable.firstChildElement("surrogate"));
+    if(!surface.isValid())
+    {
+        globalpara.reportError("The table has no surrogate, please fit one with \"Surrogate\" first.",this);
+        return false;
+    }
+    if(surface.inputEntries() != inputEntries)
+    {
+        globalpara.reportError("The inputs of the table changed since its surrogate was fitted, "
+                               "please fit it again.",this);
+        return false;
+    }
+    QString currentCaseHash;
+    if(runList.isEmpty() || !caseHash(currentTable, runList.first(), currentCaseHash))
+        return false;
+    if(currentTable.firstChildElement("surrogate").attribute("caseHash") != currentCaseHash)
+    {
+        globalpara.reportError("The case changed since the surrogate of the table was fitted, "
+                               "please calculate the table and fit the surrogate again.",this);
+        return false;
+    }
+    int nInputs = inputEntries.count();
+    QVector<int> fitted;
+    QStringList missing;
+    for(int j = 0; j < outputEntries.count(); j++)
+    {
+        fitted<<surface.outputEntries().indexOf(outputEntries.at(j));
+        if(fitted.last() < 0)
+            missing<<table->horizontalHeaderItem(nInputs+j)->text().simplified();
+    }
+
+    int outside = 0;
+    for(int i = 0; i < runList.count(); i++)
+    {
+        QDomElement currentRun = runList.at(i);
+        QDomNodeList inputs = currentRun.elementsByTagName("Input");
+        QVector<double> x;
+        for(int j = 0; j < nInputs; j++)
+            x<<inputs.at(j).toElement().elementsByTagName("value").at(0).toElement().text().toDouble();
+        bool inRange = true;
+        QVector<double> y = surface.predict(x, &inRange);
+
+        QDomNodeList outputs = currentRun.elementsByTagName("Output");
+        for(int j = 0; j < outputEntries.count(); j++)
+        {
+            if(fitted.at(j) < 0)
+                continue;
+            double value = y.at(fitted.at(j));
+            QDomElement currentOutput = outputs.at(j).toElement();
+            QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
+            QDomElement newValue = doc.createElement("value");
+            newValue.appendChild(doc.createTextNode(QString::number(value)));
+            currentOutput.replaceChild(newValue,oldValue);
+            currentOutput.setAttribute("estimated","1");
+
+            QTableWidgetItem * item = new QTableWidgetItem;
+            item->setData(Qt::DisplayRole,QString::number(value,'g',4));
+            item->setForeground(Qt::blue);
+            item->setTextAlignment(Qt::AlignCenter);
+            markEstimated(item, inRange);
+            table->setItem(i,nInputs+j,item);
+        }
+        // estimated outputs don't count as calculated ones
+        currentRun.removeAttribute("inputHash");
+        currentRun.removeAttribute("baseHash");
+        if(inRange)
+            currentRun.removeAttribute("outOfRange");
         else
         {
-            //grab output from the system
-            QDomNodeList outputs = currentRun.elementsByTagName("Output");
-            for(int j = 0; j < outputEntries.count();j++)
-            {
-                QTableWidgetItem * item = new QTableWidgetItem;
-                QDomElement currentOutput = outputs.at(j).toElement();
-                if(currentOutput.attribute("type")=="sp")
-                {
-                    QDomNodeList indexes = currentOutput.elementsByTagName("index");
-                    QDomElement index = indexes.at(0).toElement();
-                    QString spInd = index.text();
-                    QStringList spIndList = spInd.split(" ");
-                    int unitInd = spIndList.first().toInt();
-                    int localInd = spIndList.last().toInt()-1;
-                    QDomNodeList paras = currentOutput.elementsByTagName("parameter");
-                    QDomElement para = paras.at(0).toElement();
-                    QString spPara = para.text();
-                    unit * iterator = dummy->next;
-                    for(;(iterator->next!=NULL)&&(iterator->nu<unitInd);(iterator = iterator->next));
-                    QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
-                    QDomElement newElement = doc.createElement("value");
-                    if(spPara == "T")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->tTr,temperature[globalpara.unitindex_temperature],temperature[tUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->tTr,temperature[globalpara.unitindex_temperature],temperature[tUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(spPara == "P")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->pTr,pressure[globalpara.unitindex_pressure],pressure[pUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->pTr,pressure[globalpara.unitindex_pressure],pressure[pUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(spPara == "F")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->fTr,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->fTr,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(spPara == "W")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->myNodes[localInd]->wTr));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->myNodes[localInd]->wTr,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(spPara == "C")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->myNodes[localInd]->cTr));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->myNodes[localInd]->cTr,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(spPara == "H")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->myNodes[localInd]->hTr,enthalpy[globalpara.unitindex_enthalpy],enthalpy[hUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->myNodes[localInd]->hTr,enthalpy[globalpara.unitindex_enthalpy],enthalpy[hUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    currentOutput.appendChild(newElement);
-                    currentOutput.replaceChild(newElement,oldValue);
-                }
-                if(currentOutput.attribute("type") == "unit")
-                {
-                    QDomNodeList indexes = currentOutput.elementsByTagName("index");
-                    QDomElement index = indexes.at(0).toElement();
-                    int uInd = index.text().toInt();
-                    QDomNodeList paras = currentOutput.elementsByTagName("parameter");
-                    QDomElement para = paras.at(0).toElement();
-                    QString uPara = para.text();
-                    unit * iterator = dummy->next;
-                    for(;(iterator->next!=NULL)&&(iterator->nu<uInd);(iterator = iterator->next));
-                    QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
-                    QDomElement newElement = doc.createElement("value");
-                    if(uPara == "UA")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->uaT,UA[globalpara.unitindex_UA],UA[uaUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->uaT,UA[globalpara.unitindex_UA],UA[uaUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "NT")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->ntuT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->ntuT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "EF")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->effT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->effT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "CA")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->catT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->catT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "LM")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->lmtdT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->lmtdT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "HT")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->htTr,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->htTr,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "HE")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->humeffT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->humeffT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "EE")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(iterator->enthalpyeffT));
-                        item->setData(Qt::DisplayRole,QString::number(iterator->enthalpyeffT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(uPara == "MR"||uPara == "ME")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(iterator->mrateT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(iterator->mrateT,mass_flow_rate[globalpara.unitindex_massflow],mass_flow_rate[fUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-
-                    currentOutput.appendChild(newElement);
-                    currentOutput.replaceChild(newElement,oldValue);
-                }
-                if(currentOutput.attribute("type") == "global")
-                {
-                    QDomNodeList paras = currentOutput.elementsByTagName("parameter");
-                    QDomElement para = paras.at(0).toElement();
-                    QString gPara = para.text();
-                    QDomElement oldValue = currentOutput.elementsByTagName("value").at(0).toElement();
-                    QDomElement newElement = doc.createElement("value");
-                    if(gPara == "COP")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(globalpara.copT));
-                        item->setData(Qt::DisplayRole,QString::number(globalpara.copT,'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    else if(gPara == "CAP")
-                    {
-                        QDomText newText = doc.createTextNode(QString::number(convert(globalpara.capacityT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit])));
-                        item->setData(Qt::DisplayRole,QString::number(convert(globalpara.capacityT,heat_trans_rate[globalpara.unitindex_heat_trans_rate],heat_trans_rate[qUnit]),'g',4));
-                        item->setTextAlignment(Qt::AlignCenter);
-                        newElement.appendChild(newText);
-                    }
-                    currentOutput.appendChild(newElement);
-                    currentOutput.replaceChild(newElement,oldValue);
-                }
-                QBrush blueBrush(Qt::blue);
-                item->setForeground(blueBrush);
-                tableToCalculate->setItem(i,j+inputEntries.count(),item);
-            }//insert all the input into the system for run # i
+            currentRun.setAttribute("outOfRange","1");
+            outside++;
         }
     }
-    file.resize(0);
-    doc.save(stream,4);
-    file.close();
+
+    if(outside > 0 || !missing.isEmpty())
+    {
+        QString text;
+        if(outside > 0)
+            text = QString::number(outside)+" of "+QString::number(runList.count())+" runs are outside the range "
+                    "of the runs the surrogate was fitted to, their estimates (highlighted) are extrapolated.";
+        if(!missing.isEmpty())
+            text += (text.isEmpty() ? "" : "\n")+QString("The surrogate has no surface for ")+missing.join(", ")
+                    +", these outputs are left as they were.";
+        QMessageBox infoBox(this);
+        infoBox.setWindowTitle("Parametric Table");
+        infoBox.setText(text);
+        infoBox.exec();
+    }
+    return true;
 }
 
 void tableDialog::on_calculateButton_clicked()
@@ -1405,6 +1864,184 @@ void tableDialog::on_alterVarButton_clicked()
         qDebug()<<"reshape failed";
 }
 
+/// Replaces the runs of the current table with a design of experiments over
+/// its inputs; the outputs are cleared until the table is calculated.
+void tableDialog::on_designButton_clicked()
+{
+    QTableWidget * currentTable = dynamic_cast<QTableWidget *>(ui->tabWidget->currentWidget());
+
+    QString tableTempXML = Sorputils::sorpTempDir().absoluteFilePath("tableTemp.xml");
+    QFile file(tableTempXML);
+    QDomDocument doc;
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        globalpara.reportError("Fail to open case file to design table runs.",this);
+        return;
+    }
+    if(!doc.setContent(&file))
+    {
+        globalpara.reportError("Fail to load xml document to design table runs.",this);
+        file.close();
+        return;
+    }
+    file.close();
+    QDomElement tableData = doc.elementsByTagName("TableData").at(0).toElement();
+    auto tablesByTitle = Sorputils::mapElementsByAttribute(tableData.childNodes(), "title");
+    QString tableTitle = ui->tabWidget->tabText(ui->tabWidget->currentIndex());
+    QStringList list = tablesByTitle.value(tableTitle).elementsByTagName("inputEntries").at(0).toElement().text().split(";");
+    int inputCount = list.count();
+    for(int i = 0;i < list.count();i++)
+        list[i] = list[i].split(",")[0]+list[i].split(",")[1];
+
+    // the range of each input over the current runs is the default range of the design
+    QVector<double> lower(inputCount, 0), upper(inputCount, 0);
+    for(int j = 0; j < inputCount; j++)
+        for(int i = 0; i < currentTable->rowCount(); i++)
+        {
+            double value = currentTable->item(i,j)->data(Qt::DisplayRole).toDouble();
+            if(i == 0 || value < lower[j])
+                lower[j] = value;
+            if(i == 0 || value > upper[j])
+                upper[j] = value;
+        }
+
+    doeDialog designDialog(this);
+    designDialog.setInputs(list, lower, upper);
+    if(designDialog.exec() != QDialog::Accepted)
+        return;
+    QVector<QVector<double> > design = designDialog.designValues();
+    if(design.isEmpty())
+        return;
+
+    currentTable->blockSignals(true);
+    currentTable->setRowCount(design.count());
+    for(int i = 0; i < design.count(); i++)
+        for(int j = 0; j < currentTable->columnCount(); j++)
+        {
+            QTableWidgetItem * item = new QTableWidgetItem;
+            item->setData(Qt::DisplayRole,QString::number(j < inputCount ? design.at(i).at(j) : 0,'g',6));
+            item->setTextAlignment(Qt::AlignCenter);
+            if(j >= inputCount)
+                item->setForeground(Qt::blue);
+            currentTable->setItem(i,j,item);
+        }
+    currentTable->blockSignals(false);
+    if(!reshapeXml(2, 0))
+        qDebug()<<"reshape failed";
+
+    if(ui->updateBox->isChecked())
+    {
+        QMessageBox infoBox(this);
+        infoBox.setWindowTitle("Parametric Table");
+        infoBox.setText(QString::number(design.count())+" runs were generated. Uncheck \"Update Guess Values\" "
+                        "to calculate them in parallel, each run starting from the nearest converged run.");
+        infoBox.exec();
+    }
+}
+
+/// Fits a surrogate to the runs of the current table that are calculated with
+/// their current inputs, and keeps it with the table.
+void tableDialog::on_surrogateButton_clicked()
+{
+    if(!updateXml())
+        return;
+
+    QString tableTempXML = Sorputils::sorpTempDir().absoluteFilePath("tableTemp.xml");
+    QFile file(tableTempXML);
+    QDomDocument doc;
+    QTextStream stream;
+    stream.setDevice(&file);
+    if(!file.open(QIODevice::ReadWrite|QIODevice::Text))
+    {
+        globalpara.reportError("Fail to open case file for the table surrogate.",this);
+        return;
+    }
+    if(!doc.setContent(&file))
+    {
+        globalpara.reportError("Fail to load xml document for the table surrogate.",this);
+        file.close();
+        return;
+    }
+    QDomElement tableData = doc.elementsByTagName("TableData").at(0).toElement();
+    auto tablesByTitle = Sorputils::mapElementsByAttribute(tableData.childNodes(), "title");
+    QString tableTitle = ui->tabWidget->tabText(ui->tabWidget->currentIndex());
+    QDomElement currentTable = tablesByTitle[tableTitle];
+    QStringList inputEntries = currentTable.elementsByTagName("inputEntries").at(0).toElement().text().split(";");
+    QStringList outputEntries = currentTable.elementsByTagName("outputEntries").at(0).toElement().text().split(";");
+    QStringList tHeader = currentTable.elementsByTagName("header").at(0).toElement().text().split(";");
+    QStringList inputNames, outputNames;
+    for(int i = 0; i < tHeader.count(); i++)
+    {
+        if(i < inputEntries.count())
+            inputNames<<tHeader.at(i).simplified();
+        else
+            outputNames<<tHeader.at(i).simplified();
+    }
+
+    // only the runs solved with the inputs they have now in the case as it is now, not
+    // failed or estimated ones
+    QVector<QVector<double> > points, values;
+    int runs = currentTable.attribute("runs").toInt();
+    QDomNodeList runNodes = currentTable.elementsByTagName("Run");
+    QString baseHash, tableCaseHash;
+    if(runs > 0 && !caseHash(currentTable, runNodes.at(0).toElement(), tableCaseHash))
+    {
+        file.close();
+        return;
+    }
+    for(int i = 0; i < runs; i++)
+    {
+        QDomElement currentRun = runNodes.at(i).toElement();
+        QString inputHash = currentRun.attribute("inputHash");
+        if(inputHash.isEmpty() || inputHash != runInputHash(currentTable, currentRun))
+            continue;
+        if(!runBaseHashOf(currentTable, currentRun, baseHash))
+        {
+            file.close();
+            return;
+        }
+        if(currentRun.attribute("baseHash") != baseHash)
+            continue;
+        QDomNodeList inputs = currentRun.elementsByTagName("Input");
+        QDomNodeList outputs = currentRun.elementsByTagName("Output");
+        QVector<double> point, value;
+        for(int j = 0; j < inputEntries.count(); j++)
+            point<<inputs.at(j).toElement().elementsByTagName("value").at(0).toElement().text().toDouble();
+        for(int j = 0; j < outputEntries.count(); j++)
+            value<<outputs.at(j).toElement().elementsByTagName("value").at(0).toElement().text().toDouble();
+        points<<point;
+        values<<value;
+    }
+    if(points.isEmpty())
+    {
+        file.close();
+        globalpara.reportError("No run of the table is calculated with its current inputs and the case "
+                               "as it is now, please calculate the table first.",this);
+        return;
+    }
+
+    responseSurface existing = responseSurface::fromXml(currentTable.firstChildElement("surrogate"));
+    surrogateDialog sDialog(inputNames, inputEntries, outputNames, outputEntries, points, values, existing, this);
+    if(sDialog.exec() != QDialog::Accepted)
+    {
+        file.close();
+        return;
+    }
+    QDomElement oldSurrogate = currentTable.firstChildElement("surrogate");
+    if(!oldSurrogate.isNull())
+        currentTable.removeChild(oldSurrogate);
+    responseSurface surface = sDialog.surface();
+    if(surface.isValid())
+    {
+        QDomElement surrogate = surface.toXml(doc);
+        surrogate.setAttribute("caseHash", tableCaseHash);
+        currentTable.appendChild(surrogate);
+    }
+    file.resize(0);
+    doc.save(stream,4);
+    file.close();
+}
+
 void tableDialog::on_deleteTButton_clicked()
 {
     QMessageBox * askBox = new QMessageBox(this);
@@ -21,8 +21,12 @@
 #include "dataComm.h"
 #include <QTableWidget>
 #include <QList>
+#include <QVector>
+#include <QStringList>
 #include <QByteArray>
 #include <QPrinter>
+#include <QDomDocument>
+#include <QDomElement>
 
 namespace Ui {
 class tableDialog;
@@ -36,6 +40,13 @@ class tableDialog;
  * - if calculation is not successful in one row, it is stopped and the problematic row is highlighted
  * - if the table inputs are changing gradualy, it is recommended to check the "update guess values" to update the guess value
  * - after each successful row so that it's more likely to achieve a successful calculation for next row
+ * - without guess updating the runs are independent and are solved in parallel by the solverPool
+ * - each calculated run keeps hashes of its inputs and of the case it was solved in ("inputHash",
+ *   "baseHash" of the Run element), so "only calculate changed runs" can skip the runs that are up to date
+ * - a surrogate (responseSurface) fitted to the runs calculated in the case as it is now is kept with the
+ *   table, with a hash of the case ("caseHash" of the surrogate element); with "estimate with surrogate" the
+ *   outputs are estimated from it instead of solved, and runs outside its range are highlighted; once the
+ *   case changed, it has to be fitted again
  * - called by mainwindow.cpp
  *
  * Naming pattern:
@@ -73,6 +84,10 @@ private slots:
 
     void on_alterVarButton_clicked();
 
+    void on_designButton_clicked();
+
+    void on_surrogateButton_clicked();
+
     bool setupTables(bool init=true);
 
     QString translateInput(QStringList inputEntries, int index, int item);
@@ -118,6 +133,21 @@ private:
     void showEvent(QShowEvent *e);
     void paste();
 
+    bool buildInputs(calInputs &runInputs);
+    void applyRunInputs(const QDomElement &currentTable, const QDomElement &currentRun);
+    /// runBaseHash() of a run, with its inputs applied to the table's copy of the case
+    bool runBaseHashOf(const QDomElement &currentTable, const QDomElement &currentRun, QString &hash);
+    /// hash of the case apart from the inputs of the table, to tell whether a surrogate fits the case
+    bool caseHash(const QDomElement &currentTable, const QDomElement &anyRun, QString &hash);
+    void storeRunOutputs(QDomDocument &doc, const QDomElement &currentTable, const QDomElement &currentRun,
+                         QTableWidget *table, int run);
+    void markRunFailed(QTableWidget *table, int run, int nInputs, int nOutputs);
+    bool calcTableParallel(QDomDocument &doc, const QDomElement &currentTable, QTableWidget *table,
+                           const QVector<QDomElement> &runList, const QVector<bool> &stale,
+                           const QStringList &inputHashes, const QStringList &baseHashes);
+    bool estimateTable(QDomDocument &doc, const QDomElement &currentTable, QTableWidget *table,
+                       const QVector<QDomElement> &runList);
+
 };
 
 #endif // TABLEDIALOG_H
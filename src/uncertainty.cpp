@@ -0,0 +1,520 @@
+/*! \file uncertainty.cpp
+    \brief Monte Carlo propagation of uncertain inputs to the results of a case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <QtNumeric>
+
+#include "uncertainty.h"
+#include "optimizer.h"
+#include "solverpool.h"
+#include "sorpsimEngine.h"
+
+extern calOutputs outputs;
+
+namespace {
+
+/// values that set the start of the quantile markers and the histogram range
+const int firstValues = 64;
+/// samples before the confidence of the means is trusted
+const int minSamples = 100;
+/// time limit for one sample solved by the worker pool [ms]
+const int sampleTimeout = 60000;
+const double pi = 3.14159265358979323846;
+
+/// histogram range that holds values with a margin
+void histogramRange(const QVector<double> &values, double &lower, double &width)
+{
+    double low = values.first(), high = values.first();
+    for(int i = 1; i < values.count(); i++)
+    {
+        low = qMin(low, values.at(i));
+        high = qMax(high, values.at(i));
+    }
+    if(high > low)
+    {
+        width = 1.1*(high-low)/runningStatistics::histogramBins;
+        lower = low-0.05*(high-low);
+    }
+    else
+    {
+        width = qMax(1.e-3*qAbs(low), 1.e-9);
+        lower = low-0.5*width*runningStatistics::histogramBins;
+    }
+}
+
+/// uniform on (0,1) from 32 random bits, the same on every platform
+double uniform(std::mt19937 &random)
+{
+    return (random()+0.5)/4294967296.0;
+}
+
+double standardNormal(std::mt19937 &random)
+{
+    // Box-Muller
+    double u1 = uniform(random), u2 = uniform(random);
+    return std::sqrt(-2*std::log(u1))*std::cos(2*pi*u2);
+}
+
+double draw(const uncertainInput &input, std::mt19937 &random)
+{
+    switch(input.distribution)
+    {
+    case uncertainInput::Uniform:
+        return input.lower+(input.upper-input.lower)*uniform(random);
+    case uncertainInput::Triangular:
+    {
+        double u = uniform(random), range = input.upper-input.lower;
+        if(range <= 0)
+            return input.mode;
+        if(u < (input.mode-input.lower)/range)
+            return input.lower+std::sqrt(u*range*(input.mode-input.lower));
+        return input.upper-std::sqrt((1-u)*range*(input.upper-input.mode));
+    }
+    case uncertainInput::LogNormal:
+    {
+        if(input.mean <= 0)
+            return input.mean;
+        double s2 = std::log(1+input.deviation*input.deviation/(input.mean*input.mean));
+        return std::exp(std::log(input.mean)-0.5*s2+std::sqrt(s2)*standardNormal(random));
+    }
+    default:
+        return input.mean+input.deviation*standardNormal(random);
+    }
+}
+
+/// a draw that the input can take: only temperatures can be negative, and concentrations are percents
+double drawValid(const uncertainInput &input, std::mt19937 &random)
+{
+    double value = draw(input, random);
+    if(input.item.quantity == sensitivityReport::Temperature)
+        return value;
+    double top = input.item.quantity == sensitivityReport::Concentration ? 100 : qInf();
+    for(int attempt = 0; attempt < 100 && (value < 0 || value > top); attempt++)
+        value = draw(input, random);
+    return qBound(0.0, value, top);
+}
+
+bool converged(solverPool::Status status, const calOutputs &result)
+{
+    return status == solverPool::Finished && !result.stopped && result.IER >= 1 && result.IER <= 3;
+}
+
+}
+
+runningStatistics::runningStatistics() :
+    n(0),
+    runningMean(0),
+    sumSquares(0),
+    low(0),
+    high(0),
+    binLower(0),
+    width(0)
+{
+    QVector<double> levels = quantileLevels();
+    for(int i = 0; i < levels.count(); i++)
+    {
+        marker m;
+        m.p = levels.at(i);
+        markers<<m;
+    }
+}
+
+QVector<double> runningStatistics::quantileLevels()
+{
+    return QVector<double>()<<0.025<<0.05<<0.5<<0.95<<0.975;
+}
+
+void runningStatistics::add(double value)
+{
+    if(!qIsFinite(value))
+        return;
+    n++;
+    double delta = value-runningMean;
+    runningMean += delta/n;
+    sumSquares += delta*(value-runningMean);
+    low = n == 1 ? value : qMin(low, value);
+    high = n == 1 ? value : qMax(high, value);
+
+    if(first.count() < firstValues)
+        first<<value;
+    if(n == 5)
+    {
+        QVector<double> sorted = first;
+        std::sort(sorted.begin(), sorted.end());
+        for(int i = 0; i < markers.count(); i++)
+        {
+            marker &m = markers[i];
+            double desired[5] = {1, 1+2*m.p, 1+4*m.p, 3+2*m.p, 5};
+            for(int k = 0; k < 5; k++)
+            {
+                m.height[k] = sorted.at(k);
+                m.position[k] = k+1;
+                m.desired[k] = desired[k];
+            }
+        }
+    }
+    else if(n > 5)
+    {
+        for(int i = 0; i < markers.count(); i++)
+            addQuantile(markers[i], value);
+    }
+
+    if(n == firstValues)
+        setupHistogram();
+    else if(n > firstValues)
+        addHistogram(value);
+}
+
+void runningStatistics::addQuantile(marker &m, double value)
+{
+    int k;
+    if(value < m.height[0])
+    {
+        m.height[0] = value;
+        k = 0;
+    }
+    else if(value >= m.height[4])
+    {
+        m.height[4] = value;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while(k < 3 && value >= m.height[k+1])
+            k++;
+    }
+    for(int i = k+1; i < 5; i++)
+        m.position[i] += 1;
+    double increment[5] = {0, m.p/2, m.p, (1+m.p)/2, 1};
+    for(int i = 0; i < 5; i++)
+        m.desired[i] += increment[i];
+
+    // move the middle markers towards their desired positions, by a parabola through their neighbours
+    for(int i = 1; i < 4; i++)
+    {
+        double d = m.desired[i]-m.position[i];
+        if((d >= 1 && m.position[i+1]-m.position[i] > 1) || (d <= -1 && m.position[i-1]-m.position[i] < -1))
+        {
+            int s = d > 0 ? 1 : -1;
+            double h = m.height[i]+s/(m.position[i+1]-m.position[i-1])
+                    *((m.position[i]-m.position[i-1]+s)*(m.height[i+1]-m.height[i])/(m.position[i+1]-m.position[i])
+                      +(m.position[i+1]-m.position[i]-s)*(m.height[i]-m.height[i-1])/(m.position[i]-m.position[i-1]));
+            if(!(m.height[i-1] < h && h < m.height[i+1]))
+                h = m.height[i]+s*(m.height[i+s]-m.height[i])/(m.position[i+s]-m.position[i]);
+            m.height[i] = h;
+            m.position[i] += s;
+        }
+    }
+}
+
+void runningStatistics::setupHistogram()
+{
+    histogramRange(first, binLower, width);
+    bins = QVector<qint64>(histogramBins, 0);
+    for(int i = 0; i < first.count(); i++)
+        addHistogram(first.at(i));
+}
+
+void runningStatistics::addHistogram(double value)
+{
+    // double the range towards the value until it fits, two bins becoming one
+    while(value < binLower || value >= binLower+histogramBins*width)
+    {
+        QVector<qint64> merged(histogramBins, 0);
+        int offset = value < binLower ? histogramBins/2 : 0;
+        for(int k = 0; k < histogramBins; k++)
+            merged[offset+k/2] += bins.at(k);
+        if(value < binLower)
+            binLower -= histogramBins*width;
+        width *= 2;
+        bins = merged;
+    }
+    bins[qBound(0, int((value-binLower)/width), histogramBins-1)]++;
+}
+
+qint64 runningStatistics::count() const
+{
+    return n;
+}
+
+double runningStatistics::mean() const
+{
+    return runningMean;
+}
+
+double runningStatistics::variance() const
+{
+    return n > 1 ? sumSquares/(n-1) : 0;
+}
+
+double runningStatistics::minimum() const
+{
+    return low;
+}
+
+double runningStatistics::maximum() const
+{
+    return high;
+}
+
+double runningStatistics::meanHalfWidth(double z) const
+{
+    return n > 1 ? z*std::sqrt(variance()/n) : qInf();
+}
+
+double runningStatistics::quantile(int i) const
+{
+    if(n == 0)
+        return qQNaN();
+    if(n > 5)
+        return markers.at(i).height[2];
+    // too few values for the markers: interpolate between the sorted values
+    QVector<double> sorted = first;
+    std::sort(sorted.begin(), sorted.end());
+    double position = markers.at(i).p*(sorted.count()-1);
+    int k = qMin(int(position), sorted.count()-1);
+    if(k+1 >= sorted.count())
+        return sorted.at(k);
+    return sorted.at(k)+(position-k)*(sorted.at(k+1)-sorted.at(k));
+}
+
+double runningStatistics::histogramLower() const
+{
+    if(bins.isEmpty() && !first.isEmpty())
+    {
+        double lower, binSize;
+        histogramRange(first, lower, binSize);
+        return lower;
+    }
+    return binLower;
+}
+
+double runningStatistics::binWidth() const
+{
+    if(bins.isEmpty() && !first.isEmpty())
+    {
+        double lower, binSize;
+        histogramRange(first, lower, binSize);
+        return binSize;
+    }
+    return width;
+}
+
+QVector<qint64> runningStatistics::histogram() const
+{
+    if(!bins.isEmpty() || first.isEmpty())
+        return bins.isEmpty() ? QVector<qint64>(histogramBins, 0) : bins;
+    // below firstValues values the range isn't fixed yet
+    double lower, binSize;
+    histogramRange(first, lower, binSize);
+    QVector<qint64> counts(histogramBins, 0);
+    for(int i = 0; i < first.count(); i++)
+        counts[qBound(0, int((first.at(i)-lower)/binSize), histogramBins-1)]++;
+    return counts;
+}
+
+uncertaintyAnalysis::uncertaintyAnalysis() :
+    seed(1),
+    maxSamples(10000),
+    confidence(0.95),
+    tolerance(0),
+    failed(0)
+{
+}
+
+void uncertaintyAnalysis::setInputs(const calInputs &inputs)
+{
+    base = inputs;
+    base.sensitivity = false;
+}
+
+void uncertaintyAnalysis::addInput(const uncertainInput &input)
+{
+    inputs<<input;
+}
+
+void uncertaintyAnalysis::addOutput(const sensitivityReport::item &item)
+{
+    followed<<item;
+}
+
+void uncertaintyAnalysis::setSeed(quint32 value)
+{
+    seed = value;
+}
+
+void uncertaintyAnalysis::setMaxSamples(qint64 samples)
+{
+    maxSamples = qMax(samples, qint64(1));
+}
+
+void uncertaintyAnalysis::setTarget(double level, double relativeTolerance)
+{
+    confidence = qBound(0.5, level, 0.9999);
+    tolerance = qMax(relativeTolerance, 0.0);
+}
+
+QString uncertaintyAnalysis::message() const
+{
+    return endMessage;
+}
+
+qint64 uncertaintyAnalysis::samples() const
+{
+    return stats.isEmpty() ? 0 : stats.first().count();
+}
+
+qint64 uncertaintyAnalysis::failures() const
+{
+    return failed;
+}
+
+const runningStatistics &uncertaintyAnalysis::statistics(int i) const
+{
+    return stats.at(i);
+}
+
+bool uncertaintyAnalysis::confident() const
+{
+    if(tolerance <= 0 || samples() < minSamples)
+        return false;
+    double z = normalQuantile(0.5+0.5*confidence);
+    for(int i = 0; i < stats.count(); i++)
+        if(stats.at(i).meanHalfWidth(z) > tolerance*qMax(qAbs(stats.at(i).mean()), 1.e-12))
+            return false;
+    return true;
+}
+
+bool uncertaintyAnalysis::run(const progressHandler &progress)
+{
+    stats = QVector<runningStatistics>(followed.count());
+    failed = 0;
+    endMessage.clear();
+    if(inputs.isEmpty())
+    {
+        endMessage = "No uncertain inputs.";
+        return false;
+    }
+    if(followed.isEmpty())
+    {
+        endMessage = "No results to follow.";
+        return false;
+    }
+
+    std::mt19937 random(seed);
+    int workers = solverPool::shared()->workerCount();
+    int batchSize = workers > 0 ? qMax(64, 16*workers) : 16;
+    // only one batch of inputs and results is held at a time
+    QVector<calInputs> batch;
+    QVector<double> values;
+    QVector<bool> solved;
+    qint64 drawn = 0;
+    while(drawn < maxSamples)
+    {
+        int count = int(qMin(qint64(batchSize), maxSamples-drawn));
+        batch.resize(count);
+        for(int j = 0; j < count; j++)
+        {
+            batch[j] = base;
+            for(int i = 0; i < inputs.count(); i++)
+                designOptimizer::setInputValue(batch[j], inputs.at(i).item, drawValid(inputs.at(i), random));
+        }
+        drawn += count;
+
+        values = QVector<double>(count*followed.count(), 0);
+        solved = QVector<bool>(count, false);
+        auto collect = [&](int job, const calOutputs &result)
+        {
+            solved[job] = true;
+            for(int o = 0; o < followed.count(); o++)
+                values[job*followed.count()+o] = outputValue(result, followed.at(o));
+        };
+        bool started = solverPool::shared()->solve(batch, sampleTimeout,
+            [&](int job, solverPool::Status status, const calOutputs &result)
+        {
+            if(converged(status, result))
+                collect(job, result);
+        });
+        if(!started)
+        {
+            // no worker processes, solve in this process
+            for(int j = 0; j < count; j++)
+            {
+                absdCal(0,0,batch.at(j),false);
+                if(converged(solverPool::Finished, outputs))
+                    collect(j, outputs);
+            }
+        }
+
+        // in the order of the samples, so the same seed gives the same statistics
+        for(int j = 0; j < count; j++)
+        {
+            if(!solved.at(j))
+            {
+                failed++;
+                continue;
+            }
+            for(int o = 0; o < followed.count(); o++)
+                stats[o].add(values.at(j*followed.count()+o));
+        }
+
+        if(progress && !progress())
+        {
+            endMessage = "Stopped after "+QString::number(drawn)+" samples.";
+            return true;
+        }
+        if(confident())
+        {
+            endMessage = "The requested confidence was reached after "+QString::number(drawn)+" samples.";
+            return true;
+        }
+    }
+    if(samples() == 0)
+    {
+        endMessage = "None of the "+QString::number(drawn)+" samples converged.";
+        return false;
+    }
+    endMessage = "All "+QString::number(drawn)+" samples were taken";
+    endMessage.append(tolerance > 0 ? ", the requested confidence was not reached." : ".");
+    return true;
+}
+
+double uncertaintyAnalysis::outputValue(const calOutputs &out, const sensitivityReport::item &item)
+{
+    switch(item.quantity)
+    {
+    case sensitivityReport::Temperature: return out.t[item.index];
+    case sensitivityReport::Enthalpy: return out.h[item.index];
+    case sensitivityReport::MassFlow: return out.f[item.index];
+    case sensitivityReport::Concentration: return out.c[item.index];
+    case sensitivityReport::Pressure: return out.p[item.index];
+    case sensitivityReport::VaporFraction: return out.w[item.index];
+    case sensitivityReport::HeatTransfer: return out.heat[item.index];
+    case sensitivityReport::UAValue: return out.ua[item.index];
+    case sensitivityReport::COP: return out.cop;
+    case sensitivityReport::Capacity: return out.capacity;
+    default: return qQNaN();
+    }
+}
+
+double uncertaintyAnalysis::normalQuantile(double p)
+{
+    // bisection on the normal distribution function
+    double lower = -10, upper = 10;
+    for(int i = 0; i < 80; i++)
+    {
+        double middle = 0.5*(lower+upper);
+        if(0.5*std::erfc(-middle/std::sqrt(2.0)) < p)
+            lower = middle;
+        else
+            upper = middle;
+    }
+    return 0.5*(lower+upper);
+}
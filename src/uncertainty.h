@@ -0,0 +1,166 @@
+/*! \file uncertainty.h
+    \brief Monte Carlo propagation of uncertain inputs to the results of a case
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef UNCERTAINTY_H
+#define UNCERTAINTY_H
+
+#include <functional>
+
+#include <QString>
+#include <QVector>
+
+#include "dataComm.h"
+
+/// An uncertain fixed input of the case and its distribution (engine units)
+struct uncertainInput
+{
+    enum Distribution { Normal, Uniform, Triangular, LogNormal };
+
+    sensitivityReport::item item;
+    int distribution = Normal;
+    /// Normal, LogNormal: mean and standard deviation of the input
+    double mean = 0;
+    double deviation = 0;
+    /// Uniform: lower and upper; Triangular: lower, mode and upper
+    double lower = 0;
+    double mode = 0;
+    double upper = 0;
+};
+
+/*!
+Summary statistics of a stream of values in constant memory, whatever the
+number of values:
+- mean and variance by Welford's update
+- quantiles by the P-square estimator of Jain and Chlamtac (five markers per
+  quantile, no values kept)
+- a histogram of a fixed number of bins: the range is set from the first
+  values, and doubled (merging pairs of bins) whenever a value falls outside
+*/
+class runningStatistics
+{
+public:
+    static const int histogramBins = 40;
+
+    runningStatistics();
+
+    void add(double value);
+
+    qint64 count() const;
+    double mean() const;
+    /// sample variance, 0 below two values
+    double variance() const;
+    double minimum() const;
+    double maximum() const;
+    /// half width of the confidence interval of the mean, z the normal quantile of the confidence
+    double meanHalfWidth(double z) const;
+
+    /// probabilities of the quantiles that are estimated
+    static QVector<double> quantileLevels();
+    /// estimate of the quantile at quantileLevels()[i]
+    double quantile(int i) const;
+
+    /// lower end of the first bin and the width of the bins
+    double histogramLower() const;
+    double binWidth() const;
+    QVector<qint64> histogram() const;
+
+private:
+    /// the markers of the P-square estimator of one quantile
+    struct marker
+    {
+        double p;
+        double height[5];
+        double position[5];
+        double desired[5];
+    };
+
+    void addQuantile(marker &m, double value);
+    void addHistogram(double value);
+    void setupHistogram();
+
+    qint64 n;
+    double runningMean;
+    double sumSquares;
+    double low, high;
+    /// the first values: the start of the markers and of the histogram range
+    QVector<double> first;
+    QVector<marker> markers;
+    double binLower;
+    double width;
+    QVector<qint64> bins;
+};
+
+/*!
+Propagates the uncertainty of some fixed inputs of a case (UA or other heat
+transfer specifications of the components, fixed temperatures, flow rates,
+concentrations and pressures of the state points) to its results (COP,
+capacity, or any result of the sensitivity report) by Monte Carlo sampling.
+
+The inputs are drawn independently from their distributions; negative draws
+of quantities that can't be negative are drawn again. The samples are solved
+in batches by the solver workers (solverPool), or in this process if there are
+none, each warm-started from the solver state of the case. Only a batch of
+samples is held at a time, and the results go into runningStatistics, so the
+memory doesn't grow with the number of samples. Samples that don't converge
+are counted and left out of the statistics.
+
+The sampling stops at the maximum number of samples, or earlier once the
+confidence interval of the mean of every result is within the requested
+relative tolerance of the mean. The same seed gives the same samples.
+
+Used by uncertaintyDialog.
+*/
+class uncertaintyAnalysis
+{
+public:
+    /// Called after each batch; return false to stop the sampling.
+    typedef std::function<bool()> progressHandler;
+
+    uncertaintyAnalysis();
+
+    /// The case, with the warm start of its solution.
+    void setInputs(const calInputs &base);
+    void addInput(const uncertainInput &input);
+    void addOutput(const sensitivityReport::item &item);
+    void setSeed(quint32 seed);
+    void setMaxSamples(qint64 samples);
+    /// Stop once the mean of every result is known within relativeTolerance of it,
+    /// with the given confidence (e.g. 0.95); a tolerance of 0 always takes all samples.
+    void setTarget(double confidence, double relativeTolerance);
+
+    /// \return false if the sampling couldn't start
+    bool run(const progressHandler &progress);
+
+    /// Why the sampling ended.
+    QString message() const;
+    /// Converged samples so far, and the ones that failed.
+    qint64 samples() const;
+    qint64 failures() const;
+    /// Statistics of the i-th output added, engine units.
+    const runningStatistics &statistics(int i) const;
+    /// The confidence interval of every mean is within the tolerance.
+    bool confident() const;
+
+    /// The value of a result in calOutputs (engine units).
+    static double outputValue(const calOutputs &out, const sensitivityReport::item &item);
+    /// Quantile of the standard normal distribution.
+    static double normalQuantile(double p);
+
+private:
+    calInputs base;
+    QVector<uncertainInput> inputs;
+    QVector<sensitivityReport::item> followed;
+    quint32 seed;
+    qint64 maxSamples;
+    double confidence;
+    double tolerance;
+
+    QVector<runningStatistics> stats;
+    qint64 failed;
+    QString endMessage;
+};
+
+#endif // UNCERTAINTY_H
@@ -0,0 +1,355 @@
+/*! \file uncertaintydialog.cpp
+    \brief Dialog to propagate the uncertainty of inputs of the current case to its results
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#include <cmath>
+
+#include <QApplication>
+#include <QComboBox>
+#include <QHeaderView>
+#include <QTableWidget>
+
+#include <qwt_plot.h>
+#include <qwt_plot_histogram.h>
+#include <qwt_samples.h>
+
+#include "uncertaintydialog.h"
+#include "ui_uncertaintydialog.h"
+#include "mainwindow.h"
+#include "calculate.h"
+#include "optimizer.h"
+#include "resultdialog.h"
+#include "unit.h"
+
+extern globalparameter globalpara;
+extern unit *dummy;
+
+namespace {
+
+enum InputColumns { UseColumn, NameColumn, ValueColumn, DistributionColumn, SpreadColumn, InputUnitColumn };
+enum OutputColumns { OutputUseColumn, OutputNameColumn, CaseColumn, MeanColumn, DeviationColumn,
+                     LowColumn, MedianColumn, HighColumn, OutputUnitColumn };
+/// quantiles shown in LowColumn, MedianColumn and HighColumn (see runningStatistics::quantileLevels())
+const int shownQuantiles[3] = {0, 2, 4};
+
+QTableWidgetItem *fixedItem(const QString &text)
+{
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+
+QTableWidgetItem *useItem(bool checked)
+{
+    QTableWidgetItem *item = new QTableWidgetItem;
+    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+    item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    return item;
+}
+
+/// a spread of a result in the unit system of the case, around its value there
+double resultSpread(const sensitivityReport::item &item, double value, double spread)
+{
+    return resultDialog::resultToCase(item,value+spread)-resultDialog::resultToCase(item,value);
+}
+
+}
+
+uncertaintyDialog::uncertaintyDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::uncertaintyDialog),
+    ready(false),
+    running(false),
+    stopRequested(false)
+{
+    ui->setupUi(this);
+    setWindowTitle("Uncertainty Analysis");
+    setWindowModality(Qt::ApplicationModal);
+
+    histogramPlot = new QwtPlot(this);
+    histogramPlot->setCanvasBackground(Qt::white);
+    histogramPlot->setMinimumHeight(160);
+    histogramItem = new QwtPlotHistogram;
+    histogramItem->setStyle(QwtPlotHistogram::Columns);
+    histogramItem->attach(histogramPlot);
+    ui->histogramLayout->addWidget(histogramPlot);
+
+    calculate mycal(dummy);
+    if(mycal.buildInputs(globalpara,baseInputs))
+    {
+        baseInputs.sensitivity = true;
+        if(globalpara.lastSolution.isValid())
+            baseInputs.warmStart = globalpara.lastSolution;
+        calOutputs result;
+        QString error;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        bool solved = designOptimizer::solveCase(baseInputs,result,&error);
+        QApplication::restoreOverrideCursor();
+        if(!solved)
+            log("The case as it is can't be solved ("+error+"), the samples need a converged case to start from.");
+        else if(!result.sensitivity.isValid())
+            log("No fixed inputs and results of the case: "+result.sensitivity.message);
+        else
+        {
+            baseReport = result.sensitivity;
+            baseInputs.warmStart = result.state;
+            ready = true;
+            log("Check the uncertain inputs and give their distributions, and the results to follow.");
+        }
+    }
+    setupTables();
+    ui->runButton->setEnabled(ready);
+}
+
+uncertaintyDialog::~uncertaintyDialog()
+{
+    delete ui;
+}
+
+void uncertaintyDialog::setupTables()
+{
+    QStringList headers;
+    headers<<"Use"<<"Input"<<"Value"<<"Distribution"<<"Spread"<<"Unit";
+    QTableWidget *table = ui->inputTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->horizontalHeaderItem(SpreadColumn)->setToolTip("Standard deviation (normal, lognormal) or half width "
+                                                          "(uniform, triangular) around the value");
+    table->setRowCount(baseReport.inputs.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    for(int i = 0; i < baseReport.inputs.count(); i++)
+    {
+        const sensitivityReport::item &item = baseReport.inputs.at(i);
+        double value = resultDialog::inputToCase(item,designOptimizer::inputValue(baseInputs,item));
+        double spread = item.quantity == sensitivityReport::Temperature ? 1 : 0.05*qAbs(value);
+        QComboBox *distribution = new QComboBox;
+        distribution->addItem("Normal");
+        distribution->addItem("Uniform");
+        distribution->addItem("Triangular");
+        distribution->addItem("Lognormal");
+        table->setItem(i,UseColumn,useItem(false));
+        table->setItem(i,NameColumn,fixedItem(resultDialog::sensitivityName(item)));
+        table->setItem(i,ValueColumn,fixedItem(QString::number(value)));
+        table->setCellWidget(i,DistributionColumn,distribution);
+        table->setItem(i,SpreadColumn,new QTableWidgetItem(QString::number(spread)));
+        table->setItem(i,InputUnitColumn,fixedItem(resultDialog::sensitivityUnit(item)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    headers.clear();
+    headers<<"Use"<<"Result"<<"Value"<<"Mean"<<"Std. Dev.";
+    QVector<double> levels = runningStatistics::quantileLevels();
+    for(int k = 0; k < 3; k++)
+        headers<<QString::number(100*levels.at(shownQuantiles[k]))+"%";
+    headers<<"Unit";
+    table = ui->outputTable;
+    table->setColumnCount(headers.count());
+    table->setHorizontalHeaderLabels(headers);
+    table->setRowCount(baseReport.outputs.count());
+    table->verticalHeader()->setVisible(false);
+    table->setAlternatingRowColors(true);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    for(int o = 0; o < baseReport.outputs.count(); o++)
+    {
+        const sensitivityReport::item &item = baseReport.outputs.at(o);
+        bool system = item.quantity == sensitivityReport::COP || item.quantity == sensitivityReport::Capacity;
+        table->setItem(o,OutputUseColumn,useItem(system));
+        table->setItem(o,OutputNameColumn,fixedItem(resultDialog::sensitivityName(item)));
+        table->setItem(o,CaseColumn,fixedItem(QString::number(resultDialog::resultToCase(item,baseReport.results.at(o)))));
+        for(int column = MeanColumn; column <= HighColumn; column++)
+            table->setItem(o,column,fixedItem(""));
+        table->setItem(o,OutputUnitColumn,fixedItem(resultDialog::sensitivityUnit(item)));
+    }
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+}
+
+void uncertaintyDialog::on_runButton_clicked()
+{
+    analysis = uncertaintyAnalysis();
+    analysis.setInputs(baseInputs);
+    int uncertain = 0;
+
+    QTableWidget *table = ui->inputTable;
+    for(int i = 0; i < table->rowCount(); i++)
+    {
+        if(table->item(i,UseColumn)->checkState() != Qt::Checked)
+            continue;
+        uncertainInput input;
+        input.item = baseReport.inputs.at(i);
+        input.distribution = qobject_cast<QComboBox*>(table->cellWidget(i,DistributionColumn))->currentIndex();
+        bool ok = false;
+        double spread = table->item(i,SpreadColumn)->text().toDouble(&ok);
+        if(!ok || spread < 0)
+        {
+            globalpara.reportError("Please enter a spread of at least 0 for \""+table->item(i,NameColumn)->text()+"\".",this);
+            return;
+        }
+        double value = table->item(i,ValueColumn)->text().toDouble();
+        if(input.distribution == uncertainInput::LogNormal && value <= 0)
+        {
+            globalpara.reportError("A lognormal distribution needs a positive value of \""
+                                   +table->item(i,NameColumn)->text()+"\".",this);
+            return;
+        }
+        input.mean = resultDialog::inputToEngine(input.item,value);
+        input.deviation = qAbs(resultDialog::inputToEngine(input.item,value+spread)-input.mean);
+        input.lower = resultDialog::inputToEngine(input.item,value-spread);
+        input.mode = input.mean;
+        input.upper = resultDialog::inputToEngine(input.item,value+spread);
+        analysis.addInput(input);
+        uncertain++;
+    }
+    if(uncertain == 0)
+    {
+        globalpara.reportError("Please check at least one uncertain input.",this);
+        return;
+    }
+
+    followed.clear();
+    table = ui->outputTable;
+    for(int o = 0; o < table->rowCount(); o++)
+    {
+        for(int column = MeanColumn; column <= HighColumn; column++)
+            table->item(o,column)->setText("");
+        if(table->item(o,OutputUseColumn)->checkState() != Qt::Checked)
+            continue;
+        analysis.addOutput(baseReport.outputs.at(o));
+        followed<<o;
+    }
+    if(followed.isEmpty())
+    {
+        globalpara.reportError("Please check at least one result to follow.",this);
+        return;
+    }
+
+    double confidence = ui->confidenceBox->currentText().remove('%').toDouble()/100;
+    analysis.setMaxSamples(ui->samplesBox->value());
+    analysis.setSeed(quint32(ui->seedBox->value()));
+    analysis.setTarget(confidence,ui->toleranceBox->value()/100);
+
+    running = true;
+    stopRequested = false;
+    ui->runButton->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+    ui->stopButton->setEnabled(true);
+    ui->logText->clear();
+    log("Sampling "+QString::number(uncertain)+" uncertain input(s)...");
+
+    bool done = analysis.run([&]()
+    {
+        log(QString::number(analysis.samples())+" samples solved, "+QString::number(analysis.failures())+" failed");
+        showStatistics();
+        QApplication::processEvents();
+        return !stopRequested;
+    });
+
+    running = false;
+    ui->runButton->setEnabled(true);
+    ui->closeButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
+    log(analysis.message());
+    if(done)
+    {
+        showStatistics();
+        double z = uncertaintyAnalysis::normalQuantile(0.5+0.5*confidence);
+        for(int i = 0; i < followed.count(); i++)
+        {
+            const sensitivityReport::item &item = baseReport.outputs.at(followed.at(i));
+            const runningStatistics &stats = analysis.statistics(i);
+            if(stats.count() < 2)
+                continue;
+            log(resultDialog::sensitivityName(item)+": mean "
+                +QString::number(resultDialog::resultToCase(item,stats.mean()))+" +/- "
+                +QString::number(resultSpread(item,stats.mean(),stats.meanHalfWidth(z)),'g',3)+" "
+                +resultDialog::sensitivityUnit(item)+" ("+ui->confidenceBox->currentText()+" confidence)");
+        }
+        if(analysis.failures() > 0)
+            log(QString::number(analysis.failures())+" samples didn't converge and are left out of the statistics.");
+    }
+}
+
+void uncertaintyDialog::on_stopButton_clicked()
+{
+    stopRequested = true;
+}
+
+void uncertaintyDialog::on_closeButton_clicked()
+{
+    reject();
+}
+
+void uncertaintyDialog::on_outputTable_itemSelectionChanged()
+{
+    showHistogram();
+}
+
+void uncertaintyDialog::showStatistics()
+{
+    QTableWidget *table = ui->outputTable;
+    for(int i = 0; i < followed.count(); i++)
+    {
+        int row = followed.at(i);
+        const sensitivityReport::item &item = baseReport.outputs.at(row);
+        const runningStatistics &stats = analysis.statistics(i);
+        if(stats.count() == 0)
+            continue;
+        table->item(row,MeanColumn)->setText(QString::number(resultDialog::resultToCase(item,stats.mean())));
+        table->item(row,DeviationColumn)->setText(
+                    QString::number(resultSpread(item,stats.mean(),std::sqrt(stats.variance())),'g',4));
+        for(int k = 0; k < 3; k++)
+            table->item(row,LowColumn+k)->setText(
+                        QString::number(resultDialog::resultToCase(item,stats.quantile(shownQuantiles[k]))));
+    }
+    showHistogram();
+}
+
+void uncertaintyDialog::showHistogram()
+{
+    int row = ui->outputTable->currentRow();
+    int followedIndex = followed.indexOf(row);
+    if(followedIndex < 0 && !followed.isEmpty())
+    {
+        followedIndex = 0;
+        row = followed.first();
+    }
+    QVector<QwtIntervalSample> samples;
+    if(followedIndex >= 0 && analysis.samples() > 0)
+    {
+        const sensitivityReport::item &item = baseReport.outputs.at(row);
+        const runningStatistics &stats = analysis.statistics(followedIndex);
+        if(stats.count() > 0)
+        {
+            QVector<qint64> counts = stats.histogram();
+            double lower = stats.histogramLower(), width = stats.binWidth();
+            for(int k = 0; k < counts.count(); k++)
+                samples<<QwtIntervalSample(counts.at(k),
+                                           resultDialog::resultToCase(item,lower+k*width),
+                                           resultDialog::resultToCase(item,lower+(k+1)*width));
+            histogramPlot->setAxisTitle(QwtPlot::xBottom,resultDialog::sensitivityName(item)
+                                        +" ["+resultDialog::sensitivityUnit(item)+"]");
+            histogramPlot->setAxisTitle(QwtPlot::yLeft,"Samples");
+        }
+    }
+    histogramItem->setSamples(samples);
+    histogramPlot->replot();
+}
+
+void uncertaintyDialog::log(const QString &line)
+{
+    ui->logText->appendPlainText(line);
+}
+
+void uncertaintyDialog::reject()
+{
+    // closing while the samples are solved only stops the sampling
+    if(running)
+    {
+        stopRequested = true;
+        return;
+    }
+    QDialog::reject();
+}
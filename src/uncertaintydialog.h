@@ -0,0 +1,68 @@
+/*! \file uncertaintydialog.h
+    \brief Dialog to propagate the uncertainty of inputs of the current case to its results
+
+    This file is part of SorpSim and is distributed under terms in the file LICENSE.
+*/
+
+#ifndef UNCERTAINTYDIALOG_H
+#define UNCERTAINTYDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "dataComm.h"
+#include "uncertainty.h"
+
+class QwtPlot;
+class QwtPlotHistogram;
+
+namespace Ui {
+class uncertaintyDialog;
+}
+
+/// Dialog for a Monte Carlo uncertainty analysis of the current case (see uncertaintyAnalysis)
+/// - solves the case once with sensitivities to list its fixed inputs and its results
+/// - each uncertain input is spread around its value in the case, in the unit system of the case
+/// - the statistics of the chosen results and a histogram are updated while the samples are solved
+/// - called by mainwindow.cpp
+class uncertaintyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit uncertaintyDialog(QWidget *parent = 0);
+    ~uncertaintyDialog();
+
+public slots:
+    void reject();
+
+private slots:
+    void on_runButton_clicked();
+
+    void on_stopButton_clicked();
+
+    void on_closeButton_clicked();
+
+    void on_outputTable_itemSelectionChanged();
+
+private:
+    Ui::uncertaintyDialog *ui;
+
+    void setupTables();
+    void showStatistics();
+    void showHistogram();
+    void log(const QString &line);
+
+    calInputs baseInputs;
+    sensitivityReport baseReport;
+    uncertaintyAnalysis analysis;
+    /// rows of the output table that are followed, in the order of the analysis
+    QVector<int> followed;
+    QwtPlot *histogramPlot;
+    QwtPlotHistogram *histogramItem;
+    bool ready;
+    bool running;
+    bool stopRequested;
+};
+
+#endif // UNCERTAINTYDIALOG_H